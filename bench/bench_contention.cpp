@@ -0,0 +1,165 @@
+#include "../include/atomic_bitset.h"
+#include "../include/bitwise_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Shared-bitmap contention: random set/clear pairs on one bitmap and acquire/release pairs on a
+// slot pool, each through AtomicBitset / SlotAllocator and through a mutex around a plain
+// uint32_t bitmap, from 1 thread up to N.
+// Usage: bench_contention [operations per thread] [max threads] (default 1000000, max(4, hardware threads))
+
+namespace
+{
+  const std::size_t kBitmapBits = 1 << 16;
+  const std::size_t kSlots = 1024;
+
+  // The baseline a caller writes today: the repo's word helpers under one lock
+  class MutexBitmap
+  {
+  public:
+    explicit MutexBitmap(std::size_t bits) : words_((bits + 31) / 32, 0) {}
+
+    bool setBit(std::size_t position)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      uint32_t &word = words_[position / 32];
+      bool previous = bitwise::isBitSet(word, static_cast<int>(position % 32));
+      word = bitwise::setBit(word, static_cast<int>(position % 32));
+      return previous;
+    }
+
+    bool clearBit(std::size_t position)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      uint32_t &word = words_[position / 32];
+      bool previous = bitwise::isBitSet(word, static_cast<int>(position % 32));
+      word = bitwise::clearBit(word, static_cast<int>(position % 32));
+      return previous;
+    }
+
+    // First-fit slot allocation: lowest clear bit, scanning from the start
+    std::size_t acquire()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (std::size_t w = 0; w < words_.size(); ++w)
+      {
+        if (words_[w] != ~0U)
+        {
+          int bit = bitwise::countTrailingZeros(~words_[w]);
+          words_[w] = bitwise::setBit(words_[w], bit);
+          return w * 32 + static_cast<std::size_t>(bit);
+        }
+      }
+      return bitwise::SlotAllocator::kNoSlot;
+    }
+
+    void release(std::size_t slot) { clearBit(slot); }
+
+  private:
+    std::mutex mutex_;
+    std::vector<uint32_t> words_;
+  };
+
+  // Wall time for threads workers each running body(thread index)
+  template <typename Fn>
+  double timeThreads(unsigned threads, Fn body)
+  {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t)
+      workers.emplace_back(body, t);
+    for (std::thread &worker : workers)
+      worker.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+
+  // Random positions per thread, generated up front so the timed loops only touch the bitmap
+  std::vector<std::vector<uint32_t>> positions(unsigned threads, std::size_t count)
+  {
+    std::vector<std::vector<uint32_t>> all(threads);
+    for (unsigned t = 0; t < threads; ++t)
+    {
+      std::mt19937 rng(t + 1);
+      all[t].resize(count);
+      for (uint32_t &p : all[t])
+        p = rng() % kBitmapBits;
+    }
+    return all;
+  }
+
+  template <typename Bitmap>
+  double updateRate(Bitmap &bitmap, unsigned threads, const std::vector<std::vector<uint32_t>> &where)
+  {
+    double seconds = timeThreads(threads, [&](unsigned t)
+                                 {
+                                   for (uint32_t p : where[t])
+                                   {
+                                     bitmap.setBit(p);
+                                     bitmap.clearBit(p);
+                                   } });
+    return 2.0 * threads * where[0].size() / seconds / 1e6;
+  }
+
+  // Each thread holds up to four slots at a time, releasing the oldest before taking a new one
+  template <typename Pool>
+  double slotRate(Pool &pool, unsigned threads, std::size_t operations)
+  {
+    double seconds = timeThreads(threads, [&](unsigned)
+                                 {
+                                   std::size_t held[4];
+                                   for (std::size_t &slot : held)
+                                     slot = pool.acquire();
+                                   for (std::size_t i = 0; i < operations; ++i)
+                                   {
+                                     pool.release(held[i % 4]);
+                                     held[i % 4] = pool.acquire();
+                                   }
+                                   for (std::size_t slot : held)
+                                     pool.release(slot); });
+    return 2.0 * threads * operations / seconds / 1e6;
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::size_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  unsigned maxThreads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10))
+                                 : std::max(4U, std::thread::hardware_concurrency());
+  if (operations == 0 || maxThreads == 0 || maxThreads * 4 > kSlots)
+  {
+    std::fprintf(stderr, "Usage: bench_contention [operations per thread > 0] [max threads 1-%zu]\n", kSlots / 4);
+    return 1;
+  }
+
+  std::printf("Shared bitmap contention, %zu operations per thread, 1-%u threads (Mops/s, all threads)\n",
+              operations, maxThreads);
+  std::printf("%7s %12s %12s %8s %12s %12s %8s\n", "threads", "mutex bits", "atomic bits", "speedup",
+              "mutex slots", "lock-free", "speedup");
+
+  for (unsigned threads = 1; threads <= maxThreads;
+       threads = threads == maxThreads ? threads + 1 : std::min(maxThreads, threads < 4 ? threads + 1 : threads * 2))
+  {
+    std::vector<std::vector<uint32_t>> where = positions(threads, operations);
+
+    MutexBitmap lockedBits(kBitmapBits);
+    bitwise::AtomicBitset atomicBits(kBitmapBits);
+    double lockedUpdates = updateRate(lockedBits, threads, where);
+    double atomicUpdates = updateRate(atomicBits, threads, where);
+
+    MutexBitmap lockedSlots(kSlots);
+    bitwise::SlotAllocator slots(kSlots);
+    double lockedAllocs = slotRate(lockedSlots, threads, operations);
+    double lockFreeAllocs = slotRate(slots, threads, operations);
+
+    std::printf("%7u %12.1f %12.1f %7.2fx %12.1f %12.1f %7.2fx\n", threads, lockedUpdates, atomicUpdates,
+                atomicUpdates / lockedUpdates, lockedAllocs, lockFreeAllocs, lockFreeAllocs / lockedAllocs);
+  }
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include "../include/bitwise_utils.h"
+#include "../include/render_sink.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+// Measures renders per second of the display* visualizers: the original
+// character-at-a-time std::cout code versus rendering into each sink type.
+// Usage: bench_display [renders] (default 200000)
+
+namespace
+{
+  // The displayBitwiseOperation implementation this library shipped before render sinks,
+  // writing to an arbitrary stream instead of std::cout
+  void legacyDisplayBitwiseOperation(std::ostream &os, uint32_t a, uint32_t b, const std::string &operation, uint32_t result)
+  {
+    os << "\n<== Bitwise " << operation << " Operation ==>" << std::endl;
+    os << "Decimal: " << a << " " << operation << " " << b << " = " << result << std::endl;
+    os << "Hex:     " << bitwise::toHexString(a) << " " << operation << " " << bitwise::toHexString(b) << " = " << bitwise::toHexString(result) << std::endl;
+    os << std::endl;
+
+    std::string binA = bitwise::toBinaryString(a);
+    std::string binB = bitwise::toBinaryString(b);
+    std::string binResult = bitwise::toBinaryString(result);
+
+    os << "Bit-by-bit comparison:" << std::endl;
+    for (int i = 31; i >= 0; --i)
+    {
+      if (i % 4 == 3)
+        os << " ";
+      os << ((a >> i) & 1);
+    }
+    os << " (A)" << std::endl;
+
+    for (int i = 31; i >= 0; --i)
+    {
+      if (i % 4 == 3)
+        os << " ";
+      os << ((b >> i) & 1);
+    }
+    os << " (B)" << std::endl;
+
+    os << std::string(44, '-') << std::endl;
+
+    for (int i = 31; i >= 0; --i)
+    {
+      if (i % 4 == 3)
+        os << " ";
+      os << ((result >> i) & 1);
+    }
+    os << " (Result)" << std::endl;
+  }
+
+  template <typename Fn>
+  void run(const char *name, std::size_t renders, Fn render)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < renders; ++i)
+    {
+      uint32_t a = static_cast<uint32_t>(i * 2654435761U);
+      uint32_t b = static_cast<uint32_t>(i * 40503U + 7);
+      render(a, b);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("%-34s %10.0f renders/s %8.1f ns/render\n", name, renders / elapsed.count(),
+                elapsed.count() * 1e9 / renders);
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::size_t renders = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+  std::printf("displayBitwiseOperation, %zu renders\n", renders);
+
+  {
+    std::ostringstream memory;
+    run("legacy -> ostringstream", renders, [&](uint32_t a, uint32_t b)
+        { legacyDisplayBitwiseOperation(memory, a, b, "AND", a & b); });
+  }
+  {
+    bitwise::BufferSink sink;
+    run("sink -> BufferSink", renders, [&](uint32_t a, uint32_t b)
+        { bitwise::displayBitwiseOperation(sink, a, b, "AND", a & b); });
+  }
+  {
+    std::ofstream devNull("/dev/null");
+    run("legacy -> ofstream(/dev/null)", renders, [&](uint32_t a, uint32_t b)
+        { legacyDisplayBitwiseOperation(devNull, a, b, "AND", a & b); });
+  }
+  {
+    std::ofstream devNull("/dev/null");
+    bitwise::OstreamSink sink(devNull);
+    run("sink -> OstreamSink(/dev/null)", renders, [&](uint32_t a, uint32_t b)
+        { bitwise::displayBitwiseOperation(sink, a, b, "AND", a & b); });
+  }
+  {
+    int fd = open("/dev/null", O_WRONLY);
+    bitwise::FdSink sink(fd);
+    run("sink -> FdSink(/dev/null)", renders, [&](uint32_t a, uint32_t b)
+        { bitwise::displayBitwiseOperation(sink, a, b, "AND", a & b); });
+    close(fd);
+  }
+  return 0;
+}
@@ -0,0 +1,328 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Minimal microbenchmark harness: calibrated timing loops, optional hardware
+// counters through perf_event_open, and table or JSON reporting.
+
+namespace bench
+{
+  /**
+   * @brief Keeps the compiler from discarding a value the benchmark computes
+   */
+  template <typename T>
+  inline void doNotOptimize(const T &value)
+  {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+
+  /**
+   * @brief Forces pending stores to be treated as observable
+   */
+  inline void clobberMemory()
+  {
+    asm volatile("" : : : "memory");
+  }
+
+  /**
+   * @brief User-space cycle and instruction counters for the calling thread
+   *
+   * Opened as one perf event group so both counts cover the same interval. When the
+   * kernel refuses (no perf support, seccomp, perf_event_paranoid) available() is false
+   * and the benchmarks report time only.
+   */
+  class PerfCounters
+  {
+  public:
+    PerfCounters()
+    {
+#if defined(__linux__)
+      leader_ = open(PERF_COUNT_HW_CPU_CYCLES, -1);
+      if (leader_ >= 0)
+      {
+        member_ = open(PERF_COUNT_HW_INSTRUCTIONS, leader_);
+        if (member_ < 0)
+        {
+          ::close(leader_);
+          leader_ = -1;
+        }
+      }
+#endif
+    }
+
+    ~PerfCounters()
+    {
+#if defined(__linux__)
+      if (member_ >= 0)
+        ::close(member_);
+      if (leader_ >= 0)
+        ::close(leader_);
+#endif
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    bool available() const { return leader_ >= 0; }
+
+    void start()
+    {
+#if defined(__linux__)
+      if (leader_ >= 0)
+      {
+        ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+      }
+#endif
+    }
+
+    /**
+     * @brief Stops counting and returns the counts since start()
+     * @return false if the counters are unavailable or could not be read
+     */
+    bool stop(uint64_t &cycles, uint64_t &instructions)
+    {
+#if defined(__linux__)
+      if (leader_ < 0)
+        return false;
+      ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      uint64_t values[3] = {0, 0, 0}; // nr, cycles, instructions (PERF_FORMAT_GROUP layout)
+      if (::read(leader_, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) || values[0] != 2)
+        return false;
+      cycles = values[1];
+      instructions = values[2];
+      return true;
+#else
+      (void)cycles;
+      (void)instructions;
+      return false;
+#endif
+    }
+
+  private:
+#if defined(__linux__)
+    static int open(uint64_t config, int groupFd)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = config;
+      attr.disabled = groupFd < 0 ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+    }
+#endif
+
+    int leader_ = -1;
+    int member_ = -1;
+  };
+
+  struct Options
+  {
+    bool json = false;
+    bool quick = false;          // shorter samples, smallest sizes only
+    double minSampleSeconds = 0.02;
+    int samples = 5;
+    std::string filter;          // run only benchmarks whose name contains this
+  };
+
+  /**
+   * @brief One benchmark result; per-op figures divide by the operations each call performs
+   */
+  struct Measurement
+  {
+    std::string name;
+    std::string distribution;
+    std::size_t size = 0;
+    uint64_t iterations = 0;     // calls per sample
+    double nsPerOp = 0;          // fastest sample
+    double medianNsPerOp = 0;
+    double opsPerSecond = 0;
+    double bytesPerSecond = 0;   // 0 when the benchmark does not stream bytes
+    double cyclesPerOp = -1;     // -1 when perf counters are unavailable
+    double instructionsPerOp = -1;
+  };
+
+  class Suite
+  {
+  public:
+    explicit Suite(const Options &options) : options_(options) {}
+
+    const Options &options() const { return options_; }
+
+    bool countersAvailable() const { return counters_.available(); }
+
+    bool selected(const std::string &name) const
+    {
+      return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+
+    /**
+     * @brief Times fn, which performs opsPerCall operations touching bytesPerCall bytes per call
+     *
+     * The call count is doubled until one sample takes minSampleSeconds, then the
+     * fastest and median of several samples are kept.
+     */
+    template <typename Fn>
+    void run(const std::string &name, const std::string &distribution, std::size_t size,
+             std::size_t opsPerCall, std::size_t bytesPerCall, Fn fn)
+    {
+      if (!selected(name))
+        return;
+
+      fn(); // warm caches, page in buffers, resolve dispatch
+      uint64_t calls = 1;
+      while (timeCalls(fn, calls) < options_.minSampleSeconds && calls < (uint64_t(1) << 40))
+        calls *= 2;
+
+      std::vector<double> seconds;
+      double bestSeconds = 1e300;
+      uint64_t bestCycles = 0, bestInstructions = 0;
+      bool counted = false;
+      for (int s = 0; s < options_.samples; ++s)
+      {
+        counters_.start();
+        double elapsed = timeCalls(fn, calls);
+        uint64_t cycles = 0, instructions = 0;
+        bool ok = counters_.stop(cycles, instructions);
+        seconds.push_back(elapsed);
+        if (elapsed < bestSeconds)
+        {
+          bestSeconds = elapsed;
+          bestCycles = cycles;
+          bestInstructions = instructions;
+          counted = ok;
+        }
+      }
+      std::sort(seconds.begin(), seconds.end());
+
+      double ops = static_cast<double>(calls) * opsPerCall;
+      Measurement m;
+      m.name = name;
+      m.distribution = distribution;
+      m.size = size;
+      m.iterations = calls;
+      m.nsPerOp = bestSeconds * 1e9 / ops;
+      m.medianNsPerOp = seconds[seconds.size() / 2] * 1e9 / ops;
+      m.opsPerSecond = ops / bestSeconds;
+      m.bytesPerSecond = static_cast<double>(calls) * bytesPerCall / bestSeconds;
+      if (counted)
+      {
+        m.cyclesPerOp = bestCycles / ops;
+        m.instructionsPerOp = bestInstructions / ops;
+      }
+      results_.push_back(m);
+      if (!options_.json)
+        printRow(m);
+    }
+
+    void printHeader() const
+    {
+      if (options_.json)
+        return;
+      std::printf("%-28s %-10s %9s %11s %13s %11s %8s %8s\n", "benchmark", "dist", "size", "ns/op",
+                  "ops/s", "GB/s", "cyc/op", "ins/op");
+    }
+
+    /**
+     * @brief Writes every result collected so far as one JSON document
+     */
+    void printJson(std::FILE *out, const std::vector<std::pair<std::string, std::string>> &context) const
+    {
+      std::fprintf(out, "{\n  \"context\": {");
+      for (std::size_t i = 0; i < context.size(); ++i)
+      {
+        std::fprintf(out, "%s\n    \"%s\": \"%s\"", i ? "," : "", escape(context[i].first).c_str(),
+                     escape(context[i].second).c_str());
+      }
+      std::fprintf(out, "%s\n    \"perf_counters\": %s\n  },\n  \"benchmarks\": [",
+                   context.empty() ? "" : ",", countersAvailable() ? "true" : "false");
+      for (std::size_t i = 0; i < results_.size(); ++i)
+      {
+        const Measurement &m = results_[i];
+        std::fprintf(out,
+                     "%s\n    {\"name\": \"%s\", \"distribution\": \"%s\", \"size\": %zu, \"iterations\": %llu, "
+                     "\"ns_per_op\": %.4f, \"median_ns_per_op\": %.4f, \"ops_per_second\": %.1f, "
+                     "\"bytes_per_second\": %.1f, \"cycles_per_op\": %s, \"instructions_per_op\": %s}",
+                     i ? "," : "", escape(m.name).c_str(), escape(m.distribution).c_str(), m.size,
+                     static_cast<unsigned long long>(m.iterations), m.nsPerOp, m.medianNsPerOp, m.opsPerSecond,
+                     m.bytesPerSecond, number(m.cyclesPerOp).c_str(), number(m.instructionsPerOp).c_str());
+      }
+      std::fprintf(out, "\n  ]\n}\n");
+    }
+
+  private:
+    template <typename Fn>
+    static double timeCalls(Fn &fn, uint64_t calls)
+    {
+      auto start = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < calls; ++i)
+        fn();
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      return elapsed.count();
+    }
+
+    static void printRow(const Measurement &m)
+    {
+      char gb[16] = "-", cycles[16] = "-", instructions[16] = "-";
+      if (m.bytesPerSecond > 0)
+        std::snprintf(gb, sizeof(gb), "%.2f", m.bytesPerSecond / 1e9);
+      if (m.cyclesPerOp >= 0)
+      {
+        std::snprintf(cycles, sizeof(cycles), "%.2f", m.cyclesPerOp);
+        std::snprintf(instructions, sizeof(instructions), "%.2f", m.instructionsPerOp);
+      }
+      std::printf("%-28s %-10s %9zu %11.3f %13.4g %11s %8s %8s\n", m.name.c_str(), m.distribution.c_str(), m.size,
+                  m.nsPerOp, m.opsPerSecond, gb, cycles, instructions);
+      std::fflush(stdout);
+    }
+
+    static std::string number(double value)
+    {
+      if (value < 0 || !std::isfinite(value))
+        return "null";
+      char buffer[32];
+      std::snprintf(buffer, sizeof(buffer), "%.4f", value);
+      return buffer;
+    }
+
+    static std::string escape(const std::string &text)
+    {
+      std::string out;
+      for (char c : text)
+      {
+        if (c == '"' || c == '\\')
+          out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20)
+          continue;
+        out += c;
+      }
+      return out;
+    }
+
+    Options options_;
+    PerfCounters counters_;
+    std::vector<Measurement> results_;
+  };
+
+} // namespace bench
+
+#endif // BENCH_HARNESS_H
@@ -0,0 +1,82 @@
+#include "../include/bitwise_parallel.h"
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+// Thread scaling of the parallel bulk engine: AND, popcount and a multi-word
+// shift over large first-touch buffers, from 1 thread up to N.
+// Usage: bench_parallel [megabytes per buffer] [max threads] (default 256, hardware threads)
+
+namespace
+{
+  template <typename Fn>
+  double bestSeconds(int repeats, Fn fn)
+  {
+    double best = 1e30;
+    for (int r = 0; r < repeats; ++r)
+    {
+      auto start = std::chrono::steady_clock::now();
+      fn();
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      if (elapsed.count() < best)
+        best = elapsed.count();
+    }
+    return best;
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256;
+  unsigned maxThreads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10))
+                                 : std::max(1U, std::thread::hardware_concurrency());
+  std::size_t words = megabytes * 1024 * 1024 / sizeof(uint32_t);
+  std::size_t bytes = words * sizeof(uint32_t);
+  const int repeats = 5;
+
+  std::printf("Parallel bulk engine, %zu MB per buffer, 1-%u threads\n", megabytes, maxThreads);
+  std::printf("%7s %12s %8s %12s %8s %12s %8s\n", "threads", "AND GB/s", "speedup", "POPCNT GB/s", "speedup",
+              "SHL GB/s", "speedup");
+
+  double baseAnd = 0, baseCount = 0, baseShift = 0;
+  for (unsigned threads = 1; threads <= maxThreads;
+       threads = threads == maxThreads ? threads + 1 : std::min(maxThreads, threads < 4 ? threads + 1 : threads * 2))
+  {
+    bitwise::ThreadPool pool(threads);
+    // Allocated per thread count so every run gets pages first-touched by its own workers
+    bitwise::ParallelBuffer a(words, pool), b(words, pool), out(words, pool);
+    std::mt19937 rng(42);
+    for (std::size_t i = 0; i < words; ++i)
+    {
+      a[i] = rng();
+      b[i] = rng();
+    }
+
+    volatile uint64_t sink = 0;
+    double andSeconds = bestSeconds(repeats, [&]
+                                    { bitwise::parallelAnd(out.data(), a.data(), b.data(), words, pool); });
+    double countSeconds = bestSeconds(repeats, [&]
+                                      { sink = bitwise::parallelCountSetBits(a.data(), words, pool); });
+    double shiftSeconds = bestSeconds(repeats, [&]
+                                      { bitwise::parallelLeftShift(out.data(), a.data(), words, 77, pool); });
+    (void)sink;
+
+    // AND moves three buffers, popcount one and the shift two
+    double andRate = 3.0 * bytes / andSeconds / 1e9;
+    double countRate = 1.0 * bytes / countSeconds / 1e9;
+    double shiftRate = 2.0 * bytes / shiftSeconds / 1e9;
+    if (threads == 1)
+    {
+      baseAnd = andRate;
+      baseCount = countRate;
+      baseShift = shiftRate;
+    }
+    std::printf("%7u %12.2f %7.2fx %12.2f %7.2fx %12.2f %7.2fx\n", threads, andRate, andRate / baseAnd, countRate,
+                countRate / baseCount, shiftRate, shiftRate / baseShift);
+  }
+  return 0;
+}
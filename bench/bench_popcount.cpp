@@ -0,0 +1,97 @@
+#include "../include/bitwise_utils.h"
+#include "../include/bitwise_bulk.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Compares the original bit-at-a-time countSetBits loop with the POPCNT word
+// function and the vectorized buffer kernels.
+// Usage: bench_popcount [megabytes] (default 64)
+
+namespace
+{
+  // The countSetBits implementation this library shipped before hardware popcount
+  int legacyCountSetBits(uint32_t value)
+  {
+    int count = 0;
+    while (value)
+    {
+      count += value & 1;
+      value >>= 1;
+    }
+    return count;
+  }
+
+  template <typename Fn>
+  double bestSeconds(int repeats, Fn fn)
+  {
+    double best = 1e30;
+    for (int r = 0; r < repeats; ++r)
+    {
+      auto start = std::chrono::steady_clock::now();
+      fn();
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      if (elapsed.count() < best)
+        best = elapsed.count();
+    }
+    return best;
+  }
+
+  void report(const char *name, double seconds, std::size_t bytes, uint64_t count)
+  {
+    double gbPerSecond = bytes / seconds / 1e9;
+    double nsPerWord = seconds * 1e9 / (bytes / sizeof(uint32_t));
+    std::printf("%-28s %9.3f ms %8.2f GB/s %8.3f ns/word  (bits=%llu)\n",
+                name, seconds * 1e3, gbPerSecond, nsPerWord, static_cast<unsigned long long>(count));
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+  std::size_t words = megabytes * 1024 * 1024 / sizeof(uint32_t);
+  std::size_t bytes = words * sizeof(uint32_t);
+
+  std::vector<uint32_t> data(words);
+  std::mt19937 rng(42);
+  for (uint32_t &word : data)
+    word = rng();
+
+  std::printf("Population count over %zu MB (%zu words)\n", megabytes, words);
+  const int repeats = 5;
+  volatile uint64_t sink = 0;
+
+  uint64_t count = 0;
+  double seconds = bestSeconds(repeats, [&]
+                               {
+    count = 0;
+    for (uint32_t word : data)
+      count += legacyCountSetBits(word);
+    sink = count; });
+  report("legacy bit loop", seconds, bytes, count);
+
+  seconds = bestSeconds(repeats, [&]
+                        {
+    count = 0;
+    for (uint32_t word : data)
+      count += bitwise::countSetBits(word);
+    sink = count; });
+  report("countSetBits(word)", seconds, bytes, count);
+
+  bitwise::SimdLevel best = bitwise::detectSimdLevel();
+  for (int level = 0; level <= static_cast<int>(best); ++level)
+  {
+    bitwise::SimdLevel selected = bitwise::setSimdLevel(static_cast<bitwise::SimdLevel>(level));
+    seconds = bestSeconds(repeats, [&]
+                          { count = bitwise::countSetBits(data.data(), data.size()); sink = count; });
+    char name[64];
+    std::snprintf(name, sizeof(name), "countSetBits(buffer) %s", bitwise::simdLevelName(selected));
+    report(name, seconds, bytes, count);
+  }
+  bitwise::setSimdLevel(best);
+
+  (void)sink;
+  return 0;
+}
@@ -0,0 +1,234 @@
+#include "../include/bitwise_service.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Load generator for the --serve protocol: N connections, each keeping D frames of B items in
+// flight for a fixed time, reporting throughput and per-frame round-trip latency percentiles.
+// Without --connect it serves from an in-process server on a loopback TCP port.
+// Usage: bench_service [--connect ADDRESS] [--connections N] [--depth D] [--batch B]
+//                      [--seconds S] [--op and|popcnt|bin|hex|render]
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  struct Options
+  {
+    std::string connect;
+    unsigned connections = 4;
+    unsigned depth = 8;
+    unsigned batch = 16;
+    double seconds = 3;
+    bitwise::service::Op op = bitwise::service::Op::And;
+    uint8_t flags = 0;
+  };
+
+  struct ConnectionResult
+  {
+    uint64_t frames = 0;
+    uint64_t errors = 0;
+    std::vector<uint32_t> latencyNs;
+  };
+
+  bool parseOptions(int argc, char **argv, Options &options)
+  {
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+      std::string name = argv[i], value = argv[i + 1];
+      if (name == "--connect")
+        options.connect = value;
+      else if (name == "--connections")
+        options.connections = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+      else if (name == "--depth")
+        options.depth = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+      else if (name == "--batch")
+        options.batch = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+      else if (name == "--seconds")
+        options.seconds = std::strtod(value.c_str(), nullptr);
+      else if (name == "--op" && value == "and")
+        options.op = bitwise::service::Op::And;
+      else if (name == "--op" && value == "popcnt")
+        options.op = bitwise::service::Op::Popcnt;
+      else if (name == "--op" && value == "bin")
+        options.op = bitwise::service::Op::Bin;
+      else if (name == "--op" && value == "hex")
+        options.op = bitwise::service::Op::Hex;
+      else if (name == "--op" && value == "render")
+        options.flags = bitwise::service::kFlagRender;
+      else
+        return false;
+    }
+    return argc % 2 == 1 && options.connections > 0 && options.depth > 0 && options.batch > 0 &&
+           options.batch <= (options.flags & bitwise::service::kFlagRender ? bitwise::service::kMaxRenderItems : 65535) &&
+           options.seconds > 0;
+  }
+
+  bool sendAll(int fd, const uint8_t *data, std::size_t size)
+  {
+    while (size > 0)
+    {
+      ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+      if (written <= 0)
+        return false;
+      data += written;
+      size -= static_cast<std::size_t>(written);
+    }
+    return true;
+  }
+
+  // Keeps depth frames outstanding until the deadline, then drains the ones still in flight.
+  // Responses arrive in request order, so send times queue up in a FIFO.
+  void runConnection(const bitwise::service::Address &address, const Options &options, unsigned seed,
+                     Clock::time_point deadline, ConnectionResult &result)
+  {
+    std::string error;
+    int fd = bitwise::service::connectTo(address, error);
+    if (fd < 0)
+    {
+      std::fprintf(stderr, "%s\n", error.c_str());
+      return;
+    }
+
+    std::mt19937 rng(seed);
+    std::vector<uint32_t> operands(2 * options.batch);
+    for (std::size_t i = 0; i < operands.size(); i += 2)
+    {
+      operands[i] = rng();
+      operands[i + 1] = rng();
+    }
+    std::vector<uint8_t> frame;
+    bitwise::service::appendRequest(frame, 0, options.op, options.flags, operands.data(),
+                                    static_cast<uint16_t>(options.batch));
+
+    std::deque<Clock::time_point> sent;
+    std::vector<uint8_t> outgoing, incoming;
+    std::size_t parsed = 0;
+    auto queueFrames = [&](unsigned count)
+    {
+      outgoing.clear();
+      for (unsigned i = 0; i < count; ++i)
+        outgoing.insert(outgoing.end(), frame.begin(), frame.end());
+      Clock::time_point now = Clock::now();
+      for (unsigned i = 0; i < count; ++i)
+        sent.push_back(now);
+      return sendAll(fd, outgoing.data(), outgoing.size());
+    };
+
+    bool ok = queueFrames(options.depth);
+    uint8_t buffer[64 * 1024];
+    while (ok && !sent.empty())
+    {
+      ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+      if (got <= 0)
+        break;
+      incoming.insert(incoming.end(), buffer, buffer + got);
+
+      Clock::time_point now = Clock::now();
+      unsigned completed = 0;
+      bitwise::service::Response response;
+      while (std::size_t length = bitwise::service::parseResponse(incoming.data() + parsed, incoming.size() - parsed, response))
+      {
+        parsed += length;
+        result.errors += response.status != bitwise::service::Status::Ok;
+        result.latencyNs.push_back(static_cast<uint32_t>(
+            std::min<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - sent.front()).count(), UINT32_MAX)));
+        sent.pop_front();
+        ++completed;
+      }
+      result.frames += completed;
+      incoming.erase(incoming.begin(), incoming.begin() + static_cast<std::ptrdiff_t>(parsed));
+      parsed = 0;
+      if (completed > 0 && now < deadline)
+        ok = queueFrames(completed);
+    }
+    close(fd);
+  }
+
+  double percentile(const std::vector<uint32_t> &sorted, double fraction)
+  {
+    if (sorted.empty())
+      return 0;
+    std::size_t index = std::min(sorted.size() - 1, static_cast<std::size_t>(fraction * sorted.size()));
+    return sorted[index] / 1000.0;
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    std::fprintf(stderr, "Usage: bench_service [--connect ADDRESS] [--connections N] [--depth D] [--batch B 1-65535]\n"
+                         "                     [--seconds S] [--op and|popcnt|bin|hex|render (batch 1-64)]\n");
+    return 1;
+  }
+
+  bitwise::service::Address address;
+  bitwise::service::Server local;
+  std::thread localLoop;
+  std::string error;
+  if (options.connect.empty())
+  {
+    if (!local.listen(address, error))
+    {
+      std::fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+    }
+    address.port = local.port();
+    localLoop = std::thread([&]
+                            { local.run(); });
+  }
+  else if (!bitwise::service::parseAddress(options.connect, address, error))
+  {
+    std::fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+
+  std::vector<ConnectionResult> results(options.connections);
+  std::vector<std::thread> clients;
+  Clock::time_point start = Clock::now();
+  Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.seconds));
+  for (unsigned c = 0; c < options.connections; ++c)
+    clients.emplace_back(runConnection, std::cref(address), std::cref(options), c + 1, deadline, std::ref(results[c]));
+  for (std::thread &client : clients)
+    client.join();
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+
+  if (localLoop.joinable())
+  {
+    local.stop();
+    localLoop.join();
+  }
+
+  uint64_t frames = 0, errors = 0;
+  std::vector<uint32_t> latencies;
+  for (const ConnectionResult &result : results)
+  {
+    frames += result.frames;
+    errors += result.errors;
+    latencies.insert(latencies.end(), result.latencyNs.begin(), result.latencyNs.end());
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  std::printf("%s, %u connections x %u frames in flight x %u items, %.1f s%s\n",
+              options.connect.empty() ? "in-process server (loopback TCP)" : options.connect.c_str(),
+              options.connections, options.depth, options.batch, elapsed.count(),
+              options.flags & bitwise::service::kFlagRender ? ", rendered" : "");
+  std::printf("%12s %14s %10s %10s %10s %10s %8s\n", "frames/s", "items/s", "p50 us", "p99 us", "p99.9 us", "max us",
+              "errors");
+  std::printf("%12.0f %14.0f %10.1f %10.1f %10.1f %10.1f %8llu\n", frames / elapsed.count(),
+              frames * options.batch / elapsed.count(), percentile(latencies, 0.5), percentile(latencies, 0.99),
+              percentile(latencies, 0.999), latencies.empty() ? 0.0 : latencies.back() / 1000.0,
+              static_cast<unsigned long long>(errors));
+  return errors == 0 && frames > 0 ? 0 : 1;
+}
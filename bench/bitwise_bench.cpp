@@ -0,0 +1,751 @@
+#include "bench_harness.h"
+#include "../include/aligned_allocator.h"
+#include "../include/big_unsigned.h"
+#include "../include/batch_mode.h"
+#include "../include/bit_transpose.h"
+#include "../include/bit_vector.h"
+#include "../include/bloom_filter.h"
+#include "../include/morton.h"
+#include "../include/bitwise_bulk.h"
+#include "../include/bitwise_cpu.h"
+#include "../include/bitwise_expr.h"
+#include "../include/bitwise_generic.h"
+#include "../include/bitwise_stats.h"
+#include "../include/bitwise_utils.h"
+#include "../include/render_sink.h"
+#include "../include/roaring_bitmap.h"
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// Microbenchmarks for every public function of the library, across value
+// distributions and input sizes, reporting ns/op, throughput and (when
+// perf_event_open is permitted) cycles and instructions per op.
+// Usage: bitwise_bench [--json] [--quick] [--filter NAME] [--min-time MS]
+
+namespace
+{
+  using Buffer = std::vector<uint32_t, bitwise::AlignedAllocator<uint32_t>>;
+
+  enum class Distribution
+  {
+    Uniform, // every bit independent
+    Sparse,  // one set bit
+    Dense,   // one clear bit
+    Small    // 0-255
+  };
+
+  const Distribution kDistributions[] = {Distribution::Uniform, Distribution::Sparse, Distribution::Dense,
+                                         Distribution::Small};
+
+  const char *distributionName(Distribution distribution)
+  {
+    switch (distribution)
+    {
+    case Distribution::Uniform:
+      return "uniform";
+    case Distribution::Sparse:
+      return "sparse";
+    case Distribution::Dense:
+      return "dense";
+    case Distribution::Small:
+      return "small";
+    }
+    return "?";
+  }
+
+  Buffer makeValues(Distribution distribution, std::size_t count, uint32_t seed)
+  {
+    std::mt19937 rng(seed);
+    Buffer values(count);
+    for (uint32_t &value : values)
+    {
+      uint32_t r = rng();
+      switch (distribution)
+      {
+      case Distribution::Uniform:
+        value = r;
+        break;
+      case Distribution::Sparse:
+        value = 1U << (r & 31);
+        break;
+      case Distribution::Dense:
+        value = ~(1U << (r & 31));
+        break;
+      case Distribution::Small:
+        value = r & 0xFF;
+        break;
+      }
+    }
+    return values;
+  }
+
+  // Word functions: one call per value, results folded together so none are dropped
+  void benchWordFunctions(bench::Suite &suite, std::size_t n, Distribution distribution)
+  {
+    const char *dist = distributionName(distribution);
+    Buffer a = makeValues(distribution, n, 1);
+    Buffer b = makeValues(distribution, n, 2);
+    Buffer positions = makeValues(Distribution::Uniform, n, 3);
+    for (uint32_t &p : positions)
+      p &= 31;
+    const std::size_t bytes = n * sizeof(uint32_t);
+
+    auto binary = [&](const char *name, uint32_t (*op)(uint32_t, uint32_t))
+    {
+      suite.run(name, dist, n, n, 2 * bytes, [&]
+                {
+        uint32_t acc = 0;
+        for (std::size_t i = 0; i < n; ++i)
+          acc ^= op(a[i], b[i]);
+        bench::doNotOptimize(acc); });
+    };
+    auto indexed = [&](const char *name, uint32_t (*op)(uint32_t, int))
+    {
+      suite.run(name, dist, n, n, bytes, [&]
+                {
+        uint32_t acc = 0;
+        for (std::size_t i = 0; i < n; ++i)
+          acc ^= op(a[i], static_cast<int>(positions[i]));
+        bench::doNotOptimize(acc); });
+    };
+
+    binary("bitwiseAnd", bitwise::bitwiseAnd);
+    binary("bitwiseOr", bitwise::bitwiseOr);
+    binary("bitwiseXor", bitwise::bitwiseXor);
+    suite.run("bitwiseNot", dist, n, n, bytes, [&]
+              {
+      uint32_t acc = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc ^= bitwise::bitwiseNot(a[i]);
+      bench::doNotOptimize(acc); });
+    indexed("leftShift", bitwise::leftShift);
+    indexed("rightShift", bitwise::rightShift);
+    indexed("setBit", bitwise::setBit);
+    indexed("clearBit", bitwise::clearBit);
+    indexed("toggleBit", bitwise::toggleBit);
+    indexed("rotateLeft", bitwise::rotateLeft);
+    binary("extractBits", bitwise::extractBits);
+    binary("depositBits", bitwise::depositBits);
+    binary("generic::extractBits", [](uint32_t value, uint32_t mask)
+           { return bitwise::generic::extractBits(value, mask); });
+    suite.run("reverseBits", dist, n, n, bytes, [&]
+              {
+      uint32_t acc = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc ^= bitwise::reverseBits(a[i]);
+      bench::doNotOptimize(acc); });
+    suite.run("countLeadingZeros", dist, n, n, bytes, [&]
+              {
+      int acc = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc += bitwise::countLeadingZeros(a[i]) + bitwise::countTrailingZeros(a[i]);
+      bench::doNotOptimize(acc); });
+    suite.run("forEachSetBit", dist, n, n, bytes, [&]
+              {
+      std::size_t acc = 0;
+      bitwise::generic::forEachSetBit(a.data(), n, [&](std::size_t position)
+                                      { acc += position; });
+      bench::doNotOptimize(acc); });
+    suite.run("isBitSet", dist, n, n, bytes, [&]
+              {
+      int acc = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc += bitwise::isBitSet(a[i], static_cast<int>(positions[i]));
+      bench::doNotOptimize(acc); });
+    suite.run("countSetBits", dist, n, n, bytes, [&]
+              {
+      int acc = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc += bitwise::countSetBits(a[i]);
+      bench::doNotOptimize(acc); });
+    suite.run("generic::countSetBits<u64>", dist, n / 2, n / 2, bytes, [&]
+              {
+      int acc = 0;
+      const uint64_t *wide = reinterpret_cast<const uint64_t *>(a.data());
+      for (std::size_t i = 0; i < n / 2; ++i)
+        acc += bitwise::generic::countSetBits(wide[i]);
+      bench::doNotOptimize(acc); });
+
+    suite.run("toBinaryString", dist, n, n, bytes, [&]
+              {
+      std::size_t acc = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc += bitwise::toBinaryString(a[i]).size();
+      bench::doNotOptimize(acc); });
+    suite.run("toHexString", dist, n, n, bytes, [&]
+              {
+      std::size_t acc = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc += bitwise::toHexString(a[i]).size();
+      bench::doNotOptimize(acc); });
+    suite.run("toBinaryChars", dist, n, n, bytes, [&]
+              {
+      char buffer[bitwise::kMaxBinaryChars];
+      std::size_t acc = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc += bitwise::toBinaryChars(buffer, buffer + sizeof(buffer), a[i]).ptr - buffer;
+      bench::doNotOptimize(acc); });
+    suite.run("toHexChars", dist, n, n, bytes, [&]
+              {
+      char buffer[bitwise::kMaxHexChars];
+      std::size_t acc = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc += bitwise::toHexChars(buffer, buffer + sizeof(buffer), a[i]).ptr - buffer;
+      bench::doNotOptimize(acc); });
+  }
+
+  void benchPower(bench::Suite &suite, std::size_t n)
+  {
+    // Bases 2-16 and exponents 0-63, so roughly half the calls overflow
+    Buffer bases = makeValues(Distribution::Uniform, n, 4);
+    Buffer exponents = makeValues(Distribution::Uniform, n, 5);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      bases[i] = 2 + bases[i] % 15;
+      exponents[i] &= 63;
+    }
+    suite.run("power", "mixed", n, n, 0, [&]
+              {
+      long long acc = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc ^= bitwise::power(static_cast<int>(bases[i]), static_cast<int>(exponents[i]));
+      bench::doNotOptimize(acc); });
+    suite.run("checkedPower", "mixed", n, n, 0, [&]
+              {
+      long long acc = 0, result = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc += bitwise::checkedPower(static_cast<int>(bases[i]), static_cast<int>(exponents[i]), result) ? result : 0;
+      bench::doNotOptimize(acc); });
+  }
+
+  void benchRenderers(bench::Suite &suite, std::size_t n)
+  {
+    Buffer a = makeValues(Distribution::Uniform, n, 6);
+    Buffer b = makeValues(Distribution::Uniform, n, 7);
+    bitwise::BufferSink sink;
+
+    suite.run("displayBitwiseOperation", "uniform", n, n, 0, [&]
+              {
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        bitwise::displayBitwiseOperation(sink, a[i], b[i], "AND", a[i] & b[i]);
+        sink.clear();
+      } });
+    suite.run("displayBitwiseNotOperation", "uniform", n, n, 0, [&]
+              {
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        bitwise::displayBitwiseNotOperation(sink, a[i], ~a[i]);
+        sink.clear();
+      } });
+    suite.run("displayShiftOperation", "uniform", n, n, 0, [&]
+              {
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        int shift = static_cast<int>(b[i] & 31);
+        bitwise::displayShiftOperation(sink, a[i], shift, a[i] << shift, "LEFT");
+        sink.clear();
+      } });
+    for (int length : {8, 32, 62})
+    {
+      suite.run("displayBaseTable", "base2", static_cast<std::size_t>(length), 1, 0, [&]
+                {
+        bitwise::displayBaseTable(sink, length, 2);
+        sink.clear(); });
+    }
+  }
+
+  void benchBulk(bench::Suite &suite, std::size_t n)
+  {
+    Buffer a = makeValues(Distribution::Uniform, n, 8);
+    Buffer b = makeValues(Distribution::Uniform, n, 9);
+    Buffer out(n);
+    const std::size_t bytes = n * sizeof(uint32_t);
+
+    // Throughput counts every byte read and written
+    suite.run("bulk/bitwiseAnd", "uniform", n, n, 3 * bytes, [&]
+              { bitwise::bitwiseAnd(out.data(), a.data(), b.data(), n); bench::clobberMemory(); });
+    suite.run("bulk/bitwiseOr", "uniform", n, n, 3 * bytes, [&]
+              { bitwise::bitwiseOr(out.data(), a.data(), b.data(), n); bench::clobberMemory(); });
+    suite.run("bulk/bitwiseXor", "uniform", n, n, 3 * bytes, [&]
+              { bitwise::bitwiseXor(out.data(), a.data(), b.data(), n); bench::clobberMemory(); });
+    suite.run("bulk/bitwiseNot", "uniform", n, n, 2 * bytes, [&]
+              { bitwise::bitwiseNot(out.data(), a.data(), n); bench::clobberMemory(); });
+    suite.run("bulk/countSetBits", "uniform", n, n, bytes, [&]
+              { bench::doNotOptimize(bitwise::countSetBits(a.data(), n)); });
+    // Multi-word shifts by a distance that is not a whole number of words, so every word is funnelled
+    suite.run("bulk/leftShift", "uniform", n, n, 2 * bytes, [&]
+              { bitwise::leftShift(out.data(), a.data(), n, 37); bench::clobberMemory(); });
+    suite.run("bulk/leftShift(in place)", "uniform", n, n, 2 * bytes, [&]
+              { bitwise::leftShift(out.data(), out.data(), n, 37); bench::clobberMemory(); });
+    suite.run("bulk/rotateLeft", "uniform", n, n, 2 * bytes, [&]
+              { bitwise::rotateLeft(out.data(), a.data(), n, 37); bench::clobberMemory(); });
+    suite.run("bulk/rotateLeft(in place)", "uniform", n, n, 2 * bytes, [&]
+              { bitwise::rotateLeft(out.data(), out.data(), n, 37); bench::clobberMemory(); });
+
+    bitwise::ExpressionPlan plan;
+    std::string error;
+    if (bitwise::ExpressionPlan::compile("(a & b) ^ ~c << 3", plan, error))
+    {
+      Buffer c = makeValues(Distribution::Uniform, n, 10);
+      const uint32_t *columns[] = {a.data(), b.data(), c.data()};
+      suite.run("ExpressionPlan::execute", "uniform", n, n, 4 * bytes, [&]
+                { plan.execute(columns, out.data(), n); bench::clobberMemory(); });
+    }
+  }
+
+  void benchBitVector(bench::Suite &suite, std::size_t bits)
+  {
+    const std::size_t queries = 1024;
+    std::mt19937_64 rng(11);
+    bitwise::BitVector vector(bits);
+    for (std::size_t i = 0; i < bits; ++i)
+    {
+      if (rng() & 1)
+        vector.setBit(i);
+    }
+    std::size_t ones = vector.countSetBits();
+    std::vector<std::size_t> positions(queries), ranks(queries);
+    for (std::size_t i = 0; i < queries; ++i)
+    {
+      positions[i] = rng() % bits;
+      ranks[i] = ones ? rng() % ones : 0;
+    }
+    const std::size_t bytes = bits / 8;
+
+    suite.run("BitVector::countSetBits", "uniform", bits, 1, bytes, [&]
+              { bench::doNotOptimize(vector.countSetBits()); });
+    suite.run("BitVector::buildIndex", "uniform", bits, 1, bytes, [&]
+              { vector.buildRankSelectIndex(); });
+    suite.run("BitVector::rank", "uniform", bits, queries, 0, [&]
+              {
+      std::size_t acc = 0;
+      for (std::size_t p : positions)
+        acc += vector.rank(p);
+      bench::doNotOptimize(acc); });
+    suite.run("BitVector::select", "uniform", bits, queries, 0, [&]
+              {
+      std::size_t acc = 0;
+      for (std::size_t k : ranks)
+        acc += vector.select(k);
+      bench::doNotOptimize(acc); });
+  }
+
+  // Scattered single-bit updates and tests over a bit buffer, one call per bit versus one per batch
+  void benchBitBatches(bench::Suite &suite, std::size_t bits)
+  {
+    const std::size_t count = 1 << 20;
+    std::mt19937_64 rng(13);
+    Buffer words(bits / 32), positions(count);
+    for (uint32_t &position : positions)
+      position = static_cast<uint32_t>(rng() % bits);
+    std::vector<uint64_t> mask(count / 64);
+
+    suite.run("setBit loop", "uniform", bits, count, 0, [&]
+              {
+      for (uint32_t p : positions)
+        words[p / 32] = bitwise::setBit(words[p / 32], p % 32);
+      bench::clobberMemory(); });
+    suite.run("bulk/setBits", "uniform", bits, count, 0, [&]
+              { bitwise::setBits(words.data(), positions.data(), count); bench::clobberMemory(); });
+    suite.run("bulk/toggleBits", "uniform", bits, count, 0, [&]
+              { bitwise::toggleBits(words.data(), positions.data(), count); bench::clobberMemory(); });
+    suite.run("isBitSet loop", "uniform", bits, count, 0, [&]
+              {
+      std::size_t hits = 0;
+      for (uint32_t p : positions)
+        hits += bitwise::isBitSet(words[p / 32], p % 32);
+      bench::doNotOptimize(hits); });
+    suite.run("bulk/testBits", "uniform", bits, count, 0, [&]
+              { bitwise::testBits(mask.data(), words.data(), positions.data(), count); bench::clobberMemory(); });
+  }
+
+  // Bit-slicing 32-bit records: the isBitSet/setBit loop it replaces, then the block and bulk transposes
+  void benchTranspose(bench::Suite &suite, std::size_t records)
+  {
+    Buffer values = makeValues(Distribution::Uniform, records, 15);
+    const std::size_t sliceWords = (records + 31) / 32;
+    Buffer slices(32 * sliceWords);
+    const std::size_t bytes = records * sizeof(uint32_t);
+
+    suite.run("bitSlice isBitSet/setBit loop", "uniform", records, records, 2 * bytes, [&]
+              {
+      std::fill(slices.begin(), slices.end(), 0U);
+      for (std::size_t r = 0; r < records; ++r)
+      {
+        for (int b = 0; b < 32; ++b)
+        {
+          if (bitwise::isBitSet(values[r], b))
+            slices[b * sliceWords + r / 32] = bitwise::setBit(slices[b * sliceWords + r / 32], static_cast<int>(r % 32));
+        }
+      }
+      bench::clobberMemory(); });
+    suite.run("bulk/transposeBitMatrix", "uniform", records, records, 2 * bytes, [&]
+              { bitwise::transposeBitMatrix(slices.data(), values.data(), records, 1); bench::clobberMemory(); });
+
+    std::vector<uint64_t> rows64(64);
+    for (std::size_t i = 0; i < 64; ++i)
+      rows64[i] = (uint64_t(values[2 * i]) << 32) | values[2 * i + 1];
+    suite.run("transpose8x8", "uniform", 64, 64, 64 * 8, [&]
+              {
+      for (uint64_t &row : rows64)
+        row = bitwise::transpose8x8(row);
+      bench::clobberMemory(); });
+    suite.run("transpose32x32", "uniform", 32, 1, 32 * 4, [&]
+              { bitwise::transpose32x32(values.data(), values.data()); bench::clobberMemory(); });
+    suite.run("transpose64x64", "uniform", 64, 1, 64 * 8, [&]
+              { bitwise::transpose64x64(rows64.data(), rows64.data()); bench::clobberMemory(); });
+  }
+
+  // Z-order codes: the isBitSet/setBit interleave they replace, single values, then the bulk kernels
+  // at the active SIMD level and (when they differ) the per-element PDEP/PEXT fallback
+  void benchMorton(bench::Suite &suite, std::size_t points)
+  {
+    Buffer x = makeValues(Distribution::Uniform, points, 16);
+    Buffer y = makeValues(Distribution::Uniform, points, 17);
+    Buffer z = makeValues(Distribution::Uniform, points, 18);
+    Buffer codes32(points), dx(points), dy(points), dz(points);
+    std::vector<uint64_t> codes64(points);
+    const std::size_t words = points * sizeof(uint32_t);
+
+    suite.run("morton2D32 isBitSet/setBit loop", "uniform", points, points, 3 * words, [&]
+              {
+      for (std::size_t i = 0; i < points; ++i)
+      {
+        uint32_t code = 0;
+        for (int b = 0; b < 16; ++b)
+        {
+          if (bitwise::isBitSet(x[i], b))
+            code = bitwise::setBit(code, 2 * b);
+          if (bitwise::isBitSet(y[i], b))
+            code = bitwise::setBit(code, 2 * b + 1);
+        }
+        codes32[i] = code;
+      }
+      bench::clobberMemory(); });
+    suite.run("mortonEncode2D32", "uniform", points, points, 3 * words, [&]
+              {
+      for (std::size_t i = 0; i < points; ++i)
+        codes32[i] = bitwise::mortonEncode2D32(x[i], y[i]);
+      bench::clobberMemory(); });
+
+    // At the Scalar level the single-value Morton path still uses PDEP/PEXT when the CPU has BMI2
+    auto bulk = [&](const std::string &mortonSuffix, const std::string &graySuffix)
+    {
+      suite.run("bulk/mortonEncode2D32" + mortonSuffix, "uniform", points, points, 3 * words, [&]
+                { bitwise::mortonEncode2D32(codes32.data(), x.data(), y.data(), points); bench::clobberMemory(); });
+      suite.run("bulk/mortonDecode2D32" + mortonSuffix, "uniform", points, points, 3 * words, [&]
+                { bitwise::mortonDecode2D32(dx.data(), dy.data(), codes32.data(), points); bench::clobberMemory(); });
+      suite.run("bulk/mortonEncode3D32" + mortonSuffix, "uniform", points, points, 4 * words, [&]
+                { bitwise::mortonEncode3D32(codes32.data(), x.data(), y.data(), z.data(), points); bench::clobberMemory(); });
+      suite.run("bulk/mortonDecode3D32" + mortonSuffix, "uniform", points, points, 4 * words, [&]
+                { bitwise::mortonDecode3D32(dx.data(), dy.data(), dz.data(), codes32.data(), points); bench::clobberMemory(); });
+      suite.run("bulk/mortonEncode2D64" + mortonSuffix, "uniform", points, points, 4 * words, [&]
+                { bitwise::mortonEncode2D64(codes64.data(), x.data(), y.data(), points); bench::clobberMemory(); });
+      suite.run("bulk/mortonDecode2D64" + mortonSuffix, "uniform", points, points, 4 * words, [&]
+                { bitwise::mortonDecode2D64(dx.data(), dy.data(), codes64.data(), points); bench::clobberMemory(); });
+      suite.run("bulk/mortonEncode3D64" + mortonSuffix, "uniform", points, points, 5 * words, [&]
+                { bitwise::mortonEncode3D64(codes64.data(), x.data(), y.data(), z.data(), points); bench::clobberMemory(); });
+      suite.run("bulk/mortonDecode3D64" + mortonSuffix, "uniform", points, points, 5 * words, [&]
+                { bitwise::mortonDecode3D64(dx.data(), dy.data(), dz.data(), codes64.data(), points); bench::clobberMemory(); });
+      suite.run("bulk/grayEncode" + graySuffix, "uniform", points, points, 2 * words, [&]
+                { bitwise::grayEncode(codes32.data(), x.data(), points); bench::clobberMemory(); });
+      suite.run("bulk/grayDecode" + graySuffix, "uniform", points, points, 2 * words, [&]
+                { bitwise::grayDecode(codes32.data(), x.data(), points); bench::clobberMemory(); });
+    };
+    bulk("", "");
+    const bitwise::SimdLevel level = bitwise::activeSimdLevel();
+    if (level != bitwise::SimdLevel::Scalar)
+    {
+      bitwise::setSimdLevel(bitwise::SimdLevel::Scalar);
+      bulk(bitwise::cpuFeatures().bmi2 ? " (bmi2)" : " (scalar)", " (scalar)");
+      bitwise::setSimdLevel(level);
+    }
+  }
+
+  // Decimal conversion of a digits-long number: repeated division by 10^19 (quadratic), then the
+  // divide-and-conquer toString and parse
+  void benchRadix(bench::Suite &suite, std::size_t digits)
+  {
+    std::mt19937_64 rng(17);
+    std::string text(digits, '0');
+    for (char &c : text)
+      c = static_cast<char>('0' + rng() % 10);
+    text[0] = '7';
+    bitwise::BigUnsigned value;
+    std::string error;
+    bitwise::BigUnsigned::parse(text, 10, value, error);
+
+    suite.run("radix/naive toString", "decimal", digits, digits, 0, [&]
+              {
+      std::vector<uint64_t> limbs = value.limbs();
+      std::string reversed;
+      while (!limbs.empty())
+      {
+        bitwise::uint128_t remainder = 0;
+        for (std::size_t i = limbs.size(); i-- > 0;)
+        {
+          bitwise::uint128_t current = (remainder << 64) | limbs[i];
+          limbs[i] = static_cast<uint64_t>(current / 10000000000000000000ULL);
+          remainder = current % 10000000000000000000ULL;
+        }
+        while (!limbs.empty() && limbs.back() == 0)
+          limbs.pop_back();
+        for (int d = 0; d < 19; ++d, remainder /= 10)
+          reversed.push_back(static_cast<char>('0' + static_cast<int>(remainder % 10)));
+      }
+      bench::doNotOptimize(reversed.size()); });
+    suite.run("BigUnsigned::toString", "decimal", digits, digits, 0, [&]
+              { bench::doNotOptimize(value.toString(10).size()); });
+    suite.run("BigUnsigned::toString", "hex", digits, digits, 0, [&]
+              { bench::doNotOptimize(value.toString(16).size()); });
+    suite.run("BigUnsigned::parse", "decimal", digits, digits, 0, [&]
+              {
+      bitwise::BigUnsigned parsed;
+      bitwise::BigUnsigned::parse(text, 10, parsed, error);
+      bench::doNotOptimize(parsed.limbs().size()); });
+  }
+
+  // Membership filters at 1% false positives: a classic 7-probe filter on setBit/isBitSet against
+  // the split-block filter, one key at a time and in batches
+  void benchBloom(bench::Suite &suite, std::size_t keys)
+  {
+    std::mt19937_64 rng(16);
+    std::vector<uint64_t> inserted(keys), queries(keys);
+    for (uint64_t &key : inserted)
+      key = rng();
+    for (std::size_t i = 0; i < keys; ++i)
+      queries[i] = i % 2 ? inserted[i] : rng(); // half hits, half misses
+    std::vector<uint64_t> mask((keys + 63) / 64);
+
+    // 9.6 bits per key and 7 probes, each a separate word (and usually a separate cache line)
+    const std::size_t bits = keys * 10;
+    Buffer naive(bits / 32 + 1);
+    auto probe = [bits](uint64_t key, int i)
+    {
+      uint64_t h = (key ^ (key >> 29)) * 0xbf58476d1ce4e5b9ULL;
+      return static_cast<std::size_t>(((h >> 32) + uint64_t(i) * (h & 0xFFFFFFFF)) % bits);
+    };
+    for (uint64_t key : inserted)
+    {
+      for (int i = 0; i < 7; ++i)
+      {
+        std::size_t p = probe(key, i);
+        naive[p / 32] = bitwise::setBit(naive[p / 32], static_cast<int>(p % 32));
+      }
+    }
+    suite.run("bloom/naive isBitSet x7", "half-hits", keys, keys, 0, [&]
+              {
+      std::size_t hits = 0;
+      for (uint64_t key : queries)
+      {
+        bool found = true;
+        for (int i = 0; i < 7 && found; ++i)
+        {
+          std::size_t p = probe(key, i);
+          found = bitwise::isBitSet(naive[p / 32], static_cast<int>(p % 32));
+        }
+        hits += found;
+      }
+      bench::doNotOptimize(hits); });
+
+    bitwise::BloomFilter filter(keys, 0.01);
+    suite.run("BloomFilter::insertMany", "uniform", keys, keys, 0, [&]
+              { filter.insertMany(inserted.data(), keys); bench::clobberMemory(); });
+    suite.run("BloomFilter::contains", "half-hits", keys, keys, 0, [&]
+              {
+      std::size_t hits = 0;
+      for (uint64_t key : queries)
+        hits += filter.contains(key);
+      bench::doNotOptimize(hits); });
+    suite.run("BloomFilter::containsMany", "half-hits", keys, keys, 0, [&]
+              { filter.containsMany(mask.data(), queries.data(), keys); bench::clobberMemory(); });
+  }
+
+  void benchBatch(bench::Suite &suite, std::size_t lines)
+  {
+    static const char *const kOps[] = {"AND", "OR", "XOR", "NOT", "SHL", "SHR", "POPCNT", "ISSET", "SET", "HEX", "BIN"};
+    std::mt19937 rng(12);
+    std::string text;
+    for (std::size_t i = 0; i < lines; ++i)
+    {
+      const char *op = kOps[rng() % (sizeof(kOps) / sizeof(kOps[0]))];
+      text += op;
+      text += ' ';
+      text += std::to_string(rng());
+      if (std::string(op) != "NOT" && std::string(op) != "POPCNT" && std::string(op) != "HEX" && std::string(op) != "BIN")
+      {
+        text += ' ';
+        text += std::to_string(rng() & 31);
+      }
+      text += '\n';
+    }
+    bitwise::BufferSink sink;
+    suite.run("runBatch", "mixed", lines, lines, text.size(), [&]
+              {
+      bitwise::runBatch(text.data(), text.size(), sink);
+      sink.clear(); });
+  }
+
+  // Two sets over a 2^24 universe as sparse arrays, dense bitmaps or long runs
+  void benchRoaring(bench::Suite &suite)
+  {
+    const uint32_t universe = 1 << 24;
+    const char *const kShapes[] = {"sparse", "dense", "runs"};
+    for (int shape = 0; shape < 3; ++shape)
+    {
+      std::mt19937 rng(14 + shape);
+      bitwise::RoaringBitmap a, b;
+      for (bitwise::RoaringBitmap *set : {&a, &b})
+      {
+        if (shape == 0)
+        {
+          for (uint32_t i = 0; i < universe / 1024; ++i)
+            set->setBit(rng() % universe);
+        }
+        else if (shape == 1)
+        {
+          for (uint32_t i = 0; i < universe / 4; ++i)
+            set->setBit(rng() % universe);
+        }
+        else
+        {
+          for (uint32_t start = rng() % 4096; start < universe; start += 4096 + rng() % 4096)
+            set->addRange(start, uint64_t(start) + 1000 + rng() % 2000);
+        }
+      }
+      std::size_t values = static_cast<std::size_t>(a.countSetBits());
+      std::size_t bytes = a.statistics().bytes + b.statistics().bytes;
+      suite.run("RoaringBitmap::and", kShapes[shape], values, 1, bytes, [&]
+                { bench::doNotOptimize(bitwise::bitwiseAnd(a, b).countSetBits()); });
+      suite.run("RoaringBitmap::or", kShapes[shape], values, 1, bytes, [&]
+                { bench::doNotOptimize(bitwise::bitwiseOr(a, b).countSetBits()); });
+      suite.run("RoaringBitmap::contains", kShapes[shape], values, 1024, 0, [&]
+                {
+        std::size_t hits = 0;
+        for (uint32_t i = 0; i < 1024; ++i)
+          hits += a.contains(i * 16381);
+        bench::doNotOptimize(hits); });
+    }
+  }
+
+  // Cost of the instrumentation while recording: compare with the plain bitwiseAnd and bulk/bitwiseAnd rows
+  void benchStats(bench::Suite &suite, std::size_t n)
+  {
+    Buffer a = makeValues(Distribution::Uniform, n, 15);
+    Buffer b = makeValues(Distribution::Uniform, n, 16);
+    Buffer out(n);
+    bitwise::stats::setEnabled(true);
+    suite.run("stats/bitwiseAnd", "uniform", n, n, 2 * n * sizeof(uint32_t), [&]
+              {
+      uint32_t acc = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc ^= bitwise::bitwiseAnd(a[i], b[i]);
+      bench::doNotOptimize(acc); });
+    suite.run("stats/bulk/bitwiseAnd", "uniform", n, n, 3 * n * sizeof(uint32_t), [&]
+              { bitwise::bitwiseAnd(out.data(), a.data(), b.data(), n); bench::clobberMemory(); });
+    bitwise::stats::setEnabled(false);
+  }
+
+  void printUsage()
+  {
+    std::printf("Usage: bitwise_bench [--json] [--quick] [--filter NAME] [--min-time MS]\n"
+                "  --json          print results as JSON instead of a table\n"
+                "  --quick         short samples and the smallest sizes only\n"
+                "  --filter NAME   run only benchmarks whose name contains NAME\n"
+                "  --min-time MS   minimum duration of each timed sample (default 20)\n");
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  bench::Options options;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--json")
+      options.json = true;
+    else if (arg == "--quick")
+      options.quick = true;
+    else if (arg == "--filter" && i + 1 < argc)
+      options.filter = argv[++i];
+    else if (arg == "--min-time" && i + 1 < argc)
+      options.minSampleSeconds = std::strtod(argv[++i], nullptr) / 1e3;
+    else
+    {
+      printUsage();
+      return arg == "--help" || arg == "-h" ? 0 : 1;
+    }
+  }
+  if (options.quick)
+  {
+    options.minSampleSeconds = std::min(options.minSampleSeconds, 0.005);
+    options.samples = 3;
+  }
+
+  bench::Suite suite(options);
+  if (!options.json)
+  {
+    std::printf("SIMD level: %s, perf counters: %s\n", bitwise::simdLevelName(bitwise::activeSimdLevel()),
+                suite.countersAvailable() ? "yes" : "unavailable");
+  }
+  suite.printHeader();
+
+  // Word functions over an L1-resident array and one that streams from memory
+  std::vector<std::size_t> wordSizes = {1024};
+  std::vector<std::size_t> bulkSizes = {1024, 64 * 1024};
+  std::vector<std::size_t> vectorSizes = {1 << 16};
+  std::vector<std::size_t> batchBits = {1 << 20};
+  std::vector<std::size_t> bloomKeys = {1 << 16};
+  std::vector<std::size_t> radixDigits = {1000};
+  std::vector<std::size_t> mortonPoints = {1 << 12};
+  if (!options.quick)
+  {
+    wordSizes.push_back(1 << 20);
+    bulkSizes.push_back(4 << 20);
+    vectorSizes.push_back(1 << 26);
+    batchBits.push_back(std::size_t(1) << 29);
+    bloomKeys.push_back(1 << 24);
+    radixDigits.push_back(100000);
+    mortonPoints.push_back(1 << 22);
+  }
+
+  for (std::size_t n : wordSizes)
+  {
+    for (Distribution distribution : kDistributions)
+      benchWordFunctions(suite, n, distribution);
+  }
+  benchPower(suite, 1024);
+  for (std::size_t digits : radixDigits)
+    benchRadix(suite, digits);
+  benchRenderers(suite, 256);
+  for (std::size_t n : bulkSizes)
+    benchBulk(suite, n);
+  for (std::size_t bits : vectorSizes)
+    benchBitVector(suite, bits);
+  for (std::size_t bits : batchBits)
+    benchBitBatches(suite, bits);
+  benchTranspose(suite, 1 << 16);
+  for (std::size_t points : mortonPoints)
+    benchMorton(suite, points);
+  for (std::size_t keys : bloomKeys)
+    benchBloom(suite, keys);
+  benchBatch(suite, 4096);
+  benchRoaring(suite);
+  benchStats(suite, 1024);
+
+  if (options.json)
+  {
+    suite.printJson(stdout, {{"simd_level", bitwise::simdLevelName(bitwise::activeSimdLevel())},
+                             {"compiler", __VERSION__},
+#ifdef NDEBUG
+                             {"build", "release"}
+#else
+                             {"build", "debug"}
+#endif
+                            });
+  }
+  return 0;
+}
@@ -0,0 +1,49 @@
+# PGO training workload for bitwise_operators, run by the pgo-train target:
+#   cmake -DTOOL=<bitwise_operators> -DWORK_DIR=<scratch dir> -P pgo_train.cmake
+# Covers the batch evaluator and the memory-mapped file operations; bitwise_bench covers the kernels.
+
+if(NOT TOOL OR NOT WORK_DIR)
+  message(FATAL_ERROR "pgo_train.cmake needs -DTOOL=... and -DWORK_DIR=...")
+endif()
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+# A batch file mixing every operation and operand syntax
+set(lines "")
+foreach(i RANGE 1 2000)
+  math(EXPR a "(${i} * 2654435761) % 4294967296")
+  math(EXPR b "(${i} * 40503) % 65536")
+  math(EXPR n "${i} % 32")
+  string(APPEND lines "AND ${a} ${b}\nOR ${a} 0x${n}F\nXOR ${b} ${a}\nNOT ${a}\nSHL ${b} ${n}\nSHR ${a} ${n}\n"
+                      "POPCNT ${a}\nISSET ${a} ${n}\nSET ${b} ${n}\nCLEAR ${a} ${n}\nTOGGLE ${b} ${n}\n"
+                      "BIN ${b}\nHEX 0b1011\n")
+endforeach()
+file(WRITE "${WORK_DIR}/batch.txt" "${lines}")
+
+# Two 4 MiB operand files of equal size, built by doubling 64-byte seeds
+set(data_a "bitwise profile-guided training data, operand A: 0123456789abcdef")
+set(data_b "FEDCBA9876543210 :B dnarepo ,atad gniniart dediug-eliforp esiwtib")
+foreach(round RANGE 1 16)
+  string(APPEND data_a "${data_a}")
+  string(APPEND data_b "${data_b}")
+endforeach()
+set(blob_a "${WORK_DIR}/a.bin")
+set(blob_b "${WORK_DIR}/b.bin")
+file(WRITE "${blob_a}" "${data_a}")
+file(WRITE "${blob_b}" "${data_b}")
+
+function(run_tool)
+  execute_process(COMMAND "${TOOL}" ${ARGN} RESULT_VARIABLE result OUTPUT_QUIET)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Training step failed (${result}): ${ARGN}")
+  endif()
+endfunction()
+
+run_tool(--batch "${WORK_DIR}/batch.txt")
+run_tool(--and "${blob_a}" "${blob_b}" -o "${WORK_DIR}/and.bin")
+run_tool(--xor "${blob_a}" "${blob_b}" -o "${WORK_DIR}/xor.bin")
+run_tool(--not "${blob_a}" -o "${WORK_DIR}/not.bin")
+run_tool(--shl "${blob_a}" 13 -o "${WORK_DIR}/shl.bin")
+run_tool(--shr "${blob_a}" 77 -o "${WORK_DIR}/shr.bin")
+file(REMOVE_RECURSE "${WORK_DIR}")
@@ -0,0 +1,55 @@
+#ifndef ALIGNED_ALLOCATOR_H
+#define ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Size of a cache line on the targets this library cares about
+   */
+  constexpr std::size_t kCacheLineSize = 64;
+
+  /**
+   * @brief Standard allocator whose blocks start on an Alignment-byte boundary
+   * @tparam T Element type
+   * @tparam Alignment Required alignment in bytes (defaults to one cache line)
+   */
+  template <typename T, std::size_t Alignment = kCacheLineSize>
+  struct AlignedAllocator
+  {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+      using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+    T *allocate(std::size_t count)
+    {
+      return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T *pointer, std::size_t) noexcept
+    {
+      ::operator delete(pointer, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept { return false; }
+  };
+
+} // namespace bitwise
+
+#endif // ALIGNED_ALLOCATOR_H
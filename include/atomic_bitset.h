@@ -0,0 +1,131 @@
+#ifndef ATOMIC_BITSET_H
+#define ATOMIC_BITSET_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Fixed-size bitset that many threads can update without a lock
+   *
+   * Bits live in 64-bit std::atomic words. setBit(), clearBit() and toggleBit() are a single
+   * fetch_or, fetch_and or fetch_xor on the word holding the bit and return the bit's previous
+   * value, so exactly one of several threads setting the same bit sees false. Updates are
+   * acq_rel: a thread that observes a bit set by another thread also observes that thread's
+   * writes made before the update.
+   *
+   * Whole-set reads (countSetBits()) load the words one at a time and are only a snapshot when
+   * no other thread is writing.
+   */
+  class AtomicBitset
+  {
+  public:
+    /**
+     * @param bits Number of bits, all initially clear
+     */
+    explicit AtomicBitset(std::size_t bits);
+
+    AtomicBitset(const AtomicBitset &) = delete;
+    AtomicBitset &operator=(const AtomicBitset &) = delete;
+
+    std::size_t size() const { return bits_; }
+
+    /**
+     * @brief Checks bit position (acquire load)
+     */
+    bool isBitSet(std::size_t position) const;
+
+    /**
+     * @brief Sets bit position
+     * @return The bit's value before the call
+     */
+    bool setBit(std::size_t position);
+
+    /**
+     * @brief Clears bit position
+     * @return The bit's value before the call
+     */
+    bool clearBit(std::size_t position);
+
+    /**
+     * @brief Flips bit position
+     * @return The bit's value before the call
+     */
+    bool toggleBit(std::size_t position);
+
+    /**
+     * @brief Number of set bits
+     */
+    std::size_t countSetBits() const;
+
+    /**
+     * @brief Clears every bit; must not race with other updates
+     */
+    void clear();
+
+  private:
+    std::size_t bits_;
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+  };
+
+  /**
+   * @brief Lock-free allocator of slot indices in [0, capacity)
+   *
+   * Slots are bits of an atomic bitmap. acquire() finds a clear bit with a scan and claims it with
+   * fetch_or; if another thread claimed it first, the returned word shows what is still free and
+   * the scan carries on from there, so a thread never waits on another. Each thread remembers the
+   * word it last claimed from and starts its next scan there; a thread new to the allocator starts
+   * at a position derived from its id, a cache line apart from its neighbours, so concurrent
+   * threads mostly claim from different cache lines instead of all fighting over the first free bit.
+   *
+   * release() is a fetch_and. Slot numbers carry no ordering: callers that need one (a free list
+   * of lowest indices, say) should use a plain bitmap under a lock.
+   */
+  class SlotAllocator
+  {
+  public:
+    /**
+     * @brief Returned by acquire() when every slot is taken
+     */
+    static constexpr std::size_t kNoSlot = static_cast<std::size_t>(-1);
+
+    /**
+     * @param capacity Number of slots, all initially free
+     */
+    explicit SlotAllocator(std::size_t capacity);
+
+    SlotAllocator(const SlotAllocator &) = delete;
+    SlotAllocator &operator=(const SlotAllocator &) = delete;
+
+    std::size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Claims a free slot
+     * @return The slot index, or kNoSlot if all slots were taken during the scan
+     */
+    std::size_t acquire();
+
+    /**
+     * @brief Returns a slot obtained from acquire() to the pool
+     */
+    void release(std::size_t slot);
+
+    /**
+     * @brief Number of slots currently taken (a snapshot while other threads are active)
+     */
+    std::size_t inUse() const;
+
+  private:
+    std::size_t capacity_;
+    std::size_t words_;
+    std::unique_ptr<std::atomic<uint64_t>[]> bits_;
+    uint64_t id_; // distinguishes this allocator in the per-thread hint
+  };
+
+} // namespace bitwise
+
+#endif // ATOMIC_BITSET_H
@@ -0,0 +1,49 @@
+#ifndef BATCH_MODE_H
+#define BATCH_MODE_H
+
+#include <cstddef>
+
+namespace bitwise
+{
+
+  class RenderSink;
+
+  /**
+   * @brief Totals reported after a batch run
+   */
+  struct BatchResult
+  {
+    std::size_t operations = 0; // lines that produced a result
+    std::size_t errors = 0;     // lines that produced an "ERR ..." line
+    int readError = 0;          // errno of the read() that ended the input early, 0 at end of file
+  };
+
+  /**
+   * @brief Evaluates one operation per line and writes one result line per operation
+   *
+   * Each line is "<OP> <operand>...", with operands in decimal, 0x hex or 0b binary:
+   *   AND a b | OR a b | XOR a b | NOT a | SHL a n | SHR a n | POPCNT a
+   *   ISSET a pos | SET a pos | CLEAR a pos | TOGGLE a pos | BIN a | HEX a
+   * Results are written in decimal (BIN/HEX use toBinaryString/toHexString formatting).
+   * Blank lines and lines starting with '#' are skipped; malformed lines produce "ERR <reason>".
+   * Output is accumulated in a large buffer and handed to the sink in big blocks, never per line.
+   *
+   * @param inputFd File descriptor to read until end of file
+   * @param output Destination for the result lines
+   * @return Operation and error counts; readError is set when a read fails (other than EINTR), after
+   *         the lines read before the failure have been evaluated
+   */
+  BatchResult runBatch(int inputFd, RenderSink &output);
+
+  /**
+   * @brief Same as runBatch(int, RenderSink &) but over text already in memory
+   * @param data Start of the operation text
+   * @param length Number of bytes of text
+   * @param output Destination for the result lines
+   * @return Operation and error counts
+   */
+  BatchResult runBatch(const char *data, std::size_t length, RenderSink &output);
+
+} // namespace bitwise
+
+#endif // BATCH_MODE_H
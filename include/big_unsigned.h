@@ -0,0 +1,86 @@
+#ifndef BIG_UNSIGNED_H
+#define BIG_UNSIGNED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Arbitrary-precision unsigned integer with conversion to and from any base 2-36
+   *
+   * Stored as little-endian 64-bit limbs with no leading zero limbs (zero has none).
+   *
+   * Power-of-two bases (2, 4, 8, 16, 32) are converted by regrouping bits, in linear time.
+   * Other bases split the number recursively around base^(d * 2^k), where base^d is the largest
+   * power of the base that fits in a limb. The powers and their reciprocals are cached per base,
+   * and each split is a Barrett division, i.e. two Karatsuba multiplications. A conversion of n
+   * limbs therefore costs O(n^1.585 log n) instead of the O(n^2) of digit-at-a-time division.
+   */
+  class BigUnsigned
+  {
+  public:
+    BigUnsigned() = default;
+    BigUnsigned(uint64_t value);
+
+    /**
+     * @brief base^exponent, exactly (1 for exponent 0, including 0^0)
+     */
+    static BigUnsigned power(uint64_t base, uint64_t exponent);
+
+    /**
+     * @brief Parses digits in base 2-36 (0-9 then a-z, either case; no sign, prefix or separators)
+     * @param value Receives the number on success
+     * @param error Receives a description of the problem on failure
+     * @return false for an empty string, a digit outside the base or a base outside 2-36
+     */
+    static bool parse(std::string_view digits, unsigned base, BigUnsigned &value, std::string &error);
+
+    /**
+     * @brief Digits of the number in base 2-36, most significant first, without leading zeros
+     * @param uppercase Use A-Z instead of a-z for digits above 9
+     * @return "0" for zero, or an empty string for a base outside 2-36
+     */
+    std::string toString(unsigned base = 10, bool uppercase = false) const;
+
+    bool isZero() const { return limbs_.empty(); }
+
+    /**
+     * @brief Position of the highest set bit plus one (0 for zero)
+     */
+    std::size_t bitLength() const;
+
+    /**
+     * @brief The little-endian 64-bit limbs
+     */
+    const std::vector<uint64_t> &limbs() const { return limbs_; }
+
+    BigUnsigned &operator+=(const BigUnsigned &other);
+    BigUnsigned &operator*=(uint64_t factor);
+    friend BigUnsigned operator+(BigUnsigned a, const BigUnsigned &b) { return a += b; }
+    friend BigUnsigned operator*(const BigUnsigned &a, const BigUnsigned &b);
+    friend bool operator==(const BigUnsigned &a, const BigUnsigned &b) { return a.limbs_ == b.limbs_; }
+    friend bool operator!=(const BigUnsigned &a, const BigUnsigned &b) { return a.limbs_ != b.limbs_; }
+    friend bool operator<(const BigUnsigned &a, const BigUnsigned &b);
+
+  private:
+    std::vector<uint64_t> limbs_;
+  };
+
+  /**
+   * @brief Converts a number written in one base to another (both 2-36)
+   * @param digits The number; a leading '-' is carried over to the result
+   * @param output Receives the digits in toBase (lowercase, no leading zeros)
+   * @param error Receives a description of the problem on failure
+   * @return false if digits is not a valid number in fromBase or a base is outside 2-36
+   */
+  bool convertRadix(std::string_view digits, unsigned fromBase, unsigned toBase, std::string &output,
+                    std::string &error);
+
+} // namespace bitwise
+
+#endif // BIG_UNSIGNED_H
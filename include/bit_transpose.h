@@ -0,0 +1,60 @@
+#ifndef BIT_TRANSPOSE_H
+#define BIT_TRANSPOSE_H
+
+#include "bitwise_cpu.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Bit-matrix transposes for converting row-major records into bit-sliced columns
+   *
+   * A matrix is stored one row per word, with column c in bit c of the row (the same bit order as
+   * isBitSet). Transposing moves bit c of row r to bit r of row c, so transposing an array of
+   * records yields one word per bit position, ready for the bulk AND/OR/XOR kernels.
+   *
+   * The scalar path is the recursive swap-with-mask method (log2(n) rounds of delta swaps). The
+   * SSE2 and AVX2 paths regroup the rows with byte unpacks so one register holds the same byte of
+   * 16 or 32 rows, then read each output row out with movemask, one bit position at a time.
+   */
+
+  /**
+   * @brief Transposes an 8x8 bit matrix held in one word: row r is byte r, column c is bit c of the byte
+   * @param matrix The matrix, row 0 in the low byte
+   * @return The transposed matrix in the same layout
+   */
+  uint64_t transpose8x8(uint64_t matrix);
+
+  /**
+   * @brief Transposes a 32x32 bit matrix: bit r of dst[c] becomes bit c of src[r]
+   * @param dst 32 output rows (may be the same array as src)
+   * @param src 32 input rows
+   */
+  void transpose32x32(uint32_t *dst, const uint32_t *src);
+
+  /**
+   * @brief Transposes a 64x64 bit matrix: bit r of dst[c] becomes bit c of src[r]
+   * @param dst 64 output rows (may be the same array as src)
+   * @param src 64 input rows
+   */
+  void transpose64x64(uint64_t *dst, const uint64_t *src);
+
+  /**
+   * @brief Transposes a rows x (32 * rowWords) bit matrix, 32x32 blocks at a time
+   *
+   * Row r of src is words [r * rowWords, (r + 1) * rowWords), with column c in bit c % 32 of word
+   * c / 32. The result has 32 * rowWords rows of ceil(rows / 32) words each: bit r % 32 of
+   * dst[c * ceil(rows / 32) + r / 32] is column c of row r. Padding bits past the last row are 0.
+   * With rowWords == 1 this bit-slices count = rows 32-bit records into 32 slices.
+   * @param dst Output buffer of 32 * rowWords * ceil(rows / 32) words (must not overlap src)
+   * @param src Input buffer of rows * rowWords words
+   * @param rows Number of rows in src
+   * @param rowWords Number of 32-bit words per row of src
+   */
+  void transposeBitMatrix(uint32_t *dst, const uint32_t *src, std::size_t rows, std::size_t rowWords);
+
+} // namespace bitwise
+
+#endif // BIT_TRANSPOSE_H
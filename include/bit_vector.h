@@ -0,0 +1,149 @@
+#ifndef BIT_VECTOR_H
+#define BIT_VECTOR_H
+
+#include "aligned_allocator.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Growable bit array with the library's bit helpers at any position and an optional rank/select index
+   *
+   * Bits are stored in cache-line aligned 32-bit words, bit i living at bit (i % 32) of word (i / 32),
+   * so the words can be handed straight to the bulk kernels in bitwise_bulk.h.
+   *
+   * The rank/select index costs 64 bits per 2048-bit block (~3.1%) plus one sample per 8192 ones.
+   * Where 8192 ones span more than 2^22 bits, their positions are stored explicitly (at most 1/8 more).
+   * Any mutation invalidates it; rank() and select() still work without an index but fall back to a linear scan.
+   */
+  class BitVector
+  {
+  public:
+    using Word = uint32_t;
+    static constexpr std::size_t kWordBits = 32;
+
+    BitVector() = default;
+
+    /**
+     * @brief Creates a vector of the given length with every bit set to value
+     */
+    explicit BitVector(std::size_t size, bool value = false);
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * @brief Grows or shrinks the vector, filling any new bits with value
+     */
+    void resize(std::size_t size, bool value = false);
+
+    /**
+     * @brief Appends one bit to the end of the vector
+     */
+    void pushBack(bool value);
+
+    /**
+     * @brief Removes every bit (keeps the allocation)
+     */
+    void clear();
+
+    /**
+     * @brief Checks if the bit at position is set
+     * @param position Bit index, must be less than size()
+     */
+    bool isBitSet(std::size_t position) const
+    {
+      return (words_[position / kWordBits] >> (position % kWordBits)) & 1U;
+    }
+
+    /**
+     * @brief Sets the bit at position (must be less than size())
+     */
+    void setBit(std::size_t position)
+    {
+      words_[position / kWordBits] |= Word(1) << (position % kWordBits);
+      indexValid_ = false;
+    }
+
+    /**
+     * @brief Clears the bit at position (must be less than size())
+     */
+    void clearBit(std::size_t position)
+    {
+      words_[position / kWordBits] &= ~(Word(1) << (position % kWordBits));
+      indexValid_ = false;
+    }
+
+    /**
+     * @brief Toggles the bit at position (must be less than size())
+     */
+    void toggleBit(std::size_t position)
+    {
+      words_[position / kWordBits] ^= Word(1) << (position % kWordBits);
+      indexValid_ = false;
+    }
+
+    /**
+     * @brief Counts the set bits in the whole vector
+     */
+    std::size_t countSetBits() const;
+
+    /**
+     * @brief Builds (or rebuilds) the succinct rank/select index over the current contents
+     */
+    void buildRankSelectIndex();
+
+    /**
+     * @brief Returns true while the rank/select index matches the contents
+     */
+    bool hasRankSelectIndex() const { return indexValid_; }
+
+    /**
+     * @brief Counts the set bits strictly before position
+     * @param position Bit index in [0, size()]
+     * @return Number of ones in [0, position); O(1) with an index, O(n) without
+     */
+    std::size_t rank(std::size_t position) const;
+
+    /**
+     * @brief Finds the position of the k-th set bit (0-based, so rank(select(k)) == k)
+     * @param k Index of the one to find
+     * @return Bit position, or size() if fewer than k + 1 bits are set; O(1) with an index (a direct
+     *         lookup in sparse spans, at most 11 binary-search steps over block entries otherwise),
+     *         O(n) without
+     */
+    std::size_t select(std::size_t k) const;
+
+    /**
+     * @brief Raw word storage (size() rounded up to whole words; unused high bits are always zero)
+     */
+    const Word *data() const { return words_.data(); }
+    Word *data() { return words_.data(); }
+    std::size_t wordCount() const { return words_.size(); }
+
+  private:
+    void clearUnusedBits();
+    std::size_t rankLinear(std::size_t position) const;
+    std::size_t selectLinear(std::size_t k) const;
+
+    std::vector<Word, AlignedAllocator<Word>> words_;
+    std::size_t size_ = 0;
+
+    // Rank/select index. Each 2048-bit block gets one 64-bit entry: the low 32 bits hold the ones
+    // before the block (relative to its 2^32-bit region, whose base lives in regionRanks_), and three
+    // 10-bit fields hold the counts of the block's first three 512-bit sub-blocks.
+    std::vector<uint64_t> blockEntries_;
+    std::vector<uint64_t> regionRanks_;
+    std::vector<uint64_t> selectSamples_;   // block holding every 8192nd one
+    std::vector<uint64_t> sparseOffsets_;   // per sample: start of its positions in sparsePositions_, or ~0 if searched
+    std::vector<uint64_t> sparsePositions_; // positions of the ones in sparse sample spans
+    std::size_t totalOnes_ = 0;
+    bool indexValid_ = false;
+  };
+
+} // namespace bitwise
+
+#endif // BIT_VECTOR_H
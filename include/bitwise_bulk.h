@@ -0,0 +1,140 @@
+#ifndef BITWISE_BULK_H
+#define BITWISE_BULK_H
+
+#include "bitwise_cpu.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Computes dst[i] = srcA[i] & srcB[i] for every element of the buffers
+   * @param dst Output buffer (may alias srcA or srcB)
+   * @param srcA First operand buffer
+   * @param srcB Second operand buffer
+   * @param length Number of 32-bit words in each buffer
+   */
+  void bitwiseAnd(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length);
+
+  /**
+   * @brief Computes dst[i] = srcA[i] | srcB[i] for every element of the buffers
+   * @param dst Output buffer (may alias srcA or srcB)
+   * @param srcA First operand buffer
+   * @param srcB Second operand buffer
+   * @param length Number of 32-bit words in each buffer
+   */
+  void bitwiseOr(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length);
+
+  /**
+   * @brief Computes dst[i] = srcA[i] ^ srcB[i] for every element of the buffers
+   * @param dst Output buffer (may alias srcA or srcB)
+   * @param srcA First operand buffer
+   * @param srcB Second operand buffer
+   * @param length Number of 32-bit words in each buffer
+   */
+  void bitwiseXor(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length);
+
+  /**
+   * @brief Computes dst[i] = ~src[i] for every element of the buffer
+   * @param dst Output buffer (may alias src)
+   * @param src Operand buffer
+   * @param length Number of 32-bit words in each buffer
+   */
+  void bitwiseNot(uint32_t *dst, const uint32_t *src, std::size_t length);
+
+  /**
+   * @brief Counts the set bits across a whole buffer (Harley-Seal with a vpshufb nibble lookup on AVX2/AVX-512)
+   * @param data Buffer to count
+   * @param length Number of 32-bit words in the buffer
+   * @return Total number of set bits
+   */
+  uint64_t countSetBits(const uint32_t *data, std::size_t length);
+
+  /**
+   * @brief Shifts a whole buffer left as one multi-word integer: bit i of the buffer is bit (i % 32) of word (i / 32)
+   *
+   * Bits move towards higher word indices; bits shifted past the end are dropped and zeros are shifted in.
+   * Each word funnels two neighbouring source words, with SIMD kernels (VPSHLDVD on AVX-512 VBMI2)
+   * at the active level, so any distance runs at memory bandwidth.
+   * @param dst Output buffer of length words; either src itself (shift in place) or not overlapping it
+   * @param src Operand buffer
+   * @param length Number of 32-bit words in each buffer
+   * @param bits Shift distance in bits (distances of 32 * length or more give all zeros)
+   */
+  void leftShift(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits);
+
+  /**
+   * @brief Shifts a whole buffer right as one multi-word integer (towards lower word indices)
+   * @see leftShift(uint32_t *, const uint32_t *, std::size_t, std::size_t)
+   */
+  void rightShift(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits);
+
+  /**
+   * @brief Rotates a whole buffer left as one multi-word integer: bits shifted past the end come back in at bit 0
+   * @param dst Output buffer of length words; either src itself (rotate in place) or not overlapping it
+   * @param src Operand buffer
+   * @param length Number of 32-bit words in each buffer
+   * @param bits Rotation distance in bits, taken modulo 32 * length
+   */
+  void rotateLeft(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits);
+
+  /**
+   * @brief Rotates a whole buffer right as one multi-word integer (towards lower word indices)
+   * @see rotateLeft(uint32_t *, const uint32_t *, std::size_t, std::size_t)
+   */
+  void rotateRight(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits);
+
+  /**
+   * @brief Computes only words [first, last) of the multi-word leftShift, so one shift can be split into independent pieces
+   *
+   * Unlike leftShift, dst must not overlap src: other pieces still read the words this one writes.
+   */
+  void leftShiftRange(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits,
+                      std::size_t first, std::size_t last);
+
+  /**
+   * @brief Computes only words [first, last) of the multi-word rightShift
+   */
+  void rightShiftRange(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits,
+                       std::size_t first, std::size_t last);
+
+  /**
+   * @brief Sets bit positions[i] of a bit buffer for every i, with the same result as calling setBit on each
+   *
+   * Bit p is bit (p % 32) of word (p / 32), as in leftShift. Every update is prefetched a few positions
+   * ahead, and large batches over large buffers are first bucketed by 256 KiB region so the
+   * read-modify-writes of one bucket hit cache.
+   * @param words Bit buffer holding every position
+   * @param positions Bit positions in any order; duplicates are allowed
+   * @param count Number of positions
+   */
+  void setBits(uint32_t *words, const uint32_t *positions, std::size_t count);
+
+  /**
+   * @brief Clears bit positions[i] of a bit buffer for every i
+   * @see setBits(uint32_t *, const uint32_t *, std::size_t)
+   */
+  void clearBits(uint32_t *words, const uint32_t *positions, std::size_t count);
+
+  /**
+   * @brief Flips bit positions[i] of a bit buffer for every i; a position listed twice ends up unchanged
+   * @see setBits(uint32_t *, const uint32_t *, std::size_t)
+   */
+  void toggleBits(uint32_t *words, const uint32_t *positions, std::size_t count);
+
+  /**
+   * @brief Tests bit positions[i] of a bit buffer for every i and packs the answers into a mask
+   *
+   * Uses 8-wide (AVX2) or 16-wide (AVX-512) gathers of the addressed words.
+   * @param mask Output of (count + 63) / 64 words: bit (i % 64) of mask[i / 64] is set when bit
+   *             positions[i] is set; bits past count are zero
+   * @param words Bit buffer holding every position
+   * @param positions Bit positions to test
+   * @param count Number of positions
+   */
+  void testBits(uint64_t *mask, const uint32_t *words, const uint32_t *positions, std::size_t count);
+
+} // namespace bitwise
+
+#endif // BITWISE_BULK_H
@@ -0,0 +1,64 @@
+#ifndef BITWISE_CPU_H
+#define BITWISE_CPU_H
+
+namespace bitwise
+{
+
+  /**
+   * @brief Instruction set extensions reported by CPUID (and enabled by the OS)
+   */
+  struct CpuFeatures
+  {
+    bool sse2 = false;
+    bool popcnt = false;
+    bool avx2 = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512vbmi2 = false;
+    bool bmi1 = false;
+    bool bmi2 = false;
+    bool lzcnt = false;
+  };
+
+  /**
+   * @brief SIMD tiers used by the bulk kernels, ordered from least to most capable
+   */
+  enum class SimdLevel
+  {
+    Scalar = 0,
+    SSE2 = 1,
+    AVX2 = 2,
+    AVX512 = 3
+  };
+
+  /**
+   * @brief Queries CPUID once and returns the cached feature set
+   * @return Features of the running CPU (all false on non-x86 targets)
+   */
+  const CpuFeatures &cpuFeatures();
+
+  /**
+   * @brief Returns the most capable SIMD tier supported by the running CPU
+   */
+  SimdLevel detectSimdLevel();
+
+  /**
+   * @brief Returns the SIMD tier the bulk kernels currently dispatch to
+   */
+  SimdLevel activeSimdLevel();
+
+  /**
+   * @brief Overrides the SIMD tier used by the bulk kernels (e.g. for tests or benchmarks)
+   * @param level Requested tier, clamped to what the CPU supports
+   * @return The tier actually selected
+   */
+  SimdLevel setSimdLevel(SimdLevel level);
+
+  /**
+   * @brief Returns a printable name for a SIMD tier ("Scalar", "SSE2", "AVX2", "AVX512")
+   */
+  const char *simdLevelName(SimdLevel level);
+
+} // namespace bitwise
+
+#endif // BITWISE_CPU_H
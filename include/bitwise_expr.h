@@ -0,0 +1,115 @@
+#ifndef BITWISE_EXPR_H
+#define BITWISE_EXPR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bitwise
+{
+
+  /**
+   * @brief A bitwise expression compiled once into a fused, block-at-a-time execution plan
+   *
+   * The language has 32-bit unsigned literals (decimal, 0x hex, 0b binary), named column variables,
+   * parentheses and the C operators with C precedence: ~ (tightest), then << >>, then &, then ^, then |.
+   * Shifts by 32 or more yield 0 instead of being undefined.
+   *
+   * Compilation folds constants, applies algebraic identities (x & 0, x ^ x, ~~x, ...) and shares
+   * repeated subexpressions. Execution walks the columns in cache-sized blocks and runs every
+   * instruction on a block while it is still in L1, so the inputs are read once and the output
+   * written once no matter how many operators the expression has.
+   */
+  class ExpressionPlan
+  {
+  public:
+    /**
+     * @brief Elements per block; each plan register holds one block (4 KiB)
+     */
+    static constexpr std::size_t kBlockSize = 1024;
+
+    /**
+     * @brief Parses and optimizes an expression
+     * @param source Expression text, e.g. "(a & b) ^ ~c << 3"
+     * @param plan Receives the compiled plan on success
+     * @param error Receives a description of the problem on failure
+     * @return true if the expression compiled
+     */
+    static bool compile(const std::string &source, ExpressionPlan &plan, std::string &error);
+
+    /**
+     * @brief Names of the input columns, in the order execute() expects them (first appearance in the source)
+     */
+    const std::vector<std::string> &variables() const { return variables_; }
+
+    /**
+     * @brief Evaluates the plan over column arrays
+     * @param columns One pointer per entry of variables(), each to length values
+     * @param out Output array of length values (may alias a column)
+     * @param length Number of rows
+     */
+    void execute(const uint32_t *const *columns, uint32_t *out, std::size_t length) const;
+
+    /**
+     * @brief Evaluates the plan for a single row
+     * @param values One value per entry of variables()
+     */
+    uint32_t evaluate(const uint32_t *values) const;
+
+    /**
+     * @brief Number of instructions left after optimization (0 for a bare constant or variable)
+     */
+    std::size_t instructionCount() const { return instructions_.size(); }
+
+    /**
+     * @brief Number of block-sized scratch registers execution needs
+     */
+    std::size_t registerCount() const { return registerCount_; }
+
+    /**
+     * @brief Human-readable listing of the optimized plan, one instruction per line
+     */
+    std::string describe() const;
+
+    enum class Opcode : uint8_t
+    {
+      And,
+      Or,
+      Xor,
+      Not,
+      Shl,
+      Shr
+    };
+
+    enum class OperandKind : uint8_t
+    {
+      Register,
+      Column,
+      Immediate
+    };
+
+    struct Operand
+    {
+      OperandKind kind = OperandKind::Immediate;
+      uint32_t value = 0; // register index, column index or immediate value
+    };
+
+    struct Instruction
+    {
+      Opcode opcode;
+      uint32_t dst; // register index; the last instruction writes the output instead
+      Operand lhs;
+      Operand rhs; // unused for Not
+    };
+
+  private:
+    std::vector<std::string> variables_;
+    std::vector<Instruction> instructions_;
+    Operand result_; // where the result lives when there are no instructions
+    std::size_t registerCount_ = 0;
+  };
+
+} // namespace bitwise
+
+#endif // BITWISE_EXPR_H
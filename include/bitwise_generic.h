@@ -0,0 +1,569 @@
+#ifndef BITWISE_GENERIC_H
+#define BITWISE_GENERIC_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <type_traits>
+
+namespace bitwise
+{
+
+#ifdef __SIZEOF_INT128__
+#define BITWISE_HAS_INT128 1
+  __extension__ typedef unsigned __int128 uint128_t;
+#endif
+
+  /**
+   * @brief Header-only, width-generic versions of the bitwise_utils.h operations
+   *
+   * Every function is constexpr and noexcept and accepts uint8_t, uint16_t, uint32_t, uint64_t
+   * and (where the compiler has it) uint128_t, so calls inline and fold at compile time.
+   * Shift amounts and bit positions outside [0, width) are defined: shifts yield 0, and
+   * bit helpers leave the value unchanged (isBitSet returns false).
+   */
+  namespace generic
+  {
+
+    template <typename T>
+    struct is_bit_word : std::false_type
+    {
+    };
+    template <>
+    struct is_bit_word<uint8_t> : std::true_type
+    {
+    };
+    template <>
+    struct is_bit_word<uint16_t> : std::true_type
+    {
+    };
+    template <>
+    struct is_bit_word<uint32_t> : std::true_type
+    {
+    };
+    template <>
+    struct is_bit_word<uint64_t> : std::true_type
+    {
+    };
+#ifdef BITWISE_HAS_INT128
+    template <>
+    struct is_bit_word<uint128_t> : std::true_type
+    {
+    };
+#endif
+
+    /**
+     * @brief True for the unsigned operand types the generic operations accept
+     */
+    template <typename T>
+    inline constexpr bool is_bit_word_v = is_bit_word<T>::value;
+
+    /**
+     * @brief Number of bits in an operand type
+     */
+    template <typename T>
+    inline constexpr int bit_width_v = static_cast<int>(sizeof(T) * 8);
+
+#define BITWISE_REQUIRES_WORD(T) typename std::enable_if_t<is_bit_word_v<T>, int> = 0
+
+    /**
+     * @brief Performs bitwise AND operation
+     * @return Result of a & b
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T bitwiseAnd(T a, T b) noexcept
+    {
+      return static_cast<T>(a & b);
+    }
+
+    /**
+     * @brief Performs bitwise OR operation
+     * @return Result of a | b
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T bitwiseOr(T a, T b) noexcept
+    {
+      return static_cast<T>(a | b);
+    }
+
+    /**
+     * @brief Performs bitwise XOR operation
+     * @return Result of a ^ b
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T bitwiseXor(T a, T b) noexcept
+    {
+      return static_cast<T>(a ^ b);
+    }
+
+    /**
+     * @brief Performs bitwise NOT operation
+     * @return Result of ~a, truncated to the operand width
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T bitwiseNot(T a) noexcept
+    {
+      return static_cast<T>(~a);
+    }
+
+    /**
+     * @brief Performs left shift operation
+     * @return Result of a << shift, or 0 when shift is outside [0, width)
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T leftShift(T a, int shift) noexcept
+    {
+      return (shift < 0 || shift >= bit_width_v<T>) ? T(0) : static_cast<T>(a << shift);
+    }
+
+    /**
+     * @brief Performs right shift operation
+     * @return Result of a >> shift, or 0 when shift is outside [0, width)
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T rightShift(T a, int shift) noexcept
+    {
+      return (shift < 0 || shift >= bit_width_v<T>) ? T(0) : static_cast<T>(a >> shift);
+    }
+
+    /**
+     * @brief Checks if a specific bit is set
+     * @return true if the bit at bitPosition (0-based) is set
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr bool isBitSet(T value, int bitPosition) noexcept
+    {
+      return (rightShift(value, bitPosition) & 1U) != 0;
+    }
+
+    /**
+     * @brief Sets a specific bit
+     * @return value with the bit at bitPosition set
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T setBit(T value, int bitPosition) noexcept
+    {
+      return static_cast<T>(value | leftShift(T(1), bitPosition));
+    }
+
+    /**
+     * @brief Clears a specific bit
+     * @return value with the bit at bitPosition cleared
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T clearBit(T value, int bitPosition) noexcept
+    {
+      return static_cast<T>(value & bitwiseNot(leftShift(T(1), bitPosition)));
+    }
+
+    /**
+     * @brief Toggles a specific bit
+     * @return value with the bit at bitPosition flipped
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T toggleBit(T value, int bitPosition) noexcept
+    {
+      return static_cast<T>(value ^ leftShift(T(1), bitPosition));
+    }
+
+    /**
+     * @brief Counts the set bits, using POPCNT when the build targets it and branch-free SWAR otherwise
+     * @return Number of set bits
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr int countSetBits(T value) noexcept
+    {
+      if constexpr (sizeof(T) > sizeof(uint64_t))
+      {
+        return countSetBits(static_cast<uint64_t>(value)) + countSetBits(static_cast<uint64_t>(value >> 64));
+      }
+      else
+      {
+#if defined(__GNUC__) && (defined(__POPCNT__) || !(defined(__x86_64__) || defined(__i386__)))
+        return __builtin_popcountll(value);
+#else
+        uint64_t v = value;
+        v = v - ((v >> 1) & 0x5555555555555555ULL);
+        v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+        v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<int>((v * 0x0101010101010101ULL) >> 56);
+#endif
+      }
+    }
+
+    /**
+     * @brief Counts the zero bits above the highest set bit, using LZCNT when the build targets it
+     * @return Leading zero count (the full width for 0)
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr int countLeadingZeros(T value) noexcept
+    {
+      if constexpr (sizeof(T) > sizeof(uint64_t))
+      {
+        uint64_t high = static_cast<uint64_t>(value >> 64);
+        return high != 0 ? countLeadingZeros(high) : 64 + countLeadingZeros(static_cast<uint64_t>(value));
+      }
+      else
+      {
+#if defined(__GNUC__) && defined(__LZCNT__)
+        return value == 0 ? bit_width_v<T> : __builtin_clzll(value) - (64 - bit_width_v<T>);
+#else
+        // Smear the highest set bit into every lower position; the zeros left above it are the answer
+        uint64_t v = value;
+        v |= v >> 1;
+        v |= v >> 2;
+        v |= v >> 4;
+        v |= v >> 8;
+        v |= v >> 16;
+        v |= v >> 32;
+        return bit_width_v<T> - countSetBits(v);
+#endif
+      }
+    }
+
+    /**
+     * @brief Counts the zero bits below the lowest set bit, using TZCNT when the build targets it
+     * @return Trailing zero count (the full width for 0)
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr int countTrailingZeros(T value) noexcept
+    {
+      if constexpr (sizeof(T) > sizeof(uint64_t))
+      {
+        uint64_t low = static_cast<uint64_t>(value);
+        return low != 0 ? countTrailingZeros(low) : 64 + countTrailingZeros(static_cast<uint64_t>(value >> 64));
+      }
+      else
+      {
+#if defined(__GNUC__) && defined(__BMI__)
+        return value == 0 ? bit_width_v<T> : __builtin_ctzll(value);
+#else
+        // (value & -value) - 1 sets exactly the bits below the lowest set bit (all of them for 0)
+        return countSetBits(static_cast<T>(static_cast<T>(value & static_cast<T>(~value + 1)) - 1));
+#endif
+      }
+    }
+
+    /**
+     * @brief Rotates left by shift positions, taken modulo the width (negative values rotate right)
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T rotateLeft(T value, int shift) noexcept
+    {
+      // Masking both counts keeps a rotation by 0 free of an out-of-range shift
+      unsigned s = static_cast<unsigned>(shift) & (bit_width_v<T> - 1);
+      return static_cast<T>((value << s) | (value >> ((bit_width_v<T> - s) & (bit_width_v<T> - 1))));
+    }
+
+    /**
+     * @brief Rotates right by shift positions, taken modulo the width (negative values rotate left)
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T rotateRight(T value, int shift) noexcept
+    {
+      return rotateLeft(value, -shift);
+    }
+
+    /**
+     * @brief Upper half of the double-width value hi:lo shifted left, with shift taken modulo the width
+     * @return hi for a shift of 0, otherwise hi's low bits followed by lo's top shift bits
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T funnelShiftLeft(T hi, T lo, int shift) noexcept
+    {
+      unsigned s = static_cast<unsigned>(shift) & (bit_width_v<T> - 1);
+      return s == 0 ? hi : static_cast<T>((hi << s) | (lo >> (bit_width_v<T> - s)));
+    }
+
+    /**
+     * @brief Lower half of the double-width value hi:lo shifted right, with shift taken modulo the width
+     * @return lo for a shift of 0, otherwise lo's high bits preceded by hi's bottom shift bits
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T funnelShiftRight(T hi, T lo, int shift) noexcept
+    {
+      unsigned s = static_cast<unsigned>(shift) & (bit_width_v<T> - 1);
+      return s == 0 ? lo : static_cast<T>((lo >> s) | (hi << (bit_width_v<T> - s)));
+    }
+
+    /**
+     * @brief Binary-reflected Gray code: consecutive values map to codes that differ in exactly one bit
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T grayEncode(T value) noexcept
+    {
+      return static_cast<T>(value ^ (value >> 1));
+    }
+
+    /**
+     * @brief Inverse of grayEncode: bit i of the result is the XOR of code bits i and above
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T grayDecode(T code) noexcept
+    {
+      // Prefix XOR from the top in log2(width) doubling steps
+      for (int shift = 1; shift < bit_width_v<T>; shift *= 2)
+        code = static_cast<T>(code ^ (code >> shift));
+      return code;
+    }
+
+    /**
+     * @brief Reverses the bit order, so bit i moves to bit (width - 1 - i)
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T reverseBits(T value) noexcept
+    {
+      if constexpr (sizeof(T) > sizeof(uint64_t))
+      {
+        return static_cast<T>((static_cast<T>(reverseBits(static_cast<uint64_t>(value))) << 64) |
+                              reverseBits(static_cast<uint64_t>(value >> 64)));
+      }
+      else
+      {
+        // Reverse the bytes with one BSWAP, then the bits inside each byte with three mask-and-swap steps
+        uint64_t v = value;
+        if constexpr (sizeof(T) == 2)
+          v = __builtin_bswap16(static_cast<uint16_t>(v));
+        else if constexpr (sizeof(T) == 4)
+          v = __builtin_bswap32(static_cast<uint32_t>(v));
+        else if constexpr (sizeof(T) == 8)
+          v = __builtin_bswap64(v);
+        v = ((v >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((v & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+        v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+        return static_cast<T>(v);
+      }
+    }
+
+    /**
+     * @brief Prefix XOR: bit i of the result is the XOR of bits 0..i of value
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T prefixXor(T value) noexcept
+    {
+      for (int shift = 1; shift < bit_width_v<T>; shift *= 2)
+        value = static_cast<T>(value ^ static_cast<T>(value << shift));
+      return value;
+    }
+
+    /**
+     * @brief Gathers the bits of value selected by mask into the low bits of the result (PEXT)
+     *
+     * Branch-free compress from Hacker's Delight (7-4): log2(width) rounds, each moving every
+     * selected bit right by the matching power of two when the count of unselected bits below it has that bit set.
+     * @return Selected bits, packed from bit 0 up in their original order
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T extractBits(T value, T mask) noexcept
+    {
+      value = static_cast<T>(value & mask);
+      T zerosBelow = static_cast<T>(static_cast<T>(~mask) << 1); // unselected bits, counted from the right
+      for (int step = 1; step < bit_width_v<T>; step *= 2)
+      {
+        T moves = prefixXor(zerosBelow);
+        T moving = static_cast<T>(moves & mask);
+        mask = static_cast<T>((mask ^ moving) | (moving >> step));
+        T bits = static_cast<T>(value & moving);
+        value = static_cast<T>((value ^ bits) | (bits >> step));
+        zerosBelow = static_cast<T>(zerosBelow & ~moves);
+      }
+      return value;
+    }
+
+    /**
+     * @brief Scatters the low bits of value to the positions set in mask (PDEP), the inverse of extractBits
+     *
+     * Branch-free expand from Hacker's Delight (7-5): the compress moves are computed on the mask,
+     * then replayed on value in reverse order.
+     * @return Value with its low popcount(mask) bits placed at the mask positions
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T depositBits(T value, T mask) noexcept
+    {
+      constexpr int rounds = bit_width_v<T> == 8 ? 3 : bit_width_v<T> == 16 ? 4 : bit_width_v<T> == 32 ? 5 : bit_width_v<T> == 64 ? 6 : 7;
+      T moved[rounds] = {};
+      const T original = mask;
+      T zerosBelow = static_cast<T>(static_cast<T>(~mask) << 1);
+      for (int round = 0; round < rounds; ++round)
+      {
+        T moves = prefixXor(zerosBelow);
+        T moving = static_cast<T>(moves & mask);
+        moved[round] = moving;
+        mask = static_cast<T>((mask ^ moving) | (moving >> (1 << round)));
+        zerosBelow = static_cast<T>(zerosBelow & ~moves);
+      }
+      for (int round = rounds - 1; round >= 0; --round)
+      {
+        T shifted = static_cast<T>(value << (1 << round));
+        value = static_cast<T>((value & ~moved[round]) | (shifted & moved[round]));
+      }
+      return static_cast<T>(value & original);
+    }
+
+    /**
+     * @brief Range over the positions of the set bits of a word, lowest first
+     *
+     * Each step is one trailing-zero count and one clear-lowest-bit (value & (value - 1)), so the
+     * loop runs once per set bit rather than once per bit position.
+     */
+    template <typename T>
+    class SetBitPositions
+    {
+    public:
+      class iterator
+      {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int *;
+        using reference = int;
+
+        constexpr explicit iterator(T bits) noexcept : bits_(bits) {}
+        constexpr int operator*() const noexcept { return countTrailingZeros(bits_); }
+        constexpr iterator &operator++() noexcept
+        {
+          bits_ = static_cast<T>(bits_ & (bits_ - 1));
+          return *this;
+        }
+        constexpr iterator operator++(int) noexcept
+        {
+          iterator previous = *this;
+          ++*this;
+          return previous;
+        }
+        constexpr bool operator==(const iterator &other) const noexcept { return bits_ == other.bits_; }
+        constexpr bool operator!=(const iterator &other) const noexcept { return bits_ != other.bits_; }
+
+      private:
+        T bits_;
+      };
+
+      constexpr explicit SetBitPositions(T value) noexcept : value_(value) {}
+      constexpr iterator begin() const noexcept { return iterator(value_); }
+      constexpr iterator end() const noexcept { return iterator(T(0)); }
+
+    private:
+      T value_;
+    };
+
+    /**
+     * @brief Positions of the set bits of value, for use in a range-for loop
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr SetBitPositions<T> setBitPositions(T value) noexcept
+    {
+      return SetBitPositions<T>(value);
+    }
+
+    /**
+     * @brief Calls fn(position) for every set bit of a word buffer, lowest first; bit p is bit (p % width) of word (p / width)
+     */
+    template <typename T, typename Fn, BITWISE_REQUIRES_WORD(T)>
+    void forEachSetBit(const T *words, std::size_t length, Fn fn)
+    {
+      for (std::size_t w = 0; w < length; ++w)
+      {
+        const std::size_t base = w * bit_width_v<T>;
+        for (T bits = words[w]; bits != 0; bits = static_cast<T>(bits & (bits - 1)))
+          fn(base + static_cast<std::size_t>(countTrailingZeros(bits)));
+      }
+    }
+
+    /**
+     * @brief Raises base to exponent by repeated squaring, wrapping modulo 2^width like any unsigned product
+     * @return base^exponent mod 2^width
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr T power(T base, unsigned exponent) noexcept
+    {
+      T result = 1;
+      while (exponent != 0)
+      {
+        if (exponent & 1U)
+          result = static_cast<T>(result * base);
+        base = static_cast<T>(base * base);
+        exponent >>= 1;
+      }
+      return result;
+    }
+
+    /**
+     * @brief Raises a signed base to exponent by repeated squaring, detecting long long overflow
+     * @param result Receives base^exponent when it fits (left unspecified otherwise)
+     * @return false if any intermediate or final product overflows long long
+     */
+    constexpr bool checkedPower(long long base, unsigned exponent, long long &result) noexcept
+    {
+      long long acc = 1;
+      while (exponent != 0)
+      {
+        if ((exponent & 1U) && __builtin_mul_overflow(acc, base, &acc))
+          return false;
+        exponent >>= 1;
+        // The last squaring is never used, and may overflow even when the result fits
+        if (exponent != 0 && __builtin_mul_overflow(base, base, &base))
+          return false;
+      }
+      result = acc;
+      return true;
+    }
+
+    /**
+     * @brief Number of characters in a full-width grouped binary rendering (digits plus a space per nibble boundary)
+     */
+    template <typename T>
+    inline constexpr std::size_t binary_chars_v = bit_width_v<T> + bit_width_v<T> / 4 - 1;
+
+    /**
+     * @brief Renders every bit of value, grouped in nibbles like toBinaryString, at compile time
+     * @return Null-terminated character array
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    constexpr std::array<char, binary_chars_v<T> + 1> toBinaryArray(T value) noexcept
+    {
+      std::array<char, binary_chars_v<T> + 1> out{};
+      std::size_t pos = 0;
+      for (int i = bit_width_v<T> - 1; i >= 0; --i)
+      {
+        out[pos++] = isBitSet(value, i) ? '1' : '0';
+        if (i % 4 == 0 && i != 0)
+        {
+          out[pos++] = ' ';
+        }
+      }
+      out[pos] = '\0';
+      return out;
+    }
+
+    /**
+     * @brief Converts a value of any supported width to its binary string representation
+     * @param value The value to convert
+     * @param bits Number of bits to show (default: the full width)
+     * @return Binary string with a space every 4 bits
+     */
+    template <typename T, BITWISE_REQUIRES_WORD(T)>
+    std::string toBinaryString(T value, int bits = bit_width_v<T>)
+    {
+      std::string result;
+      result.reserve(bits > 0 ? bits + (bits - 1) / 4 : 0);
+      for (int i = bits - 1; i >= 0; --i)
+      {
+        result += isBitSet(value, i) ? '1' : '0';
+        if (i % 4 == 0 && i != 0)
+        {
+          result += ' ';
+        }
+      }
+      return result;
+    }
+
+#undef BITWISE_REQUIRES_WORD
+
+  } // namespace generic
+
+} // namespace bitwise
+
+#endif // BITWISE_GENERIC_H
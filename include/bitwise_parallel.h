@@ -0,0 +1,123 @@
+#ifndef BITWISE_PARALLEL_H
+#define BITWISE_PARALLEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bitwise
+{
+
+  class ThreadPool;
+
+  /**
+   * @brief Words each parallel task processes per operand (64 KiB, about half an L2 slice)
+   */
+  constexpr std::size_t kParallelGrainWords = 16384;
+
+  /**
+   * @brief Sets the size of the pool the parallel functions use by default
+   *
+   * Recreates the default pool, so it must not be called while a parallel operation is running.
+   * @param threads Thread count including the caller; 0 means one per hardware thread (the default)
+   */
+  void setParallelThreads(unsigned threads);
+
+  /**
+   * @brief The pool the parallel functions use when none is passed
+   */
+  ThreadPool &defaultThreadPool();
+
+  /**
+   * @brief Multithreaded bitwiseAnd over large buffers; buffers below a few tasks run on the calling thread
+   * @param dst Output buffer (may alias srcA or srcB)
+   * @param srcA First operand buffer
+   * @param srcB Second operand buffer
+   * @param length Number of 32-bit words in each buffer
+   * @param pool Pool to run on
+   */
+  void parallelAnd(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length,
+                   ThreadPool &pool = defaultThreadPool());
+
+  /**
+   * @brief Multithreaded bitwiseOr; see parallelAnd
+   */
+  void parallelOr(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length,
+                  ThreadPool &pool = defaultThreadPool());
+
+  /**
+   * @brief Multithreaded bitwiseXor; see parallelAnd
+   */
+  void parallelXor(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length,
+                   ThreadPool &pool = defaultThreadPool());
+
+  /**
+   * @brief Multithreaded bitwiseNot; dst may alias src
+   */
+  void parallelNot(uint32_t *dst, const uint32_t *src, std::size_t length, ThreadPool &pool = defaultThreadPool());
+
+  /**
+   * @brief Multithreaded countSetBits over a buffer
+   * @return Total number of set bits
+   */
+  uint64_t parallelCountSetBits(const uint32_t *data, std::size_t length, ThreadPool &pool = defaultThreadPool());
+
+  /**
+   * @brief Multithreaded multi-word leftShift; each task funnels its words from the source independently
+   * @param dst Output buffer (must not overlap src)
+   * @param src Operand buffer
+   * @param length Number of 32-bit words in each buffer
+   * @param bits Shift distance in bits
+   * @param pool Pool to run on
+   */
+  void parallelLeftShift(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits,
+                         ThreadPool &pool = defaultThreadPool());
+
+  /**
+   * @brief Multithreaded multi-word rightShift; see parallelLeftShift
+   */
+  void parallelRightShift(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits,
+                          ThreadPool &pool = defaultThreadPool());
+
+  /**
+   * @brief Zero-filled word buffer whose pages are first touched by the pool workers that will process them
+   *
+   * Memory comes straight from mmap, so no page is backed until it is written. The constructor
+   * zeroes the buffer with the same task split the parallel functions use, and on a NUMA
+   * machine the kernel places each page on the node of the thread that first wrote it. Later
+   * parallel passes with the same pool then mostly read node-local memory.
+   */
+  class ParallelBuffer
+  {
+  public:
+    ParallelBuffer() = default;
+
+    /**
+     * @param length Number of 32-bit words
+     * @param pool Pool whose workers touch the pages
+     * @throws std::bad_alloc if the mapping fails
+     */
+    explicit ParallelBuffer(std::size_t length, ThreadPool &pool = defaultThreadPool());
+    ~ParallelBuffer();
+
+    ParallelBuffer(ParallelBuffer &&other) noexcept;
+    ParallelBuffer &operator=(ParallelBuffer &&other) noexcept;
+    ParallelBuffer(const ParallelBuffer &) = delete;
+    ParallelBuffer &operator=(const ParallelBuffer &) = delete;
+
+    uint32_t *data() { return data_; }
+    const uint32_t *data() const { return data_; }
+    std::size_t size() const { return length_; }
+
+    uint32_t &operator[](std::size_t index) { return data_[index]; }
+    const uint32_t &operator[](std::size_t index) const { return data_[index]; }
+
+  private:
+    void release();
+
+    uint32_t *data_ = nullptr;
+    std::size_t length_ = 0;
+  };
+
+} // namespace bitwise
+
+#endif // BITWISE_PARALLEL_H
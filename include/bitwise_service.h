@@ -0,0 +1,240 @@
+#ifndef BITWISE_SERVICE_H
+#define BITWISE_SERVICE_H
+
+#include "render_sink.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bitwise
+{
+  namespace service
+  {
+
+    /**
+     * @brief Operations a request frame can ask for; every item carries two operands (a, b)
+     *
+     * Numeric results are one uint32_t per item:
+     *   And/Or/Xor a b | Not a | Shl/Shr a n | Popcnt a | IsSet/Set/Clear/Toggle a pos
+     * Text results are one string per item:
+     *   Bin a (toBinaryString) | Hex a (toHexString) | BaseTable length basis (displayBaseTable)
+     * With kFlagRender, And/Or/Xor/Not/Shl/Shr return the display* visualizer text instead of the number.
+     */
+    enum class Op : uint8_t
+    {
+      And = 1,
+      Or,
+      Xor,
+      Not,
+      Shl,
+      Shr,
+      Popcnt,
+      IsSet,
+      Set,
+      Clear,
+      Toggle,
+      Bin,
+      Hex,
+      BaseTable
+    };
+
+    enum class Status : uint8_t
+    {
+      Ok = 0,
+      BadRequest = 1 // the payload is one message string describing the problem
+    };
+
+    /**
+     * @brief Request flag: render the operation with its display* visualizer
+     */
+    constexpr uint8_t kFlagRender = 1;
+
+    /**
+     * @brief Bytes in a request or response header
+     *
+     * Every frame is a 12-byte little-endian header followed by its payload:
+     *   request:  u32 payload bytes, u32 id, u8 op, u8 flags,  u16 item count; count x (u32 a, u32 b)
+     *   response: u32 payload bytes, u32 id, u8 op, u8 status, u16 item count; count x u32 for numbers,
+     *             count x (u32 length, bytes) for text
+     * Responses come back in request order with the request's id, so a client may pipeline any
+     * number of frames on one connection.
+     */
+    constexpr std::size_t kHeaderSize = 12;
+
+    /**
+     * @brief Largest request payload accepted; a longer frame closes the connection
+     */
+    constexpr std::size_t kMaxRequestPayload = 65535 * 8;
+
+    /**
+     * @brief Most items a BaseTable or rendered request may carry
+     *
+     * Their text runs to about 13 KB per item, so a larger frame is answered with BadRequest
+     * instead of buffering hundreds of megabytes of output.
+     */
+    constexpr std::size_t kMaxRenderItems = 64;
+
+    /**
+     * @brief A decoded response frame; payload points into the caller's buffer
+     */
+    struct Response
+    {
+      uint32_t id = 0;
+      Op op = Op::And;
+      Status status = Status::Ok;
+      uint16_t count = 0;
+      const uint8_t *payload = nullptr;
+      uint32_t payloadSize = 0;
+
+      /**
+       * @brief Result i of a numeric response
+       */
+      uint32_t number(std::size_t i) const;
+
+      /**
+       * @brief All strings of a text response (or the message of a BadRequest response)
+       */
+      std::vector<std::string> texts() const;
+    };
+
+    /**
+     * @brief Appends one request frame to out
+     * @param out Buffer the frame is appended to
+     * @param id Echoed back in the response
+     * @param op Operation applied to every item
+     * @param flags 0 or kFlagRender
+     * @param operands 2 * count values: a0, b0, a1, b1, ...
+     * @param count Number of items (at most 65535)
+     */
+    void appendRequest(std::vector<uint8_t> &out, uint32_t id, Op op, uint8_t flags, const uint32_t *operands,
+                       uint16_t count);
+
+    /**
+     * @brief Decodes the response frame at the start of data
+     * @return Bytes the frame occupies, or 0 if data does not hold a whole frame yet
+     */
+    std::size_t parseResponse(const uint8_t *data, std::size_t size, Response &response);
+
+    /**
+     * @brief Per-connection request processor, independent of any socket
+     *
+     * Holds the rendering buffer so a connection allocates nothing once its buffers have grown to
+     * the size of its largest batch.
+     */
+    class Session
+    {
+    public:
+      /**
+       * @brief Answers every complete request frame at the start of data
+       * @param data Received bytes
+       * @param size Number of received bytes
+       * @param out Responses are appended here, in request order
+       * @param outputLimit No further frame is answered once out holds this many bytes
+       * @return Bytes consumed; a partial trailing frame, and any frame past outputLimit, is left for the next call
+       */
+      std::size_t process(const uint8_t *data, std::size_t size, std::vector<uint8_t> &out,
+                          std::size_t outputLimit = SIZE_MAX);
+
+      /**
+       * @brief True once a frame could not be parsed; the connection should be closed after flushing out
+       */
+      bool failed() const { return failed_; }
+
+    private:
+      void answer(const uint8_t *frame, std::vector<uint8_t> &out);
+
+      BufferSink render_;
+      bool failed_ = false;
+    };
+
+    /**
+     * @brief Where a server listens or a client connects
+     */
+    struct Address
+    {
+      std::string unixPath; // non-empty for a Unix domain socket
+      std::string host = "127.0.0.1";
+      uint16_t port = 0; // 0 lets listen() pick a free port
+    };
+
+    /**
+     * @brief Parses "unix:PATH", "HOST:PORT" or "PORT" (loopback)
+     * @return true on success; otherwise error describes the problem
+     */
+    bool parseAddress(const std::string &text, Address &address, std::string &error);
+
+    /**
+     * @brief Opens a blocking client connection
+     * @return The socket descriptor, or -1 with error set
+     */
+    int connectTo(const Address &address, std::string &error);
+
+    /**
+     * @brief Single-threaded epoll server for the request protocol
+     *
+     * All sockets are non-blocking and level-triggered. Each readable event reads what is
+     * available into the connection's input buffer, answers every complete frame in it and
+     * sends the responses with one write, so pipelined requests cost one read and one write
+     * per batch. Output that the socket does not take at once is kept and the connection waits
+     * for EPOLLOUT, and reading from it pauses until the backlog drains; frames already received
+     * past the backlog limit are answered as it drains. A connection's buffers stay allocated for
+     * its lifetime. When the process runs out of descriptors, accepting pauses until a connection
+     * closes; new clients wait in the listen backlog meanwhile.
+     */
+    class Server
+    {
+    public:
+      Server();
+      ~Server();
+
+      Server(const Server &) = delete;
+      Server &operator=(const Server &) = delete;
+
+      /**
+       * @brief Binds and listens; a stale Unix socket file at the path is replaced
+       * @return true on success; otherwise error describes the problem
+       */
+      bool listen(const Address &address, std::string &error);
+
+      /**
+       * @brief TCP port actually bound (useful after listening on port 0); 0 for Unix sockets
+       */
+      uint16_t port() const { return port_; }
+
+      /**
+       * @brief Serves connections until stop() is called
+       */
+      void run();
+
+      /**
+       * @brief Makes run() return; safe to call from another thread or a signal handler
+       */
+      void stop();
+
+    private:
+      struct Connection;
+
+      void acceptAll();
+      void onReadable(Connection &connection);
+      void onWritable(Connection &connection);
+      bool serve(Connection &connection);
+      bool flush(Connection &connection);
+      void updateInterest(Connection &connection);
+      void close(int fd);
+      void closeListener();
+
+      int listenFd_ = -1;
+      int epollFd_ = -1;
+      int wakeFd_ = -1;
+      uint16_t port_ = 0;
+      bool acceptPaused_ = false; // out of descriptors; the listener is re-armed when a session closes
+      std::string unixPath_;
+      std::vector<std::unique_ptr<Connection>> connections_; // indexed by descriptor
+    };
+
+  } // namespace service
+} // namespace bitwise
+
+#endif // BITWISE_SERVICE_H
@@ -0,0 +1,224 @@
+#ifndef BITWISE_STATS_H
+#define BITWISE_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Set to 0 (cmake -DBITWISE_ENABLE_STATS=OFF) to compile every instrumentation point out of the library
+#ifndef BITWISE_ENABLE_STATS
+#define BITWISE_ENABLE_STATS 1
+#endif
+
+namespace bitwise
+{
+
+  /**
+   * @brief Optional per-operation call counters, byte counts and latency histograms
+   *
+   * Recording is off until setEnabled(true); while off, each instrumented call costs one relaxed
+   * load and a not-taken branch. Every thread records into its own counters, which snapshot()
+   * merges on demand, so recording never takes a lock or a contended cache line. Word-sized
+   * operations only count calls; buffer-sized ones are also timed into log2 nanosecond buckets.
+   */
+  namespace stats
+  {
+
+    enum class Operation : uint8_t
+    {
+      // Single-word operations (calls only)
+      And,
+      Or,
+      Xor,
+      Not,
+      LeftShift,
+      RightShift,
+      CountSetBits,
+      IsBitSet,
+      SetBit,
+      ClearBit,
+      ToggleBit,
+      CountLeadingZeros,
+      CountTrailingZeros,
+      Rotate,
+      FunnelShift,
+      ReverseBits,
+      ExtractBits,
+      DepositBits,
+      // Buffer operations (calls, bytes and latency)
+      BulkAnd,
+      BulkOr,
+      BulkXor,
+      BulkNot,
+      BulkCountSetBits,
+      BulkLeftShift,
+      BulkRightShift,
+      BulkRotate,
+      BulkSetBits,
+      BulkClearBits,
+      BulkToggleBits,
+      BulkTestBits,
+      BulkTranspose,
+      BulkMortonEncode,
+      BulkMortonDecode,
+      BulkGrayEncode,
+      BulkGrayDecode,
+      ParallelAnd,
+      ParallelOr,
+      ParallelXor,
+      ParallelNot,
+      ParallelCountSetBits,
+      ParallelLeftShift,
+      ParallelRightShift,
+      FileCombine,
+      FileInvert,
+      FileShift,
+      FileCountSetBits,
+      ExpressionExecute,
+      BatchRun,
+      RoaringAnd,
+      RoaringOr,
+      RoaringXor,
+      RoaringAndNot,
+      BloomInsert,
+      BloomQuery,
+      ServiceRequest,
+      RadixConvert,
+      Count
+    };
+
+    constexpr std::size_t kOperationCount = static_cast<std::size_t>(Operation::Count);
+
+    /**
+     * @brief Latency buckets: bucket 0 holds 0 ns, bucket i holds [2^(i-1), 2^i) ns, the last one everything longer
+     */
+    constexpr std::size_t kLatencyBuckets = 40;
+
+    /**
+     * @brief True when the library was built with the instrumentation points
+     */
+    constexpr bool kCompiledIn = BITWISE_ENABLE_STATS != 0;
+
+    struct OperationStats
+    {
+      uint64_t calls = 0;
+      uint64_t bytes = 0;
+      uint64_t timedCalls = 0;
+      uint64_t totalNanoseconds = 0;
+      std::array<uint64_t, kLatencyBuckets> latency{};
+    };
+
+    struct Snapshot
+    {
+      std::array<OperationStats, kOperationCount> operations{};
+
+      const OperationStats &operator[](Operation op) const { return operations[static_cast<std::size_t>(op)]; }
+    };
+
+    /**
+     * @brief Stable name of an operation as used in the JSON dump (for example "bulk.and")
+     */
+    const char *operationName(Operation op);
+
+    namespace detail
+    {
+      extern std::atomic<bool> enabledFlag;
+    }
+
+    /**
+     * @brief Turns recording on or off for every thread
+     */
+    void setEnabled(bool enabled);
+
+    inline bool enabled()
+    {
+      return detail::enabledFlag.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Counts one call of op on the calling thread
+     *
+     * Marked cold so the disabled path through an instrumented function stays a fall-through branch.
+     */
+    __attribute__((cold)) void record(Operation op, uint64_t bytes);
+
+    /**
+     * @brief Counts one call of op on the calling thread and adds its latency to the histogram
+     */
+    void recordTimed(Operation op, uint64_t bytes, uint64_t nanoseconds);
+
+    /**
+     * @brief Merges the counters of every thread, live or exited, since the last reset()
+     */
+    Snapshot snapshot();
+
+    /**
+     * @brief Starts a new measurement period; later snapshots only include calls made after it
+     */
+    void reset();
+
+    /**
+     * @brief Renders the operations with at least one call as a JSON object
+     */
+    std::string toJson(const Snapshot &snapshot);
+
+    /**
+     * @brief Times the enclosing scope into op when recording is enabled
+     */
+    class ScopedTimer
+    {
+    public:
+      ScopedTimer(Operation op, uint64_t bytes) noexcept : op_(op), bytes_(bytes), active_(enabled())
+      {
+        if (active_)
+          start_ = std::chrono::steady_clock::now();
+      }
+
+      ~ScopedTimer()
+      {
+        if (active_)
+        {
+          auto elapsed = std::chrono::steady_clock::now() - start_;
+          recordTimed(op_, bytes_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+      }
+
+      /**
+       * @brief Replaces the byte count, for operations that only learn their size part way through
+       */
+      void setBytes(uint64_t bytes) noexcept { bytes_ = bytes; }
+
+      ScopedTimer(const ScopedTimer &) = delete;
+      ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+      Operation op_;
+      uint64_t bytes_;
+      bool active_;
+      std::chrono::steady_clock::time_point start_;
+    };
+
+  } // namespace stats
+
+} // namespace bitwise
+
+#if BITWISE_ENABLE_STATS
+#define BITWISE_STATS_COUNT(op)                                        \
+  do                                                                   \
+  {                                                                    \
+    if (__builtin_expect(::bitwise::stats::enabled(), 0))              \
+      ::bitwise::stats::record(::bitwise::stats::Operation::op, 0);    \
+  } while (0)
+#define BITWISE_STATS_SCOPE(op, bytes) \
+  ::bitwise::stats::ScopedTimer bitwiseStatsScope_(::bitwise::stats::Operation::op, (bytes))
+#define BITWISE_STATS_SET_BYTES(bytes) bitwiseStatsScope_.setBytes(bytes)
+#else
+#define BITWISE_STATS_COUNT(op) ((void)0)
+#define BITWISE_STATS_SCOPE(op, bytes) ((void)0)
+#define BITWISE_STATS_SET_BYTES(bytes) ((void)(bytes))
+#endif
+
+#endif // BITWISE_STATS_H
@@ -1,6 +1,8 @@
 #ifndef BITWISE_UTILS_H
 #define BITWISE_UTILS_H
 
+#include <charconv>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -8,6 +10,8 @@
 namespace bitwise
 {
 
+  class RenderSink;
+
   /**
    * @brief Converts an integer to its binary string representation
    * @param value The integer value to convert
@@ -23,6 +27,45 @@ namespace bitwise
    */
   std::string toHexString(uint32_t value);
 
+  /**
+   * @brief Buffer size that fits any 32-bit binary rendering with the default grouping (32 digits + 7 spaces)
+   */
+  constexpr std::size_t kMaxBinaryChars = 39;
+
+  /**
+   * @brief Buffer size that fits any 32-bit hex rendering with the "0x" prefix
+   */
+  constexpr std::size_t kMaxHexChars = 10;
+
+  /**
+   * @brief Returns how many characters toBinaryChars writes for the given options
+   * @param bits Number of bits to show
+   * @param grouped Whether a space is inserted every 4 bits
+   */
+  std::size_t binaryCharsLength(int bits, bool grouped = true);
+
+  /**
+   * @brief Writes the binary representation into [first, last) without allocating (std::to_chars style)
+   * @param first Start of the output buffer
+   * @param last End of the output buffer
+   * @param value The integer value to convert
+   * @param bits Number of bits to show (default: 32); bits above 31 render as leading zeros
+   * @param grouped Add a space every 4 bits, as toBinaryString does (default: true)
+   * @return {one past the last character written, std::errc()} or {last, std::errc::value_too_large}
+   */
+  std::to_chars_result toBinaryChars(char *first, char *last, uint32_t value, int bits = 32, bool grouped = true);
+
+  /**
+   * @brief Writes the hexadecimal representation into [first, last) without allocating (std::to_chars style)
+   * @param first Start of the output buffer
+   * @param last End of the output buffer
+   * @param value The integer value to convert
+   * @param prefixed Prepend "0x", as toHexString does (default: true)
+   * @param uppercase Use A-F rather than a-f (default: true)
+   * @return {one past the last character written, std::errc()} or {last, std::errc::value_too_large}
+   */
+  std::to_chars_result toHexChars(char *first, char *last, uint32_t value, bool prefixed = true, bool uppercase = true);
+
   /**
    * @brief Performs bitwise AND operation and returns detailed result
    * @param a First operand
@@ -58,7 +101,7 @@ namespace bitwise
    * @brief Performs left shift operation and returns detailed result
    * @param a Operand to shift
    * @param shift Number of positions to shift left
-   * @return Result of a << shift
+   * @return Result of a << shift (0 when shift is outside 0-31)
    */
   uint32_t leftShift(uint32_t a, int shift);
 
@@ -66,23 +109,44 @@ namespace bitwise
    * @brief Performs right shift operation and returns detailed result
    * @param a Operand to shift
    * @param shift Number of positions to shift right
-   * @return Result of a >> shift
+   * @return Result of a >> shift (0 when shift is outside 0-31)
    */
   uint32_t rightShift(uint32_t a, int shift);
 
   /**
-   * @brief calculate the value of the provided base and exponent pair
-   * @return the result of the exponential calculation
+   * @brief calculate the value of the provided base and exponent pair, by repeated squaring
+   * @return the result of the exponential calculation (1 for exponent <= 0), saturated to
+   *         LLONG_MAX / LLONG_MIN when it does not fit in a long long; BigUnsigned::power
+   *         (big_unsigned.h) gives the exact value at any size
    */
   long long power(int base, int exponent);
 
+  /**
+   * @brief calculate the value of the provided base and exponent pair, reporting overflow
+   * @param result Receives base^exponent (1 for exponent <= 0) when it fits in a long long
+   * @return false if the result overflows; see generic::checkedPower for a constexpr version
+   */
+  bool checkedPower(int base, int exponent, long long &result);
+
   /**
    * @brief Displays a basis table with the powers and values associated with the provided base (basis) system value of the provided table length
+   *
+   * Powers, their decimal text and column labels are cached per basis (up to 256 columns for 64
+   * bases), so repeated or growing tables only compute the new columns. Powers are exact at any
+   * table length; longer tables are computed for the call alone.
    * @param table_length the number of places to display in the table
    * @param basis the number base for the preferred system
    */
   void displayBaseTable(int table_length, int basis);
 
+  /**
+   * @brief Renders the displayBaseTable view into a sink with a single write
+   * @param sink Destination for the rendered text (see render_sink.h)
+   * @param table_length the number of places to display in the table
+   * @param basis the number base for the preferred system
+   */
+  void displayBaseTable(RenderSink &sink, int table_length, int basis);
+
   /**
    * @brief Displays a detailed comparison of two values and their bitwise operation result
    * @param a First operand
@@ -92,6 +156,16 @@ namespace bitwise
    */
   void displayBitwiseOperation(uint32_t a, uint32_t b, const std::string &operation, uint32_t result);
 
+  /**
+   * @brief Renders the displayBitwiseOperation view into a sink with a single write
+   * @param sink Destination for the rendered text (see render_sink.h)
+   * @param a First operand
+   * @param b Second operand
+   * @param operation Operation name (e.g., "AND", "OR", "XOR")
+   * @param result Result of the operation
+   */
+  void displayBitwiseOperation(RenderSink &sink, uint32_t a, uint32_t b, const std::string &operation, uint32_t result);
+
   /**
    * @brief Displays a detailed view of a single value and its bitwise NOT operation
    * @param a Operand
@@ -99,6 +173,14 @@ namespace bitwise
    */
   void displayBitwiseNotOperation(uint32_t a, uint32_t result);
 
+  /**
+   * @brief Renders the displayBitwiseNotOperation view into a sink with a single write
+   * @param sink Destination for the rendered text (see render_sink.h)
+   * @param a Operand
+   * @param result Result of the NOT operation
+   */
+  void displayBitwiseNotOperation(RenderSink &sink, uint32_t a, uint32_t result);
+
   /**
    * @brief Displays a detailed view of a shift operation
    * @param a Original value
@@ -108,6 +190,16 @@ namespace bitwise
    */
   void displayShiftOperation(uint32_t a, int shift, uint32_t result, const std::string &direction);
 
+  /**
+   * @brief Renders the displayShiftOperation view into a sink with a single write
+   * @param sink Destination for the rendered text (see render_sink.h)
+   * @param a Original value
+   * @param shift Number of positions to shift
+   * @param result Result of the shift operation
+   * @param direction Direction of shift ("LEFT" or "RIGHT")
+   */
+  void displayShiftOperation(RenderSink &sink, uint32_t a, int shift, uint32_t result, const std::string &direction);
+
   /**
    * @brief Counts the number of set bits (1s) in an integer
    * @param value The integer to count bits in
@@ -147,6 +239,77 @@ namespace bitwise
    */
   uint32_t toggleBit(uint32_t value, int bitPosition);
 
+  /**
+   * @brief Counts the zero bits above the highest set bit (LZCNT when the CPU has it)
+   * @param value The integer to scan
+   * @return Number of leading zeros, 32 for 0
+   */
+  int countLeadingZeros(uint32_t value);
+
+  /**
+   * @brief Counts the zero bits below the lowest set bit (TZCNT when the CPU has BMI1)
+   * @param value The integer to scan
+   * @return Number of trailing zeros, 32 for 0
+   */
+  int countTrailingZeros(uint32_t value);
+
+  /**
+   * @brief Rotates an integer left; bits shifted out of the top come back in at the bottom
+   * @param value The integer to rotate
+   * @param shift Number of positions, taken modulo 32
+   * @return Rotated integer
+   */
+  uint32_t rotateLeft(uint32_t value, int shift);
+
+  /**
+   * @brief Rotates an integer right; bits shifted out of the bottom come back in at the top
+   * @param value The integer to rotate
+   * @param shift Number of positions, taken modulo 32
+   * @return Rotated integer
+   */
+  uint32_t rotateRight(uint32_t value, int shift);
+
+  /**
+   * @brief Shifts the 64-bit value hi:lo left and keeps the upper 32 bits (SHLD)
+   * @param hi Upper word
+   * @param lo Lower word, whose top bits are shifted into hi
+   * @param shift Number of positions, taken modulo 32
+   * @return The funnelled word; a rotate when hi == lo
+   */
+  uint32_t funnelShiftLeft(uint32_t hi, uint32_t lo, int shift);
+
+  /**
+   * @brief Shifts the 64-bit value hi:lo right and keeps the lower 32 bits (SHRD)
+   * @param hi Upper word, whose bottom bits are shifted into lo
+   * @param lo Lower word
+   * @param shift Number of positions, taken modulo 32
+   * @return The funnelled word; a rotate when hi == lo
+   */
+  uint32_t funnelShiftRight(uint32_t hi, uint32_t lo, int shift);
+
+  /**
+   * @brief Reverses the bit order of an integer (bit 0 becomes bit 31)
+   * @param value The integer to reverse
+   * @return Reversed integer
+   */
+  uint32_t reverseBits(uint32_t value);
+
+  /**
+   * @brief Packs the bits of value selected by mask into the low bits of the result (PEXT when the CPU has BMI2)
+   * @param value The integer to extract from
+   * @param mask Bits to keep
+   * @return Selected bits in their original order, starting at bit 0
+   */
+  uint32_t extractBits(uint32_t value, uint32_t mask);
+
+  /**
+   * @brief Spreads the low bits of value over the positions set in mask (PDEP when the CPU has BMI2)
+   * @param value The integer whose low bits are deposited
+   * @param mask Destination positions
+   * @return Integer with the bits placed at the mask positions and zeros elsewhere
+   */
+  uint32_t depositBits(uint32_t value, uint32_t mask);
+
 } // namespace bitwise
 
 #endif // BITWISE_UTILS_H
\ No newline at end of file
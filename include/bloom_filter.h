@@ -0,0 +1,118 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include "aligned_allocator.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Split-block Bloom filter: every key touches a single 256-bit block
+   *
+   * A key's 64-bit hash picks one 32-byte block (half a cache line) with its high half and sets one
+   * bit in each of the block's eight 32-bit words with its low half, so an insert or lookup costs
+   * one cache miss instead of the k misses of a classic Bloom filter. On AVX2 a block is tested or
+   * updated with one 256-bit load; the batch functions hash ahead and prefetch the blocks so many
+   * misses are in flight at once. The bit layout is the same at every SIMD level.
+   */
+  class BloomFilter
+  {
+  public:
+    /**
+     * @brief 32-bit words per block (one bit of each is set per key)
+     */
+    static constexpr std::size_t kBlockWords = 8;
+
+    /**
+     * @brief A filter with a single block
+     */
+    BloomFilter() : BloomFilter(std::size_t(1)) {}
+
+    /**
+     * @brief An empty filter with the given number of 256-bit blocks (at least one)
+     */
+    explicit BloomFilter(std::size_t blocks);
+
+    /**
+     * @brief An empty filter sized so that expectedKeys insertions give at most falsePositiveRate
+     * @param expectedKeys Number of keys the filter is sized for
+     * @param falsePositiveRate Target probability that contains() reports an absent key, in (0, 1)
+     */
+    BloomFilter(std::size_t expectedKeys, double falsePositiveRate);
+
+    /**
+     * @brief Smallest block count whose expected false positive rate after keys insertions is at most rate
+     */
+    static std::size_t blocksFor(std::size_t keys, double rate);
+
+    /**
+     * @brief Expected false positive rate of a filter with the given number of blocks after keys insertions
+     */
+    static double falsePositiveRate(std::size_t blocks, std::size_t keys);
+
+    /**
+     * @brief Adds key to the filter
+     */
+    void insert(uint64_t key);
+
+    /**
+     * @brief Checks key: false means definitely absent, true means present or a false positive
+     */
+    bool contains(uint64_t key) const;
+
+    /**
+     * @brief Adds count keys, prefetching the blocks of upcoming keys
+     */
+    void insertMany(const uint64_t *keys, std::size_t count);
+
+    /**
+     * @brief Checks count keys and packs the answers into a mask
+     * @param mask Output of (count + 63) / 64 words: bit (i % 64) of mask[i / 64] is contains(keys[i]);
+     *             bits past count are zero
+     * @param keys Keys to check
+     * @param count Number of keys
+     */
+    void containsMany(uint64_t *mask, const uint64_t *keys, std::size_t count) const;
+
+    /**
+     * @brief Removes every key
+     */
+    void clear();
+
+    std::size_t blockCount() const { return words_.size() / kBlockWords; }
+    std::size_t sizeInBytes() const { return words_.size() * sizeof(uint32_t); }
+
+    /**
+     * @brief Bytes written by serialize(): a 16-byte header followed by the blocks
+     */
+    std::size_t serializedSize() const;
+
+    /**
+     * @brief Writes the filter to a flat buffer of serializedSize() bytes ("BWBF", version, block count, words; little-endian)
+     */
+    void serialize(uint8_t *out) const;
+
+    /**
+     * @brief Rebuilds a filter from serialize() output
+     * @param data Serialized bytes
+     * @param size Number of bytes available at data
+     * @param filter Receives the filter on success
+     * @param error Receives a description of the problem on failure
+     * @return true on success
+     */
+    static bool deserialize(const uint8_t *data, std::size_t size, BloomFilter &filter, std::string &error);
+
+    bool operator==(const BloomFilter &other) const { return words_ == other.words_; }
+    bool operator!=(const BloomFilter &other) const { return !(*this == other); }
+
+  private:
+    std::vector<uint32_t, AlignedAllocator<uint32_t>> words_;
+  };
+
+} // namespace bitwise
+
+#endif // BLOOM_FILTER_H
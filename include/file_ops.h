@@ -0,0 +1,113 @@
+#ifndef FILE_OPS_H
+#define FILE_OPS_H
+
+#include "io_queue.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Bytes of each file mapped at a time; resident memory stays near this per file
+   */
+  constexpr std::size_t kFileChunkBytes = std::size_t(8) << 20;
+
+  enum class FileOp
+  {
+    And,
+    Or,
+    Xor
+  };
+
+  /**
+   * @brief Combines two equally sized files bit by bit and writes the result to a new file
+   *
+   * The files are processed in page-aligned windows: each window of the inputs is mapped
+   * read-only with a sequential access hint, combined by the bulk kernels straight into a
+   * shared mapping of the output, then unmapped. Nothing is copied through user buffers.
+   *
+   * @param op AND, OR or XOR
+   * @param inputA First input file
+   * @param inputB Second input file, same size as inputA
+   * @param output Output file, created or truncated (must not be one of the inputs)
+   * @param error Receives a description of the problem on failure
+   * @param chunkBytes Window size, rounded up to a whole number of pages
+   * @return true if the output was written
+   */
+  bool combineFiles(FileOp op, const char *inputA, const char *inputB, const char *output, std::string &error,
+                    std::size_t chunkBytes = kFileChunkBytes);
+
+  /**
+   * @brief Writes the bitwise NOT of every byte of input to output
+   * @return true if the output was written; see combineFiles for the parameters
+   */
+  bool invertFile(const char *input, const char *output, std::string &error, std::size_t chunkBytes = kFileChunkBytes);
+
+  /**
+   * @brief Shifts a whole file as one little-endian bit string and writes a file of the same size
+   *
+   * Bit i of the file is bit (i % 8) of byte (i / 8), the layout of BitVector and of uint32_t
+   * arrays on little-endian machines. A left shift moves bits towards the end of the file;
+   * bits shifted past either end are dropped and zeros are shifted in.
+   *
+   * @param bits Shift distance in bits (any value; shifts past the file length give all zeros)
+   * @param left true for a left shift, false for a right shift
+   * @return true if the output was written; see combineFiles for the other parameters
+   */
+  bool shiftFile(const char *input, const char *output, uint64_t bits, bool left, std::string &error,
+                 std::size_t chunkBytes = kFileChunkBytes);
+
+  /**
+   * @brief Tuning for the streamed file operations
+   */
+  struct StreamOptions
+  {
+    std::size_t chunkBytes = std::size_t(1) << 20; // bytes per buffer, rounded up to a multiple of 4 KiB
+    unsigned depth = 8;                             // chunks in flight (being read, computed or written)
+    bool direct = true;                             // open with O_DIRECT where the file system supports it
+    IoBackend backend = IoBackend::Auto;
+  };
+
+  /**
+   * @brief combineFiles through an asynchronous read/compute/write pipeline instead of mmap
+   *
+   * Each of options.depth slots owns aligned buffers (registered with io_uring when the kernel
+   * allows) and moves one chunk through three stages: reads of both inputs, the bulk kernel, and
+   * the write. The next chunks' reads are queued while the current one is computed and written,
+   * so the disk never waits for the CPU or the CPU for the disk. Files are opened with O_DIRECT
+   * when possible, so large files do not churn the page cache. All reads and writes are 4 KiB
+   * aligned; the aligned tail written past the end is truncated afterwards.
+   *
+   * @return true if the output was written; see combineFiles for the other parameters
+   */
+  bool streamCombineFiles(FileOp op, const char *inputA, const char *inputB, const char *output, std::string &error,
+                          const StreamOptions &options = StreamOptions());
+
+  /**
+   * @brief invertFile through the streaming pipeline (see streamCombineFiles)
+   */
+  bool streamInvertFile(const char *input, const char *output, std::string &error,
+                        const StreamOptions &options = StreamOptions());
+
+  /**
+   * @brief shiftFile through the streaming pipeline (see streamCombineFiles)
+   *
+   * Each output chunk reads the aligned input range that covers its source bits, so neighbouring
+   * chunks overlap by at most two alignment blocks.
+   */
+  bool streamShiftFile(const char *input, const char *output, uint64_t bits, bool left, std::string &error,
+                       const StreamOptions &options = StreamOptions());
+
+  /**
+   * @brief Counts the set bits of a whole file through the streaming pipeline (reads only)
+   * @param count Receives the number of set bits
+   * @return true on success
+   */
+  bool streamCountSetBits(const char *input, uint64_t &count, std::string &error,
+                          const StreamOptions &options = StreamOptions());
+
+} // namespace bitwise
+
+#endif // FILE_OPS_H
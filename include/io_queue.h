@@ -0,0 +1,95 @@
+#ifndef IO_QUEUE_H
+#define IO_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace bitwise
+{
+
+  enum class IoBackend
+  {
+    Auto,    // io_uring when the kernel allows it, otherwise Threads
+    IoUring, // io_uring through the raw system calls
+    Threads  // pread/pwrite on background threads
+  };
+
+  /**
+   * @brief Name of a backend for messages ("auto", "io_uring" or "threads")
+   */
+  const char *ioBackendName(IoBackend backend);
+
+  /**
+   * @brief True when io_uring_setup succeeds on this kernel (it may be missing or blocked by seccomp)
+   */
+  bool ioUringAvailable();
+
+  /**
+   * @brief A finished read or write
+   */
+  struct IoCompletion
+  {
+    uint64_t tag;   // value passed to read() or write()
+    int64_t result; // bytes transferred (short only at end of file), or -errno
+  };
+
+  /**
+   * @brief Asynchronous positional file I/O with a bounded number of requests in flight
+   *
+   * read() and write() queue a request; wait() hands the queued requests to the backend and
+   * blocks until one of them finishes. Completions may come back in any order, one per request:
+   * both backends continue a partial transfer until it is complete, fails or reaches the end of
+   * the file. The io_uring
+   * backend maps the submission and completion rings directly (no liburing) and uses
+   * READ_FIXED/WRITE_FIXED for buffers passed to registerBuffers(). The thread backend runs
+   * pread/pwrite on a few worker threads; epoll cannot help here because regular files always
+   * poll as ready.
+   */
+  class IoQueue
+  {
+  public:
+    /**
+     * @brief Creates a queue for up to depth requests in flight
+     * @param backend Backend to use; Auto picks io_uring when available
+     * @param depth Maximum number of queued plus running requests
+     * @param error Receives a description of the problem on failure
+     * @return The queue, or nullptr on failure
+     */
+    static std::unique_ptr<IoQueue> create(IoBackend backend, unsigned depth, std::string &error);
+
+    virtual ~IoQueue() = default;
+
+    /**
+     * @brief The backend actually in use (never Auto)
+     */
+    virtual IoBackend backend() const = 0;
+
+    /**
+     * @brief Pins buffers for the lifetime of the queue so requests inside them skip the per-request
+     *        page mapping; a no-op for the thread backend
+     * @return true if the buffers were registered (requests work either way)
+     */
+    virtual bool registerBuffers(uint8_t *const *buffers, std::size_t count, std::size_t bytesEach) = 0;
+
+    /**
+     * @brief Queues a read of length bytes at offset; buffer must stay valid until its completion
+     */
+    virtual void read(int fd, uint8_t *buffer, std::size_t length, uint64_t offset, uint64_t tag) = 0;
+
+    /**
+     * @brief Queues a write of length bytes at offset; buffer must stay valid until its completion
+     */
+    virtual void write(int fd, const uint8_t *buffer, std::size_t length, uint64_t offset, uint64_t tag) = 0;
+
+    /**
+     * @brief Starts the queued requests and waits for one completion
+     * @return false if the backend itself failed (error is set); failed requests report -errno instead
+     */
+    virtual bool wait(IoCompletion &completion, std::string &error) = 0;
+  };
+
+} // namespace bitwise
+
+#endif // IO_QUEUE_H
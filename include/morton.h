@@ -0,0 +1,100 @@
+#ifndef MORTON_H
+#define MORTON_H
+
+#include "bitwise_cpu.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Morton (Z-order) codes for 2-D and 3-D coordinates, and bulk Gray-code conversion
+   *
+   * A Morton code interleaves the coordinate bits: in 2-D bit i of x lands on code bit 2i and bit i
+   * of y on bit 2i + 1; in 3-D they land on bits 3i, 3i + 1 and 3i + 2, with z on the last. Points
+   * that are close in space mostly get close codes.
+   * The 32-bit codes hold 16-bit (2-D) or 10-bit (3-D) coordinates, the 64-bit codes 32-bit or 21-bit
+   * ones; coordinate bits above that width are ignored.
+   *
+   * Single values use PDEP/PEXT when the CPU has BMI2 and magic-number spreading otherwise (a shift,
+   * OR and mask per halving of the bit spacing). The bulk functions take structure-of-arrays
+   * coordinates and run the spreading on eight 32-bit or four 64-bit lanes at a time with AVX2,
+   * falling back to the single-value path at lower SIMD levels. The 64-bit codes stay on PDEP/PEXT
+   * at the AVX-512 level, where it is faster than four-lane spreading.
+   */
+
+  /**
+   * @brief Interleaves the low 16 bits of x and y into a 32-bit code (x in the even bits)
+   */
+  uint32_t mortonEncode2D32(uint32_t x, uint32_t y);
+
+  /**
+   * @brief Interleaves the 32 bits of x and y into a 64-bit code (x in the even bits)
+   */
+  uint64_t mortonEncode2D64(uint32_t x, uint32_t y);
+
+  /**
+   * @brief Interleaves the low 10 bits of x, y and z into a 30-bit code (x in bits 0, 3, 6, ...)
+   */
+  uint32_t mortonEncode3D32(uint32_t x, uint32_t y, uint32_t z);
+
+  /**
+   * @brief Interleaves the low 21 bits of x, y and z into a 63-bit code (x in bits 0, 3, 6, ...)
+   */
+  uint64_t mortonEncode3D64(uint32_t x, uint32_t y, uint32_t z);
+
+  /**
+   * @brief Splits a 2-D Morton code back into its coordinates (bits of the code outside the layout are ignored)
+   */
+  void mortonDecode2D32(uint32_t code, uint32_t &x, uint32_t &y);
+  void mortonDecode2D64(uint64_t code, uint32_t &x, uint32_t &y);
+
+  /**
+   * @brief Splits a 3-D Morton code back into its coordinates (bits of the code outside the layout are ignored)
+   */
+  void mortonDecode3D32(uint32_t code, uint32_t &x, uint32_t &y, uint32_t &z);
+  void mortonDecode3D64(uint64_t code, uint32_t &x, uint32_t &y, uint32_t &z);
+
+  /**
+   * @brief Encodes count points given as separate coordinate arrays
+   * @param codes Output buffer of count codes (must not overlap the inputs)
+   * @param x X coordinates
+   * @param y Y coordinates
+   * @param count Number of points
+   */
+  void mortonEncode2D32(uint32_t *codes, const uint32_t *x, const uint32_t *y, std::size_t count);
+  void mortonEncode2D64(uint64_t *codes, const uint32_t *x, const uint32_t *y, std::size_t count);
+
+  /**
+   * @brief Encodes count 3-D points given as separate coordinate arrays
+   * @see mortonEncode2D32(uint32_t *, const uint32_t *, const uint32_t *, std::size_t)
+   */
+  void mortonEncode3D32(uint32_t *codes, const uint32_t *x, const uint32_t *y, const uint32_t *z, std::size_t count);
+  void mortonEncode3D64(uint64_t *codes, const uint32_t *x, const uint32_t *y, const uint32_t *z, std::size_t count);
+
+  /**
+   * @brief Decodes count codes into separate coordinate arrays (none may overlap codes)
+   */
+  void mortonDecode2D32(uint32_t *x, uint32_t *y, const uint32_t *codes, std::size_t count);
+  void mortonDecode2D64(uint32_t *x, uint32_t *y, const uint64_t *codes, std::size_t count);
+  void mortonDecode3D32(uint32_t *x, uint32_t *y, uint32_t *z, const uint32_t *codes, std::size_t count);
+  void mortonDecode3D64(uint32_t *x, uint32_t *y, uint32_t *z, const uint64_t *codes, std::size_t count);
+
+  /**
+   * @brief Converts count values to binary-reflected Gray code (dst may be the same array as src)
+   * @see generic::grayEncode for single values
+   */
+  void grayEncode(uint32_t *dst, const uint32_t *src, std::size_t count);
+  void grayEncode(uint64_t *dst, const uint64_t *src, std::size_t count);
+
+  /**
+   * @brief Converts count Gray codes back to binary (dst may be the same array as src)
+   * @see generic::grayDecode for single values
+   */
+  void grayDecode(uint32_t *dst, const uint32_t *src, std::size_t count);
+  void grayDecode(uint64_t *dst, const uint64_t *src, std::size_t count);
+
+} // namespace bitwise
+
+#endif // MORTON_H
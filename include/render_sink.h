@@ -0,0 +1,75 @@
+#ifndef RENDER_SINK_H
+#define RENDER_SINK_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Destination for rendered text; the display* visualizers issue one write per operation
+   */
+  class RenderSink
+  {
+  public:
+    virtual ~RenderSink() = default;
+
+    /**
+     * @brief Consumes a block of rendered text
+     * @param data Start of the text (not null-terminated)
+     * @param length Number of bytes to write
+     */
+    virtual void write(const char *data, std::size_t length) = 0;
+  };
+
+  /**
+   * @brief Sink that appends everything to an in-memory string
+   */
+  class BufferSink : public RenderSink
+  {
+  public:
+    void write(const char *data, std::size_t length) override { buffer_.append(data, length); }
+
+    const std::string &str() const { return buffer_; }
+    void clear() { buffer_.clear(); }
+
+  private:
+    std::string buffer_;
+  };
+
+  /**
+   * @brief Sink that writes straight to a POSIX file descriptor (no stdio buffering, no flushes)
+   */
+  class FdSink : public RenderSink
+  {
+  public:
+    explicit FdSink(int fd) : fd_(fd) {}
+
+    /**
+     * @brief Writes the whole block, retrying on partial writes and EINTR
+     */
+    void write(const char *data, std::size_t length) override;
+
+  private:
+    int fd_;
+  };
+
+  /**
+   * @brief Sink that forwards to a std::ostream with a single unformatted write
+   */
+  class OstreamSink : public RenderSink
+  {
+  public:
+    explicit OstreamSink(std::ostream &stream) : stream_(stream) {}
+
+    void write(const char *data, std::size_t length) override { stream_.write(data, static_cast<std::streamsize>(length)); }
+
+  private:
+    std::ostream &stream_;
+  };
+
+} // namespace bitwise
+
+#endif // RENDER_SINK_H
@@ -0,0 +1,158 @@
+#ifndef ROARING_BITMAP_H
+#define ROARING_BITMAP_H
+
+#include "aligned_allocator.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Compressed set of 32-bit values in the Roaring layout
+   *
+   * The 32-bit space is split into 65536 chunks keyed by the high 16 bits. Each non-empty chunk
+   * holds its low 16 bits in whichever container is smallest:
+   *   - array:  sorted uint16_t values, for up to 4096 values (2 bytes per value)
+   *   - bitmap: 2048 32-bit words (8 KiB), for denser chunks
+   *   - run:    sorted (start, length - 1) pairs, for chunks made of long intervals (after runOptimize()
+   *             or addRange())
+   * Membership, updates and countSetBits() work on the containers directly. Set operations pair
+   * up containers with equal keys; bitmap pairs go through the bulk word kernels in bitwise_bulk.h.
+   */
+  class RoaringBitmap
+  {
+  public:
+    RoaringBitmap() = default;
+    RoaringBitmap(std::initializer_list<uint32_t> values);
+
+    /**
+     * @brief Checks if value is in the set
+     */
+    bool contains(uint32_t value) const;
+
+    /**
+     * @brief Adds value to the set
+     */
+    void setBit(uint32_t value);
+
+    /**
+     * @brief Removes value from the set
+     */
+    void clearBit(uint32_t value);
+
+    /**
+     * @brief Adds value if it is absent, removes it otherwise
+     */
+    void toggleBit(uint32_t value);
+
+    /**
+     * @brief Adds count values; sorted input takes a fast path that appends chunk by chunk
+     */
+    void addMany(const uint32_t *values, std::size_t count);
+
+    /**
+     * @brief Adds every value in [first, last), stored as runs
+     * @param first First value of the range
+     * @param last One past the last value (up to 2^32)
+     */
+    void addRange(uint32_t first, uint64_t last);
+
+    /**
+     * @brief Number of values in the set
+     */
+    uint64_t countSetBits() const;
+
+    bool empty() const { return keys_.empty(); }
+
+    /**
+     * @brief Converts each container to a run container when that is smaller, and back when it is not
+     * @return true if any container changed representation
+     */
+    bool runOptimize();
+
+    /**
+     * @brief All values in increasing order
+     */
+    std::vector<uint32_t> toVector() const;
+
+    /**
+     * @brief Container counts and the bytes they occupy
+     */
+    struct Statistics
+    {
+      std::size_t arrayContainers = 0;
+      std::size_t bitmapContainers = 0;
+      std::size_t runContainers = 0;
+      std::size_t bytes = 0; // container payloads plus 2-byte keys
+    };
+    Statistics statistics() const;
+
+    bool operator==(const RoaringBitmap &other) const;
+    bool operator!=(const RoaringBitmap &other) const { return !(*this == other); }
+
+    friend RoaringBitmap bitwiseAnd(const RoaringBitmap &a, const RoaringBitmap &b);
+    friend RoaringBitmap bitwiseOr(const RoaringBitmap &a, const RoaringBitmap &b);
+    friend RoaringBitmap bitwiseXor(const RoaringBitmap &a, const RoaringBitmap &b);
+    friend RoaringBitmap bitwiseAndNot(const RoaringBitmap &a, const RoaringBitmap &b);
+
+    /**
+     * @brief Most values an array container holds before it becomes a bitmap
+     */
+    static constexpr uint32_t kArrayMaxSize = 4096;
+
+    /**
+     * @brief Words in a bitmap container (65536 bits)
+     */
+    static constexpr std::size_t kBitmapWords = 65536 / 32;
+
+    enum class ContainerKind : uint8_t
+    {
+      Array,
+      Bitmap,
+      Run
+    };
+
+    struct Container
+    {
+      ContainerKind kind = ContainerKind::Array;
+      uint32_t cardinality = 0;
+      std::vector<uint16_t> values;                        // array values, or run (start, length - 1) pairs
+      std::vector<uint32_t, AlignedAllocator<uint32_t>> words; // bitmap words
+    };
+
+  private:
+    Container *find(uint16_t key);
+    const Container *find(uint16_t key) const;
+    Container &findOrCreate(uint16_t key);
+    void erase(uint16_t key);
+
+    std::vector<uint16_t> keys_; // sorted high halves
+    std::vector<Container> containers_;
+  };
+
+  /**
+   * @brief Values in both sets
+   */
+  RoaringBitmap bitwiseAnd(const RoaringBitmap &a, const RoaringBitmap &b);
+
+  /**
+   * @brief Values in either set
+   */
+  RoaringBitmap bitwiseOr(const RoaringBitmap &a, const RoaringBitmap &b);
+
+  /**
+   * @brief Values in exactly one of the sets
+   */
+  RoaringBitmap bitwiseXor(const RoaringBitmap &a, const RoaringBitmap &b);
+
+  /**
+   * @brief Values in a but not in b
+   */
+  RoaringBitmap bitwiseAndNot(const RoaringBitmap &a, const RoaringBitmap &b);
+
+} // namespace bitwise
+
+#endif // ROARING_BITMAP_H
@@ -0,0 +1,90 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bitwise
+{
+
+  /**
+   * @brief Fixed-size work-stealing thread pool for data-parallel loops
+   *
+   * Every worker owns a deque guarded by its own mutex. parallelFor() deals each worker a
+   * contiguous block of task indices; a worker runs its block front to back and, once it is
+   * empty, steals from the back of another worker's block. The calling thread acts as worker 0,
+   * so a pool of N threads starts N - 1 background threads and a pool of 1 runs everything inline.
+   *
+   * With no stealing, task i always runs on the same worker for the same task count, which is
+   * what lets ParallelBuffer's first-touch initialization place pages near the thread that later
+   * processes them.
+   */
+  class ThreadPool
+  {
+  public:
+    /**
+     * @param threads Number of threads including the caller; 0 means std::thread::hardware_concurrency()
+     */
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Number of threads that execute tasks, including the calling thread
+     */
+    unsigned threadCount() const { return static_cast<unsigned>(queues_.size()); }
+
+    /**
+     * @brief Runs body(task) for every task in [0, taskCount) and returns when all have finished
+     * @param taskCount Number of tasks
+     * @param body Called once per task index, from any pool thread; must not throw
+     */
+    void parallelFor(std::size_t taskCount, const std::function<void(std::size_t)> &body);
+
+  private:
+    struct Job
+    {
+      const std::function<void(std::size_t)> *body;
+      std::atomic<std::size_t> remaining;
+    };
+
+    struct Task
+    {
+      Job *job;
+      std::size_t index;
+    };
+
+    // One worker's deque; the owner pops the front, thieves take the back
+    struct alignas(64) WorkQueue
+    {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+
+    bool popLocal(unsigned worker, Task &task);
+    bool steal(unsigned worker, Task &task);
+    bool runOne(unsigned worker);
+    void finish(Job &job);
+    void workerLoop(unsigned worker);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<std::size_t> queued_{0}; // tasks sitting in any deque
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;     // workers: tasks were queued or the pool is stopping
+    std::condition_variable finished_; // callers: a job's last task completed
+    bool stopping_ = false;
+  };
+
+} // namespace bitwise
+
+#endif // THREAD_POOL_H
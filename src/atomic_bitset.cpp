@@ -0,0 +1,133 @@
+#include "atomic_bitset.h"
+
+namespace bitwise
+{
+  namespace
+  {
+    constexpr std::size_t kWordBits = 64;
+    constexpr std::size_t kWordsPerLine = 64 / sizeof(uint64_t);
+
+    std::size_t wordCount(std::size_t bits)
+    {
+      return (bits + kWordBits - 1) / kWordBits;
+    }
+
+    inline uint64_t bitMask(std::size_t position)
+    {
+      return uint64_t(1) << (position % kWordBits);
+    }
+
+    std::atomic<uint64_t> nextAllocatorId{1};
+    std::atomic<std::size_t> nextThreadOrdinal{0};
+
+    // The word each thread last claimed from, valid for the allocator whose id it records
+    struct SearchHint
+    {
+      uint64_t allocator = 0;
+      std::size_t word = 0;
+    };
+    thread_local SearchHint searchHint;
+
+    // A new thread's first scan starts one cache line further on than the previous thread's
+    std::size_t initialWord(std::size_t words)
+    {
+      thread_local std::size_t ordinal = nextThreadOrdinal.fetch_add(1, std::memory_order_relaxed);
+      return ordinal * kWordsPerLine % words;
+    }
+  } // namespace
+
+  AtomicBitset::AtomicBitset(std::size_t bits)
+      : bits_(bits), words_(new std::atomic<uint64_t>[wordCount(bits)])
+  {
+    clear();
+  }
+
+  bool AtomicBitset::isBitSet(std::size_t position) const
+  {
+    return (words_[position / kWordBits].load(std::memory_order_acquire) & bitMask(position)) != 0;
+  }
+
+  bool AtomicBitset::setBit(std::size_t position)
+  {
+    const uint64_t mask = bitMask(position);
+    return (words_[position / kWordBits].fetch_or(mask, std::memory_order_acq_rel) & mask) != 0;
+  }
+
+  bool AtomicBitset::clearBit(std::size_t position)
+  {
+    const uint64_t mask = bitMask(position);
+    return (words_[position / kWordBits].fetch_and(~mask, std::memory_order_acq_rel) & mask) != 0;
+  }
+
+  bool AtomicBitset::toggleBit(std::size_t position)
+  {
+    const uint64_t mask = bitMask(position);
+    return (words_[position / kWordBits].fetch_xor(mask, std::memory_order_acq_rel) & mask) != 0;
+  }
+
+  std::size_t AtomicBitset::countSetBits() const
+  {
+    std::size_t count = 0;
+    for (std::size_t w = 0; w < wordCount(bits_); ++w)
+      count += static_cast<std::size_t>(__builtin_popcountll(words_[w].load(std::memory_order_relaxed)));
+    return count;
+  }
+
+  void AtomicBitset::clear()
+  {
+    for (std::size_t w = 0; w < wordCount(bits_); ++w)
+      words_[w].store(0, std::memory_order_relaxed);
+  }
+
+  SlotAllocator::SlotAllocator(std::size_t capacity)
+      : capacity_(capacity), words_(wordCount(capacity)), bits_(new std::atomic<uint64_t>[words_]),
+        id_(nextAllocatorId.fetch_add(1, std::memory_order_relaxed))
+  {
+    for (std::size_t w = 0; w < words_; ++w)
+      bits_[w].store(0, std::memory_order_relaxed);
+    // Slots past capacity in the last word start out taken so acquire() never hands them out
+    if (capacity_ % kWordBits != 0)
+      bits_[words_ - 1].store(~uint64_t(0) << (capacity_ % kWordBits), std::memory_order_relaxed);
+  }
+
+  std::size_t SlotAllocator::acquire()
+  {
+    if (words_ == 0)
+      return kNoSlot;
+    SearchHint &hint = searchHint;
+    const std::size_t start = hint.allocator == id_ ? hint.word : initialWord(words_);
+    for (std::size_t i = 0; i < words_; ++i)
+    {
+      std::size_t w = start + i < words_ ? start + i : start + i - words_;
+      uint64_t word = bits_[w].load(std::memory_order_relaxed);
+      while (word != ~uint64_t(0))
+      {
+        const uint64_t lowestClear = ~word & (word + 1);
+        const uint64_t previous = bits_[w].fetch_or(lowestClear, std::memory_order_acq_rel);
+        if ((previous & lowestClear) == 0)
+        {
+          hint.allocator = id_;
+          hint.word = w;
+          return w * kWordBits + static_cast<std::size_t>(__builtin_ctzll(lowestClear));
+        }
+        // Lost the race for that bit; previous shows what is still free in this word
+        word = previous;
+      }
+    }
+    return kNoSlot;
+  }
+
+  void SlotAllocator::release(std::size_t slot)
+  {
+    bits_[slot / kWordBits].fetch_and(~bitMask(slot), std::memory_order_release);
+  }
+
+  std::size_t SlotAllocator::inUse() const
+  {
+    std::size_t taken = 0;
+    for (std::size_t w = 0; w < words_; ++w)
+      taken += static_cast<std::size_t>(__builtin_popcountll(bits_[w].load(std::memory_order_relaxed)));
+    return taken - (words_ * kWordBits - capacity_);
+  }
+
+} // namespace bitwise
@@ -0,0 +1,321 @@
+#include "batch_mode.h"
+#include "bitwise_stats.h"
+#include "bitwise_utils.h"
+#include "render_sink.h"
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+namespace bitwise
+{
+  namespace
+  {
+    constexpr std::size_t kIoChunk = 1 << 20;   // bytes read per syscall
+    constexpr std::size_t kMaxResultLine = 64; // longest line one operation can emit
+
+    enum class BatchOp
+    {
+      And,
+      Or,
+      Xor,
+      Not,
+      Shl,
+      Shr,
+      Popcnt,
+      IsSet,
+      Set,
+      Clear,
+      Toggle,
+      Bin,
+      Hex
+    };
+
+    struct OpSpec
+    {
+      const char *name;
+      std::size_t length;
+      BatchOp op;
+      int operands;
+    };
+
+    const OpSpec kOps[] = {
+        {"AND", 3, BatchOp::And, 2},
+        {"OR", 2, BatchOp::Or, 2},
+        {"XOR", 3, BatchOp::Xor, 2},
+        {"NOT", 3, BatchOp::Not, 1},
+        {"SHL", 3, BatchOp::Shl, 2},
+        {"SHR", 3, BatchOp::Shr, 2},
+        {"POPCNT", 6, BatchOp::Popcnt, 1},
+        {"ISSET", 5, BatchOp::IsSet, 2},
+        {"SET", 3, BatchOp::Set, 2},
+        {"CLEAR", 5, BatchOp::Clear, 2},
+        {"TOGGLE", 6, BatchOp::Toggle, 2},
+        {"BIN", 3, BatchOp::Bin, 1},
+        {"HEX", 3, BatchOp::Hex, 1},
+    };
+
+    inline bool isBlank(char c)
+    {
+      return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    const OpSpec *findOp(const char *name, std::size_t length)
+    {
+      char upper[8];
+      if (length == 0 || length > sizeof(upper))
+        return nullptr;
+      for (std::size_t i = 0; i < length; ++i)
+      {
+        char c = name[i];
+        upper[i] = (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+      }
+      for (const OpSpec &spec : kOps)
+      {
+        if (spec.length == length && std::memcmp(spec.name, upper, length) == 0)
+          return &spec;
+      }
+      return nullptr;
+    }
+
+    // Parses a decimal, 0x hex or 0b binary operand that must fill [first, last)
+    bool parseOperand(const char *first, const char *last, uint32_t &value)
+    {
+      int base = 10;
+      if (last - first > 2 && first[0] == '0')
+      {
+        if (first[1] == 'x' || first[1] == 'X')
+          base = 16;
+        else if (first[1] == 'b' || first[1] == 'B')
+          base = 2;
+        if (base != 10)
+          first += 2;
+      }
+      std::from_chars_result parsed = std::from_chars(first, last, value, base);
+      return parsed.ec == std::errc() && parsed.ptr == last;
+    }
+
+    class BatchRunner
+    {
+    public:
+      explicit BatchRunner(RenderSink &sink) : sink_(sink), out_(kIoChunk) {}
+
+      void processLine(const char *first, const char *last)
+      {
+        while (first < last && isBlank(*first))
+          ++first;
+        while (last > first && isBlank(last[-1]))
+          --last;
+        if (first == last || *first == '#')
+          return;
+
+        if (out_.size() - used_ < kMaxResultLine)
+          flush();
+
+        const char *token = first;
+        while (first < last && !isBlank(*first))
+          ++first;
+        const OpSpec *spec = findOp(token, static_cast<std::size_t>(first - token));
+        if (spec == nullptr)
+        {
+          error("unknown operation");
+          return;
+        }
+
+        uint32_t operands[2] = {0, 0};
+        int count = 0;
+        while (true)
+        {
+          while (first < last && isBlank(*first))
+            ++first;
+          if (first == last)
+            break;
+          const char *start = first;
+          while (first < last && !isBlank(*first))
+            ++first;
+          if (count == spec->operands)
+          {
+            error("too many operands");
+            return;
+          }
+          if (!parseOperand(start, first, operands[count]))
+          {
+            error("invalid operand");
+            return;
+          }
+          ++count;
+        }
+        if (count != spec->operands)
+        {
+          error("missing operand");
+          return;
+        }
+        evaluate(spec->op, operands[0], operands[1]);
+      }
+
+      void flush()
+      {
+        if (used_ > 0)
+        {
+          sink_.write(out_.data(), used_);
+          used_ = 0;
+        }
+      }
+
+      BatchResult result() const { return result_; }
+
+    private:
+      void evaluate(BatchOp op, uint32_t a, uint32_t b)
+      {
+        // Shift counts and bit positions outside 0-31 are undefined for 32-bit operands
+        bool needsBitIndex = op == BatchOp::Shl || op == BatchOp::Shr || op == BatchOp::IsSet ||
+                             op == BatchOp::Set || op == BatchOp::Clear || op == BatchOp::Toggle;
+        if (needsBitIndex && b > 31)
+        {
+          error("bit index out of range (0-31)");
+          return;
+        }
+
+        int index = static_cast<int>(b);
+        switch (op)
+        {
+        case BatchOp::And:
+          number(bitwiseAnd(a, b));
+          break;
+        case BatchOp::Or:
+          number(bitwiseOr(a, b));
+          break;
+        case BatchOp::Xor:
+          number(bitwiseXor(a, b));
+          break;
+        case BatchOp::Not:
+          number(bitwiseNot(a));
+          break;
+        case BatchOp::Shl:
+          number(leftShift(a, index));
+          break;
+        case BatchOp::Shr:
+          number(rightShift(a, index));
+          break;
+        case BatchOp::Popcnt:
+          number(static_cast<uint32_t>(countSetBits(a)));
+          break;
+        case BatchOp::IsSet:
+          number(isBitSet(a, index) ? 1 : 0);
+          break;
+        case BatchOp::Set:
+          number(setBit(a, index));
+          break;
+        case BatchOp::Clear:
+          number(clearBit(a, index));
+          break;
+        case BatchOp::Toggle:
+          number(toggleBit(a, index));
+          break;
+        case BatchOp::Bin:
+          used_ = toBinaryChars(out_.data() + used_, out_.data() + out_.size(), a).ptr - out_.data();
+          endLine();
+          break;
+        case BatchOp::Hex:
+          used_ = toHexChars(out_.data() + used_, out_.data() + out_.size(), a).ptr - out_.data();
+          endLine();
+          break;
+        }
+      }
+
+      void number(uint32_t value)
+      {
+        used_ = std::to_chars(out_.data() + used_, out_.data() + out_.size(), value).ptr - out_.data();
+        endLine();
+      }
+
+      void endLine()
+      {
+        out_[used_++] = '\n';
+        ++result_.operations;
+      }
+
+      void error(const char *reason)
+      {
+        std::size_t length = std::strlen(reason);
+        std::memcpy(out_.data() + used_, "ERR ", 4);
+        std::memcpy(out_.data() + used_ + 4, reason, length);
+        used_ += 4 + length;
+        out_[used_++] = '\n';
+        ++result_.errors;
+      }
+
+      RenderSink &sink_;
+      std::vector<char> out_;
+      std::size_t used_ = 0;
+      BatchResult result_;
+    };
+  } // namespace
+
+  BatchResult runBatch(const char *data, std::size_t length, RenderSink &output)
+  {
+    BITWISE_STATS_SCOPE(BatchRun, length);
+    BatchRunner runner(output);
+    const char *end = data + length;
+    while (data < end)
+    {
+      const char *newline = static_cast<const char *>(std::memchr(data, '\n', end - data));
+      const char *lineEnd = newline ? newline : end;
+      runner.processLine(data, lineEnd);
+      data = newline ? newline + 1 : end;
+    }
+    runner.flush();
+    return runner.result();
+  }
+
+  BatchResult runBatch(int inputFd, RenderSink &output)
+  {
+    BITWISE_STATS_SCOPE(BatchRun, 0);
+    uint64_t totalBytes = 0;
+    BatchRunner runner(output);
+    std::vector<char> input(kIoChunk);
+    std::size_t carry = 0; // bytes of an incomplete line kept from the previous read
+    int readError = 0;
+
+    while (true)
+    {
+      ssize_t received = ::read(inputFd, input.data() + carry, input.size() - carry);
+      if (received < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        readError = errno;
+        break;
+      }
+      if (received == 0)
+        break;
+      totalBytes += static_cast<uint64_t>(received);
+
+      const char *lineStart = input.data();
+      const char *end = input.data() + carry + received;
+      while (const char *newline = static_cast<const char *>(std::memchr(lineStart, '\n', end - lineStart)))
+      {
+        runner.processLine(lineStart, newline);
+        lineStart = newline + 1;
+      }
+      carry = static_cast<std::size_t>(end - lineStart);
+      std::memmove(input.data(), lineStart, carry);
+      if (carry == input.size())
+      {
+        input.resize(input.size() * 2); // a single line longer than the buffer
+      }
+    }
+    if (carry > 0)
+    {
+      runner.processLine(input.data(), input.data() + carry);
+    }
+    BITWISE_STATS_SET_BYTES(totalBytes);
+    runner.flush();
+    BatchResult result = runner.result();
+    result.readError = readError;
+    return result;
+  }
+
+} // namespace bitwise
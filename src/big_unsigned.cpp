@@ -0,0 +1,625 @@
+#include "big_unsigned.h"
+#include "bitwise_generic.h"
+#include "bitwise_stats.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace bitwise
+{
+  namespace
+  {
+    using Limbs = std::vector<uint64_t>;
+    using uint128 = uint128_t;
+
+    // Below these sizes (in limbs) the quadratic algorithms are faster than the recursive ones
+    constexpr std::size_t kKaratsubaThreshold = 32;
+    constexpr std::size_t kRadixThreshold = 32;
+
+    void trim(Limbs &a)
+    {
+      while (!a.empty() && a.back() == 0)
+        a.pop_back();
+    }
+
+    // Both trimmed
+    int compare(const Limbs &a, const Limbs &b)
+    {
+      if (a.size() != b.size())
+        return a.size() < b.size() ? -1 : 1;
+      for (std::size_t i = a.size(); i-- > 0;)
+      {
+        if (a[i] != b[i])
+          return a[i] < b[i] ? -1 : 1;
+      }
+      return 0;
+    }
+
+    // a += b << (64 * shift)
+    void addShifted(Limbs &a, const uint64_t *b, std::size_t n, std::size_t shift)
+    {
+      if (a.size() < shift + n)
+        a.resize(shift + n, 0);
+      uint64_t carry = 0;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        uint128 sum = static_cast<uint128>(a[shift + i]) + b[i] + carry;
+        a[shift + i] = static_cast<uint64_t>(sum);
+        carry = static_cast<uint64_t>(sum >> 64);
+      }
+      for (std::size_t i = shift + n; carry != 0; ++i)
+      {
+        if (i == a.size())
+          a.push_back(0);
+        carry = ++a[i] == 0;
+      }
+    }
+
+    void addShifted(Limbs &a, const Limbs &b, std::size_t shift)
+    {
+      addShifted(a, b.data(), b.size(), shift);
+    }
+
+    // a -= b; a must not be smaller than b
+    void subtract(Limbs &a, const Limbs &b)
+    {
+      uint64_t borrow = 0;
+      for (std::size_t i = 0; i < a.size() && (i < b.size() || borrow != 0); ++i)
+      {
+        uint128 difference = static_cast<uint128>(a[i]) - (i < b.size() ? b[i] : 0) - borrow;
+        a[i] = static_cast<uint64_t>(difference);
+        borrow = static_cast<uint64_t>(difference >> 64) != 0;
+      }
+      trim(a);
+    }
+
+    // a = a * factor + addend
+    void multiplyAdd(Limbs &a, uint64_t factor, uint64_t addend)
+    {
+      uint64_t carry = addend;
+      for (uint64_t &limb : a)
+      {
+        uint128 product = static_cast<uint128>(limb) * factor + carry;
+        limb = static_cast<uint64_t>(product);
+        carry = static_cast<uint64_t>(product >> 64);
+      }
+      if (carry != 0)
+        a.push_back(carry);
+      trim(a);
+    }
+
+    // a /= divisor, returning the remainder
+    uint64_t divideSmall(Limbs &a, uint64_t divisor)
+    {
+      uint128 remainder = 0;
+      for (std::size_t i = a.size(); i-- > 0;)
+      {
+        uint128 current = (remainder << 64) | a[i];
+        a[i] = static_cast<uint64_t>(current / divisor);
+        remainder = current % divisor;
+      }
+      trim(a);
+      return static_cast<uint64_t>(remainder);
+    }
+
+    // a >> (64 * count)
+    Limbs dropLimbs(const Limbs &a, std::size_t count)
+    {
+      return count >= a.size() ? Limbs() : Limbs(a.begin() + static_cast<std::ptrdiff_t>(count), a.end());
+    }
+
+    Limbs multiply(const uint64_t *a, std::size_t na, const uint64_t *b, std::size_t nb)
+    {
+      while (na > 0 && a[na - 1] == 0)
+        --na;
+      while (nb > 0 && b[nb - 1] == 0)
+        --nb;
+      if (na == 0 || nb == 0)
+        return Limbs();
+      if (na < nb)
+      {
+        std::swap(a, b);
+        std::swap(na, nb);
+      }
+
+      Limbs out;
+      if (nb < kKaratsubaThreshold)
+      {
+        out.assign(na + nb, 0);
+        for (std::size_t i = 0; i < nb; ++i)
+        {
+          uint64_t carry = 0;
+          for (std::size_t j = 0; j < na; ++j)
+          {
+            uint128 t = static_cast<uint128>(a[j]) * b[i] + out[i + j] + carry;
+            out[i + j] = static_cast<uint64_t>(t);
+            carry = static_cast<uint64_t>(t >> 64);
+          }
+          out[i + na] = carry;
+        }
+        trim(out);
+        return out;
+      }
+
+      // Very unbalanced: multiply nb-limb slices of a by b
+      if (na >= 2 * nb)
+      {
+        for (std::size_t i = 0; i < na; i += nb)
+          addShifted(out, multiply(a + i, std::min(nb, na - i), b, nb), i);
+        trim(out);
+        return out;
+      }
+
+      // Karatsuba: (a1 B + a0)(b1 B + b0) = z2 B^2 + ((a0 + a1)(b0 + b1) - z0 - z2) B + z0
+      const std::size_t m = na / 2; // nb > m here
+      Limbs z0 = multiply(a, m, b, m);
+      Limbs z2 = multiply(a + m, na - m, b + m, nb - m);
+      Limbs sumA(a, a + m), sumB(b, b + m);
+      addShifted(sumA, a + m, na - m, 0);
+      addShifted(sumB, b + m, nb - m, 0);
+      Limbs z1 = multiply(sumA.data(), sumA.size(), sumB.data(), sumB.size());
+      subtract(z1, z0);
+      subtract(z1, z2);
+      out = std::move(z0);
+      addShifted(out, z1, m);
+      addShifted(out, z2, 2 * m);
+      trim(out);
+      return out;
+    }
+
+    Limbs multiply(const Limbs &a, const Limbs &b)
+    {
+      return multiply(a.data(), a.size(), b.data(), b.size());
+    }
+
+    // beta^count, where beta = 2^64
+    Limbs limbPower(std::size_t count)
+    {
+      Limbs result(count + 1, 0);
+      result[count] = 1;
+      return result;
+    }
+
+    // floor(beta^(2n) / d) for an n-limb d, one bit at a time
+    Limbs reciprocalBasecase(const Limbs &d)
+    {
+      const std::size_t n = d.size();
+      Limbs quotient(2 * n + 1, 0), remainder;
+      for (std::size_t bit = 128 * n + 1; bit-- > 0;)
+      {
+        // remainder = remainder * 2 + (bit of beta^(2n))
+        uint64_t carry = bit == 128 * n;
+        for (uint64_t &limb : remainder)
+        {
+          uint64_t top = limb >> 63;
+          limb = (limb << 1) | carry;
+          carry = top;
+        }
+        if (carry != 0)
+          remainder.push_back(carry);
+        if (compare(remainder, d) >= 0)
+        {
+          subtract(remainder, d);
+          quotient[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+      }
+      trim(quotient);
+      return quotient;
+    }
+
+    // floor(beta^(2n) / d) for an n-limb d. The reciprocal of d's top n/2 + 2 limbs, shifted into
+    // place, is good to about n/2 limbs; one Newton step x += x (beta^(2n) - d x) / beta^(2n)
+    // doubles that, and a final exact check fixes the last unit or two.
+    Limbs reciprocal(const Limbs &d)
+    {
+      const std::size_t n = d.size();
+      if (n <= kRadixThreshold)
+        return reciprocalBasecase(d);
+
+      const std::size_t h = n / 2 + 2;
+      Limbs x = reciprocal(dropLimbs(d, n - h));
+      x.insert(x.begin(), n - h, 0);
+
+      const Limbs unit = limbPower(2 * n);
+      Limbs dx = multiply(d, x);
+      if (compare(dx, unit) <= 0)
+      {
+        Limbs error = unit;
+        subtract(error, dx);
+        addShifted(x, dropLimbs(multiply(x, error), 2 * n), 0);
+      }
+      else
+      {
+        Limbs error = std::move(dx);
+        subtract(error, unit);
+        Limbs step = dropLimbs(multiply(x, error), 2 * n);
+        addShifted(step, Limbs{1}, 0);
+        if (compare(step, x) >= 0)
+          x.clear();
+        else
+          subtract(x, step);
+      }
+
+      const Limbs one{1};
+      dx = multiply(d, x);
+      while (compare(dx, unit) > 0)
+      {
+        subtract(x, one);
+        subtract(dx, d);
+      }
+      Limbs remainder = unit;
+      subtract(remainder, dx);
+      while (compare(remainder, d) >= 0)
+      {
+        addShifted(x, one, 0);
+        subtract(remainder, d);
+      }
+      return x;
+    }
+
+    // A base's limb-sized digit group: base^digits is the largest power of base that fits in a limb
+    struct Radix
+    {
+      unsigned base;
+      unsigned digits;
+      uint64_t limbBase;
+    };
+
+    Radix radixFor(unsigned base)
+    {
+      Radix radix{base, 1, base};
+      while (radix.limbBase <= UINT64_MAX / base)
+      {
+        radix.limbBase *= base;
+        ++radix.digits;
+      }
+      return radix;
+    }
+
+    // power = limbBase^(2^k) for level k, and reciprocal = floor(beta^(2n) / power) for its n limbs
+    // (filled in only once a conversion divides by the level)
+    struct PowerLevel
+    {
+      Limbs power;
+      Limbs reciprocal;
+    };
+
+    using PowerLevels = std::vector<std::shared_ptr<const PowerLevel>>;
+
+    std::mutex &powerMutex()
+    {
+      static std::mutex mutex;
+      return mutex;
+    }
+
+    // Caller holds powerMutex()
+    PowerLevels &cachedLevels(unsigned base)
+    {
+      static std::map<unsigned, PowerLevels> cache;
+      return cache[base];
+    }
+
+    // Levels are shared read-only, so a conversion keeps its snapshot while other threads extend the table
+    PowerLevels powerLevels(const Radix &radix, std::size_t minLevels, std::size_t minLimbs)
+    {
+      std::lock_guard<std::mutex> lock(powerMutex());
+      PowerLevels &levels = cachedLevels(radix.base);
+      while (levels.size() < minLevels || (levels.empty() ? 0 : levels.back()->power.size()) <= minLimbs)
+      {
+        auto level = std::make_shared<PowerLevel>();
+        level->power = levels.empty() ? Limbs{radix.limbBase} : multiply(levels.back()->power, levels.back()->power);
+        levels.push_back(std::move(level));
+      }
+      return levels;
+    }
+
+    // Makes sure the first count levels of the snapshot (and of the cache) carry their reciprocals
+    void addReciprocals(const Radix &radix, PowerLevels &snapshot, std::size_t count)
+    {
+      std::lock_guard<std::mutex> lock(powerMutex());
+      PowerLevels &levels = cachedLevels(radix.base);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        if (levels[i]->reciprocal.empty())
+        {
+          auto level = std::make_shared<PowerLevel>();
+          level->power = levels[i]->power;
+          level->reciprocal = reciprocal(level->power);
+          levels[i] = std::move(level);
+        }
+        snapshot[i] = levels[i];
+      }
+    }
+
+    // x < level.power^2, so x fits in 2n limbs and one Barrett step leaves a remainder at most a
+    // couple of divisors too large
+    void divideByLevel(const Limbs &x, const PowerLevel &level, Limbs &quotient, Limbs &remainder)
+    {
+      quotient = dropLimbs(multiply(x, level.reciprocal), 2 * level.power.size());
+      remainder = x;
+      subtract(remainder, multiply(quotient, level.power));
+      while (compare(remainder, level.power) >= 0)
+      {
+        subtract(remainder, level.power);
+        addShifted(quotient, Limbs{1}, 0);
+      }
+    }
+
+    char digitChar(unsigned value, bool uppercase)
+    {
+      return (uppercase ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ" : "0123456789abcdefghijklmnopqrstuvwxyz")[value];
+    }
+
+    // Appends the digits of one limb-sized group, least significant first. A constant base lets
+    // the compiler replace the divisions with multiplications.
+    template <unsigned Base>
+    void appendGroup(uint64_t group, unsigned digits, bool uppercase, std::string &reversed)
+    {
+      for (unsigned i = 0; i < digits; ++i)
+      {
+        reversed.push_back(digitChar(static_cast<unsigned>(group % Base), uppercase));
+        group /= Base;
+      }
+    }
+
+    void appendGroup(uint64_t group, const Radix &radix, bool uppercase, std::string &reversed)
+    {
+      if (radix.base == 10)
+        return appendGroup<10>(group, radix.digits, uppercase, reversed);
+      for (unsigned i = 0; i < radix.digits; ++i)
+      {
+        reversed.push_back(digitChar(static_cast<unsigned>(group % radix.base), uppercase));
+        group /= radix.base;
+      }
+    }
+
+    // Appends x in radix, zero-padded to width digits (no padding for width 0)
+    void writeBasecase(Limbs x, const Radix &radix, std::size_t width, bool uppercase, std::string &out)
+    {
+      std::string reversed;
+      while (!x.empty())
+        appendGroup(divideSmall(x, radix.limbBase), radix, uppercase, reversed);
+      while (!reversed.empty() && reversed.back() == '0')
+        reversed.pop_back();
+      if (reversed.size() < width)
+        reversed.append(width - reversed.size(), '0');
+      out.append(reversed.rbegin(), reversed.rend());
+    }
+
+    // Appends x < levels[level]->power, splitting it around the next lower level
+    void writeDigits(const Limbs &x, const PowerLevels &levels, std::size_t level, const Radix &radix,
+                     std::size_t width, bool uppercase, std::string &out)
+    {
+      if (level == 0 || x.size() <= kRadixThreshold)
+        return writeBasecase(x, radix, width, uppercase, out);
+
+      const PowerLevel &split = *levels[level - 1];
+      if (compare(x, split.power) < 0)
+        return writeDigits(x, levels, level - 1, radix, width, uppercase, out);
+
+      Limbs quotient, remainder;
+      divideByLevel(x, split, quotient, remainder);
+      const std::size_t lowDigits = std::size_t(radix.digits) << (level - 1);
+      writeDigits(quotient, levels, level - 1, radix, width > lowDigits ? width - lowDigits : 0, uppercase, out);
+      writeDigits(remainder, levels, level - 1, radix, lowDigits, uppercase, out);
+    }
+
+    // Digit values, most significant first; the low part of each split is a whole number of levels
+    Limbs readDigits(const uint8_t *values, std::size_t count, const PowerLevels &levels, const Radix &radix)
+    {
+      if (count <= std::size_t(radix.digits) * kRadixThreshold)
+      {
+        Limbs x;
+        std::size_t i = 0;
+        std::size_t group = count % radix.digits == 0 ? radix.digits : count % radix.digits;
+        while (i < count)
+        {
+          uint64_t value = 0, scale = 1;
+          for (std::size_t end = i + group; i < end; ++i)
+          {
+            value = value * radix.base + values[i];
+            scale *= radix.base;
+          }
+          multiplyAdd(x, scale, value);
+          group = radix.digits;
+        }
+        return x;
+      }
+
+      std::size_t level = 0;
+      while ((std::size_t(radix.digits) << (level + 1)) < count)
+        ++level;
+      const std::size_t lowDigits = std::size_t(radix.digits) << level;
+      Limbs x = multiply(readDigits(values, count - lowDigits, levels, radix), levels[level]->power);
+      addShifted(x, readDigits(values + count - lowDigits, lowDigits, levels, radix), 0);
+      trim(x);
+      return x;
+    }
+
+    int digitValue(char c)
+    {
+      if (c >= '0' && c <= '9')
+        return c - '0';
+      if (c >= 'a' && c <= 'z')
+        return c - 'a' + 10;
+      if (c >= 'A' && c <= 'Z')
+        return c - 'A' + 10;
+      return 64;
+    }
+
+    bool isPowerOfTwo(unsigned base)
+    {
+      return (base & (base - 1)) == 0;
+    }
+  } // namespace
+
+  BigUnsigned::BigUnsigned(uint64_t value)
+  {
+    if (value != 0)
+      limbs_.push_back(value);
+  }
+
+  BigUnsigned BigUnsigned::power(uint64_t base, uint64_t exponent)
+  {
+    BigUnsigned result(1);
+    if (exponent == 0 || base == 1)
+      return result;
+    if (base == 0)
+      return BigUnsigned();
+    if ((base & (base - 1)) == 0)
+    {
+      const uint64_t bit = static_cast<uint64_t>(__builtin_ctzll(base)) * exponent;
+      result.limbs_.assign(bit / 64 + 1, 0);
+      result.limbs_.back() = uint64_t(1) << (bit % 64);
+      return result;
+    }
+    // Square-and-multiply from the top exponent bit down
+    for (int bit = 63 - __builtin_clzll(exponent); bit >= 0; --bit)
+    {
+      result.limbs_ = multiply(result.limbs_, result.limbs_);
+      if ((exponent >> bit) & 1)
+        multiplyAdd(result.limbs_, base, 0);
+    }
+    return result;
+  }
+
+  bool BigUnsigned::parse(std::string_view digits, unsigned base, BigUnsigned &value, std::string &error)
+  {
+    if (base < 2 || base > 36)
+    {
+      error = "base must be 2-36";
+      return false;
+    }
+    if (digits.empty())
+    {
+      error = "empty number";
+      return false;
+    }
+    std::vector<uint8_t> values(digits.size());
+    for (std::size_t i = 0; i < digits.size(); ++i)
+    {
+      int digit = digitValue(digits[i]);
+      if (digit >= static_cast<int>(base))
+      {
+        error = std::string("invalid digit '") + digits[i] + "' for base " + std::to_string(base);
+        return false;
+      }
+      values[i] = static_cast<uint8_t>(digit);
+    }
+
+    Limbs limbs;
+    if (isPowerOfTwo(base))
+    {
+      // Digit i from the end holds bits [i * shift, (i + 1) * shift)
+      const unsigned shift = static_cast<unsigned>(__builtin_ctz(base));
+      limbs.assign((values.size() * shift + 63) / 64, 0);
+      for (std::size_t i = 0; i < values.size(); ++i)
+      {
+        const uint64_t digit = values[values.size() - 1 - i];
+        const std::size_t bit = i * shift;
+        limbs[bit / 64] |= digit << (bit % 64);
+        if (bit % 64 + shift > 64)
+          limbs[bit / 64 + 1] |= digit >> (64 - bit % 64);
+      }
+      trim(limbs);
+    }
+    else
+    {
+      const Radix radix = radixFor(base);
+      std::size_t levels = 0;
+      while ((std::size_t(radix.digits) << levels) < values.size())
+        ++levels;
+      limbs = readDigits(values.data(), values.size(), powerLevels(radix, levels, 0), radix);
+    }
+    value.limbs_ = std::move(limbs);
+    return true;
+  }
+
+  std::string BigUnsigned::toString(unsigned base, bool uppercase) const
+  {
+    if (base < 2 || base > 36)
+      return std::string();
+    if (limbs_.empty())
+      return "0";
+
+    std::string out;
+    if (isPowerOfTwo(base))
+    {
+      const unsigned shift = static_cast<unsigned>(__builtin_ctz(base));
+      const std::size_t count = (bitLength() + shift - 1) / shift;
+      out.reserve(count);
+      for (std::size_t i = count; i-- > 0;)
+      {
+        const std::size_t bit = i * shift;
+        uint64_t digit = limbs_[bit / 64] >> (bit % 64);
+        if (bit % 64 + shift > 64 && bit / 64 + 1 < limbs_.size())
+          digit |= limbs_[bit / 64 + 1] << (64 - bit % 64);
+        out.push_back(digitChar(static_cast<unsigned>(digit & (base - 1)), uppercase));
+      }
+      return out;
+    }
+
+    const Radix radix = radixFor(base);
+    // The top level is the first power above the number; splitting starts one below it
+    PowerLevels levels = powerLevels(radix, 1, limbs_.size());
+    while (levels.size() > 1 && compare(limbs_, levels[levels.size() - 2]->power) < 0)
+      levels.pop_back();
+    addReciprocals(radix, levels, levels.size() - 1);
+    writeDigits(limbs_, levels, levels.size() - 1, radix, 0, uppercase, out);
+    return out;
+  }
+
+  std::size_t BigUnsigned::bitLength() const
+  {
+    if (limbs_.empty())
+      return 0;
+    return 64 * limbs_.size() - static_cast<std::size_t>(__builtin_clzll(limbs_.back()));
+  }
+
+  BigUnsigned &BigUnsigned::operator+=(const BigUnsigned &other)
+  {
+    addShifted(limbs_, other.limbs_, 0);
+    return *this;
+  }
+
+  BigUnsigned &BigUnsigned::operator*=(uint64_t factor)
+  {
+    multiplyAdd(limbs_, factor, 0);
+    return *this;
+  }
+
+  BigUnsigned operator*(const BigUnsigned &a, const BigUnsigned &b)
+  {
+    BigUnsigned result;
+    result.limbs_ = multiply(a.limbs_, b.limbs_);
+    return result;
+  }
+
+  bool operator<(const BigUnsigned &a, const BigUnsigned &b)
+  {
+    return compare(a.limbs_, b.limbs_) < 0;
+  }
+
+  bool convertRadix(std::string_view digits, unsigned fromBase, unsigned toBase, std::string &output,
+                    std::string &error)
+  {
+    BITWISE_STATS_SCOPE(RadixConvert, digits.size());
+    const bool negative = !digits.empty() && digits.front() == '-';
+    if (negative)
+      digits.remove_prefix(1);
+    if (toBase < 2 || toBase > 36)
+    {
+      error = "base must be 2-36";
+      return false;
+    }
+    BigUnsigned value;
+    if (!BigUnsigned::parse(digits, fromBase, value, error))
+      return false;
+    output = value.toString(toBase);
+    if (negative && !value.isZero())
+      output.insert(output.begin(), '-');
+    return true;
+  }
+
+} // namespace bitwise
@@ -0,0 +1,305 @@
+#include "bit_transpose.h"
+#include "bitwise_stats.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITWISE_X86 1
+#endif
+
+namespace bitwise
+{
+  namespace
+  {
+    using Kernel32 = void (*)(uint32_t *, const uint32_t *);
+    using Kernel64 = void (*)(uint64_t *, const uint64_t *);
+
+    // Recursive swap-with-mask: round j swaps the j x j blocks off the diagonal of every 2j x 2j
+    // block, exchanging bit c + j of row k with bit c of row k + j (k and c with bit j clear)
+    template <typename Word>
+    void transposeRecursive(Word *rows)
+    {
+      constexpr unsigned kBits = sizeof(Word) * 8;
+      Word mask = static_cast<Word>(~Word(0)) >> (kBits / 2);
+      for (unsigned j = kBits / 2; j != 0; j >>= 1, mask ^= static_cast<Word>(mask << j))
+      {
+        // Written as runs of j consecutive rows so the compiler can vectorize the wide rounds
+        for (unsigned base = 0; base < kBits; base += 2 * j)
+        {
+          for (unsigned k = base; k < base + j; ++k)
+          {
+            Word t = ((rows[k] >> j) ^ rows[k + j]) & mask;
+            rows[k] ^= static_cast<Word>(t << j);
+            rows[k + j] ^= t;
+          }
+        }
+      }
+    }
+
+    void transpose32Scalar(uint32_t *dst, const uint32_t *src)
+    {
+      if (dst != src)
+        std::memcpy(dst, src, 32 * sizeof(uint32_t));
+      transposeRecursive(dst);
+    }
+
+    void transpose64Scalar(uint64_t *dst, const uint64_t *src)
+    {
+      if (dst != src)
+        std::memcpy(dst, src, 64 * sizeof(uint64_t));
+      transposeRecursive(dst);
+    }
+
+#ifdef BITWISE_X86
+    // Byte regrouping shared by the SIMD kernels. Register i starts with the rows i * 16 / Regs
+    // onwards of a 16-row group (per 128-bit lane), so a byte's position holds (row bits below the
+    // register index, byte index) and the register index holds the high row bits. Each round of
+    // unpacks pushes one register-index bit into the bottom of the byte position and pops the top
+    // position bit into the register index; after four rounds every position is a row number 0-15
+    // and each register holds one byte column of all 16 rows.
+    constexpr std::size_t kByteOfRegister4[] = {0, 1, 2, 3};
+    constexpr std::size_t kByteOfRegister8[] = {0, 2, 4, 6, 1, 3, 5, 7};
+
+    template <std::size_t Regs>
+    __attribute__((target("sse2"))) void groupBytesSse2(__m128i *x)
+    {
+      constexpr unsigned kIndexBits = Regs == 4 ? 2 : 3;
+      for (unsigned round = 0; round < 4; ++round)
+      {
+        const std::size_t stride = std::size_t(1) << (kIndexBits - 1 - round % kIndexBits);
+        __m128i next[Regs];
+        for (std::size_t i = 0; i < Regs; ++i)
+        {
+          if ((i & stride) == 0)
+          {
+            next[i] = _mm_unpacklo_epi8(x[i], x[i | stride]);
+            next[i | stride] = _mm_unpackhi_epi8(x[i], x[i | stride]);
+          }
+        }
+        for (std::size_t i = 0; i < Regs; ++i)
+          x[i] = next[i];
+      }
+    }
+
+    template <std::size_t Regs>
+    __attribute__((target("avx2"))) void groupBytesAvx2(__m256i *x)
+    {
+      constexpr unsigned kIndexBits = Regs == 4 ? 2 : 3;
+      for (unsigned round = 0; round < 4; ++round)
+      {
+        const std::size_t stride = std::size_t(1) << (kIndexBits - 1 - round % kIndexBits);
+        __m256i next[Regs];
+        for (std::size_t i = 0; i < Regs; ++i)
+        {
+          if ((i & stride) == 0)
+          {
+            next[i] = _mm256_unpacklo_epi8(x[i], x[i | stride]);
+            next[i | stride] = _mm256_unpackhi_epi8(x[i], x[i | stride]);
+          }
+        }
+        for (std::size_t i = 0; i < Regs; ++i)
+          x[i] = next[i];
+      }
+    }
+
+    // Two 16-byte loads as the low and high lane, so each lane runs the network on its own 16 rows
+    __attribute__((target("avx2"))) inline __m256i loadLanes(const void *low, const void *high)
+    {
+      __m256i lanes = _mm256_castsi128_si256(_mm_loadu_si128(static_cast<const __m128i *>(low)));
+      return _mm256_inserti128_si256(lanes, _mm_loadu_si128(static_cast<const __m128i *>(high)), 1);
+    }
+
+    // movemask reads bit 7 of every byte, i.e. column 8k + 7 of each row; doubling the bytes moves
+    // the next column into bit 7
+    __attribute__((target("sse2"))) void transpose32Sse2(uint32_t *dst, const uint32_t *src)
+    {
+      uint16_t parts[2][32];
+      for (unsigned half = 0; half < 2; ++half)
+      {
+        __m128i x[4];
+        for (std::size_t i = 0; i < 4; ++i)
+          x[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16 * half + 4 * i));
+        groupBytesSse2<4>(x);
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+          __m128i v = x[i];
+          for (int bit = 7; bit >= 0; --bit)
+          {
+            parts[half][8 * kByteOfRegister4[i] + bit] = static_cast<uint16_t>(_mm_movemask_epi8(v));
+            v = _mm_add_epi8(v, v);
+          }
+        }
+      }
+      for (std::size_t c = 0; c < 32; ++c)
+        dst[c] = parts[0][c] | (uint32_t(parts[1][c]) << 16);
+    }
+
+    __attribute__((target("sse2"))) void transpose64Sse2(uint64_t *dst, const uint64_t *src)
+    {
+      uint16_t parts[4][64];
+      for (unsigned quarter = 0; quarter < 4; ++quarter)
+      {
+        __m128i x[8];
+        for (std::size_t i = 0; i < 8; ++i)
+          x[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16 * quarter + 2 * i));
+        groupBytesSse2<8>(x);
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+          __m128i v = x[i];
+          for (int bit = 7; bit >= 0; --bit)
+          {
+            parts[quarter][8 * kByteOfRegister8[i] + bit] = static_cast<uint16_t>(_mm_movemask_epi8(v));
+            v = _mm_add_epi8(v, v);
+          }
+        }
+      }
+      for (std::size_t c = 0; c < 64; ++c)
+      {
+        dst[c] = parts[0][c] | (uint64_t(parts[1][c]) << 16) | (uint64_t(parts[2][c]) << 32) |
+                 (uint64_t(parts[3][c]) << 48);
+      }
+    }
+
+    __attribute__((target("avx2"))) void transpose32Avx2(uint32_t *dst, const uint32_t *src)
+    {
+      uint32_t out[32];
+      __m256i x[4];
+      for (std::size_t i = 0; i < 4; ++i)
+        x[i] = loadLanes(src + 4 * i, src + 16 + 4 * i);
+      groupBytesAvx2<4>(x);
+      for (std::size_t i = 0; i < 4; ++i)
+      {
+        __m256i v = x[i];
+        for (int bit = 7; bit >= 0; --bit)
+        {
+          out[8 * kByteOfRegister4[i] + bit] = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+          v = _mm256_add_epi8(v, v);
+        }
+      }
+      std::memcpy(dst, out, sizeof(out));
+    }
+
+    __attribute__((target("avx2"))) void transpose64Avx2(uint64_t *dst, const uint64_t *src)
+    {
+      uint32_t halves[2][64];
+      for (unsigned half = 0; half < 2; ++half)
+      {
+        const uint64_t *rows = src + 32 * half;
+        __m256i x[8];
+        for (std::size_t i = 0; i < 8; ++i)
+          x[i] = loadLanes(rows + 2 * i, rows + 16 + 2 * i);
+        groupBytesAvx2<8>(x);
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+          __m256i v = x[i];
+          for (int bit = 7; bit >= 0; --bit)
+          {
+            halves[half][8 * kByteOfRegister8[i] + bit] = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+            v = _mm256_add_epi8(v, v);
+          }
+        }
+      }
+      for (std::size_t c = 0; c < 64; ++c)
+        dst[c] = halves[0][c] | (uint64_t(halves[1][c]) << 32);
+    }
+#endif
+
+    Kernel32 kernel32()
+    {
+#ifdef BITWISE_X86
+      switch (activeSimdLevel())
+      {
+      case SimdLevel::AVX512:
+      case SimdLevel::AVX2:
+        return transpose32Avx2;
+      case SimdLevel::SSE2:
+        return transpose32Sse2;
+      case SimdLevel::Scalar:
+        break;
+      }
+#endif
+      return transpose32Scalar;
+    }
+
+    Kernel64 kernel64()
+    {
+#ifdef BITWISE_X86
+      switch (activeSimdLevel())
+      {
+      case SimdLevel::AVX512:
+      case SimdLevel::AVX2:
+        return transpose64Avx2;
+      case SimdLevel::SSE2:
+        return transpose64Sse2;
+      case SimdLevel::Scalar:
+        break;
+      }
+#endif
+      return transpose64Scalar;
+    }
+  } // namespace
+
+  uint64_t transpose8x8(uint64_t matrix)
+  {
+    // Swap the low bits of the row and column indices, then the middle bits, then the high bits
+    uint64_t t = (matrix ^ (matrix >> 7)) & 0x00AA00AA00AA00AAULL;
+    matrix ^= t ^ (t << 7);
+    t = (matrix ^ (matrix >> 14)) & 0x0000CCCC0000CCCCULL;
+    matrix ^= t ^ (t << 14);
+    t = (matrix ^ (matrix >> 28)) & 0x00000000F0F0F0F0ULL;
+    matrix ^= t ^ (t << 28);
+    return matrix;
+  }
+
+  void transpose32x32(uint32_t *dst, const uint32_t *src)
+  {
+    kernel32()(dst, src);
+  }
+
+  void transpose64x64(uint64_t *dst, const uint64_t *src)
+  {
+    kernel64()(dst, src);
+  }
+
+  void transposeBitMatrix(uint32_t *dst, const uint32_t *src, std::size_t rows, std::size_t rowWords)
+  {
+    BITWISE_STATS_SCOPE(BulkTranspose, 2 * rows * rowWords * sizeof(uint32_t));
+    const Kernel32 kernel = kernel32();
+    const std::size_t outWords = (rows + 31) / 32;
+    // Output rows are outWords apart, so results are staged for kTileBlocks row blocks at a time and
+    // written out as runs of consecutive words instead of one scattered word per block
+    constexpr std::size_t kTileBlocks = 16;
+    uint32_t block[32];
+    uint32_t tile[32][kTileBlocks];
+    for (std::size_t firstBlock = 0; firstBlock < outWords; firstBlock += kTileBlocks)
+    {
+      const std::size_t blocks = std::min(kTileBlocks, outWords - firstBlock);
+      for (std::size_t column = 0; column < rowWords; ++column)
+      {
+        for (std::size_t b = 0; b < blocks; ++b)
+        {
+          const std::size_t first = (firstBlock + b) * 32;
+          const std::size_t count = std::min<std::size_t>(32, rows - first);
+          // Full blocks of single-word rows are already contiguous; anything else is gathered first
+          if (rowWords == 1 && count == 32)
+          {
+            kernel(block, src + first);
+          }
+          else
+          {
+            for (std::size_t i = 0; i < count; ++i)
+              block[i] = src[(first + i) * rowWords + column];
+            std::fill(block + count, block + 32, 0U);
+            kernel(block, block);
+          }
+          for (std::size_t bit = 0; bit < 32; ++bit)
+            tile[bit][b] = block[bit];
+        }
+        for (std::size_t bit = 0; bit < 32; ++bit)
+          std::memcpy(dst + (column * 32 + bit) * outWords + firstBlock, tile[bit], blocks * sizeof(uint32_t));
+      }
+    }
+  }
+
+} // namespace bitwise
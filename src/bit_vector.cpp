@@ -0,0 +1,306 @@
+#include "bit_vector.h"
+#include "bitwise_bulk.h"
+#include "bitwise_cpu.h"
+#include "bitwise_utils.h"
+#include <algorithm>
+
+namespace bitwise
+{
+  namespace
+  {
+    constexpr std::size_t kBlockBits = 2048;
+    constexpr std::size_t kBlockWords = kBlockBits / BitVector::kWordBits;    // 64
+    constexpr std::size_t kSubBlockWords = 512 / BitVector::kWordBits;        // 16, one cache line
+    constexpr std::size_t kSubBlocksPerBlock = kBlockWords / kSubBlockWords;  // 4
+    constexpr std::size_t kRegionBlocks = (std::size_t(1) << 32) / kBlockBits; // blocks per 2^32 bits
+    constexpr std::size_t kSelectSampleRate = 8192;
+    // Sample spans covering more blocks than this store their ones' positions outright (one 64-bit
+    // position per 512 or more bits, so at most 1/8 extra); shorter spans are binary searched in at
+    // most log2(2048) = 11 steps. Either way select() does a bounded amount of work.
+    constexpr std::size_t kSparseSpanBlocks = 2048;
+    constexpr uint64_t kDenseSpan = ~uint64_t(0);
+    constexpr uint64_t kRelativeRankMask = 0xFFFFFFFFULL;
+
+    inline std::size_t subBlockCount(uint64_t entry, std::size_t subBlock)
+    {
+      return (entry >> (32 + 10 * subBlock)) & 0x3FF;
+    }
+
+    const bool kHasBmi2 = cpuFeatures().bmi2;
+
+    // Position of the r-th (0-based) set bit of a word that has more than r set bits
+    std::size_t selectInWord(uint32_t word, std::size_t r)
+    {
+      // PDEP drops bit r onto the r-th set bit of word in one instruction
+      if (kHasBmi2)
+        return static_cast<std::size_t>(countTrailingZeros(depositBits(1U << r, word)));
+
+      std::size_t position = 0;
+      for (int width = 16; width >= 4; width /= 2)
+      {
+        std::size_t low = countSetBits(word & ((1U << width) - 1));
+        if (r >= low)
+        {
+          r -= low;
+          word >>= width;
+          position += width;
+        }
+      }
+      while (true)
+      {
+        if (word & 1U)
+        {
+          if (r == 0)
+            return position;
+          --r;
+        }
+        word >>= 1;
+        ++position;
+      }
+    }
+  } // namespace
+
+  BitVector::BitVector(std::size_t size, bool value)
+  {
+    resize(size, value);
+  }
+
+  void BitVector::resize(std::size_t size, bool value)
+  {
+    std::size_t oldSize = size_;
+    words_.resize((size + kWordBits - 1) / kWordBits, value ? ~Word(0) : Word(0));
+    if (value && size > oldSize && oldSize % kWordBits != 0)
+    {
+      words_[oldSize / kWordBits] |= ~Word(0) << (oldSize % kWordBits);
+    }
+    size_ = size;
+    clearUnusedBits();
+    indexValid_ = false;
+  }
+
+  void BitVector::pushBack(bool value)
+  {
+    if (size_ % kWordBits == 0)
+    {
+      words_.push_back(0);
+    }
+    if (value)
+    {
+      words_[size_ / kWordBits] |= Word(1) << (size_ % kWordBits);
+    }
+    ++size_;
+    indexValid_ = false;
+  }
+
+  void BitVector::clear()
+  {
+    words_.clear();
+    size_ = 0;
+    indexValid_ = false;
+  }
+
+  std::size_t BitVector::countSetBits() const
+  {
+    return bitwise::countSetBits(words_.data(), words_.size());
+  }
+
+  void BitVector::clearUnusedBits()
+  {
+    if (size_ % kWordBits != 0)
+    {
+      words_.back() &= (Word(1) << (size_ % kWordBits)) - 1;
+    }
+  }
+
+  void BitVector::buildRankSelectIndex()
+  {
+    std::size_t blocks = (words_.size() + kBlockWords - 1) / kBlockWords;
+    blockEntries_.assign(blocks, 0);
+    regionRanks_.assign(blocks / kRegionBlocks + 1, 0);
+    selectSamples_.clear();
+
+    uint64_t total = 0;
+    for (std::size_t block = 0; block < blocks; ++block)
+    {
+      if (block % kRegionBlocks == 0)
+      {
+        regionRanks_[block / kRegionBlocks] = total;
+      }
+      uint64_t entry = total - regionRanks_[block / kRegionBlocks];
+      uint64_t blockOnes = 0;
+      for (std::size_t sub = 0; sub < kSubBlocksPerBlock; ++sub)
+      {
+        std::size_t first = block * kBlockWords + sub * kSubBlockWords;
+        if (first >= words_.size())
+          break;
+        std::size_t count = std::min(kSubBlockWords, words_.size() - first);
+        uint64_t ones = bitwise::countSetBits(words_.data() + first, count);
+        if (sub + 1 < kSubBlocksPerBlock)
+        {
+          entry |= ones << (32 + 10 * sub);
+        }
+        blockOnes += ones;
+      }
+      blockEntries_[block] = entry;
+
+      // Record this block for every sampled one (0, 8192, 16384, ...) that falls inside it
+      while (selectSamples_.size() * kSelectSampleRate < total + blockOnes)
+      {
+        selectSamples_.push_back(block);
+      }
+      total += blockOnes;
+    }
+    totalOnes_ = total;
+
+    // Spell out the positions inside spans too long to search
+    sparseOffsets_.assign(selectSamples_.size(), kDenseSpan);
+    sparsePositions_.clear();
+    for (std::size_t sample = 0; sample < selectSamples_.size(); ++sample)
+    {
+      std::size_t first = selectSamples_[sample];
+      std::size_t end = sample + 1 < selectSamples_.size() ? selectSamples_[sample + 1] : blocks - 1;
+      if (end - first < kSparseSpanBlocks)
+        continue;
+      sparseOffsets_[sample] = sparsePositions_.size();
+      std::size_t skip = sample * kSelectSampleRate - (regionRanks_[first / kRegionBlocks] + (blockEntries_[first] & kRelativeRankMask));
+      std::size_t wanted = std::min<std::size_t>(kSelectSampleRate, total - sample * kSelectSampleRate);
+      for (std::size_t w = first * kBlockWords; wanted > 0; ++w)
+      {
+        for (Word word = words_[w]; word != 0 && wanted > 0; word &= word - 1)
+        {
+          if (skip > 0)
+          {
+            --skip;
+            continue;
+          }
+          sparsePositions_.push_back(w * kWordBits + static_cast<std::size_t>(countTrailingZeros(word)));
+          --wanted;
+        }
+      }
+    }
+    indexValid_ = true;
+  }
+
+  std::size_t BitVector::rank(std::size_t position) const
+  {
+    if (position > size_)
+    {
+      position = size_;
+    }
+    if (!indexValid_)
+    {
+      return rankLinear(position);
+    }
+    std::size_t block = position / kBlockBits;
+    if (block >= blockEntries_.size())
+    {
+      return totalOnes_;
+    }
+
+    uint64_t entry = blockEntries_[block];
+    std::size_t result = regionRanks_[block / kRegionBlocks] + (entry & kRelativeRankMask);
+    std::size_t sub = (position % kBlockBits) / 512;
+    for (std::size_t s = 0; s < sub; ++s)
+    {
+      result += subBlockCount(entry, s);
+    }
+
+    // At most one cache line of words is left to count
+    std::size_t lastWord = position / kWordBits;
+    for (std::size_t w = block * kBlockWords + sub * kSubBlockWords; w < lastWord; ++w)
+    {
+      result += bitwise::countSetBits(words_[w]);
+    }
+    if (position % kWordBits != 0)
+    {
+      result += bitwise::countSetBits(words_[lastWord] & ((Word(1) << (position % kWordBits)) - 1));
+    }
+    return result;
+  }
+
+  std::size_t BitVector::select(std::size_t k) const
+  {
+    if (!indexValid_)
+    {
+      return selectLinear(k);
+    }
+    if (k >= totalOnes_)
+    {
+      return size_;
+    }
+
+    // Sparse spans answer directly; otherwise the samples bracket the answer within
+    // kSparseSpanBlocks blocks, and the block entries in between are binary searched
+    std::size_t sample = k / kSelectSampleRate;
+    if (sparseOffsets_[sample] != kDenseSpan)
+    {
+      return static_cast<std::size_t>(sparsePositions_[sparseOffsets_[sample] + k % kSelectSampleRate]);
+    }
+    std::size_t lo = selectSamples_[sample];
+    std::size_t hi = sample + 1 < selectSamples_.size() ? selectSamples_[sample + 1] : blockEntries_.size() - 1;
+    auto blockRank = [this](std::size_t block)
+    {
+      return regionRanks_[block / kRegionBlocks] + (blockEntries_[block] & kRelativeRankMask);
+    };
+    while (lo < hi)
+    {
+      std::size_t mid = lo + (hi - lo + 1) / 2;
+      if (blockRank(mid) <= k)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+
+    std::size_t remaining = k - blockRank(lo);
+    uint64_t entry = blockEntries_[lo];
+    std::size_t sub = 0;
+    for (; sub + 1 < kSubBlocksPerBlock; ++sub)
+    {
+      std::size_t ones = subBlockCount(entry, sub);
+      if (remaining < ones)
+        break;
+      remaining -= ones;
+    }
+
+    for (std::size_t w = lo * kBlockWords + sub * kSubBlockWords; w < words_.size(); ++w)
+    {
+      std::size_t ones = bitwise::countSetBits(words_[w]);
+      if (remaining < ones)
+      {
+        return w * kWordBits + selectInWord(words_[w], remaining);
+      }
+      remaining -= ones;
+    }
+    return size_;
+  }
+
+  std::size_t BitVector::rankLinear(std::size_t position) const
+  {
+    if (position > size_)
+    {
+      position = size_;
+    }
+    std::size_t fullWords = position / kWordBits;
+    std::size_t result = bitwise::countSetBits(words_.data(), fullWords);
+    if (position % kWordBits != 0)
+    {
+      result += bitwise::countSetBits(words_[fullWords] & ((Word(1) << (position % kWordBits)) - 1));
+    }
+    return result;
+  }
+
+  std::size_t BitVector::selectLinear(std::size_t k) const
+  {
+    for (std::size_t w = 0; w < words_.size(); ++w)
+    {
+      std::size_t ones = bitwise::countSetBits(words_[w]);
+      if (k < ones)
+      {
+        return w * kWordBits + selectInWord(words_[w], k);
+      }
+      k -= ones;
+    }
+    return size_;
+  }
+
+} // namespace bitwise
@@ -0,0 +1,964 @@
+#include "bitwise_bulk.h"
+#include "bitwise_stats.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITWISE_X86 1
+#endif
+
+namespace bitwise
+{
+  namespace
+  {
+    enum class BinaryOp
+    {
+      And,
+      Or,
+      Xor
+    };
+
+    template <BinaryOp Op>
+    inline uint32_t applyScalar(uint32_t a, uint32_t b)
+    {
+      if constexpr (Op == BinaryOp::And)
+        return a & b;
+      else if constexpr (Op == BinaryOp::Or)
+        return a | b;
+      else
+        return a ^ b;
+    }
+
+    template <BinaryOp Op>
+    void binaryScalar(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length)
+    {
+      for (std::size_t i = 0; i < length; ++i)
+      {
+        dst[i] = applyScalar<Op>(srcA[i], srcB[i]);
+      }
+    }
+
+    void notScalar(uint32_t *dst, const uint32_t *src, std::size_t length)
+    {
+      for (std::size_t i = 0; i < length; ++i)
+      {
+        dst[i] = ~src[i];
+      }
+    }
+
+    [[maybe_unused]] uint64_t popcountSwar64(uint64_t value)
+    {
+      value = value - ((value >> 1) & 0x5555555555555555ULL);
+      value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+      value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+      return (value * 0x0101010101010101ULL) >> 56;
+    }
+
+    // Walks the buffer 64 bits at a time; the odd trailing word is counted on its own
+    template <typename Popcount64>
+    uint64_t countWords(const uint32_t *data, std::size_t length, Popcount64 popcount64)
+    {
+      uint64_t total = 0;
+      std::size_t i = 0;
+      for (; i + 2 <= length; i += 2)
+      {
+        uint64_t pair;
+        std::memcpy(&pair, data + i, sizeof(pair));
+        total += popcount64(pair);
+      }
+      if (i < length)
+      {
+        total += popcount64(data[i]);
+      }
+      return total;
+    }
+
+    uint64_t countScalarSwar(const uint32_t *data, std::size_t length)
+    {
+#if defined(__GNUC__) && (defined(__POPCNT__) || !(defined(__x86_64__) || defined(__i386__)))
+      return countWords(data, length, [](uint64_t v) -> uint64_t { return __builtin_popcountll(v); });
+#else
+      return countWords(data, length, popcountSwar64);
+#endif
+    }
+
+#ifdef BITWISE_X86
+    __attribute__((target("popcnt"))) uint64_t countScalarPopcnt(const uint32_t *data, std::size_t length)
+    {
+      uint64_t total = 0;
+      std::size_t i = 0;
+      // Four independent accumulators keep the popcnt unit busy
+      uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+      for (; i + 8 <= length; i += 8)
+      {
+        uint64_t w[4];
+        std::memcpy(w, data + i, sizeof(w));
+        c0 += __builtin_popcountll(w[0]);
+        c1 += __builtin_popcountll(w[1]);
+        c2 += __builtin_popcountll(w[2]);
+        c3 += __builtin_popcountll(w[3]);
+      }
+      total = c0 + c1 + c2 + c3;
+      for (; i < length; ++i)
+      {
+        total += __builtin_popcount(data[i]);
+      }
+      return total;
+    }
+
+    // Each SIMD kernel handles whole vectors (unrolled x2 so two loads are in flight)
+    // and hands the remaining tail to the scalar loop.
+
+    template <BinaryOp Op>
+    __attribute__((target("sse2"))) void binarySse2(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length)
+    {
+      std::size_t i = 0;
+      for (; i + 8 <= length; i += 8)
+      {
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcA + i));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcA + i + 4));
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcB + i));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcB + i + 4));
+        __m128i r0, r1;
+        if constexpr (Op == BinaryOp::And)
+        {
+          r0 = _mm_and_si128(a0, b0);
+          r1 = _mm_and_si128(a1, b1);
+        }
+        else if constexpr (Op == BinaryOp::Or)
+        {
+          r0 = _mm_or_si128(a0, b0);
+          r1 = _mm_or_si128(a1, b1);
+        }
+        else
+        {
+          r0 = _mm_xor_si128(a0, b0);
+          r1 = _mm_xor_si128(a1, b1);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), r0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4), r1);
+      }
+      binaryScalar<Op>(dst + i, srcA + i, srcB + i, length - i);
+    }
+
+    __attribute__((target("sse2"))) void notSse2(uint32_t *dst, const uint32_t *src, std::size_t length)
+    {
+      const __m128i ones = _mm_set1_epi32(-1);
+      std::size_t i = 0;
+      for (; i + 8 <= length; i += 8)
+      {
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_xor_si128(a0, ones));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4), _mm_xor_si128(a1, ones));
+      }
+      notScalar(dst + i, src + i, length - i);
+    }
+
+    template <BinaryOp Op>
+    __attribute__((target("avx2"))) void binaryAvx2(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length)
+    {
+      std::size_t i = 0;
+      for (; i + 16 <= length; i += 16)
+      {
+        __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcA + i));
+        __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcA + i + 8));
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcB + i));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcB + i + 8));
+        __m256i r0, r1;
+        if constexpr (Op == BinaryOp::And)
+        {
+          r0 = _mm256_and_si256(a0, b0);
+          r1 = _mm256_and_si256(a1, b1);
+        }
+        else if constexpr (Op == BinaryOp::Or)
+        {
+          r0 = _mm256_or_si256(a0, b0);
+          r1 = _mm256_or_si256(a1, b1);
+        }
+        else
+        {
+          r0 = _mm256_xor_si256(a0, b0);
+          r1 = _mm256_xor_si256(a1, b1);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), r0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 8), r1);
+      }
+      binaryScalar<Op>(dst + i, srcA + i, srcB + i, length - i);
+    }
+
+    __attribute__((target("avx2"))) void notAvx2(uint32_t *dst, const uint32_t *src, std::size_t length)
+    {
+      const __m256i ones = _mm256_set1_epi32(-1);
+      std::size_t i = 0;
+      for (; i + 16 <= length; i += 16)
+      {
+        __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(a0, ones));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 8), _mm256_xor_si256(a1, ones));
+      }
+      notScalar(dst + i, src + i, length - i);
+    }
+
+    template <BinaryOp Op>
+    __attribute__((target("avx512f"))) void binaryAvx512(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length)
+    {
+      std::size_t i = 0;
+      for (; i + 32 <= length; i += 32)
+      {
+        __m512i a0 = _mm512_loadu_si512(srcA + i);
+        __m512i a1 = _mm512_loadu_si512(srcA + i + 16);
+        __m512i b0 = _mm512_loadu_si512(srcB + i);
+        __m512i b1 = _mm512_loadu_si512(srcB + i + 16);
+        __m512i r0, r1;
+        if constexpr (Op == BinaryOp::And)
+        {
+          r0 = _mm512_and_si512(a0, b0);
+          r1 = _mm512_and_si512(a1, b1);
+        }
+        else if constexpr (Op == BinaryOp::Or)
+        {
+          r0 = _mm512_or_si512(a0, b0);
+          r1 = _mm512_or_si512(a1, b1);
+        }
+        else
+        {
+          r0 = _mm512_xor_si512(a0, b0);
+          r1 = _mm512_xor_si512(a1, b1);
+        }
+        _mm512_storeu_si512(dst + i, r0);
+        _mm512_storeu_si512(dst + i + 16, r1);
+      }
+      // Masked load/store finishes the tail without dropping to scalar code
+      for (; i < length; i += 16)
+      {
+        std::size_t remaining = length - i;
+        __mmask16 mask = remaining >= 16 ? static_cast<__mmask16>(0xFFFF)
+                                         : static_cast<__mmask16>((1U << remaining) - 1);
+        __m512i a = _mm512_maskz_loadu_epi32(mask, srcA + i);
+        __m512i b = _mm512_maskz_loadu_epi32(mask, srcB + i);
+        __m512i r;
+        if constexpr (Op == BinaryOp::And)
+          r = _mm512_and_si512(a, b);
+        else if constexpr (Op == BinaryOp::Or)
+          r = _mm512_or_si512(a, b);
+        else
+          r = _mm512_xor_si512(a, b);
+        _mm512_mask_storeu_epi32(dst + i, mask, r);
+      }
+    }
+
+    __attribute__((target("avx512f"))) void notAvx512(uint32_t *dst, const uint32_t *src, std::size_t length)
+    {
+      const __m512i ones = _mm512_set1_epi32(-1);
+      std::size_t i = 0;
+      for (; i + 32 <= length; i += 32)
+      {
+        __m512i a0 = _mm512_loadu_si512(src + i);
+        __m512i a1 = _mm512_loadu_si512(src + i + 16);
+        _mm512_storeu_si512(dst + i, _mm512_xor_si512(a0, ones));
+        _mm512_storeu_si512(dst + i + 16, _mm512_xor_si512(a1, ones));
+      }
+      for (; i < length; i += 16)
+      {
+        std::size_t remaining = length - i;
+        __mmask16 mask = remaining >= 16 ? static_cast<__mmask16>(0xFFFF)
+                                         : static_cast<__mmask16>((1U << remaining) - 1);
+        __m512i a = _mm512_maskz_loadu_epi32(mask, src + i);
+        _mm512_mask_storeu_epi32(dst + i, mask, _mm512_xor_si512(a, ones));
+      }
+    }
+
+    // Per-byte popcount via a 16-entry nibble table (vpshufb), summed into 64-bit lanes with vpsadbw
+    __attribute__((target("avx2"))) inline __m256i popcount256(__m256i v)
+    {
+      const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                              0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+      const __m256i lowMask = _mm256_set1_epi8(0x0F);
+      __m256i lo = _mm256_and_si256(v, lowMask);
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+      __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+      return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+    }
+
+    // Carry-save adder: folds three inputs into a sum (low) and carry (high) vector
+    __attribute__((target("avx2"))) inline void csa256(__m256i &high, __m256i &low, __m256i a, __m256i b, __m256i c)
+    {
+      __m256i u = _mm256_xor_si256(a, b);
+      high = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+      low = _mm256_xor_si256(u, c);
+    }
+
+    __attribute__((target("avx2"))) inline __m256i load256(const uint32_t *data, std::size_t vector)
+    {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data) + vector);
+    }
+
+    // Harley-Seal: a CSA tree over 16 vectors means only one vpshufb popcount per 512 bytes
+    __attribute__((target("avx2"))) uint64_t countAvx2(const uint32_t *data, std::size_t length)
+    {
+      const std::size_t vectors = length / 8;
+      __m256i total = _mm256_setzero_si256();
+      __m256i ones = _mm256_setzero_si256();
+      __m256i twos = _mm256_setzero_si256();
+      __m256i fours = _mm256_setzero_si256();
+      __m256i eights = _mm256_setzero_si256();
+      __m256i sixteens, twosA, twosB, foursA, foursB, eightsA, eightsB;
+
+      std::size_t i = 0;
+      for (; i + 16 <= vectors; i += 16)
+      {
+        csa256(twosA, ones, ones, load256(data, i + 0), load256(data, i + 1));
+        csa256(twosB, ones, ones, load256(data, i + 2), load256(data, i + 3));
+        csa256(foursA, twos, twos, twosA, twosB);
+        csa256(twosA, ones, ones, load256(data, i + 4), load256(data, i + 5));
+        csa256(twosB, ones, ones, load256(data, i + 6), load256(data, i + 7));
+        csa256(foursB, twos, twos, twosA, twosB);
+        csa256(eightsA, fours, fours, foursA, foursB);
+        csa256(twosA, ones, ones, load256(data, i + 8), load256(data, i + 9));
+        csa256(twosB, ones, ones, load256(data, i + 10), load256(data, i + 11));
+        csa256(foursA, twos, twos, twosA, twosB);
+        csa256(twosA, ones, ones, load256(data, i + 12), load256(data, i + 13));
+        csa256(twosB, ones, ones, load256(data, i + 14), load256(data, i + 15));
+        csa256(foursB, twos, twos, twosA, twosB);
+        csa256(eightsB, fours, fours, foursA, foursB);
+        csa256(sixteens, eights, eights, eightsA, eightsB);
+        total = _mm256_add_epi64(total, popcount256(sixteens));
+      }
+
+      total = _mm256_slli_epi64(total, 4);
+      total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(eights), 3));
+      total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(fours), 2));
+      total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(twos), 1));
+      total = _mm256_add_epi64(total, popcount256(ones));
+      for (; i < vectors; ++i)
+      {
+        total = _mm256_add_epi64(total, popcount256(load256(data, i)));
+      }
+
+      uint64_t lanes[4];
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), total);
+      uint64_t count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+      return count + countScalarSwar(data + vectors * 8, length - vectors * 8);
+    }
+
+    __attribute__((target("avx512f,avx512bw"))) inline __m512i popcount512(__m512i v)
+    {
+      // Same nibble table as popcount256, packed four bytes per lane
+      const __m512i lookup = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+      const __m512i lowMask = _mm512_set1_epi8(0x0F);
+      __m512i lo = _mm512_and_si512(v, lowMask);
+      __m512i hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), lowMask);
+      __m512i counts = _mm512_add_epi8(_mm512_shuffle_epi8(lookup, lo), _mm512_shuffle_epi8(lookup, hi));
+      return _mm512_sad_epu8(counts, _mm512_setzero_si512());
+    }
+
+    // vpternlogd evaluates each half of the carry-save adder in a single instruction
+    __attribute__((target("avx512f,avx512bw"))) inline void csa512(__m512i &high, __m512i &low, __m512i a, __m512i b, __m512i c)
+    {
+      low = _mm512_ternarylogic_epi32(a, b, c, 0x96);  // a ^ b ^ c
+      high = _mm512_ternarylogic_epi32(a, b, c, 0xE8); // majority(a, b, c)
+    }
+
+    __attribute__((target("avx512f,avx512bw"))) inline __m512i load512(const uint32_t *data, std::size_t vector)
+    {
+      return _mm512_loadu_si512(data + vector * 16);
+    }
+
+    __attribute__((target("avx512f,avx512bw"))) uint64_t countAvx512(const uint32_t *data, std::size_t length)
+    {
+      const std::size_t vectors = length / 16;
+      __m512i total = _mm512_setzero_si512();
+      __m512i ones = _mm512_setzero_si512();
+      __m512i twos = _mm512_setzero_si512();
+      __m512i fours = _mm512_setzero_si512();
+      __m512i eights = _mm512_setzero_si512();
+      __m512i sixteens, twosA, twosB, foursA, foursB, eightsA, eightsB;
+
+      std::size_t i = 0;
+      for (; i + 16 <= vectors; i += 16)
+      {
+        csa512(twosA, ones, ones, load512(data, i + 0), load512(data, i + 1));
+        csa512(twosB, ones, ones, load512(data, i + 2), load512(data, i + 3));
+        csa512(foursA, twos, twos, twosA, twosB);
+        csa512(twosA, ones, ones, load512(data, i + 4), load512(data, i + 5));
+        csa512(twosB, ones, ones, load512(data, i + 6), load512(data, i + 7));
+        csa512(foursB, twos, twos, twosA, twosB);
+        csa512(eightsA, fours, fours, foursA, foursB);
+        csa512(twosA, ones, ones, load512(data, i + 8), load512(data, i + 9));
+        csa512(twosB, ones, ones, load512(data, i + 10), load512(data, i + 11));
+        csa512(foursA, twos, twos, twosA, twosB);
+        csa512(twosA, ones, ones, load512(data, i + 12), load512(data, i + 13));
+        csa512(twosB, ones, ones, load512(data, i + 14), load512(data, i + 15));
+        csa512(foursB, twos, twos, twosA, twosB);
+        csa512(eightsB, fours, fours, foursA, foursB);
+        csa512(sixteens, eights, eights, eightsA, eightsB);
+        total = _mm512_add_epi64(total, popcount512(sixteens));
+      }
+
+      // The all-lanes maskz form avoids GCC 12's spurious -Wuninitialized in _mm512_slli_epi64
+      total = _mm512_maskz_slli_epi64(0xFF, total, 4);
+      total = _mm512_add_epi64(total, _mm512_maskz_slli_epi64(0xFF, popcount512(eights), 3));
+      total = _mm512_add_epi64(total, _mm512_maskz_slli_epi64(0xFF, popcount512(fours), 2));
+      total = _mm512_add_epi64(total, _mm512_maskz_slli_epi64(0xFF, popcount512(twos), 1));
+      total = _mm512_add_epi64(total, popcount512(ones));
+      for (; i < vectors; ++i)
+      {
+        total = _mm512_add_epi64(total, popcount512(load512(data, i)));
+      }
+
+      uint64_t lanes[8];
+      _mm512_storeu_si512(lanes, total);
+      uint64_t count = 0;
+      for (uint64_t lane : lanes)
+        count += lane;
+      return count + countScalarSwar(data + vectors * 16, length - vectors * 16);
+    }
+#endif
+
+    enum class BitOp
+    {
+      Set,
+      Clear,
+      Toggle
+    };
+
+    // How many positions ahead the bit kernels prefetch; enough to cover a DRAM miss at a few ns per update
+    constexpr std::size_t kPrefetchDistance = 16;
+    // Batches are bucketed when they are at least this large and span more than one region
+    constexpr std::size_t kBucketMinCount = std::size_t(1) << 16;
+    constexpr unsigned kRegionShift = 21; // 2^21 bits = 256 KiB of buffer per bucket
+
+    template <BitOp Op>
+    inline void applyBit(uint32_t *words, uint32_t position)
+    {
+      uint32_t &word = words[position >> 5];
+      uint32_t bit = 1U << (position & 31);
+      if constexpr (Op == BitOp::Set)
+        word |= bit;
+      else if constexpr (Op == BitOp::Clear)
+        word &= ~bit;
+      else
+        word ^= bit;
+    }
+
+    template <BitOp Op>
+    void applyBitsPrefetched(uint32_t *words, const uint32_t *positions, std::size_t count)
+    {
+      std::size_t i = 0;
+      for (; i + kPrefetchDistance < count; ++i)
+      {
+        __builtin_prefetch(words + (positions[i + kPrefetchDistance] >> 5), 1);
+        applyBit<Op>(words, positions[i]);
+      }
+      for (; i < count; ++i)
+      {
+        applyBit<Op>(words, positions[i]);
+      }
+    }
+
+    // All three operations commute with themselves, so reordering the positions never changes the result
+    template <BitOp Op>
+    void applyBits(uint32_t *words, const uint32_t *positions, std::size_t count)
+    {
+      if (count < kBucketMinCount)
+      {
+        applyBitsPrefetched<Op>(words, positions, count);
+        return;
+      }
+      std::size_t regions = (*std::max_element(positions, positions + count) >> kRegionShift) + 1;
+      if (regions == 1)
+      {
+        applyBitsPrefetched<Op>(words, positions, count);
+        return;
+      }
+
+      // Counting sort by region: one pass to size the buckets, one to scatter into them
+      std::vector<std::size_t> offsets(regions + 1, 0);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        ++offsets[(positions[i] >> kRegionShift) + 1];
+      }
+      for (std::size_t r = 1; r <= regions; ++r)
+      {
+        offsets[r] += offsets[r - 1];
+      }
+      std::vector<uint32_t> bucketed(count);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        bucketed[offsets[positions[i] >> kRegionShift]++] = positions[i];
+      }
+      applyBitsPrefetched<Op>(words, bucketed.data(), count);
+    }
+
+    void testBitsScalar(uint64_t *mask, const uint32_t *words, const uint32_t *positions, std::size_t first,
+                        std::size_t count)
+    {
+      for (std::size_t i = first; i < count; ++i)
+      {
+        if (i + kPrefetchDistance < count)
+          __builtin_prefetch(words + (positions[i + kPrefetchDistance] >> 5));
+        uint32_t position = positions[i];
+        uint64_t bit = (words[position >> 5] >> (position & 31)) & 1;
+        mask[i / 64] |= bit << (i % 64);
+      }
+    }
+
+#ifdef BITWISE_X86
+    __attribute__((target("avx2"))) void testBitsAvx2(uint64_t *mask, const uint32_t *words, const uint32_t *positions,
+                                                      std::size_t count)
+    {
+      const __m256i lowBits = _mm256_set1_epi32(31);
+      std::size_t i = 0;
+      for (; i + 8 <= count; i += 8)
+      {
+        __m256i position = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(positions + i));
+        // Word indices are at most 2^27, so the signed 32-bit gather offsets cannot overflow
+        __m256i word = _mm256_i32gather_epi32(reinterpret_cast<const int *>(words), _mm256_srli_epi32(position, 5), 4);
+        // Move the tested bit into the sign bit and collect the eight sign bits
+        __m256i shift = _mm256_sub_epi32(lowBits, _mm256_and_si256(position, lowBits));
+        uint32_t lanes = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_sllv_epi32(word, shift))));
+        mask[i / 64] |= uint64_t(lanes) << (i % 64);
+      }
+      testBitsScalar(mask, words, positions, i, count);
+    }
+
+    __attribute__((target("avx512f"))) void testBitsAvx512(uint64_t *mask, const uint32_t *words,
+                                                           const uint32_t *positions, std::size_t count)
+    {
+      const __m512i lowBits = _mm512_set1_epi32(31);
+      const __m512i one = _mm512_set1_epi32(1);
+      std::size_t i = 0;
+      for (; i + 16 <= count; i += 16)
+      {
+        __m512i position = _mm512_loadu_si512(positions + i);
+        // The explicitly masked forms sidestep GCC 12's -Wmaybe-uninitialized on _mm512_undefined_epi32
+        __m512i index = _mm512_maskz_srli_epi32(0xFFFF, position, 5);
+        __m512i word = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, index, words, 4);
+        __m512i bit = _mm512_maskz_sllv_epi32(0xFFFF, one, _mm512_and_si512(position, lowBits));
+        mask[i / 64] |= uint64_t(_mm512_test_epi32_mask(word, bit)) << (i % 64);
+      }
+      testBitsScalar(mask, words, positions, i, count);
+    }
+#endif
+
+    template <BinaryOp Op>
+    void dispatchBinary(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length)
+    {
+#ifdef BITWISE_X86
+      switch (activeSimdLevel())
+      {
+      case SimdLevel::AVX512:
+        binaryAvx512<Op>(dst, srcA, srcB, length);
+        return;
+      case SimdLevel::AVX2:
+        binaryAvx2<Op>(dst, srcA, srcB, length);
+        return;
+      case SimdLevel::SSE2:
+        binarySse2<Op>(dst, srcA, srcB, length);
+        return;
+      case SimdLevel::Scalar:
+        break;
+      }
+#endif
+      binaryScalar<Op>(dst, srcA, srcB, length);
+    }
+
+    // dst[j] = funnelShiftLeft(hi[j], hi[j - 1], shift) for j in [0, count), with shift in 1-31 and
+    // hi[-1] readable. Every block loads its inputs before it stores, and blocks run downwards when
+    // dst may overlap hi from above (in-place left shifts) and upwards otherwise, so the source words
+    // are read before they are overwritten.
+    void funnelScalar(uint32_t *dst, const uint32_t *hi, unsigned shift, std::size_t count, bool downwards)
+    {
+      const uint32_t *lo = hi - 1;
+      if (downwards)
+      {
+        for (std::size_t j = count; j-- > 0;)
+          dst[j] = (hi[j] << shift) | (lo[j] >> (32 - shift));
+      }
+      else
+      {
+        for (std::size_t j = 0; j < count; ++j)
+          dst[j] = (hi[j] << shift) | (lo[j] >> (32 - shift));
+      }
+    }
+
+#ifdef BITWISE_X86
+    // The lane-crossing part of the funnel is the load one word below hi: lane k of lo holds the
+    // word that lane k of hi's neighbour holds, so each lane combines two adjacent source words
+    __attribute__((target("sse2"))) void funnelSse2(uint32_t *dst, const uint32_t *hi, unsigned shift,
+                                                    std::size_t count, bool downwards)
+    {
+      const uint32_t *lo = hi - 1;
+      const __m128i left = _mm_cvtsi32_si128(static_cast<int>(shift));
+      const __m128i right = _mm_cvtsi32_si128(static_cast<int>(32 - shift));
+      const std::size_t body = count / 4 * 4;
+      if (downwards)
+      {
+        funnelScalar(dst + body, hi + body, shift, count - body, true);
+        for (std::size_t j = body; j > 0;)
+        {
+          j -= 4;
+          __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hi + j));
+          __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lo + j));
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j), _mm_or_si128(_mm_sll_epi32(h, left), _mm_srl_epi32(l, right)));
+        }
+        return;
+      }
+      for (std::size_t j = 0; j < body; j += 4)
+      {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hi + j));
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lo + j));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j), _mm_or_si128(_mm_sll_epi32(h, left), _mm_srl_epi32(l, right)));
+      }
+      funnelScalar(dst + body, hi + body, shift, count - body, false);
+    }
+
+    __attribute__((target("avx2"))) void funnelAvx2(uint32_t *dst, const uint32_t *hi, unsigned shift,
+                                                    std::size_t count, bool downwards)
+    {
+      const uint32_t *lo = hi - 1;
+      const __m128i left = _mm_cvtsi32_si128(static_cast<int>(shift));
+      const __m128i right = _mm_cvtsi32_si128(static_cast<int>(32 - shift));
+      const std::size_t body = count / 8 * 8;
+      if (downwards)
+      {
+        funnelScalar(dst + body, hi + body, shift, count - body, true);
+        for (std::size_t j = body; j > 0;)
+        {
+          j -= 8;
+          __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hi + j));
+          __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lo + j));
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + j),
+                              _mm256_or_si256(_mm256_sll_epi32(h, left), _mm256_srl_epi32(l, right)));
+        }
+        return;
+      }
+      for (std::size_t j = 0; j < body; j += 8)
+      {
+        __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hi + j));
+        __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lo + j));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + j),
+                            _mm256_or_si256(_mm256_sll_epi32(h, left), _mm256_srl_epi32(l, right)));
+      }
+      funnelScalar(dst + body, hi + body, shift, count - body, false);
+    }
+
+    __attribute__((target("avx512f"))) void funnelAvx512(uint32_t *dst, const uint32_t *hi, unsigned shift,
+                                                         std::size_t count, bool downwards)
+    {
+      const uint32_t *lo = hi - 1;
+      // Per-lane variable shifts with a broadcast count (VPSLLVD/VPSRLVD); the all-lanes zero-masked
+      // forms avoid GCC 12's spurious -Wmaybe-uninitialized on the unmasked intrinsics
+      const __m512i left = _mm512_set1_epi32(static_cast<int>(shift));
+      const __m512i right = _mm512_set1_epi32(static_cast<int>(32 - shift));
+      const std::size_t body = count / 16 * 16;
+      if (downwards)
+      {
+        funnelScalar(dst + body, hi + body, shift, count - body, true);
+        for (std::size_t j = body; j > 0;)
+        {
+          j -= 16;
+          __m512i h = _mm512_loadu_si512(hi + j);
+          __m512i l = _mm512_loadu_si512(lo + j);
+          _mm512_storeu_si512(dst + j, _mm512_or_si512(_mm512_maskz_sllv_epi32(0xFFFF, h, left), _mm512_maskz_srlv_epi32(0xFFFF, l, right)));
+        }
+        return;
+      }
+      for (std::size_t j = 0; j < body; j += 16)
+      {
+        __m512i h = _mm512_loadu_si512(hi + j);
+        __m512i l = _mm512_loadu_si512(lo + j);
+        _mm512_storeu_si512(dst + j, _mm512_or_si512(_mm512_maskz_sllv_epi32(0xFFFF, h, left), _mm512_maskz_srlv_epi32(0xFFFF, l, right)));
+      }
+      funnelScalar(dst + body, hi + body, shift, count - body, false);
+    }
+
+    // VPSHLDVD does the whole funnel in one instruction
+    __attribute__((target("avx512f,avx512vbmi2"))) void funnelAvx512Vbmi2(uint32_t *dst, const uint32_t *hi,
+                                                                         unsigned shift, std::size_t count,
+                                                                         bool downwards)
+    {
+      const uint32_t *lo = hi - 1;
+      const __m512i amount = _mm512_set1_epi32(static_cast<int>(shift));
+      const std::size_t body = count / 16 * 16;
+      if (downwards)
+      {
+        funnelScalar(dst + body, hi + body, shift, count - body, true);
+        for (std::size_t j = body; j > 0;)
+        {
+          j -= 16;
+          _mm512_storeu_si512(dst + j, _mm512_shldv_epi32(_mm512_loadu_si512(hi + j), _mm512_loadu_si512(lo + j), amount));
+        }
+        return;
+      }
+      for (std::size_t j = 0; j < body; j += 16)
+        _mm512_storeu_si512(dst + j, _mm512_shldv_epi32(_mm512_loadu_si512(hi + j), _mm512_loadu_si512(lo + j), amount));
+      funnelScalar(dst + body, hi + body, shift, count - body, false);
+    }
+#endif
+
+    void funnelWords(uint32_t *dst, const uint32_t *hi, unsigned shift, std::size_t count, bool downwards)
+    {
+#ifdef BITWISE_X86
+      switch (activeSimdLevel())
+      {
+      case SimdLevel::AVX512:
+        if (cpuFeatures().avx512vbmi2)
+          funnelAvx512Vbmi2(dst, hi, shift, count, downwards);
+        else
+          funnelAvx512(dst, hi, shift, count, downwards);
+        return;
+      case SimdLevel::AVX2:
+        funnelAvx2(dst, hi, shift, count, downwards);
+        return;
+      case SimdLevel::SSE2:
+        funnelSse2(dst, hi, shift, count, downwards);
+        return;
+      case SimdLevel::Scalar:
+        break;
+      }
+#endif
+      funnelScalar(dst, hi, shift, count, downwards);
+    }
+
+    // Word i of a left shift by bits = 32 * q + r funnels source words i - q and i - q - 1; words
+    // below q take only zeros (and src[0] for word q). Run downwards, the parts go from the top, so
+    // a shift with dst == src reads every source word before it is overwritten.
+    void leftShiftWords(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits,
+                        std::size_t first, std::size_t last, bool downwards)
+    {
+      const std::size_t q = bits / 32;
+      const unsigned r = static_cast<unsigned>(bits % 32);
+      last = std::min(last, length);
+      if (first >= last)
+        return;
+      const std::size_t zeroEnd = std::min(last, q);
+      const std::size_t bodyStart = std::max(first, q + 1);
+      const bool edge = q >= first && q < last;
+
+      auto body = [&]
+      {
+        if (bodyStart >= last)
+          return;
+        if (r == 0)
+          std::memmove(dst + bodyStart, src + bodyStart - q, (last - bodyStart) * sizeof(uint32_t));
+        else
+          funnelWords(dst + bodyStart, src + bodyStart - q, r, last - bodyStart, downwards);
+      };
+      if (downwards)
+        body();
+      if (edge)
+        dst[q] = src[0] << r;
+      if (first < zeroEnd)
+        std::fill(dst + first, dst + zeroEnd, 0U);
+      if (!downwards)
+        body();
+    }
+
+    // Word i of a right shift funnels source words i + q + 1 and i + q; words from length - q on
+    // take only zeros. Running upwards is already safe in place.
+    void rightShiftWords(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits,
+                         std::size_t first, std::size_t last)
+    {
+      const std::size_t q = bits / 32;
+      const unsigned r = static_cast<unsigned>(bits % 32);
+      last = std::min(last, length);
+      if (first >= last)
+        return;
+      const std::size_t sourced = q < length ? length - q : 0; // words that take any source bits
+      const std::size_t full = r == 0 ? sourced : (sourced > 0 ? sourced - 1 : 0);
+      const std::size_t bodyEnd = std::min(last, full);
+      if (first < bodyEnd)
+      {
+        if (r == 0)
+          std::memmove(dst + first, src + first + q, (bodyEnd - first) * sizeof(uint32_t));
+        else
+          funnelWords(dst + first, src + first + q + 1, 32 - r, bodyEnd - first, false);
+      }
+      if (r != 0 && sourced > 0 && full >= first && full < last)
+        dst[full] = src[length - 1] >> r;
+      const std::size_t zeroStart = std::max(first, sourced);
+      if (zeroStart < last)
+        std::fill(dst + zeroStart, dst + last, 0U);
+    }
+
+    // Rotation by bits = 32 * q + r over the whole buffer: word i funnels source words i - q and
+    // i - q - 1, both taken modulo length
+    void rotateLeftWords(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits)
+    {
+      if (length == 0)
+        return;
+      bits %= 32 * length;
+      const std::size_t q = bits / 32;
+      const unsigned r = static_cast<unsigned>(bits % 32);
+      if (dst == src)
+      {
+        // Whole words first, then one downward funnel pass with the old top word wrapping into word 0
+        std::rotate(dst, dst + length - q, dst + length);
+        if (r != 0)
+        {
+          const uint32_t top = dst[length - 1];
+          funnelWords(dst + 1, dst + 1, r, length - 1, true);
+          dst[0] = (dst[0] << r) | (top >> (32 - r));
+        }
+        return;
+      }
+      if (r == 0)
+      {
+        std::memcpy(dst + q, src, (length - q) * sizeof(uint32_t));
+        std::memcpy(dst, src + length - q, q * sizeof(uint32_t));
+        return;
+      }
+      funnelWords(dst + q + 1, src + 1, r, length - q - 1, false);
+      dst[q] = (src[0] << r) | (src[length - 1] >> (32 - r));
+      funnelWords(dst, src + length - q, r, q, false);
+    }
+  } // namespace
+
+  void bitwiseAnd(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length)
+  {
+    BITWISE_STATS_SCOPE(BulkAnd, 3 * length * sizeof(uint32_t));
+    dispatchBinary<BinaryOp::And>(dst, srcA, srcB, length);
+  }
+
+  void bitwiseOr(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length)
+  {
+    BITWISE_STATS_SCOPE(BulkOr, 3 * length * sizeof(uint32_t));
+    dispatchBinary<BinaryOp::Or>(dst, srcA, srcB, length);
+  }
+
+  void bitwiseXor(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length)
+  {
+    BITWISE_STATS_SCOPE(BulkXor, 3 * length * sizeof(uint32_t));
+    dispatchBinary<BinaryOp::Xor>(dst, srcA, srcB, length);
+  }
+
+  void bitwiseNot(uint32_t *dst, const uint32_t *src, std::size_t length)
+  {
+    BITWISE_STATS_SCOPE(BulkNot, 2 * length * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    switch (activeSimdLevel())
+    {
+    case SimdLevel::AVX512:
+      notAvx512(dst, src, length);
+      return;
+    case SimdLevel::AVX2:
+      notAvx2(dst, src, length);
+      return;
+    case SimdLevel::SSE2:
+      notSse2(dst, src, length);
+      return;
+    case SimdLevel::Scalar:
+      break;
+    }
+#endif
+    notScalar(dst, src, length);
+  }
+
+  uint64_t countSetBits(const uint32_t *data, std::size_t length)
+  {
+    BITWISE_STATS_SCOPE(BulkCountSetBits, length * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    const CpuFeatures &features = cpuFeatures();
+    switch (activeSimdLevel())
+    {
+    case SimdLevel::AVX512:
+      if (features.avx512bw)
+        return countAvx512(data, length);
+      return countAvx2(data, length);
+    case SimdLevel::AVX2:
+      return countAvx2(data, length);
+    case SimdLevel::SSE2:
+    case SimdLevel::Scalar:
+      break;
+    }
+    // SSE2 has no byte shuffle, so below AVX2 the best option is the POPCNT instruction
+    if (features.popcnt)
+      return countScalarPopcnt(data, length);
+#endif
+    return countScalarSwar(data, length);
+  }
+
+  void leftShiftRange(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits,
+                      std::size_t first, std::size_t last)
+  {
+    leftShiftWords(dst, src, length, bits, first, last, false);
+  }
+
+  void rightShiftRange(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits,
+                       std::size_t first, std::size_t last)
+  {
+    rightShiftWords(dst, src, length, bits, first, last);
+  }
+
+  void leftShift(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits)
+  {
+    BITWISE_STATS_SCOPE(BulkLeftShift, 2 * length * sizeof(uint32_t));
+    leftShiftWords(dst, src, length, bits, 0, length, dst == src);
+  }
+
+  void rightShift(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits)
+  {
+    BITWISE_STATS_SCOPE(BulkRightShift, 2 * length * sizeof(uint32_t));
+    rightShiftWords(dst, src, length, bits, 0, length);
+  }
+
+  void rotateLeft(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits)
+  {
+    BITWISE_STATS_SCOPE(BulkRotate, 2 * length * sizeof(uint32_t));
+    rotateLeftWords(dst, src, length, bits);
+  }
+
+  void rotateRight(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits)
+  {
+    BITWISE_STATS_SCOPE(BulkRotate, 2 * length * sizeof(uint32_t));
+    if (length == 0)
+      return;
+    const std::size_t total = 32 * length;
+    rotateLeftWords(dst, src, length, total - bits % total);
+  }
+
+  void setBits(uint32_t *words, const uint32_t *positions, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkSetBits, count * sizeof(uint32_t));
+    applyBits<BitOp::Set>(words, positions, count);
+  }
+
+  void clearBits(uint32_t *words, const uint32_t *positions, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkClearBits, count * sizeof(uint32_t));
+    applyBits<BitOp::Clear>(words, positions, count);
+  }
+
+  void toggleBits(uint32_t *words, const uint32_t *positions, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkToggleBits, count * sizeof(uint32_t));
+    applyBits<BitOp::Toggle>(words, positions, count);
+  }
+
+  void testBits(uint64_t *mask, const uint32_t *words, const uint32_t *positions, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkTestBits, count * sizeof(uint32_t));
+    std::fill(mask, mask + (count + 63) / 64, 0);
+#ifdef BITWISE_X86
+    switch (activeSimdLevel())
+    {
+    case SimdLevel::AVX512:
+      testBitsAvx512(mask, words, positions, count);
+      return;
+    case SimdLevel::AVX2:
+      testBitsAvx2(mask, words, positions, count);
+      return;
+    case SimdLevel::SSE2:
+    case SimdLevel::Scalar:
+      break;
+    }
+#endif
+    testBitsScalar(mask, words, positions, 0, count);
+  }
+
+} // namespace bitwise
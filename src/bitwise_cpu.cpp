@@ -0,0 +1,121 @@
+#include "bitwise_cpu.h"
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define BITWISE_X86 1
+#endif
+
+namespace bitwise
+{
+  namespace
+  {
+#ifdef BITWISE_X86
+    // XCR0 tells us which register states the OS saves on a context switch;
+    // a CPU advertising AVX is useless if the OS does not preserve the YMM/ZMM registers
+    unsigned long long readXcr0()
+    {
+      unsigned int eax, edx;
+      __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+      return (static_cast<unsigned long long>(edx) << 32) | eax;
+    }
+#endif
+
+    CpuFeatures queryCpuFeatures()
+    {
+      CpuFeatures features;
+#ifdef BITWISE_X86
+      unsigned int eax, ebx, ecx, edx;
+      if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      {
+        return features;
+      }
+      features.sse2 = (edx >> 26) & 1;
+      features.popcnt = (ecx >> 23) & 1;
+
+      bool osxsave = (ecx >> 27) & 1;
+      bool avxState = false;
+      bool avx512State = false;
+      if (osxsave)
+      {
+        unsigned long long xcr0 = readXcr0();
+        avxState = (xcr0 & 0x6) == 0x6;     // XMM | YMM
+        avx512State = (xcr0 & 0xE6) == 0xE6; // XMM | YMM | opmask | ZMM_Hi256 | Hi16_ZMM
+      }
+
+      if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+      {
+        features.bmi1 = (ebx >> 3) & 1;
+        features.avx2 = avxState && ((ebx >> 5) & 1);
+        features.bmi2 = (ebx >> 8) & 1;
+        features.avx512f = avx512State && ((ebx >> 16) & 1);
+        features.avx512bw = avx512State && ((ebx >> 30) & 1);
+        features.avx512vbmi2 = avx512State && ((ecx >> 6) & 1);
+      }
+
+      if (__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx))
+      {
+        features.lzcnt = (ecx >> 5) & 1;
+      }
+#endif
+      return features;
+    }
+
+    std::atomic<int> &selectedLevel()
+    {
+      static std::atomic<int> level{static_cast<int>(detectSimdLevel())};
+      return level;
+    }
+  } // namespace
+
+  const CpuFeatures &cpuFeatures()
+  {
+    static const CpuFeatures features = queryCpuFeatures();
+    return features;
+  }
+
+  SimdLevel detectSimdLevel()
+  {
+    const CpuFeatures &features = cpuFeatures();
+    if (features.avx512f)
+      return SimdLevel::AVX512;
+    if (features.avx2)
+      return SimdLevel::AVX2;
+    if (features.sse2)
+      return SimdLevel::SSE2;
+    return SimdLevel::Scalar;
+  }
+
+  SimdLevel activeSimdLevel()
+  {
+    return static_cast<SimdLevel>(selectedLevel().load(std::memory_order_relaxed));
+  }
+
+  SimdLevel setSimdLevel(SimdLevel level)
+  {
+    SimdLevel supported = detectSimdLevel();
+    if (level > supported)
+    {
+      level = supported;
+    }
+    selectedLevel().store(static_cast<int>(level), std::memory_order_relaxed);
+    return level;
+  }
+
+  const char *simdLevelName(SimdLevel level)
+  {
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+      return "Scalar";
+    case SimdLevel::SSE2:
+      return "SSE2";
+    case SimdLevel::AVX2:
+      return "AVX2";
+    case SimdLevel::AVX512:
+      return "AVX512";
+    }
+    return "Unknown";
+  }
+
+} // namespace bitwise
@@ -0,0 +1,647 @@
+#include "bitwise_expr.h"
+#include "bitwise_stats.h"
+#include "bitwise_bulk.h"
+#include <algorithm>
+#include <charconv>
+#include <map>
+#include <tuple>
+
+namespace bitwise
+{
+  namespace
+  {
+    enum class NodeKind : uint8_t
+    {
+      Const,
+      Var,
+      Not,
+      And,
+      Or,
+      Xor,
+      Shl,
+      Shr
+    };
+
+    struct Node
+    {
+      NodeKind kind;
+      uint32_t value; // constant value or variable index
+      int lhs;
+      int rhs;
+    };
+
+    constexpr uint32_t kAllOnes = 0xFFFFFFFFU;
+    constexpr uint32_t kOutputRegister = 0xFFFFFFFFU;
+
+    inline uint32_t shiftLeft(uint32_t value, uint32_t count)
+    {
+      return count >= 32 ? 0 : value << count;
+    }
+
+    inline uint32_t shiftRight(uint32_t value, uint32_t count)
+    {
+      return count >= 32 ? 0 : value >> count;
+    }
+
+    // Builds the expression DAG. Every node goes through the make* functions, which fold
+    // constants, apply identities and return an existing node for a repeated subexpression.
+    class GraphBuilder
+    {
+    public:
+      std::vector<Node> nodes;
+
+      int makeConst(uint32_t value) { return intern({NodeKind::Const, value, -1, -1}); }
+      int makeVar(uint32_t index) { return intern({NodeKind::Var, index, -1, -1}); }
+
+      int makeNot(int operand)
+      {
+        const Node &node = nodes[operand];
+        if (node.kind == NodeKind::Const)
+          return makeConst(~node.value);
+        if (node.kind == NodeKind::Not)
+          return node.lhs; // ~~x == x
+        return intern({NodeKind::Not, 0, operand, -1});
+      }
+
+      int makeBinary(NodeKind kind, int lhs, int rhs)
+      {
+        if (kind == NodeKind::Shl || kind == NodeKind::Shr)
+          return makeShift(kind, lhs, rhs);
+
+        // Canonical operand order for the commutative operators: constant on the right,
+        // otherwise lower node id first, so "a & b" and "b & a" share one node
+        if (isConst(lhs) || (!isConst(rhs) && lhs > rhs))
+          std::swap(lhs, rhs);
+
+        if (isConst(lhs) && isConst(rhs))
+        {
+          uint32_t a = nodes[lhs].value, b = nodes[rhs].value;
+          return makeConst(kind == NodeKind::And ? (a & b) : kind == NodeKind::Or ? (a | b) : (a ^ b));
+        }
+
+        if (isConst(rhs))
+        {
+          uint32_t c = nodes[rhs].value;
+          if (kind == NodeKind::And && c == 0)
+            return rhs;
+          if (kind == NodeKind::And && c == kAllOnes)
+            return lhs;
+          if (kind == NodeKind::Or && c == 0)
+            return lhs;
+          if (kind == NodeKind::Or && c == kAllOnes)
+            return rhs;
+          if (kind == NodeKind::Xor && c == 0)
+            return lhs;
+          if (kind == NodeKind::Xor && c == kAllOnes)
+            return makeNot(lhs);
+        }
+
+        if (lhs == rhs)
+          return kind == NodeKind::Xor ? makeConst(0) : lhs; // x & x == x | x == x, x ^ x == 0
+
+        return intern({kind, 0, lhs, rhs});
+      }
+
+      bool isConst(int node) const { return nodes[node].kind == NodeKind::Const; }
+
+    private:
+      int makeShift(NodeKind kind, int lhs, int rhs)
+      {
+        if (isConst(lhs) && isConst(rhs))
+        {
+          uint32_t a = nodes[lhs].value, count = nodes[rhs].value;
+          return makeConst(kind == NodeKind::Shl ? shiftLeft(a, count) : shiftRight(a, count));
+        }
+        if (isConst(lhs) && nodes[lhs].value == 0)
+          return lhs;
+        if (isConst(rhs))
+        {
+          uint32_t count = nodes[rhs].value;
+          if (count == 0)
+            return lhs;
+          if (count >= 32)
+            return makeConst(0);
+          // (x << a) << b == x << (a + b), and likewise for right shifts
+          const Node &inner = nodes[lhs];
+          if (inner.kind == kind && isConst(inner.rhs))
+          {
+            uint32_t total = nodes[inner.rhs].value + count;
+            return total >= 32 ? makeConst(0) : intern({kind, 0, inner.lhs, makeConst(total)});
+          }
+        }
+        return intern({kind, 0, lhs, rhs});
+      }
+
+      int intern(const Node &node)
+      {
+        auto key = std::make_tuple(node.kind, node.value, node.lhs, node.rhs);
+        auto found = index_.find(key);
+        if (found != index_.end())
+          return found->second;
+        nodes.push_back(node);
+        int id = static_cast<int>(nodes.size()) - 1;
+        index_.emplace(key, id);
+        return id;
+      }
+
+      std::map<std::tuple<NodeKind, uint32_t, int, int>, int> index_;
+    };
+
+    // Recursive-descent parser over the C precedence levels: | ^ & << >> ~
+    class Parser
+    {
+    public:
+      Parser(const std::string &source, GraphBuilder &graph, std::vector<std::string> &variables)
+          : source_(source), graph_(graph), variables_(variables) {}
+
+      bool parse(int &root, std::string &error)
+      {
+        root = parseOr();
+        skipSpace();
+        if (error_.empty() && pos_ != source_.size())
+          fail("unexpected '" + std::string(1, source_[pos_]) + "'");
+        error = error_;
+        return error_.empty();
+      }
+
+    private:
+      // Every parse function returns 0 after a failure, which is not a node id while the graph is
+      // still empty, so operands are checked with ok() before they reach the graph builder
+      int parseOr()
+      {
+        int lhs = parseXor();
+        while (ok() && accept("|"))
+        {
+          int rhs = parseXor();
+          if (!ok())
+            return 0;
+          lhs = graph_.makeBinary(NodeKind::Or, lhs, rhs);
+        }
+        return lhs;
+      }
+
+      int parseXor()
+      {
+        int lhs = parseAnd();
+        while (ok() && accept("^"))
+        {
+          int rhs = parseAnd();
+          if (!ok())
+            return 0;
+          lhs = graph_.makeBinary(NodeKind::Xor, lhs, rhs);
+        }
+        return lhs;
+      }
+
+      int parseAnd()
+      {
+        int lhs = parseShift();
+        while (ok() && accept("&"))
+        {
+          int rhs = parseShift();
+          if (!ok())
+            return 0;
+          lhs = graph_.makeBinary(NodeKind::And, lhs, rhs);
+        }
+        return lhs;
+      }
+
+      int parseShift()
+      {
+        int lhs = parseUnary();
+        while (ok())
+        {
+          NodeKind kind;
+          if (accept("<<"))
+            kind = NodeKind::Shl;
+          else if (accept(">>"))
+            kind = NodeKind::Shr;
+          else
+            break;
+          int rhs = parseUnary();
+          if (!ok())
+            return 0;
+          lhs = graph_.makeBinary(kind, lhs, rhs);
+        }
+        return lhs;
+      }
+
+      int parseUnary()
+      {
+        if (accept("~"))
+        {
+          int operand = parseUnary();
+          return ok() ? graph_.makeNot(operand) : 0;
+        }
+        return parsePrimary();
+      }
+
+      int parsePrimary()
+      {
+        skipSpace();
+        if (!ok())
+          return 0;
+        if (pos_ == source_.size())
+          return fail("unexpected end of expression");
+
+        char c = source_[pos_];
+        if (c == '(')
+        {
+          ++pos_;
+          int inner = parseOr();
+          if (ok() && !accept(")"))
+            return fail("expected ')'");
+          return inner;
+        }
+        if (c >= '0' && c <= '9')
+          return parseNumber();
+        if (isIdentifierStart(c))
+        {
+          std::size_t start = pos_;
+          while (pos_ < source_.size() && (isIdentifierStart(source_[pos_]) || (source_[pos_] >= '0' && source_[pos_] <= '9')))
+            ++pos_;
+          std::string name = source_.substr(start, pos_ - start);
+          auto found = std::find(variables_.begin(), variables_.end(), name);
+          if (found == variables_.end())
+          {
+            variables_.push_back(name);
+            found = variables_.end() - 1;
+          }
+          return graph_.makeVar(static_cast<uint32_t>(found - variables_.begin()));
+        }
+        return fail("unexpected '" + std::string(1, c) + "'");
+      }
+
+      int parseNumber()
+      {
+        std::size_t start = pos_;
+        int base = 10;
+        if (source_.compare(pos_, 2, "0x") == 0 || source_.compare(pos_, 2, "0X") == 0)
+          base = 16;
+        else if (source_.compare(pos_, 2, "0b") == 0 || source_.compare(pos_, 2, "0B") == 0)
+          base = 2;
+        if (base != 10)
+          pos_ += 2;
+
+        uint32_t value = 0;
+        const char *first = source_.data() + pos_;
+        const char *last = source_.data() + source_.size();
+        std::from_chars_result parsed = std::from_chars(first, last, value, base);
+        if (parsed.ec != std::errc() || parsed.ptr == first)
+        {
+          pos_ = start;
+          return fail(parsed.ec == std::errc::result_out_of_range ? "literal does not fit in 32 bits" : "invalid literal");
+        }
+        pos_ += parsed.ptr - first;
+        if (pos_ < source_.size() && (isIdentifierStart(source_[pos_]) || (source_[pos_] >= '0' && source_[pos_] <= '9')))
+          return fail("invalid literal");
+        return graph_.makeConst(value);
+      }
+
+      static bool isIdentifierStart(char c)
+      {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+      }
+
+      void skipSpace()
+      {
+        while (pos_ < source_.size() && (source_[pos_] == ' ' || source_[pos_] == '\t'))
+          ++pos_;
+      }
+
+      bool accept(const char *token)
+      {
+        skipSpace();
+        std::size_t length = std::char_traits<char>::length(token);
+        if (source_.compare(pos_, length, token) != 0)
+          return false;
+        pos_ += length;
+        return true;
+      }
+
+      bool ok() const { return error_.empty(); }
+
+      int fail(const std::string &message)
+      {
+        if (error_.empty())
+          error_ = message + " at column " + std::to_string(pos_ + 1);
+        return 0;
+      }
+
+      const std::string &source_;
+      GraphBuilder &graph_;
+      std::vector<std::string> &variables_;
+      std::size_t pos_ = 0;
+      std::string error_;
+    };
+
+    ExpressionPlan::Opcode opcodeFor(NodeKind kind)
+    {
+      switch (kind)
+      {
+      case NodeKind::And:
+        return ExpressionPlan::Opcode::And;
+      case NodeKind::Or:
+        return ExpressionPlan::Opcode::Or;
+      case NodeKind::Xor:
+        return ExpressionPlan::Opcode::Xor;
+      case NodeKind::Not:
+        return ExpressionPlan::Opcode::Not;
+      case NodeKind::Shl:
+        return ExpressionPlan::Opcode::Shl;
+      default:
+        return ExpressionPlan::Opcode::Shr;
+      }
+    }
+
+    uint32_t applyScalar(ExpressionPlan::Opcode opcode, uint32_t a, uint32_t b)
+    {
+      switch (opcode)
+      {
+      case ExpressionPlan::Opcode::And:
+        return a & b;
+      case ExpressionPlan::Opcode::Or:
+        return a | b;
+      case ExpressionPlan::Opcode::Xor:
+        return a ^ b;
+      case ExpressionPlan::Opcode::Not:
+        return ~a;
+      case ExpressionPlan::Opcode::Shl:
+        return shiftLeft(a, b);
+      case ExpressionPlan::Opcode::Shr:
+        return shiftRight(a, b);
+      }
+      return 0;
+    }
+
+    // Block kernel for one instruction once its operands are resolved. Register/column
+    // operands arrive as pointers; an immediate arrives with a null pointer and its value.
+    void runBlock(ExpressionPlan::Opcode opcode, uint32_t *dst, std::size_t n,
+                  const uint32_t *a, uint32_t aImm, const uint32_t *b, uint32_t bImm)
+    {
+      using Opcode = ExpressionPlan::Opcode;
+      if (opcode == Opcode::Not)
+      {
+        bitwiseNot(dst, a, n);
+        return;
+      }
+      if (a && b)
+      {
+        switch (opcode)
+        {
+        case Opcode::And:
+          bitwiseAnd(dst, a, b, n);
+          return;
+        case Opcode::Or:
+          bitwiseOr(dst, a, b, n);
+          return;
+        case Opcode::Xor:
+          bitwiseXor(dst, a, b, n);
+          return;
+        case Opcode::Shl:
+          for (std::size_t i = 0; i < n; ++i)
+            dst[i] = shiftLeft(a[i], b[i]);
+          return;
+        default:
+          for (std::size_t i = 0; i < n; ++i)
+            dst[i] = shiftRight(a[i], b[i]);
+          return;
+        }
+      }
+      if (a)
+      {
+        // Immediate right operand; shift counts here are already known to be 1-31
+        switch (opcode)
+        {
+        case Opcode::And:
+          for (std::size_t i = 0; i < n; ++i)
+            dst[i] = a[i] & bImm;
+          return;
+        case Opcode::Or:
+          for (std::size_t i = 0; i < n; ++i)
+            dst[i] = a[i] | bImm;
+          return;
+        case Opcode::Xor:
+          for (std::size_t i = 0; i < n; ++i)
+            dst[i] = a[i] ^ bImm;
+          return;
+        case Opcode::Shl:
+          for (std::size_t i = 0; i < n; ++i)
+            dst[i] = a[i] << bImm;
+          return;
+        default:
+          for (std::size_t i = 0; i < n; ++i)
+            dst[i] = a[i] >> bImm;
+          return;
+        }
+      }
+      // Immediate left operand only happens for shifts such as "1 << a"
+      for (std::size_t i = 0; i < n; ++i)
+        dst[i] = applyScalar(opcode, aImm, b[i]);
+    }
+
+    void describeOperand(std::string &out, const ExpressionPlan::Operand &operand, const std::vector<std::string> &variables)
+    {
+      switch (operand.kind)
+      {
+      case ExpressionPlan::OperandKind::Register:
+        out += "r" + std::to_string(operand.value);
+        break;
+      case ExpressionPlan::OperandKind::Column:
+        out += variables[operand.value];
+        break;
+      case ExpressionPlan::OperandKind::Immediate:
+        out += std::to_string(operand.value);
+        break;
+      }
+    }
+  } // namespace
+
+  bool ExpressionPlan::compile(const std::string &source, ExpressionPlan &plan, std::string &error)
+  {
+    GraphBuilder graph;
+    std::vector<std::string> variables;
+    int root = 0;
+    Parser parser(source, graph, variables);
+    if (!parser.parse(root, error))
+    {
+      return false;
+    }
+
+    // Keep only nodes reachable from the root; ids are already in dependency order
+    std::vector<bool> live(graph.nodes.size(), false);
+    std::vector<int> lastUse(graph.nodes.size(), -1);
+    live[root] = true;
+    for (int id = root; id >= 0; --id)
+    {
+      if (!live[id])
+        continue;
+      const Node &node = graph.nodes[id];
+      if (node.lhs >= 0)
+      {
+        live[node.lhs] = true;
+        lastUse[node.lhs] = std::max(lastUse[node.lhs], id);
+      }
+      if (node.rhs >= 0)
+      {
+        live[node.rhs] = true;
+        lastUse[node.rhs] = std::max(lastUse[node.rhs], id);
+      }
+    }
+
+    ExpressionPlan result;
+    result.variables_ = std::move(variables);
+    std::vector<Operand> location(graph.nodes.size());
+    std::vector<uint32_t> freeRegisters;
+
+    for (int id = 0; id <= root; ++id)
+    {
+      if (!live[id])
+        continue;
+      const Node &node = graph.nodes[id];
+      if (node.kind == NodeKind::Const)
+      {
+        location[id] = {OperandKind::Immediate, node.value};
+        continue;
+      }
+      if (node.kind == NodeKind::Var)
+      {
+        location[id] = {OperandKind::Column, node.value};
+        continue;
+      }
+
+      Instruction instruction;
+      instruction.opcode = opcodeFor(node.kind);
+      instruction.lhs = location[node.lhs];
+      if (node.rhs >= 0)
+        instruction.rhs = location[node.rhs];
+
+      // Every kernel is element-wise, so an operand's register can be reused as the destination
+      for (int operand : {node.lhs, node.rhs})
+      {
+        if (operand >= 0 && lastUse[operand] == id && location[operand].kind == OperandKind::Register &&
+            std::find(freeRegisters.begin(), freeRegisters.end(), location[operand].value) == freeRegisters.end())
+          freeRegisters.push_back(location[operand].value);
+      }
+
+      if (id == root)
+      {
+        instruction.dst = kOutputRegister;
+      }
+      else if (!freeRegisters.empty())
+      {
+        instruction.dst = freeRegisters.back();
+        freeRegisters.pop_back();
+      }
+      else
+      {
+        instruction.dst = static_cast<uint32_t>(result.registerCount_++);
+      }
+      location[id] = {OperandKind::Register, instruction.dst};
+      result.instructions_.push_back(instruction);
+    }
+
+    result.result_ = location[root];
+    plan = std::move(result);
+    return true;
+  }
+
+  void ExpressionPlan::execute(const uint32_t *const *columns, uint32_t *out, std::size_t length) const
+  {
+    BITWISE_STATS_SCOPE(ExpressionExecute, length * sizeof(uint32_t));
+    if (instructions_.empty())
+    {
+      // Bare constant or bare variable
+      for (std::size_t i = 0; i < length; ++i)
+        out[i] = result_.kind == OperandKind::Immediate ? result_.value : columns[result_.value][i];
+      return;
+    }
+
+    std::vector<uint32_t> registers(registerCount_ * kBlockSize);
+    for (std::size_t start = 0; start < length; start += kBlockSize)
+    {
+      std::size_t n = std::min(kBlockSize, length - start);
+      auto resolve = [&](const Operand &operand) -> const uint32_t *
+      {
+        switch (operand.kind)
+        {
+        case OperandKind::Register:
+          return registers.data() + operand.value * kBlockSize;
+        case OperandKind::Column:
+          return columns[operand.value] + start;
+        case OperandKind::Immediate:
+          break;
+        }
+        return nullptr;
+      };
+
+      for (const Instruction &instruction : instructions_)
+      {
+        uint32_t *dst = instruction.dst == kOutputRegister ? out + start
+                                                           : registers.data() + instruction.dst * kBlockSize;
+        runBlock(instruction.opcode, dst, n,
+                 resolve(instruction.lhs), instruction.lhs.value,
+                 resolve(instruction.rhs), instruction.rhs.value);
+      }
+    }
+  }
+
+  uint32_t ExpressionPlan::evaluate(const uint32_t *values) const
+  {
+    std::vector<uint32_t> registers(registerCount_ + 1);
+    auto read = [&](const Operand &operand)
+    {
+      switch (operand.kind)
+      {
+      case OperandKind::Register:
+        return operand.value == kOutputRegister ? registers[registerCount_] : registers[operand.value];
+      case OperandKind::Column:
+        return values[operand.value];
+      case OperandKind::Immediate:
+        break;
+      }
+      return operand.value;
+    };
+
+    if (instructions_.empty())
+      return read(result_);
+    for (const Instruction &instruction : instructions_)
+    {
+      uint32_t value = applyScalar(instruction.opcode, read(instruction.lhs), read(instruction.rhs));
+      registers[instruction.dst == kOutputRegister ? registerCount_ : instruction.dst] = value;
+    }
+    return registers[registerCount_];
+  }
+
+  std::string ExpressionPlan::describe() const
+  {
+    static const char *const symbols[] = {"&", "|", "^", "~", "<<", ">>"};
+    std::string out;
+    if (instructions_.empty())
+    {
+      out += "out = ";
+      describeOperand(out, result_, variables_);
+      out += "\n";
+      return out;
+    }
+    for (const Instruction &instruction : instructions_)
+    {
+      out += instruction.dst == kOutputRegister ? "out" : "r" + std::to_string(instruction.dst);
+      out += " = ";
+      if (instruction.opcode == Opcode::Not)
+      {
+        out += "~";
+        describeOperand(out, instruction.lhs, variables_);
+      }
+      else
+      {
+        describeOperand(out, instruction.lhs, variables_);
+        out += std::string(" ") + symbols[static_cast<int>(instruction.opcode)] + " ";
+        describeOperand(out, instruction.rhs, variables_);
+      }
+      out += "\n";
+    }
+    return out;
+  }
+
+} // namespace bitwise
@@ -0,0 +1,176 @@
+#include "bitwise_parallel.h"
+#include "bitwise_stats.h"
+#include "bitwise_bulk.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sys/mman.h>
+#include <vector>
+
+namespace bitwise
+{
+  namespace
+  {
+    // Below this many tasks the wake-up cost outweighs the extra bandwidth
+    constexpr std::size_t kMinParallelTasks = 4;
+
+    std::mutex &defaultPoolMutex()
+    {
+      static std::mutex mutex;
+      return mutex;
+    }
+
+    std::unique_ptr<ThreadPool> &defaultPoolSlot()
+    {
+      static std::unique_ptr<ThreadPool> pool;
+      return pool;
+    }
+
+    std::size_t taskCount(std::size_t length)
+    {
+      return (length + kParallelGrainWords - 1) / kParallelGrainWords;
+    }
+
+    // Runs body(first, last) over grain-sized word ranges, inline when the buffer is small
+    template <typename Body>
+    void forEachGrain(ThreadPool &pool, std::size_t length, Body body)
+    {
+      std::size_t tasks = taskCount(length);
+      if (tasks < kMinParallelTasks || pool.threadCount() == 1)
+      {
+        body(std::size_t(0), length);
+        return;
+      }
+      pool.parallelFor(tasks, [&](std::size_t task)
+                       {
+        std::size_t first = task * kParallelGrainWords;
+        body(first, std::min(length, first + kParallelGrainWords)); });
+    }
+  } // namespace
+
+  void setParallelThreads(unsigned threads)
+  {
+    std::lock_guard<std::mutex> lock(defaultPoolMutex());
+    defaultPoolSlot() = std::make_unique<ThreadPool>(threads);
+  }
+
+  ThreadPool &defaultThreadPool()
+  {
+    std::lock_guard<std::mutex> lock(defaultPoolMutex());
+    std::unique_ptr<ThreadPool> &pool = defaultPoolSlot();
+    if (!pool)
+    {
+      pool = std::make_unique<ThreadPool>();
+    }
+    return *pool;
+  }
+
+  void parallelAnd(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length, ThreadPool &pool)
+  {
+    BITWISE_STATS_SCOPE(ParallelAnd, 3 * length * sizeof(uint32_t));
+    forEachGrain(pool, length, [&](std::size_t first, std::size_t last)
+                 { bitwiseAnd(dst + first, srcA + first, srcB + first, last - first); });
+  }
+
+  void parallelOr(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length, ThreadPool &pool)
+  {
+    BITWISE_STATS_SCOPE(ParallelOr, 3 * length * sizeof(uint32_t));
+    forEachGrain(pool, length, [&](std::size_t first, std::size_t last)
+                 { bitwiseOr(dst + first, srcA + first, srcB + first, last - first); });
+  }
+
+  void parallelXor(uint32_t *dst, const uint32_t *srcA, const uint32_t *srcB, std::size_t length, ThreadPool &pool)
+  {
+    BITWISE_STATS_SCOPE(ParallelXor, 3 * length * sizeof(uint32_t));
+    forEachGrain(pool, length, [&](std::size_t first, std::size_t last)
+                 { bitwiseXor(dst + first, srcA + first, srcB + first, last - first); });
+  }
+
+  void parallelNot(uint32_t *dst, const uint32_t *src, std::size_t length, ThreadPool &pool)
+  {
+    BITWISE_STATS_SCOPE(ParallelNot, 2 * length * sizeof(uint32_t));
+    forEachGrain(pool, length, [&](std::size_t first, std::size_t last)
+                 { bitwiseNot(dst + first, src + first, last - first); });
+  }
+
+  uint64_t parallelCountSetBits(const uint32_t *data, std::size_t length, ThreadPool &pool)
+  {
+    BITWISE_STATS_SCOPE(ParallelCountSetBits, length * sizeof(uint32_t));
+    // One slot per task, each written once, so sharing cache lines costs nothing measurable
+    std::vector<uint64_t> partial(std::max<std::size_t>(1, taskCount(length)), 0);
+    forEachGrain(pool, length, [&](std::size_t first, std::size_t last)
+                 { partial[first / kParallelGrainWords] = countSetBits(data + first, last - first); });
+    uint64_t total = 0;
+    for (uint64_t count : partial)
+      total += count;
+    return total;
+  }
+
+  void parallelLeftShift(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits, ThreadPool &pool)
+  {
+    BITWISE_STATS_SCOPE(ParallelLeftShift, 2 * length * sizeof(uint32_t));
+    forEachGrain(pool, length, [&](std::size_t first, std::size_t last)
+                 { leftShiftRange(dst, src, length, bits, first, last); });
+  }
+
+  void parallelRightShift(uint32_t *dst, const uint32_t *src, std::size_t length, std::size_t bits, ThreadPool &pool)
+  {
+    BITWISE_STATS_SCOPE(ParallelRightShift, 2 * length * sizeof(uint32_t));
+    forEachGrain(pool, length, [&](std::size_t first, std::size_t last)
+                 { rightShiftRange(dst, src, length, bits, first, last); });
+  }
+
+  ParallelBuffer::ParallelBuffer(std::size_t length, ThreadPool &pool) : length_(length)
+  {
+    if (length == 0)
+      return;
+    void *memory = ::mmap(nullptr, length * sizeof(uint32_t), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+      length_ = 0;
+      throw std::bad_alloc();
+    }
+    data_ = static_cast<uint32_t *>(memory);
+    // Fresh anonymous pages already read as zero; the write is what assigns each page to a node
+    forEachGrain(pool, length, [&](std::size_t first, std::size_t last)
+                 { std::memset(data_ + first, 0, (last - first) * sizeof(uint32_t)); });
+  }
+
+  ParallelBuffer::~ParallelBuffer()
+  {
+    release();
+  }
+
+  ParallelBuffer::ParallelBuffer(ParallelBuffer &&other) noexcept : data_(other.data_), length_(other.length_)
+  {
+    other.data_ = nullptr;
+    other.length_ = 0;
+  }
+
+  ParallelBuffer &ParallelBuffer::operator=(ParallelBuffer &&other) noexcept
+  {
+    if (this != &other)
+    {
+      release();
+      data_ = other.data_;
+      length_ = other.length_;
+      other.data_ = nullptr;
+      other.length_ = 0;
+    }
+    return *this;
+  }
+
+  void ParallelBuffer::release()
+  {
+    if (data_ != nullptr)
+    {
+      ::munmap(data_, length_ * sizeof(uint32_t));
+      data_ = nullptr;
+      length_ = 0;
+    }
+  }
+
+} // namespace bitwise
@@ -0,0 +1,722 @@
+#include "bitwise_service.h"
+#include "bitwise_stats.h"
+#include "bitwise_utils.h"
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace bitwise
+{
+  namespace service
+  {
+    namespace
+    {
+      constexpr std::size_t kReadChunk = 64 * 1024;   // free input space guaranteed before each read
+      constexpr std::size_t kMaxBacklog = 1 << 20;    // unsent output above which reading pauses
+      constexpr int kMaxEvents = 64;
+
+      void put32(std::vector<uint8_t> &out, uint32_t value)
+      {
+        uint8_t bytes[4] = {static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8),
+                            static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24)};
+        out.insert(out.end(), bytes, bytes + 4);
+      }
+
+      void store32(uint8_t *out, uint32_t value)
+      {
+        out[0] = static_cast<uint8_t>(value);
+        out[1] = static_cast<uint8_t>(value >> 8);
+        out[2] = static_cast<uint8_t>(value >> 16);
+        out[3] = static_cast<uint8_t>(value >> 24);
+      }
+
+      uint32_t load32(const uint8_t *in)
+      {
+        return uint32_t(in[0]) | (uint32_t(in[1]) << 8) | (uint32_t(in[2]) << 16) | (uint32_t(in[3]) << 24);
+      }
+
+      uint16_t load16(const uint8_t *in)
+      {
+        return static_cast<uint16_t>(in[0] | (in[1] << 8));
+      }
+
+      // Header with a zero payload length, patched by finishFrame once the payload is known
+      std::size_t beginFrame(std::vector<uint8_t> &out, uint32_t id, uint8_t op, uint8_t third, uint16_t count)
+      {
+        std::size_t start = out.size();
+        put32(out, 0);
+        put32(out, id);
+        uint8_t tail[4] = {op, third, static_cast<uint8_t>(count), static_cast<uint8_t>(count >> 8)};
+        out.insert(out.end(), tail, tail + 4);
+        return start;
+      }
+
+      void finishFrame(std::vector<uint8_t> &out, std::size_t start)
+      {
+        store32(out.data() + start, static_cast<uint32_t>(out.size() - start - kHeaderSize));
+      }
+
+      void putText(std::vector<uint8_t> &out, const char *text, std::size_t length)
+      {
+        put32(out, static_cast<uint32_t>(length));
+        out.insert(out.end(), text, text + length);
+      }
+
+      void badRequest(std::vector<uint8_t> &out, uint32_t id, uint8_t op, const char *message)
+      {
+        std::size_t start = beginFrame(out, id, op, static_cast<uint8_t>(Status::BadRequest), 1);
+        putText(out, message, std::strlen(message));
+        finishFrame(out, start);
+      }
+
+      bool isBitIndexOp(Op op)
+      {
+        return op == Op::Shl || op == Op::Shr || op == Op::IsSet || op == Op::Set || op == Op::Clear ||
+               op == Op::Toggle;
+      }
+
+      bool hasVisualizer(Op op)
+      {
+        return op == Op::And || op == Op::Or || op == Op::Xor || op == Op::Not || op == Op::Shl || op == Op::Shr;
+      }
+
+      uint32_t evaluate(Op op, uint32_t a, uint32_t b)
+      {
+        int index = static_cast<int>(b);
+        switch (op)
+        {
+        case Op::And:
+          return bitwiseAnd(a, b);
+        case Op::Or:
+          return bitwiseOr(a, b);
+        case Op::Xor:
+          return bitwiseXor(a, b);
+        case Op::Not:
+          return bitwiseNot(a);
+        case Op::Shl:
+          return leftShift(a, index);
+        case Op::Shr:
+          return rightShift(a, index);
+        case Op::Popcnt:
+          return static_cast<uint32_t>(countSetBits(a));
+        case Op::IsSet:
+          return isBitSet(a, index) ? 1 : 0;
+        case Op::Set:
+          return setBit(a, index);
+        case Op::Clear:
+          return clearBit(a, index);
+        case Op::Toggle:
+          return toggleBit(a, index);
+        default:
+          return 0;
+        }
+      }
+
+      void render(RenderSink &sink, Op op, uint32_t a, uint32_t b)
+      {
+        uint32_t result = evaluate(op, a, b);
+        switch (op)
+        {
+        case Op::And:
+          displayBitwiseOperation(sink, a, b, "AND", result);
+          break;
+        case Op::Or:
+          displayBitwiseOperation(sink, a, b, "OR", result);
+          break;
+        case Op::Xor:
+          displayBitwiseOperation(sink, a, b, "XOR", result);
+          break;
+        case Op::Not:
+          displayBitwiseNotOperation(sink, a, result);
+          break;
+        case Op::Shl:
+          displayShiftOperation(sink, a, static_cast<int>(b), result, "LEFT");
+          break;
+        case Op::Shr:
+          displayShiftOperation(sink, a, static_cast<int>(b), result, "RIGHT");
+          break;
+        default:
+          break;
+        }
+      }
+
+      std::string describeError(const char *what, const std::string &target, int err)
+      {
+        return std::string(what) + " " + target + ": " + std::strerror(err);
+      }
+
+      bool fillUnixAddress(const std::string &path, sockaddr_un &address, std::string &error)
+      {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+        {
+          error = "socket path too long: " + path;
+          return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+      }
+
+      addrinfo *resolve(const Address &address, bool passive, std::string &error)
+      {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = passive ? AI_PASSIVE : 0;
+        addrinfo *results = nullptr;
+        std::string port = std::to_string(address.port);
+        int status = getaddrinfo(address.host.c_str(), port.c_str(), &hints, &results);
+        if (status != 0)
+        {
+          error = "cannot resolve " + address.host + ": " + gai_strerror(status);
+          return nullptr;
+        }
+        return results;
+      }
+    } // namespace
+
+    uint32_t Response::number(std::size_t i) const
+    {
+      return load32(payload + 4 * i);
+    }
+
+    std::vector<std::string> Response::texts() const
+    {
+      std::vector<std::string> result;
+      const uint8_t *in = payload, *end = payload + payloadSize;
+      while (end - in >= 4)
+      {
+        std::size_t length = load32(in);
+        in += 4;
+        if (static_cast<std::size_t>(end - in) < length)
+          break;
+        result.emplace_back(reinterpret_cast<const char *>(in), length);
+        in += length;
+      }
+      return result;
+    }
+
+    void appendRequest(std::vector<uint8_t> &out, uint32_t id, Op op, uint8_t flags, const uint32_t *operands,
+                       uint16_t count)
+    {
+      std::size_t start = beginFrame(out, id, static_cast<uint8_t>(op), flags, count);
+      for (std::size_t i = 0; i < 2 * std::size_t(count); ++i)
+        put32(out, operands[i]);
+      finishFrame(out, start);
+    }
+
+    std::size_t parseResponse(const uint8_t *data, std::size_t size, Response &response)
+    {
+      if (size < kHeaderSize)
+        return 0;
+      uint32_t payloadSize = load32(data);
+      if (size - kHeaderSize < payloadSize)
+        return 0;
+      response.id = load32(data + 4);
+      response.op = static_cast<Op>(data[8]);
+      response.status = static_cast<Status>(data[9]);
+      response.count = load16(data + 10);
+      response.payload = data + kHeaderSize;
+      response.payloadSize = payloadSize;
+      return kHeaderSize + payloadSize;
+    }
+
+    std::size_t Session::process(const uint8_t *data, std::size_t size, std::vector<uint8_t> &out,
+                                 std::size_t outputLimit)
+    {
+      std::size_t consumed = 0;
+      while (!failed_ && size - consumed >= kHeaderSize && out.size() < outputLimit)
+      {
+        const uint8_t *frame = data + consumed;
+        const std::size_t payloadSize = load32(frame);
+        if (payloadSize > kMaxRequestPayload)
+        {
+          // The length itself is garbage, so there is no next frame to find
+          badRequest(out, load32(frame + 4), frame[8], "request payload too large");
+          failed_ = true;
+          return size;
+        }
+        if (size - consumed - kHeaderSize < payloadSize)
+          break;
+        answer(frame, out);
+        consumed += kHeaderSize + payloadSize;
+      }
+      return consumed;
+    }
+
+    void Session::answer(const uint8_t *frame, std::vector<uint8_t> &out)
+    {
+      const uint32_t payloadSize = load32(frame);
+      BITWISE_STATS_SCOPE(ServiceRequest, kHeaderSize + payloadSize);
+      const uint32_t id = load32(frame + 4);
+      const uint8_t code = frame[8];
+      const uint8_t flags = frame[9];
+      const uint16_t count = load16(frame + 10);
+      const uint8_t *items = frame + kHeaderSize;
+      const Op op = static_cast<Op>(code);
+
+      if (code < static_cast<uint8_t>(Op::And) || code > static_cast<uint8_t>(Op::BaseTable))
+        return badRequest(out, id, code, "unknown operation");
+      if ((flags & ~kFlagRender) != 0)
+        return badRequest(out, id, code, "unknown flags");
+      if (payloadSize != 8 * std::size_t(count))
+        return badRequest(out, id, code, "payload size does not match item count");
+      const bool rendered = (flags & kFlagRender) != 0;
+      if (rendered && !hasVisualizer(op))
+        return badRequest(out, id, code, "operation has no visualizer");
+      if ((rendered || op == Op::BaseTable) && count > kMaxRenderItems)
+        return badRequest(out, id, code, "too many rendered items (at most 64)");
+
+      // Every item is checked before any result is written, so a frame fails as a whole
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        uint32_t a = load32(items + 8 * i), b = load32(items + 8 * i + 4);
+        if (isBitIndexOp(op) && b > 31)
+          return badRequest(out, id, code, "bit index out of range (0-31)");
+        if (op == Op::BaseTable && (a > 64 || b < 2 || b > 36))
+          return badRequest(out, id, code, "base table needs length 0-64 and basis 2-36");
+      }
+
+      std::size_t start = beginFrame(out, id, code, static_cast<uint8_t>(Status::Ok), count);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        uint32_t a = load32(items + 8 * i), b = load32(items + 8 * i + 4);
+        if (op == Op::Bin || op == Op::Hex)
+        {
+          char text[kMaxBinaryChars];
+          std::to_chars_result written = op == Op::Bin ? toBinaryChars(text, text + sizeof(text), a)
+                                                       : toHexChars(text, text + sizeof(text), a);
+          putText(out, text, static_cast<std::size_t>(written.ptr - text));
+        }
+        else if (rendered || op == Op::BaseTable)
+        {
+          render_.clear();
+          if (op == Op::BaseTable)
+            displayBaseTable(render_, static_cast<int>(a), static_cast<int>(b));
+          else
+            render(render_, op, a, b);
+          putText(out, render_.str().data(), render_.str().size());
+        }
+        else
+        {
+          put32(out, evaluate(op, a, b));
+        }
+      }
+      finishFrame(out, start);
+    }
+
+    bool parseAddress(const std::string &text, Address &address, std::string &error)
+    {
+      Address parsed;
+      if (text.compare(0, 5, "unix:") == 0)
+      {
+        parsed.unixPath = text.substr(5);
+        if (parsed.unixPath.empty())
+        {
+          error = "missing socket path in " + text;
+          return false;
+        }
+        address = parsed;
+        return true;
+      }
+
+      std::size_t colon = text.rfind(':');
+      std::string port = text;
+      if (colon != std::string::npos)
+      {
+        parsed.host = text.substr(0, colon);
+        port = text.substr(colon + 1);
+      }
+      const char *last = port.data() + port.size();
+      std::from_chars_result result = std::from_chars(port.data(), last, parsed.port);
+      if (parsed.host.empty() || port.empty() || result.ec != std::errc() || result.ptr != last)
+      {
+        error = "invalid address " + text + " (expected unix:PATH, HOST:PORT or PORT)";
+        return false;
+      }
+      address = parsed;
+      return true;
+    }
+
+    int connectTo(const Address &address, std::string &error)
+    {
+      if (!address.unixPath.empty())
+      {
+        sockaddr_un local;
+        if (!fillUnixAddress(address.unixPath, local, error))
+          return -1;
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr *>(&local), sizeof(local)) != 0)
+        {
+          error = describeError("cannot connect to", address.unixPath, errno);
+          if (fd >= 0)
+            ::close(fd);
+          return -1;
+        }
+        return fd;
+      }
+
+      addrinfo *results = resolve(address, false, error);
+      if (results == nullptr)
+        return -1;
+      int fd = -1, err = 0;
+      for (addrinfo *ai = results; ai != nullptr && fd < 0; ai = ai->ai_next)
+      {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd >= 0 && ::connect(fd, ai->ai_addr, ai->ai_addrlen) != 0)
+        {
+          err = errno;
+          ::close(fd);
+          fd = -1;
+        }
+      }
+      freeaddrinfo(results);
+      if (fd < 0)
+      {
+        error = describeError("cannot connect to", address.host + ":" + std::to_string(address.port), err);
+        return -1;
+      }
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      return fd;
+    }
+
+    struct Server::Connection
+    {
+      explicit Connection(int socket) : fd(socket), in(kReadChunk) {}
+
+      int fd;
+      Session session;
+      std::vector<uint8_t> in; // received bytes, in[0, inUsed) not yet answered
+      std::size_t inUsed = 0;
+      std::vector<uint8_t> out; // responses, out[outSent, size) not yet written
+      std::size_t outSent = 0;
+      uint32_t events = EPOLLIN;
+    };
+
+    Server::Server()
+        : epollFd_(epoll_create1(EPOLL_CLOEXEC)), wakeFd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    {
+      if (epollFd_ >= 0 && wakeFd_ >= 0)
+      {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = wakeFd_;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event);
+      }
+    }
+
+    Server::~Server()
+    {
+      for (std::unique_ptr<Connection> &connection : connections_)
+      {
+        if (connection)
+          ::close(connection->fd);
+      }
+      closeListener();
+      for (int fd : {epollFd_, wakeFd_})
+      {
+        if (fd >= 0)
+          ::close(fd);
+      }
+    }
+
+    bool Server::listen(const Address &address, std::string &error)
+    {
+      if (epollFd_ < 0 || wakeFd_ < 0)
+      {
+        error = describeError("cannot create the event loop", "descriptors", errno);
+        return false;
+      }
+      if (listenFd_ >= 0)
+      {
+        error = "server is already listening";
+        return false;
+      }
+
+      if (!address.unixPath.empty())
+      {
+        sockaddr_un local;
+        if (!fillUnixAddress(address.unixPath, local, error))
+          return false;
+        // Replace the socket file a previous server left behind, but nothing else
+        struct stat existing;
+        if (lstat(address.unixPath.c_str(), &existing) == 0)
+        {
+          if (!S_ISSOCK(existing.st_mode))
+          {
+            error = address.unixPath + " exists and is not a socket";
+            return false;
+          }
+          unlink(address.unixPath.c_str());
+        }
+        listenFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd_ < 0 || bind(listenFd_, reinterpret_cast<sockaddr *>(&local), sizeof(local)) != 0)
+        {
+          error = describeError("cannot bind", address.unixPath, errno);
+          closeListener();
+          return false;
+        }
+        unixPath_ = address.unixPath;
+      }
+      else
+      {
+        addrinfo *results = resolve(address, true, error);
+        if (results == nullptr)
+          return false;
+        int err = 0;
+        for (addrinfo *ai = results; ai != nullptr && listenFd_ < 0; ai = ai->ai_next)
+        {
+          listenFd_ = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+          int one = 1;
+          if (listenFd_ >= 0)
+            setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+          if (listenFd_ >= 0 && bind(listenFd_, ai->ai_addr, ai->ai_addrlen) != 0)
+          {
+            err = errno;
+            ::close(listenFd_);
+            listenFd_ = -1;
+          }
+        }
+        freeaddrinfo(results);
+        if (listenFd_ < 0)
+        {
+          error = describeError("cannot bind", address.host + ":" + std::to_string(address.port), err);
+          return false;
+        }
+        sockaddr_storage bound{};
+        socklen_t length = sizeof(bound);
+        getsockname(listenFd_, reinterpret_cast<sockaddr *>(&bound), &length);
+        port_ = ntohs(bound.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6 *>(&bound)->sin6_port
+                                                  : reinterpret_cast<sockaddr_in *>(&bound)->sin_port);
+      }
+
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.fd = listenFd_;
+      if (::listen(listenFd_, SOMAXCONN) != 0 || epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &event) != 0)
+      {
+        error = describeError("cannot listen on", unixPath_.empty() ? address.host : unixPath_, errno);
+        closeListener();
+        return false;
+      }
+      return true;
+    }
+
+    void Server::closeListener()
+    {
+      if (listenFd_ >= 0)
+        ::close(listenFd_);
+      listenFd_ = -1;
+      if (!unixPath_.empty())
+        unlink(unixPath_.c_str());
+      unixPath_.clear();
+      port_ = 0;
+    }
+
+    void Server::run()
+    {
+      epoll_event events[kMaxEvents];
+      while (true)
+      {
+        int ready = epoll_wait(epollFd_, events, kMaxEvents, -1);
+        if (ready < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return;
+        }
+        for (int i = 0; i < ready; ++i)
+        {
+          const int fd = events[i].data.fd;
+          if (fd == wakeFd_)
+          {
+            uint64_t count;
+            ssize_t drained = read(wakeFd_, &count, sizeof(count));
+            (void)drained;
+            return;
+          }
+          if (fd == listenFd_)
+          {
+            acceptAll();
+            continue;
+          }
+          if (static_cast<std::size_t>(fd) >= connections_.size() || !connections_[fd])
+            continue;
+          if (events[i].events & EPOLLERR)
+          {
+            close(fd);
+            continue;
+          }
+          if (events[i].events & EPOLLOUT)
+            onWritable(*connections_[fd]);
+          // onWritable may have closed the connection
+          if (connections_[fd] && (events[i].events & (EPOLLIN | EPOLLHUP)))
+            onReadable(*connections_[fd]);
+        }
+      }
+    }
+
+    void Server::stop()
+    {
+      uint64_t one = 1;
+      ssize_t written = write(wakeFd_, &one, sizeof(one));
+      (void)written;
+    }
+
+    void Server::acceptAll()
+    {
+      while (true)
+      {
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+          if (errno == EINTR || errno == ECONNABORTED)
+            continue;
+          if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM)
+          {
+            // The listener is level-triggered and would stay readable, so stop watching it
+            // until a session closes and frees a descriptor
+            epoll_event event{};
+            event.data.fd = listenFd_;
+            epoll_ctl(epollFd_, EPOLL_CTL_MOD, listenFd_, &event);
+            acceptPaused_ = true;
+          }
+          return; // EAGAIN once the backlog is empty
+        }
+        if (unixPath_.empty())
+        {
+          int one = 1;
+          setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+          ::close(fd);
+          continue;
+        }
+        if (static_cast<std::size_t>(fd) >= connections_.size())
+          connections_.resize(static_cast<std::size_t>(fd) + 1);
+        connections_[fd].reset(new Connection(fd));
+      }
+    }
+
+    void Server::onReadable(Connection &connection)
+    {
+      if (connection.in.size() - connection.inUsed < kReadChunk)
+        connection.in.resize(connection.inUsed + kReadChunk);
+      ssize_t received = recv(connection.fd, connection.in.data() + connection.inUsed,
+                              connection.in.size() - connection.inUsed, 0);
+      if (received <= 0)
+      {
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+          return;
+        close(connection.fd); // peer closed or the socket failed
+        return;
+      }
+      connection.inUsed += static_cast<std::size_t>(received);
+      if (serve(connection))
+        updateInterest(connection);
+    }
+
+    void Server::onWritable(Connection &connection)
+    {
+      if (!flush(connection))
+        return;
+      // Frames left over when the backlog filled up are answered once it drains
+      if (connection.out.size() - connection.outSent < kMaxBacklog && connection.inUsed > 0 && !serve(connection))
+        return;
+      updateInterest(connection);
+    }
+
+    bool Server::serve(Connection &connection)
+    {
+      // Answer complete frames until the backlog is full, then keep the rest at the front of the buffer
+      while (true)
+      {
+        std::size_t consumed = connection.session.process(connection.in.data(), connection.inUsed, connection.out,
+                                                          connection.outSent + kMaxBacklog);
+        connection.inUsed -= consumed;
+        std::memmove(connection.in.data(), connection.in.data() + consumed, connection.inUsed);
+        if (!flush(connection))
+          return false;
+        if (consumed == 0 || connection.out.size() - connection.outSent >= kMaxBacklog)
+          return true;
+      }
+    }
+
+    bool Server::flush(Connection &connection)
+    {
+      while (connection.outSent < connection.out.size())
+      {
+        ssize_t written = send(connection.fd, connection.out.data() + connection.outSent,
+                               connection.out.size() - connection.outSent, MSG_NOSIGNAL);
+        if (written < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return true;
+          close(connection.fd);
+          return false;
+        }
+        connection.outSent += static_cast<std::size_t>(written);
+      }
+      connection.out.clear(); // keeps its capacity for the next batch
+      connection.outSent = 0;
+      if (connection.session.failed())
+      {
+        close(connection.fd);
+        return false;
+      }
+      return true;
+    }
+
+    void Server::updateInterest(Connection &connection)
+    {
+      const std::size_t backlog = connection.out.size() - connection.outSent;
+      uint32_t wanted = 0;
+      if (backlog < kMaxBacklog && !connection.session.failed())
+        wanted |= EPOLLIN;
+      if (backlog > 0)
+        wanted |= EPOLLOUT;
+      if (wanted == connection.events)
+        return;
+      epoll_event event{};
+      event.events = wanted;
+      event.data.fd = connection.fd;
+      epoll_ctl(epollFd_, EPOLL_CTL_MOD, connection.fd, &event);
+      connection.events = wanted;
+    }
+
+    void Server::close(int fd)
+    {
+      epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+      ::close(fd);
+      connections_[fd].reset();
+      if (acceptPaused_)
+      {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = listenFd_;
+        epoll_ctl(epollFd_, EPOLL_CTL_MOD, listenFd_, &event);
+        acceptPaused_ = false;
+      }
+    }
+
+  } // namespace service
+} // namespace bitwise
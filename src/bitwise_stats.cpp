@@ -0,0 +1,227 @@
+#include "bitwise_stats.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace bitwise
+{
+  namespace stats
+  {
+    namespace detail
+    {
+      std::atomic<bool> enabledFlag{false};
+    }
+
+    namespace
+    {
+      constexpr const char *kOperationNames[] = {
+          "and", "or", "xor", "not", "shl", "shr", "popcount", "isBitSet", "setBit", "clearBit", "toggleBit",
+          "clz", "ctz", "rotate", "funnelShift", "reverseBits", "extractBits", "depositBits",
+          "bulk.and", "bulk.or", "bulk.xor", "bulk.not", "bulk.popcount", "bulk.shl", "bulk.shr", "bulk.rotate",
+          "bulk.setBits", "bulk.clearBits", "bulk.toggleBits", "bulk.testBits", "bulk.transpose",
+          "bulk.mortonEncode", "bulk.mortonDecode", "bulk.grayEncode", "bulk.grayDecode",
+          "parallel.and", "parallel.or", "parallel.xor", "parallel.not", "parallel.popcount", "parallel.shl",
+          "parallel.shr", "file.combine", "file.invert", "file.shift", "file.popcount", "expr.execute", "batch.run",
+          "roaring.and", "roaring.or", "roaring.xor", "roaring.andNot",
+          "bloom.insertMany", "bloom.containsMany", "service.request", "radix.convert"};
+      static_assert(sizeof(kOperationNames) / sizeof(kOperationNames[0]) == kOperationCount,
+                    "every operation needs a name");
+
+      // Written only by the owning thread (load + store, no locked instruction) and read by snapshot()
+      struct Slot
+      {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> timedCalls{0};
+        std::atomic<uint64_t> totalNanoseconds{0};
+        std::array<std::atomic<uint64_t>, kLatencyBuckets> latency{};
+      };
+
+      struct ThreadCounters
+      {
+        std::array<Slot, kOperationCount> slots;
+      };
+
+      inline void bump(std::atomic<uint64_t> &counter, uint64_t amount)
+      {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+      }
+
+      void accumulate(OperationStats &into, const Slot &slot)
+      {
+        into.calls += slot.calls.load(std::memory_order_relaxed);
+        into.bytes += slot.bytes.load(std::memory_order_relaxed);
+        into.timedCalls += slot.timedCalls.load(std::memory_order_relaxed);
+        into.totalNanoseconds += slot.totalNanoseconds.load(std::memory_order_relaxed);
+        for (std::size_t b = 0; b < kLatencyBuckets; ++b)
+          into.latency[b] += slot.latency[b].load(std::memory_order_relaxed);
+      }
+
+      struct Registry
+      {
+        std::mutex mutex;
+        std::vector<ThreadCounters *> live;
+        Snapshot retired;  // counters of threads that have exited
+        Snapshot baseline; // totals at the last reset()
+      };
+
+      // Never destroyed, so threads that exit during static destruction can still fold their counters in
+      Registry &registry()
+      {
+        static Registry *instance = new Registry();
+        return *instance;
+      }
+
+      struct ThreadHandle
+      {
+        ThreadCounters *counters = nullptr;
+
+        ~ThreadHandle()
+        {
+          if (counters == nullptr)
+            return;
+          Registry &r = registry();
+          std::lock_guard<std::mutex> lock(r.mutex);
+          for (std::size_t op = 0; op < kOperationCount; ++op)
+            accumulate(r.retired.operations[op], counters->slots[op]);
+          r.live.erase(std::find(r.live.begin(), r.live.end(), counters));
+          delete counters;
+        }
+      };
+
+      thread_local ThreadHandle threadHandle;
+
+      Slot &localSlot(Operation op)
+      {
+        ThreadCounters *counters = threadHandle.counters;
+        if (counters == nullptr)
+        {
+          counters = new ThreadCounters();
+          Registry &r = registry();
+          std::lock_guard<std::mutex> lock(r.mutex);
+          r.live.push_back(counters);
+          threadHandle.counters = counters;
+        }
+        return counters->slots[static_cast<std::size_t>(op)];
+      }
+
+      // Caller holds the registry mutex
+      Snapshot totals(Registry &r)
+      {
+        Snapshot total = r.retired;
+        for (ThreadCounters *counters : r.live)
+        {
+          for (std::size_t op = 0; op < kOperationCount; ++op)
+            accumulate(total.operations[op], counters->slots[op]);
+        }
+        return total;
+      }
+
+      std::size_t latencyBucket(uint64_t nanoseconds)
+      {
+        std::size_t bucket = nanoseconds == 0 ? 0 : static_cast<std::size_t>(64 - __builtin_clzll(nanoseconds));
+        return std::min(bucket, kLatencyBuckets - 1);
+      }
+    } // namespace
+
+    const char *operationName(Operation op)
+    {
+      std::size_t index = static_cast<std::size_t>(op);
+      return index < kOperationCount ? kOperationNames[index] : "unknown";
+    }
+
+    void setEnabled(bool enabled)
+    {
+      detail::enabledFlag.store(enabled, std::memory_order_relaxed);
+    }
+
+    void record(Operation op, uint64_t bytes)
+    {
+      Slot &slot = localSlot(op);
+      bump(slot.calls, 1);
+      bump(slot.bytes, bytes);
+    }
+
+    void recordTimed(Operation op, uint64_t bytes, uint64_t nanoseconds)
+    {
+      Slot &slot = localSlot(op);
+      bump(slot.calls, 1);
+      bump(slot.bytes, bytes);
+      bump(slot.timedCalls, 1);
+      bump(slot.totalNanoseconds, nanoseconds);
+      bump(slot.latency[latencyBucket(nanoseconds)], 1);
+    }
+
+    Snapshot snapshot()
+    {
+      Registry &r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      Snapshot total = totals(r);
+      for (std::size_t op = 0; op < kOperationCount; ++op)
+      {
+        OperationStats &stats = total.operations[op];
+        const OperationStats &base = r.baseline.operations[op];
+        stats.calls -= base.calls;
+        stats.bytes -= base.bytes;
+        stats.timedCalls -= base.timedCalls;
+        stats.totalNanoseconds -= base.totalNanoseconds;
+        for (std::size_t b = 0; b < kLatencyBuckets; ++b)
+          stats.latency[b] -= base.latency[b];
+      }
+      return total;
+    }
+
+    void reset()
+    {
+      // Counters are never cleared under their owners; the baseline is subtracted instead
+      Registry &r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      r.baseline = totals(r);
+    }
+
+    std::string toJson(const Snapshot &snapshot)
+    {
+      std::string json = "{\"compiled_in\":";
+      json += kCompiledIn ? "true" : "false";
+      json += ",\"enabled\":";
+      json += enabled() ? "true" : "false";
+      json += ",\"operations\":[";
+      bool first = true;
+      for (std::size_t op = 0; op < kOperationCount; ++op)
+      {
+        const OperationStats &stats = snapshot.operations[op];
+        if (stats.calls == 0)
+          continue;
+        json += first ? "" : ",";
+        first = false;
+        json += "{\"name\":\"";
+        json += kOperationNames[op];
+        json += "\",\"calls\":" + std::to_string(stats.calls);
+        json += ",\"bytes\":" + std::to_string(stats.bytes);
+        if (stats.timedCalls != 0)
+        {
+          json += ",\"total_ns\":" + std::to_string(stats.totalNanoseconds);
+          json += ",\"mean_ns\":" + std::to_string(stats.totalNanoseconds / stats.timedCalls);
+          // Only the occupied buckets, each with its exclusive upper bound
+          json += ",\"latency\":[";
+          bool firstBucket = true;
+          for (std::size_t b = 0; b < kLatencyBuckets; ++b)
+          {
+            if (stats.latency[b] == 0)
+              continue;
+            json += firstBucket ? "" : ",";
+            firstBucket = false;
+            json += "{\"lt_ns\":";
+            json += b + 1 < kLatencyBuckets ? std::to_string(uint64_t(1) << b) : "null";
+            json += ",\"count\":" + std::to_string(stats.latency[b]) + "}";
+          }
+          json += "]";
+        }
+        json += "}";
+      }
+      json += "]}";
+      return json;
+    }
+
+  } // namespace stats
+} // namespace bitwise
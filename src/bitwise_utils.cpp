@@ -1,245 +1,598 @@
 #include "bitwise_utils.h"
+#include "big_unsigned.h"
+#include "bitwise_cpu.h"
+#include "bitwise_generic.h"
+#include "bitwise_stats.h"
+#include "render_sink.h"
 #include <iostream>
-#include <iomanip>
-#include <sstream>
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITWISE_X86 1
+#endif
 
 namespace bitwise
 {
-  // default value of 32 bits...
-  std::string toBinaryString(uint32_t value, int bits)
+  namespace
   {
-    std::string result;
-    for (int i = bits - 1; i >= 0; --i)
+#if defined(BITWISE_X86) && !defined(__POPCNT__)
+    __attribute__((target("popcnt"))) int popcountHardware(uint32_t value)
+    {
+      return __builtin_popcount(value);
+    }
+
+    // Resolved once at load time so the per-call cost is a predictable branch
+    const bool kHasPopcnt = cpuFeatures().popcnt;
+#endif
+
+#if defined(BITWISE_X86) && !defined(__LZCNT__)
+    __attribute__((target("lzcnt"))) int leadingZerosHardware(uint32_t value)
+    {
+      return static_cast<int>(_lzcnt_u32(value));
+    }
+
+    const bool kHasLzcnt = cpuFeatures().lzcnt;
+#endif
+
+#if defined(BITWISE_X86) && !defined(__BMI__)
+    __attribute__((target("bmi"))) int trailingZerosHardware(uint32_t value)
+    {
+      return static_cast<int>(_tzcnt_u32(value));
+    }
+
+    const bool kHasBmi1 = cpuFeatures().bmi1;
+#endif
+
+#if defined(BITWISE_X86) && !defined(__BMI2__)
+    __attribute__((target("bmi2"))) uint32_t extractHardware(uint32_t value, uint32_t mask)
+    {
+      return _pext_u32(value, mask);
+    }
+
+    __attribute__((target("bmi2"))) uint32_t depositHardware(uint32_t value, uint32_t mask)
+    {
+      return _pdep_u32(value, mask);
+    }
+
+    const bool kHasBmi2 = cpuFeatures().bmi2;
+#endif
+
+    // Formatting tables, generated at compile time: the 4 binary digits of every nibble,
+    // the 8 binary digits of every byte, and the 2 hex digits of every byte
+    constexpr std::array<std::array<char, 4>, 16> makeNibbleBinaryTable()
+    {
+      std::array<std::array<char, 4>, 16> table{};
+      for (int n = 0; n < 16; ++n)
+        for (int bit = 0; bit < 4; ++bit)
+          table[n][3 - bit] = ((n >> bit) & 1) ? '1' : '0';
+      return table;
+    }
+
+    constexpr std::array<std::array<char, 8>, 256> makeByteBinaryTable()
+    {
+      std::array<std::array<char, 8>, 256> table{};
+      for (int b = 0; b < 256; ++b)
+        for (int bit = 0; bit < 8; ++bit)
+          table[b][7 - bit] = ((b >> bit) & 1) ? '1' : '0';
+      return table;
+    }
+
+    constexpr std::array<std::array<char, 2>, 256> makeByteHexTable(bool uppercase)
+    {
+      const char *digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+      std::array<std::array<char, 2>, 256> table{};
+      for (int b = 0; b < 256; ++b)
+      {
+        table[b][0] = digits[b >> 4];
+        table[b][1] = digits[b & 0xF];
+      }
+      return table;
+    }
+
+    constexpr auto kNibbleBinary = makeNibbleBinaryTable();
+    constexpr auto kByteBinary = makeByteBinaryTable();
+    constexpr auto kByteHexUpper = makeByteHexTable(true);
+    constexpr auto kByteHexLower = makeByteHexTable(false);
+
+    // Bits above 31 are shown as leading zeros instead of shifting out of range
+    inline uint32_t digitGroup(uint32_t value, int shift, uint32_t mask)
+    {
+      return shift < 32 ? (value >> shift) & mask : 0;
+    }
+
+    // Assembles one visualization in a reusable per-thread buffer so each render
+    // costs a single sink write and, after warm-up, no allocations
+    class RenderBuffer
     {
-      result += ((value >> i) & 1) ? '1' : '0';
-      if (i % 4 == 0 && i != 0)
+    public:
+      RenderBuffer() : out_(scratch()) { out_.clear(); }
+
+      RenderBuffer &text(const char *value)
+      {
+        out_.append(value);
+        return *this;
+      }
+
+      RenderBuffer &text(const std::string &value)
+      {
+        out_.append(value);
+        return *this;
+      }
+
+      RenderBuffer &fill(char c, std::size_t count)
+      {
+        out_.append(count, c);
+        return *this;
+      }
+
+      template <typename Integer>
+      RenderBuffer &decimal(Integer value)
       {
-        result += ' '; // Add space every 4 bits for readability
+        char buffer[24];
+        std::to_chars_result written = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out_.append(buffer, written.ptr);
+        return *this;
       }
+
+      RenderBuffer &hex(uint32_t value)
+      {
+        char buffer[kMaxHexChars];
+        std::to_chars_result written = toHexChars(buffer, buffer + sizeof(buffer), value);
+        out_.append(buffer, written.ptr);
+        return *this;
+      }
+
+      // One 32-bit row of the bit-by-bit views: a leading space, then nibbles separated by spaces
+      RenderBuffer &bitRow(uint32_t value)
+      {
+        char buffer[kMaxBinaryChars + 1];
+        buffer[0] = ' ';
+        std::to_chars_result written = toBinaryChars(buffer + 1, buffer + sizeof(buffer), value);
+        out_.append(buffer, written.ptr);
+        return *this;
+      }
+
+      void flushTo(RenderSink &sink) { sink.write(out_.data(), out_.size()); }
+
+    private:
+      static std::string &scratch()
+      {
+        thread_local std::string buffer;
+        return buffer;
+      }
+
+      std::string &out_;
+    };
+
+    // Per-basis columns for displayBaseTable, extended on demand: values[i] and labels[i] are the
+    // decimal text of basis^i and "basis^i", and widths[i] is the widest of either over [0, i].
+    // Powers are exact at any length (see big_unsigned.h).
+    struct BaseTableColumns
+    {
+      std::vector<std::string> values;
+      std::vector<std::string> labels;
+      std::vector<std::size_t> widths;
+      BigUnsigned next = 1; // |basis|^values.size()
+    };
+
+    std::mutex &baseTableMutex()
+    {
+      static std::mutex mutex;
+      return mutex;
+    }
+
+    // The cache holds tables up to kCachedPowers columns for at most kCachedBases bases (a few MB at
+    // worst); longer tables are built for the one call, since their text grows quadratically
+    constexpr int kCachedPowers = 256;
+    constexpr std::size_t kCachedBases = 64;
+
+    void extendColumns(BaseTableColumns &columns, int basis, int length)
+    {
+      const std::string prefix = std::to_string(basis) + "^";
+      // Only an odd power of a negative base is negative
+      const uint64_t magnitude = basis < 0 ? 0 - static_cast<uint64_t>(basis) : static_cast<uint64_t>(basis);
+      while (static_cast<int>(columns.values.size()) <= length)
+      {
+        std::size_t exponent = columns.values.size();
+        bool negative = basis < 0 && (exponent & 1) && !columns.next.isZero();
+        columns.values.push_back((negative ? "-" : "") + columns.next.toString());
+        columns.labels.push_back(prefix + std::to_string(exponent));
+        std::size_t width = std::max(columns.values.back().size(), columns.labels.back().size());
+        columns.widths.push_back(exponent == 0 ? width : std::max(width, columns.widths.back()));
+        columns.next *= magnitude;
+      }
+    }
+
+    // Caller holds baseTableMutex(); scratch receives tables too long to cache
+    const BaseTableColumns &baseTableColumns(int basis, int length, BaseTableColumns &scratch)
+    {
+      if (length > kCachedPowers)
+      {
+        extendColumns(scratch, basis, length);
+        return scratch;
+      }
+      static std::map<int, BaseTableColumns> cache;
+      if (cache.size() >= kCachedBases && cache.find(basis) == cache.end())
+        cache.clear();
+      BaseTableColumns &columns = cache[basis];
+      extendColumns(columns, basis, length);
+      return columns;
+    }
+  } // namespace
+
+  std::size_t binaryCharsLength(int bits, bool grouped)
+  {
+    if (bits <= 0)
+      return 0;
+    return grouped ? bits + (bits - 1) / 4 : bits;
+  }
+
+  std::to_chars_result toBinaryChars(char *first, char *last, uint32_t value, int bits, bool grouped)
+  {
+    std::size_t length = binaryCharsLength(bits, grouped);
+    if (static_cast<std::size_t>(last - first) < length)
+    {
+      return {last, std::errc::value_too_large};
+    }
+    if (length == 0)
+    {
+      return {first, std::errc()};
+    }
+
+    char *out = first;
+    if (grouped)
+    {
+      // Nibbles from most to least significant; the leading one may be partial
+      int top = (bits - 1) / 4;
+      int lead = bits - top * 4;
+      for (int nibble = top; nibble >= 0; --nibble)
+      {
+        int count = nibble == top ? lead : 4;
+        const auto &digits = kNibbleBinary[digitGroup(value, nibble * 4, 0xF)];
+        std::memcpy(out, digits.data() + 4 - count, count);
+        out += count;
+        if (nibble != 0)
+        {
+          *out++ = ' '; // Add space every 4 bits for readability
+        }
+      }
+    }
+    else
+    {
+      int top = (bits - 1) / 8;
+      int lead = bits - top * 8;
+      for (int byte = top; byte >= 0; --byte)
+      {
+        int count = byte == top ? lead : 8;
+        const auto &digits = kByteBinary[digitGroup(value, byte * 8, 0xFF)];
+        std::memcpy(out, digits.data() + 8 - count, count);
+        out += count;
+      }
+    }
+    return {out, std::errc()};
+  }
+
+  std::to_chars_result toHexChars(char *first, char *last, uint32_t value, bool prefixed, bool uppercase)
+  {
+    std::size_t digits = 1;
+    for (uint32_t rest = value >> 4; rest != 0; rest >>= 4)
+    {
+      ++digits;
+    }
+    std::size_t length = digits + (prefixed ? 2 : 0);
+    if (static_cast<std::size_t>(last - first) < length)
+    {
+      return {last, std::errc::value_too_large};
+    }
+
+    char *out = first;
+    if (prefixed)
+    {
+      *out++ = '0';
+      *out++ = 'x';
+    }
+    // Fill from the least significant end, two digits per table lookup
+    const auto &table = uppercase ? kByteHexUpper : kByteHexLower;
+    char *end = out + digits;
+    char *p = end;
+    while (p - out >= 2)
+    {
+      p -= 2;
+      std::memcpy(p, table[value & 0xFF].data(), 2);
+      value >>= 8;
     }
+    if (p > out)
+    {
+      *--p = table[value & 0xF][1];
+    }
+    return {end, std::errc()};
+  }
+
+  // default value of 32 bits...
+  std::string toBinaryString(uint32_t value, int bits)
+  {
+    std::string result(binaryCharsLength(bits, true), '\0');
+    toBinaryChars(result.data(), result.data() + result.size(), value, bits);
     return result;
   }
 
   std::string toHexString(uint32_t value)
   {
-    std::stringstream ss;
-    ss << "0x" << std::hex << std::uppercase << value;
-    return ss.str();
+    // Formatted in place (kMaxHexChars fits the small-string buffer), like toBinaryString
+    std::string result(kMaxHexChars, '\0');
+    std::to_chars_result written = toHexChars(result.data(), result.data() + result.size(), value);
+    result.resize(static_cast<std::size_t>(written.ptr - result.data()));
+    return result;
   }
 
   uint32_t bitwiseAnd(uint32_t a, uint32_t b)
   {
-    return a & b;
+    BITWISE_STATS_COUNT(And);
+    return generic::bitwiseAnd(a, b);
   }
 
   uint32_t bitwiseOr(uint32_t a, uint32_t b)
   {
-    return a | b;
+    BITWISE_STATS_COUNT(Or);
+    return generic::bitwiseOr(a, b);
   }
 
   uint32_t bitwiseXor(uint32_t a, uint32_t b)
   {
-    return a ^ b;
+    BITWISE_STATS_COUNT(Xor);
+    return generic::bitwiseXor(a, b);
   }
 
   uint32_t bitwiseNot(uint32_t a)
   {
-    return ~a;
+    BITWISE_STATS_COUNT(Not);
+    return generic::bitwiseNot(a);
   }
 
   uint32_t leftShift(uint32_t a, int shift)
   {
-    return a << shift;
+    BITWISE_STATS_COUNT(LeftShift);
+    return generic::leftShift(a, shift);
   }
 
   uint32_t rightShift(uint32_t a, int shift)
   {
-    return a >> shift;
+    BITWISE_STATS_COUNT(RightShift);
+    return generic::rightShift(a, shift);
   }
 
-  long long power(int base, int exponent)
+  bool checkedPower(int base, int exponent, long long &result)
   {
-    long long result = 1;
-    for (int itr = 0; itr < exponent; itr++)
+    if (exponent <= 0)
     {
-      result *= base;
+      result = 1;
+      return true;
     }
-    return result;
+    return generic::checkedPower(base, static_cast<unsigned>(exponent), result);
   }
 
-  void displayBaseTable(int table_length, int basis)
+  long long power(int base, int exponent)
   {
-    std::string values_row;
-    std::string powers_row;
-    int longest_value;
-
-    for (int i = table_length; i >= 0; i--)
+    long long result;
+    if (checkedPower(base, exponent, result))
     {
-      // Value row build
-      long long value = power(basis, i);
-      std::string value_str = std::to_string(value);
-      if (i == table_length)
-      {
-        longest_value = value_str.length();
-      }
-
-      if (value_str.length() < longest_value)
-      {
-        int spacesToAdd = longest_value - value_str.length();
-        value_str = std::string(spacesToAdd, ' ') + value_str;
-      }
-      values_row += (value_str + "|");
-
-      // Power row build
-      std::string exponent_str = std::to_string(i);
-      std::string basis_str = (std::to_string(basis) + "^");
-      int powers_whitespace = longest_value - (exponent_str.length() + basis_str.length()); // {basis}^(i)
-      powers_row += (std::string(powers_whitespace, ' ') + basis_str + exponent_str) + "|";
+      return result;
     }
-    values_row += "\n";
-    std::cout << "\n<== Base" << basis << " Table ==> \n";
-    std::cout << values_row << powers_row << std::endl;
+    // Only an odd power of a negative base is negative
+    bool negative = base < 0 && (exponent & 1);
+    return negative ? std::numeric_limits<long long>::min() : std::numeric_limits<long long>::max();
   }
 
-  void displayBitwiseOperation(uint32_t a, uint32_t b, const std::string &operation, uint32_t result)
+  void displayBaseTable(int table_length, int basis)
   {
-    std::cout << "\n<== Bitwise " << operation << " Operation ==>" << std::endl;
-    std::cout << "Decimal: " << a << " " << operation << " " << b << " = " << result << std::endl;
-    std::cout << "Hex:     " << toHexString(a) << " " << operation << " " << toHexString(b) << " = " << toHexString(result) << std::endl;
-    std::cout << std::endl;
+    OstreamSink sink(std::cout);
+    displayBaseTable(sink, table_length, basis);
+    std::cout.flush();
+  }
 
-    std::string binA = toBinaryString(a);
-    std::string binB = toBinaryString(b);
-    std::string binResult = toBinaryString(result);
+  void displayBaseTable(RenderSink &sink, int table_length, int basis)
+  {
+    RenderBuffer out;
+    out.text("\n<== Base").decimal(basis).text(" Table ==> \n");
 
-    // Show bit-by-bit comparison
-    std::cout << "Bit-by-bit comparison:" << std::endl;
-    for (int i = 31; i >= 0; --i)
-    {
-      if (i % 4 == 3)
-        std::cout << " ";
-      std::cout << ((a >> i) & 1);
-    }
-    std::cout << " (A)" << std::endl;
+    std::lock_guard<std::mutex> lock(baseTableMutex());
+    BaseTableColumns scratch;
+    const BaseTableColumns &columns = baseTableColumns(basis, table_length, scratch);
+    int top = table_length;
+    std::size_t width = top >= 0 ? columns.widths[top] : 0;
 
-    for (int i = 31; i >= 0; --i)
+    for (int i = top; i >= 0; i--)
     {
-      if (i % 4 == 3)
-        std::cout << " ";
-      std::cout << ((b >> i) & 1);
+      out.fill(' ', width - columns.values[i].size()).text(columns.values[i]).text("|");
     }
-    std::cout << " (B)" << std::endl;
-
-    std::cout << std::string(44, '-') << std::endl;
-
-    for (int i = 31; i >= 0; --i)
+    out.text("\n");
+    for (int i = top; i >= 0; i--)
     {
-      if (i % 4 == 3)
-        std::cout << " ";
-      std::cout << ((result >> i) & 1);
+      out.fill(' ', width - columns.labels[i].size()).text(columns.labels[i]).text("|");
     }
-    std::cout << " (Result)" << std::endl;
+    out.text("\n");
+    out.flushTo(sink);
   }
 
-  void displayBitwiseNotOperation(uint32_t a, uint32_t result)
+  void displayBitwiseOperation(uint32_t a, uint32_t b, const std::string &operation, uint32_t result)
   {
-    std::cout << "\n<== Bitwise NOT Operation ==>" << std::endl;
-    std::cout << "Decimal: ~" << a << " = " << result << std::endl;
-    std::cout << "Hex:     ~" << toHexString(a) << " = " << toHexString(result) << std::endl;
-    std::cout << std::endl;
+    OstreamSink sink(std::cout);
+    displayBitwiseOperation(sink, a, b, operation, result);
+  }
 
-    std::string binA = toBinaryString(a);
-    std::string binResult = toBinaryString(result);
+  void displayBitwiseOperation(RenderSink &sink, uint32_t a, uint32_t b, const std::string &operation, uint32_t result)
+  {
+    RenderBuffer out;
+    out.text("\n<== Bitwise ").text(operation).text(" Operation ==>\n");
+    out.text("Decimal: ").decimal(a).text(" ").text(operation).text(" ").decimal(b).text(" = ").decimal(result).text("\n");
+    out.text("Hex:     ").hex(a).text(" ").text(operation).text(" ").hex(b).text(" = ").hex(result).text("\n");
+    out.text("\n");
 
     // Show bit-by-bit comparison
-    std::cout << "Bit-by-bit comparison:" << std::endl;
-    for (int i = 31; i >= 0; --i)
-    {
-      if (i % 4 == 3)
-        std::cout << " ";
-      std::cout << ((a >> i) & 1);
-    }
-    std::cout << " (A)" << std::endl;
+    out.text("Bit-by-bit comparison:\n");
+    out.bitRow(a).text(" (A)\n");
+    out.bitRow(b).text(" (B)\n");
+    out.fill('-', 44).text("\n");
+    out.bitRow(result).text(" (Result)\n");
+    out.flushTo(sink);
+  }
 
-    std::cout << std::string(44, '-') << std::endl;
+  void displayBitwiseNotOperation(uint32_t a, uint32_t result)
+  {
+    OstreamSink sink(std::cout);
+    displayBitwiseNotOperation(sink, a, result);
+  }
 
-    for (int i = 31; i >= 0; --i)
-    {
-      if (i % 4 == 3)
-        std::cout << " ";
-      std::cout << ((result >> i) & 1);
-    }
-    std::cout << " (~A)" << std::endl;
+  void displayBitwiseNotOperation(RenderSink &sink, uint32_t a, uint32_t result)
+  {
+    RenderBuffer out;
+    out.text("\n<== Bitwise NOT Operation ==>\n");
+    out.text("Decimal: ~").decimal(a).text(" = ").decimal(result).text("\n");
+    out.text("Hex:     ~").hex(a).text(" = ").hex(result).text("\n");
+    out.text("\n");
+
+    // Show bit-by-bit comparison
+    out.text("Bit-by-bit comparison:\n");
+    out.bitRow(a).text(" (A)\n");
+    out.fill('-', 44).text("\n");
+    out.bitRow(result).text(" (~A)\n");
+    out.flushTo(sink);
   }
 
   void displayShiftOperation(uint32_t a, int shift, uint32_t result, const std::string &direction)
   {
-    std::cout << "\n<== " << direction << " Shift Operation ==>" << std::endl;
-    std::cout << "Decimal: " << a << " " << (direction == "LEFT" ? "<<" : ">>") << " " << shift << " = " << result << std::endl;
-    std::cout << "Hex:     " << toHexString(a) << " " << (direction == "LEFT" ? "<<" : ">>") << " " << shift << " = " << toHexString(result) << std::endl;
-    std::cout << std::endl;
-
-    std::string binA = toBinaryString(a);
-    std::string binResult = toBinaryString(result);
+    OstreamSink sink(std::cout);
+    displayShiftOperation(sink, a, shift, result, direction);
+  }
 
-    // Show shift visualization
-    std::cout << "Shift visualization:" << std::endl;
-    for (int i = 31; i >= 0; --i)
-    {
-      if (i % 4 == 3)
-        std::cout << " ";
-      std::cout << ((a >> i) & 1);
-    }
-    std::cout << " (Original)" << std::endl;
+  void displayShiftOperation(RenderSink &sink, uint32_t a, int shift, uint32_t result, const std::string &direction)
+  {
+    const bool left = direction == "LEFT";
+    const char *symbol = left ? " << " : " >> ";
 
-    if (direction == "LEFT")
-    {
-      std::cout << std::string(shift * 2, ' ') << "←- shifted left by " << shift << " positions" << std::endl;
-    }
-    else
-    {
-      std::cout << std::string(shift * 2, ' ') << "-→ shifted right by " << shift << " positions" << std::endl;
-    }
+    RenderBuffer out;
+    out.text("\n<== ").text(direction).text(" Shift Operation ==>\n");
+    out.text("Decimal: ").decimal(a).text(symbol).decimal(shift).text(" = ").decimal(result).text("\n");
+    out.text("Hex:     ").hex(a).text(symbol).decimal(shift).text(" = ").hex(result).text("\n");
+    out.text("\n");
 
-    for (int i = 31; i >= 0; --i)
-    {
-      if (i % 4 == 3)
-        std::cout << " ";
-      std::cout << ((result >> i) & 1);
-    }
-    std::cout << " (Result)" << std::endl;
+    // Show shift visualization
+    out.text("Shift visualization:\n");
+    out.bitRow(a).text(" (Original)\n");
+    out.fill(' ', shift > 0 ? static_cast<std::size_t>(shift) * 2 : 0);
+    out.text(left ? "←- shifted left by " : "-→ shifted right by ").decimal(shift).text(" positions\n");
+    out.bitRow(result).text(" (Result)\n");
+    out.flushTo(sink);
   }
 
   int countSetBits(uint32_t value)
   {
-    int count = 0;
-    while (value)
-    {
-      count += value & 1;
-      value >>= 1;
-    }
-    return count;
+    BITWISE_STATS_COUNT(CountSetBits);
+#if defined(BITWISE_X86) && !defined(__POPCNT__)
+    return kHasPopcnt ? popcountHardware(value) : generic::countSetBits(value);
+#else
+    return generic::countSetBits(value);
+#endif
   }
 
   bool isBitSet(uint32_t value, int bitPosition)
   {
-    return (value >> bitPosition) & 1;
+    BITWISE_STATS_COUNT(IsBitSet);
+    return generic::isBitSet(value, bitPosition);
   }
 
   uint32_t setBit(uint32_t value, int bitPosition)
   {
-    return value | (1U << bitPosition);
+    BITWISE_STATS_COUNT(SetBit);
+    return generic::setBit(value, bitPosition);
   }
 
   uint32_t clearBit(uint32_t value, int bitPosition)
   {
-    return value & ~(1U << bitPosition);
+    BITWISE_STATS_COUNT(ClearBit);
+    return generic::clearBit(value, bitPosition);
   }
 
   uint32_t toggleBit(uint32_t value, int bitPosition)
   {
-    return value ^ (1U << bitPosition);
+    BITWISE_STATS_COUNT(ToggleBit);
+    return generic::toggleBit(value, bitPosition);
+  }
+
+  int countLeadingZeros(uint32_t value)
+  {
+    BITWISE_STATS_COUNT(CountLeadingZeros);
+#if defined(BITWISE_X86) && !defined(__LZCNT__)
+    return kHasLzcnt ? leadingZerosHardware(value) : generic::countLeadingZeros(value);
+#else
+    return generic::countLeadingZeros(value);
+#endif
+  }
+
+  int countTrailingZeros(uint32_t value)
+  {
+    BITWISE_STATS_COUNT(CountTrailingZeros);
+#if defined(BITWISE_X86) && !defined(__BMI__)
+    return kHasBmi1 ? trailingZerosHardware(value) : generic::countTrailingZeros(value);
+#else
+    return generic::countTrailingZeros(value);
+#endif
+  }
+
+  uint32_t rotateLeft(uint32_t value, int shift)
+  {
+    BITWISE_STATS_COUNT(Rotate);
+    return generic::rotateLeft(value, shift);
+  }
+
+  uint32_t rotateRight(uint32_t value, int shift)
+  {
+    BITWISE_STATS_COUNT(Rotate);
+    return generic::rotateRight(value, shift);
+  }
+
+  uint32_t funnelShiftLeft(uint32_t hi, uint32_t lo, int shift)
+  {
+    BITWISE_STATS_COUNT(FunnelShift);
+    return generic::funnelShiftLeft(hi, lo, shift);
+  }
+
+  uint32_t funnelShiftRight(uint32_t hi, uint32_t lo, int shift)
+  {
+    BITWISE_STATS_COUNT(FunnelShift);
+    return generic::funnelShiftRight(hi, lo, shift);
+  }
+
+  uint32_t reverseBits(uint32_t value)
+  {
+    BITWISE_STATS_COUNT(ReverseBits);
+    return generic::reverseBits(value);
+  }
+
+  uint32_t extractBits(uint32_t value, uint32_t mask)
+  {
+    BITWISE_STATS_COUNT(ExtractBits);
+#if defined(BITWISE_X86) && !defined(__BMI2__)
+    return kHasBmi2 ? extractHardware(value, mask) : generic::extractBits(value, mask);
+#else
+    return generic::extractBits(value, mask);
+#endif
+  }
+
+  uint32_t depositBits(uint32_t value, uint32_t mask)
+  {
+    BITWISE_STATS_COUNT(DepositBits);
+#if defined(BITWISE_X86) && !defined(__BMI2__)
+    return kHasBmi2 ? depositHardware(value, mask) : generic::depositBits(value, mask);
+#else
+    return generic::depositBits(value, mask);
+#endif
   }
 
-} // namespace bitwise
\ No newline at end of file
+} // namespace bitwise
@@ -0,0 +1,348 @@
+#include "bloom_filter.h"
+#include "bitwise_cpu.h"
+#include "bitwise_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITWISE_X86 1
+#endif
+
+namespace bitwise
+{
+  namespace
+  {
+    // Odd multipliers that spread the low 32 hash bits over the eight words of a block
+    constexpr uint32_t kSalts[BloomFilter::kBlockWords] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                           0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+    constexpr char kMagic[4] = {'B', 'W', 'B', 'F'};
+    constexpr uint32_t kFormatVersion = 1;
+    constexpr std::size_t kHeaderBytes = 16;
+
+    // Keys hashed ahead of use in the batch functions, so their blocks can be prefetched together
+    constexpr std::size_t kBatchKeys = 32;
+
+    // MurmurHash3's 64-bit finalizer: every key bit affects every hash bit
+    inline uint64_t mixKey(uint64_t key)
+    {
+      key ^= key >> 33;
+      key *= 0xff51afd7ed558ccdULL;
+      key ^= key >> 33;
+      key *= 0xc4ceb9fe1a85ec53ULL;
+      key ^= key >> 33;
+      return key;
+    }
+
+    // Multiply-shift maps the high 32 hash bits onto [0, blocks) without a division
+    inline std::size_t blockIndex(uint64_t hash, std::size_t blocks)
+    {
+      return static_cast<std::size_t>(((hash >> 32) * blocks) >> 32);
+    }
+
+    void insertScalar(uint32_t *block, uint32_t key)
+    {
+      for (std::size_t i = 0; i < BloomFilter::kBlockWords; ++i)
+        block[i] |= 1U << ((key * kSalts[i]) >> 27);
+    }
+
+    bool containsScalar(const uint32_t *block, uint32_t key)
+    {
+      bool found = true;
+      for (std::size_t i = 0; i < BloomFilter::kBlockWords; ++i)
+        found &= ((block[i] >> ((key * kSalts[i]) >> 27)) & 1) != 0;
+      return found;
+    }
+
+#ifdef BITWISE_X86
+    __attribute__((target("avx2"))) inline __m256i blockMask(uint32_t key)
+    {
+      const __m256i salts = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(kSalts));
+      __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)), salts), 27);
+      return _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+    }
+
+    __attribute__((target("avx2"))) void insertAvx2(uint32_t *block, uint32_t key)
+    {
+      __m256i *vector = reinterpret_cast<__m256i *>(block);
+      _mm256_store_si256(vector, _mm256_or_si256(_mm256_load_si256(vector), blockMask(key)));
+    }
+
+    bool useAvx2()
+    {
+      return activeSimdLevel() >= SimdLevel::AVX2;
+    }
+
+    // testc is 1 when every bit of the mask is also set in the block
+    __attribute__((target("avx2"))) bool containsAvx2(const uint32_t *block, uint32_t key)
+    {
+      return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(block)), blockMask(key)) != 0;
+    }
+#endif
+
+    // Hashes a batch of keys into block offsets and block bits, prefetching each block (for writing when ForWrite is 1)
+    template <int ForWrite>
+    inline void hashBatch(const uint64_t *keys, std::size_t batch, const uint32_t *words, std::size_t blocks,
+                          std::size_t *offsets, uint32_t *bits)
+    {
+      for (std::size_t i = 0; i < batch; ++i)
+      {
+        uint64_t hash = mixKey(keys[i]);
+        offsets[i] = blockIndex(hash, blocks) * BloomFilter::kBlockWords;
+        bits[i] = static_cast<uint32_t>(hash);
+        __builtin_prefetch(words + offsets[i], ForWrite);
+      }
+    }
+
+    // The batch kernels come in one copy per instruction set so the block operation inlines into the
+    // loop; answers are collected in a register and stored once per 64 keys
+    void insertManyScalar(uint32_t *words, std::size_t blocks, const uint64_t *keys, std::size_t count)
+    {
+      std::size_t offsets[kBatchKeys];
+      uint32_t bits[kBatchKeys];
+      for (std::size_t first = 0; first < count; first += kBatchKeys)
+      {
+        const std::size_t batch = std::min(kBatchKeys, count - first);
+        hashBatch<1>(keys + first, batch, words, blocks, offsets, bits);
+        for (std::size_t i = 0; i < batch; ++i)
+          insertScalar(words + offsets[i], bits[i]);
+      }
+    }
+
+    void containsManyScalar(uint64_t *mask, const uint32_t *words, std::size_t blocks, const uint64_t *keys,
+                            std::size_t count)
+    {
+      std::size_t offsets[kBatchKeys];
+      uint32_t bits[kBatchKeys];
+      uint64_t answers = 0;
+      for (std::size_t first = 0; first < count; first += kBatchKeys)
+      {
+        const std::size_t batch = std::min(kBatchKeys, count - first);
+        hashBatch<0>(keys + first, batch, words, blocks, offsets, bits);
+        for (std::size_t i = 0; i < batch; ++i)
+          answers |= uint64_t(containsScalar(words + offsets[i], bits[i])) << ((first + i) % 64);
+        if ((first + batch) % 64 == 0 || first + batch == count)
+        {
+          mask[first / 64] = answers;
+          answers = 0;
+        }
+      }
+    }
+
+#ifdef BITWISE_X86
+    __attribute__((target("avx2"))) void insertManyAvx2(uint32_t *words, std::size_t blocks, const uint64_t *keys,
+                                                        std::size_t count)
+    {
+      std::size_t offsets[kBatchKeys];
+      uint32_t bits[kBatchKeys];
+      for (std::size_t first = 0; first < count; first += kBatchKeys)
+      {
+        const std::size_t batch = std::min(kBatchKeys, count - first);
+        hashBatch<1>(keys + first, batch, words, blocks, offsets, bits);
+        for (std::size_t i = 0; i < batch; ++i)
+          insertAvx2(words + offsets[i], bits[i]);
+      }
+    }
+
+    __attribute__((target("avx2"))) void containsManyAvx2(uint64_t *mask, const uint32_t *words, std::size_t blocks,
+                                                          const uint64_t *keys, std::size_t count)
+    {
+      std::size_t offsets[kBatchKeys];
+      uint32_t bits[kBatchKeys];
+      uint64_t answers = 0;
+      for (std::size_t first = 0; first < count; first += kBatchKeys)
+      {
+        const std::size_t batch = std::min(kBatchKeys, count - first);
+        hashBatch<0>(keys + first, batch, words, blocks, offsets, bits);
+        for (std::size_t i = 0; i < batch; ++i)
+          answers |= uint64_t(containsAvx2(words + offsets[i], bits[i])) << ((first + i) % 64);
+        if ((first + batch) % 64 == 0 || first + batch == count)
+        {
+          mask[first / 64] = answers;
+          answers = 0;
+        }
+      }
+    }
+#endif
+
+    // Probability that one query hits all eight bits of a block that received keys insertions
+    double blockHitRate(double keys)
+    {
+      return std::pow(1.0 - std::pow(1.0 - 1.0 / 32, keys), BloomFilter::kBlockWords);
+    }
+
+    void writeLittleEndian(uint8_t *out, uint64_t value, std::size_t bytes)
+    {
+      for (std::size_t i = 0; i < bytes; ++i)
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint64_t readLittleEndian(const uint8_t *in, std::size_t bytes)
+    {
+      uint64_t value = 0;
+      for (std::size_t i = 0; i < bytes; ++i)
+        value |= uint64_t(in[i]) << (8 * i);
+      return value;
+    }
+  } // namespace
+
+  BloomFilter::BloomFilter(std::size_t blocks) : words_(std::max<std::size_t>(blocks, 1) * kBlockWords, 0)
+  {
+  }
+
+  BloomFilter::BloomFilter(std::size_t expectedKeys, double falsePositiveRate)
+      : BloomFilter(blocksFor(expectedKeys, falsePositiveRate))
+  {
+  }
+
+  double BloomFilter::falsePositiveRate(std::size_t blocks, std::size_t keys)
+  {
+    // The keys landing in the queried block are Poisson distributed with mean keys / blocks; sum
+    // the hit rate over that distribution within 12 standard deviations of the mean
+    const double mean = static_cast<double>(keys) / static_cast<double>(std::max<std::size_t>(blocks, 1));
+    if (mean == 0)
+      return 0;
+    const double spread = 12 * std::sqrt(mean) + 12;
+    const double first = std::max(0.0, std::floor(mean - spread));
+    const double last = std::ceil(mean + spread);
+    double rate = 0;
+    for (double i = first; i <= last; ++i)
+      rate += std::exp(i * std::log(mean) - mean - std::lgamma(i + 1)) * blockHitRate(i);
+    return std::min(rate, 1.0);
+  }
+
+  std::size_t BloomFilter::blocksFor(std::size_t keys, double rate)
+  {
+    // Rates outside (0, 1) are clamped to [1e-9, 1]
+    rate = std::min(std::max(rate, 1e-9), 1.0);
+    if (keys == 0 || rate >= 1.0)
+      return 1;
+    // Double until the rate is met, then binary search the last doubling step
+    std::size_t low = 1, high = std::max<std::size_t>(keys / 16, 1);
+    while (falsePositiveRate(high, keys) > rate)
+    {
+      low = high + 1;
+      high *= 2;
+    }
+    while (low < high)
+    {
+      std::size_t middle = low + (high - low) / 2;
+      if (falsePositiveRate(middle, keys) <= rate)
+        high = middle;
+      else
+        low = middle + 1;
+    }
+    return high;
+  }
+
+  void BloomFilter::insert(uint64_t key)
+  {
+    uint64_t hash = mixKey(key);
+    uint32_t *block = words_.data() + blockIndex(hash, blockCount()) * kBlockWords;
+#ifdef BITWISE_X86
+    if (useAvx2())
+    {
+      insertAvx2(block, static_cast<uint32_t>(hash));
+      return;
+    }
+#endif
+    insertScalar(block, static_cast<uint32_t>(hash));
+  }
+
+  bool BloomFilter::contains(uint64_t key) const
+  {
+    uint64_t hash = mixKey(key);
+    const uint32_t *block = words_.data() + blockIndex(hash, blockCount()) * kBlockWords;
+#ifdef BITWISE_X86
+    if (useAvx2())
+      return containsAvx2(block, static_cast<uint32_t>(hash));
+#endif
+    return containsScalar(block, static_cast<uint32_t>(hash));
+  }
+
+  void BloomFilter::insertMany(const uint64_t *keys, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BloomInsert, count * sizeof(uint64_t));
+#ifdef BITWISE_X86
+    if (useAvx2())
+    {
+      insertManyAvx2(words_.data(), blockCount(), keys, count);
+      return;
+    }
+#endif
+    insertManyScalar(words_.data(), blockCount(), keys, count);
+  }
+
+  void BloomFilter::containsMany(uint64_t *mask, const uint64_t *keys, std::size_t count) const
+  {
+    BITWISE_STATS_SCOPE(BloomQuery, count * sizeof(uint64_t));
+#ifdef BITWISE_X86
+    if (useAvx2())
+    {
+      containsManyAvx2(mask, words_.data(), blockCount(), keys, count);
+      return;
+    }
+#endif
+    containsManyScalar(mask, words_.data(), blockCount(), keys, count);
+  }
+
+  void BloomFilter::clear()
+  {
+    std::fill(words_.begin(), words_.end(), 0U);
+  }
+
+  std::size_t BloomFilter::serializedSize() const
+  {
+    return kHeaderBytes + sizeInBytes();
+  }
+
+  void BloomFilter::serialize(uint8_t *out) const
+  {
+    std::memcpy(out, kMagic, sizeof(kMagic));
+    writeLittleEndian(out + 4, kFormatVersion, 4);
+    writeLittleEndian(out + 8, blockCount(), 8);
+    out += kHeaderBytes;
+    for (uint32_t word : words_)
+    {
+      writeLittleEndian(out, word, 4);
+      out += 4;
+    }
+  }
+
+  bool BloomFilter::deserialize(const uint8_t *data, std::size_t size, BloomFilter &filter, std::string &error)
+  {
+    if (size < kHeaderBytes || std::memcmp(data, kMagic, sizeof(kMagic)) != 0)
+    {
+      error = "not a serialized Bloom filter";
+      return false;
+    }
+    uint64_t version = readLittleEndian(data + 4, 4);
+    if (version != kFormatVersion)
+    {
+      error = "unsupported Bloom filter format version " + std::to_string(version);
+      return false;
+    }
+    const uint64_t blocks = readLittleEndian(data + 8, 8);
+    const std::size_t blockBytes = kBlockWords * sizeof(uint32_t);
+    if (blocks == 0 || blocks != (size - kHeaderBytes) / blockBytes || (size - kHeaderBytes) % blockBytes != 0)
+    {
+      error = "Bloom filter size does not match its header (" + std::to_string(blocks) + " blocks in " +
+              std::to_string(size) + " bytes)";
+      return false;
+    }
+
+    BloomFilter result(static_cast<std::size_t>(blocks));
+    const uint8_t *in = data + kHeaderBytes;
+    for (uint32_t &word : result.words_)
+    {
+      word = static_cast<uint32_t>(readLittleEndian(in, 4));
+      in += 4;
+    }
+    filter = std::move(result);
+    return true;
+  }
+
+} // namespace bitwise
@@ -0,0 +1,711 @@
+#include "file_ops.h"
+#include "bitwise_stats.h"
+#include "bitwise_bulk.h"
+#include "aligned_allocator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bitwise
+{
+  namespace
+  {
+    std::string describeError(const char *action, const char *path, int err)
+    {
+      return std::string(action) + " " + path + ": " + std::strerror(err);
+    }
+
+    class FileDescriptor
+    {
+    public:
+      FileDescriptor() = default;
+      ~FileDescriptor()
+      {
+        if (fd_ >= 0)
+          ::close(fd_);
+      }
+      FileDescriptor(const FileDescriptor &) = delete;
+      FileDescriptor &operator=(const FileDescriptor &) = delete;
+
+      void reset(int fd) { fd_ = fd; }
+      int get() const { return fd_; }
+
+    private:
+      int fd_ = -1;
+    };
+
+    // One page-aligned window [first, last) of a file, unmapped when it goes out of scope
+    class MappedWindow
+    {
+    public:
+      MappedWindow() = default;
+      ~MappedWindow() { unmap(); }
+      MappedWindow(const MappedWindow &) = delete;
+      MappedWindow &operator=(const MappedWindow &) = delete;
+
+      bool map(int fd, uint64_t first, uint64_t last, bool writable, std::size_t pageSize)
+      {
+        unmap();
+        if (first >= last)
+          return true; // empty window, nothing to map
+        start_ = first - first % pageSize;
+        length_ = static_cast<std::size_t>(last - start_);
+        void *address = ::mmap(nullptr, length_, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                               writable ? MAP_SHARED : MAP_PRIVATE, fd, static_cast<off_t>(start_));
+        if (address == MAP_FAILED)
+        {
+          length_ = 0;
+          return false;
+        }
+        base_ = static_cast<uint8_t *>(address);
+        if (!writable)
+          ::madvise(base_, length_, MADV_SEQUENTIAL);
+        return true;
+      }
+
+      // Address of file offset `offset`, which must lie inside the window
+      uint8_t *at(uint64_t offset) const { return base_ + (offset - start_); }
+
+    private:
+      void unmap()
+      {
+        if (length_ > 0)
+          ::munmap(base_, length_);
+        base_ = nullptr;
+        length_ = 0;
+      }
+
+      uint8_t *base_ = nullptr;
+      uint64_t start_ = 0;
+      std::size_t length_ = 0;
+    };
+
+    bool sameFile(const struct stat &a, const struct stat &b)
+    {
+      return a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+    }
+
+    bool openInput(const char *path, FileDescriptor &fd, struct stat &info, std::string &error)
+    {
+      fd.reset(::open(path, O_RDONLY));
+      if (fd.get() < 0)
+      {
+        error = describeError("cannot open", path, errno);
+        return false;
+      }
+      if (::fstat(fd.get(), &info) != 0)
+      {
+        error = describeError("cannot stat", path, errno);
+        return false;
+      }
+      if (!S_ISREG(info.st_mode))
+      {
+        error = std::string(path) + " is not a regular file";
+        return false;
+      }
+      return true;
+    }
+
+    // Creates output at its final size; blocks are reserved up front where the file system
+    // allows, so running out of space is reported here rather than as SIGBUS mid-write
+    bool createOutput(const char *path, uint64_t size, const struct stat *const *inputs, std::size_t inputCount,
+                      FileDescriptor &fd, std::string &error)
+    {
+      struct stat existing;
+      if (::stat(path, &existing) == 0)
+      {
+        for (std::size_t i = 0; i < inputCount; ++i)
+        {
+          if (sameFile(existing, *inputs[i]))
+          {
+            error = std::string("output ") + path + " must not be one of the inputs";
+            return false;
+          }
+        }
+      }
+      fd.reset(::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644));
+      if (fd.get() < 0)
+      {
+        error = describeError("cannot create", path, errno);
+        return false;
+      }
+      if (::ftruncate(fd.get(), static_cast<off_t>(size)) != 0)
+      {
+        error = describeError("cannot resize", path, errno);
+        return false;
+      }
+      if (size > 0)
+      {
+        int err = ::posix_fallocate(fd.get(), 0, static_cast<off_t>(size));
+        if (err != 0 && err != EOPNOTSUPP && err != EINVAL)
+        {
+          error = describeError("cannot allocate", path, err);
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool mapWindow(MappedWindow &window, const FileDescriptor &fd, const char *path, uint64_t first, uint64_t last,
+                   bool writable, std::size_t pageSize, std::string &error)
+    {
+      if (window.map(fd.get(), first, last, writable, pageSize))
+        return true;
+      error = describeError("cannot map", path, errno);
+      return false;
+    }
+
+    std::size_t windowBytes(std::size_t chunkBytes, std::size_t pageSize)
+    {
+      chunkBytes = std::max(chunkBytes, pageSize);
+      return (chunkBytes + pageSize - 1) / pageSize * pageSize;
+    }
+
+    std::size_t pageSize()
+    {
+      long size = ::sysconf(_SC_PAGESIZE);
+      return size > 0 ? static_cast<std::size_t>(size) : 4096;
+    }
+
+    // Byte-granular shift of one output window. Output byte j takes its bits from input bit
+    // 8 * j + offset, i.e. (in[j + s] >> r) | (in[j + s + 1] << (8 - r)) with offset = 8 * s + r.
+    // File byte i lives at input[i - inStart]; bytes outside [inFirst, inLast) (which covers the
+    // file's part of the window) read as 0.
+    void shiftWindow(uint8_t *out, int64_t first, int64_t last, const uint8_t *input, int64_t inStart, int64_t inFirst,
+                     int64_t inLast, int64_t s, unsigned r)
+    {
+      auto at = [&](int64_t i)
+      {
+        return input + (i - inStart);
+      };
+      auto byteAt = [&](int64_t i) -> uint64_t
+      {
+        return (i >= inFirst && i < inLast) ? *at(i) : 0;
+      };
+
+      int64_t j = first;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      // Bytes up to the first full 8-byte load, then 8 output bytes per step from unaligned loads
+      while (j < last && j + s < inFirst)
+      {
+        out[j - first] = static_cast<uint8_t>((byteAt(j + s) >> r) | (r ? byteAt(j + s + 1) << (8 - r) : 0));
+        ++j;
+      }
+      for (; j + 8 <= last && j + s + 9 <= inLast; j += 8)
+      {
+        uint64_t word;
+        std::memcpy(&word, at(j + s), sizeof(word));
+        if (r)
+          word = (word >> r) | (uint64_t(*at(j + s + 8)) << (64 - r));
+        std::memcpy(out + (j - first), &word, sizeof(word));
+      }
+#endif
+      for (; j < last; ++j)
+      {
+        out[j - first] = static_cast<uint8_t>((byteAt(j + s) >> r) | (r ? byteAt(j + s + 1) << (8 - r) : 0));
+      }
+    }
+
+    // Output bit i comes from input bit i + offset: offset = 8 * s + r with 0 <= r < 8
+    void shiftOffsets(uint64_t bits, bool left, int64_t &s, unsigned &r)
+    {
+      const int64_t offset = left ? -static_cast<int64_t>(bits) : static_cast<int64_t>(bits);
+      s = offset >= 0 ? offset / 8 : -((-offset + 7) / 8);
+      r = static_cast<unsigned>(offset - 8 * s);
+    }
+
+    // O_DIRECT wants buffers, offsets and lengths aligned to the logical block size; 4 KiB covers
+    // every common device
+    constexpr std::size_t kDirectAlignment = 4096;
+
+    uint64_t alignDown(uint64_t value)
+    {
+      return value - value % kDirectAlignment;
+    }
+
+    uint64_t alignUp(uint64_t value)
+    {
+      return alignDown(value + kDirectAlignment - 1);
+    }
+
+    // Opens path again with O_DIRECT; falls back to the buffered descriptor when the file system refuses
+    int directDescriptor(const char *path, int flags, const FileDescriptor &buffered, FileDescriptor &direct,
+                         bool wanted)
+    {
+      if (wanted)
+      {
+        direct.reset(::open(path, flags | O_DIRECT));
+        if (direct.get() >= 0)
+          return direct.get();
+      }
+      return buffered.get();
+    }
+
+    enum class StreamKind
+    {
+      Combine,
+      Invert,
+      Shift,
+      Count
+    };
+
+    struct StreamJob
+    {
+      StreamKind kind;
+      FileOp op = FileOp::And;
+      int64_t s = 0; // Shift: output bit i comes from input bit i + 8 * s + r
+      unsigned r = 0;
+      std::size_t inputCount = 1;
+      int inputs[2] = {-1, -1};
+      const char *inputPaths[2] = {nullptr, nullptr};
+      int output = -1; // -1 when nothing is written (Count)
+      const char *outputPath = nullptr;
+      uint64_t size = 0;
+      uint64_t setBits = 0; // Count result
+    };
+
+    // One chunk moving through the pipeline: output bytes [first, last), read into buffers whose
+    // byte 0 is file offset readStart
+    struct StreamSlot
+    {
+      uint64_t first = 0, last = 0;
+      uint64_t readStart = 0;
+      int64_t inFirst = 0, inLast = 0; // Shift: input bytes the chunk needs, clipped to the file
+      unsigned pendingReads = 0;
+      bool busy = false;
+      uint8_t *in[2] = {nullptr, nullptr};
+      uint8_t *out = nullptr;
+    };
+
+    // Completion tags: slot index * 4 + stage, stage 0/1 = read of input 0/1, 2 = write
+    constexpr uint64_t kWriteStage = 2;
+
+    void computeChunk(StreamJob &job, const StreamSlot &slot)
+    {
+      const std::size_t length = static_cast<std::size_t>(slot.last - slot.first);
+      const std::size_t words = length / sizeof(uint32_t);
+      const std::size_t tail = words * sizeof(uint32_t);
+      const uint32_t *a = reinterpret_cast<const uint32_t *>(slot.in[0]);
+      const uint32_t *b = reinterpret_cast<const uint32_t *>(slot.in[1]);
+      uint32_t *dst = reinterpret_cast<uint32_t *>(slot.out);
+      switch (job.kind)
+      {
+      case StreamKind::Combine:
+        if (job.op == FileOp::And)
+          bitwiseAnd(dst, a, b, words);
+        else if (job.op == FileOp::Or)
+          bitwiseOr(dst, a, b, words);
+        else
+          bitwiseXor(dst, a, b, words);
+        for (std::size_t i = tail; i < length; ++i)
+        {
+          uint8_t x = slot.in[0][i], y = slot.in[1][i];
+          slot.out[i] = job.op == FileOp::And ? (x & y) : job.op == FileOp::Or ? (x | y) : (x ^ y);
+        }
+        break;
+      case StreamKind::Invert:
+        bitwiseNot(dst, a, words);
+        for (std::size_t i = tail; i < length; ++i)
+          slot.out[i] = static_cast<uint8_t>(~slot.in[0][i]);
+        break;
+      case StreamKind::Count:
+        job.setBits += countSetBits(a, words);
+        for (std::size_t i = tail; i < length; ++i)
+          job.setBits += static_cast<uint64_t>(__builtin_popcount(slot.in[0][i]));
+        break;
+      case StreamKind::Shift:
+        if (slot.inFirst >= slot.inLast)
+          std::memset(slot.out, 0, length); // every bit was shifted in from outside the file
+        else
+          shiftWindow(slot.out, static_cast<int64_t>(slot.first), static_cast<int64_t>(slot.last), slot.in[0],
+                      static_cast<int64_t>(slot.readStart), slot.inFirst, slot.inLast, job.s, job.r);
+        break;
+      }
+    }
+
+    // Runs job chunk by chunk with up to options.depth chunks in flight. Reads for new chunks are
+    // queued as soon as a slot frees up, so the kernel works on them while this thread computes.
+    bool runStream(StreamJob &job, const StreamOptions &options, std::string &error)
+    {
+      if (job.size == 0)
+        return true;
+      const std::size_t chunk = static_cast<std::size_t>(alignUp(std::max<std::size_t>(options.chunkBytes, 1)));
+      const unsigned depth = std::max(1U, options.depth);
+      // A shifted chunk's source range is unaligned, so its aligned read may spill into one extra block per side
+      const std::size_t bufferBytes = job.kind == StreamKind::Shift ? chunk + 2 * kDirectAlignment : chunk;
+      const std::size_t buffersPerSlot = job.inputCount + (job.output >= 0 ? 1 : 0);
+
+      std::vector<uint8_t, AlignedAllocator<uint8_t, kDirectAlignment>> storage(depth * buffersPerSlot * bufferBytes);
+      std::vector<uint8_t *> buffers;
+      std::vector<StreamSlot> slots(depth);
+      for (StreamSlot &slot : slots)
+      {
+        for (std::size_t i = 0; i < job.inputCount; ++i)
+        {
+          slot.in[i] = storage.data() + buffers.size() * bufferBytes;
+          buffers.push_back(slot.in[i]);
+        }
+        if (job.output >= 0)
+        {
+          slot.out = storage.data() + buffers.size() * bufferBytes;
+          buffers.push_back(slot.out);
+        }
+      }
+
+      // Declared after the buffers so it is destroyed first
+      std::unique_ptr<IoQueue> queue = IoQueue::create(options.backend, depth * 2, error);
+      if (!queue)
+        return false;
+      queue->registerBuffers(buffers.data(), buffers.size(), bufferBytes);
+
+      // On failure the buffers must outlive every request still in flight
+      auto fail = [&]
+      {
+        IoCompletion ignored;
+        std::string unused;
+        while (queue->wait(ignored, unused))
+        {
+        }
+        return false;
+      };
+
+      const uint64_t chunks = (job.size + chunk - 1) / chunk;
+      uint64_t next = 0, finished = 0;
+
+      auto computeAndWrite = [&](std::size_t index)
+      {
+        StreamSlot &slot = slots[index];
+        computeChunk(job, slot);
+        if (job.output >= 0)
+        {
+          queue->write(job.output, slot.out, static_cast<std::size_t>(alignUp(slot.last - slot.first)), slot.first,
+                       index * 4 + kWriteStage);
+        }
+        else
+        {
+          slot.busy = false;
+          ++finished;
+        }
+      };
+
+      auto start = [&](std::size_t index, uint64_t chunkIndex)
+      {
+        StreamSlot &slot = slots[index];
+        slot.busy = true;
+        slot.first = chunkIndex * chunk;
+        slot.last = std::min<uint64_t>(job.size, slot.first + chunk);
+        slot.pendingReads = 0;
+        if (job.kind == StreamKind::Shift)
+        {
+          slot.inFirst = std::max<int64_t>(0, static_cast<int64_t>(slot.first) + job.s);
+          slot.inLast = std::min<int64_t>(static_cast<int64_t>(job.size), static_cast<int64_t>(slot.last) + job.s + 1);
+          if (slot.inFirst < slot.inLast)
+          {
+            slot.readStart = alignDown(static_cast<uint64_t>(slot.inFirst));
+            queue->read(job.inputs[0], slot.in[0], static_cast<std::size_t>(alignUp(static_cast<uint64_t>(slot.inLast)) - slot.readStart),
+                        slot.readStart, index * 4);
+            slot.pendingReads = 1;
+          }
+        }
+        else
+        {
+          slot.readStart = slot.first;
+          for (std::size_t i = 0; i < job.inputCount; ++i)
+            queue->read(job.inputs[i], slot.in[i], static_cast<std::size_t>(alignUp(slot.last - slot.first)), slot.first,
+                        index * 4 + i);
+          slot.pendingReads = static_cast<unsigned>(job.inputCount);
+        }
+        if (slot.pendingReads == 0)
+          computeAndWrite(index);
+      };
+
+      while (finished < chunks)
+      {
+        for (std::size_t index = 0; index < slots.size() && next < chunks; ++index)
+        {
+          if (!slots[index].busy)
+            start(index, next++);
+        }
+
+        IoCompletion completion;
+        if (!queue->wait(completion, error))
+          return fail();
+        const std::size_t index = static_cast<std::size_t>(completion.tag / 4);
+        const uint64_t stage = completion.tag % 4;
+        StreamSlot &slot = slots[index];
+        const char *path = stage == kWriteStage ? job.outputPath : job.inputPaths[stage];
+        if (completion.result < 0)
+        {
+          error = describeError(stage == kWriteStage ? "cannot write" : "cannot read", path,
+                                static_cast<int>(-completion.result));
+          return fail();
+        }
+
+        if (stage == kWriteStage)
+        {
+          if (static_cast<uint64_t>(completion.result) < slot.last - slot.first)
+          {
+            error = std::string("short write to ") + path;
+            return fail();
+          }
+          slot.busy = false;
+          ++finished;
+          continue;
+        }
+
+        // Reads come back short only at the end of the file, and never before the bytes the chunk needs
+        const uint64_t needed = job.kind == StreamKind::Shift ? static_cast<uint64_t>(slot.inLast) - slot.readStart
+                                                              : slot.last - slot.first;
+        if (static_cast<uint64_t>(completion.result) < needed)
+        {
+          error = std::string(path) + " changed size while being read";
+          return fail();
+        }
+        if (--slot.pendingReads == 0)
+          computeAndWrite(index);
+      }
+
+      // Aligned writes may have run past the end of the file
+      if (job.output >= 0 && job.size % kDirectAlignment != 0 && ::ftruncate(job.output, static_cast<off_t>(job.size)) != 0)
+      {
+        error = describeError("cannot resize", job.outputPath, errno);
+        return false;
+      }
+      return true;
+    }
+  } // namespace
+
+  bool combineFiles(FileOp op, const char *inputA, const char *inputB, const char *output, std::string &error,
+                    std::size_t chunkBytes)
+  {
+    BITWISE_STATS_SCOPE(FileCombine, 0);
+    FileDescriptor fdA, fdB, fdOut;
+    struct stat infoA, infoB;
+    if (!openInput(inputA, fdA, infoA, error) || !openInput(inputB, fdB, infoB, error))
+      return false;
+    if (infoA.st_size != infoB.st_size)
+    {
+      error = std::string(inputA) + " and " + inputB + " differ in size";
+      return false;
+    }
+    const struct stat *inputs[] = {&infoA, &infoB};
+    const uint64_t size = static_cast<uint64_t>(infoA.st_size);
+    BITWISE_STATS_SET_BYTES(3 * size);
+    if (!createOutput(output, size, inputs, 2, fdOut, error))
+      return false;
+
+    const std::size_t page = pageSize();
+    const std::size_t window = windowBytes(chunkBytes, page);
+    for (uint64_t first = 0; first < size; first += window)
+    {
+      uint64_t last = std::min<uint64_t>(size, first + window);
+      MappedWindow a, b, out;
+      if (!mapWindow(a, fdA, inputA, first, last, false, page, error) ||
+          !mapWindow(b, fdB, inputB, first, last, false, page, error) ||
+          !mapWindow(out, fdOut, output, first, last, true, page, error))
+        return false;
+
+      // Windows start on page boundaries, so the word view is aligned; a ragged tail is done bytewise
+      std::size_t length = static_cast<std::size_t>(last - first);
+      std::size_t words = length / sizeof(uint32_t);
+      uint32_t *dst = reinterpret_cast<uint32_t *>(out.at(first));
+      const uint32_t *srcA = reinterpret_cast<const uint32_t *>(a.at(first));
+      const uint32_t *srcB = reinterpret_cast<const uint32_t *>(b.at(first));
+      switch (op)
+      {
+      case FileOp::And:
+        bitwiseAnd(dst, srcA, srcB, words);
+        break;
+      case FileOp::Or:
+        bitwiseOr(dst, srcA, srcB, words);
+        break;
+      case FileOp::Xor:
+        bitwiseXor(dst, srcA, srcB, words);
+        break;
+      }
+      for (std::size_t i = words * sizeof(uint32_t); i < length; ++i)
+      {
+        uint8_t x = *a.at(first + i), y = *b.at(first + i);
+        *out.at(first + i) = op == FileOp::And ? (x & y) : op == FileOp::Or ? (x | y) : (x ^ y);
+      }
+    }
+    return true;
+  }
+
+  bool invertFile(const char *input, const char *output, std::string &error, std::size_t chunkBytes)
+  {
+    BITWISE_STATS_SCOPE(FileInvert, 0);
+    FileDescriptor fdIn, fdOut;
+    struct stat info;
+    if (!openInput(input, fdIn, info, error))
+      return false;
+    const struct stat *inputs[] = {&info};
+    const uint64_t size = static_cast<uint64_t>(info.st_size);
+    BITWISE_STATS_SET_BYTES(2 * size);
+    if (!createOutput(output, size, inputs, 1, fdOut, error))
+      return false;
+
+    const std::size_t page = pageSize();
+    const std::size_t window = windowBytes(chunkBytes, page);
+    for (uint64_t first = 0; first < size; first += window)
+    {
+      uint64_t last = std::min<uint64_t>(size, first + window);
+      MappedWindow in, out;
+      if (!mapWindow(in, fdIn, input, first, last, false, page, error) ||
+          !mapWindow(out, fdOut, output, first, last, true, page, error))
+        return false;
+      std::size_t length = static_cast<std::size_t>(last - first);
+      std::size_t words = length / sizeof(uint32_t);
+      bitwiseNot(reinterpret_cast<uint32_t *>(out.at(first)), reinterpret_cast<const uint32_t *>(in.at(first)), words);
+      for (std::size_t i = words * sizeof(uint32_t); i < length; ++i)
+      {
+        *out.at(first + i) = static_cast<uint8_t>(~*in.at(first + i));
+      }
+    }
+    return true;
+  }
+
+  bool shiftFile(const char *input, const char *output, uint64_t bits, bool left, std::string &error,
+                 std::size_t chunkBytes)
+  {
+    BITWISE_STATS_SCOPE(FileShift, 0);
+    FileDescriptor fdIn, fdOut;
+    struct stat info;
+    if (!openInput(input, fdIn, info, error))
+      return false;
+    const struct stat *inputs[] = {&info};
+    const uint64_t size = static_cast<uint64_t>(info.st_size);
+    BITWISE_STATS_SET_BYTES(2 * size);
+    if (!createOutput(output, size, inputs, 1, fdOut, error))
+      return false;
+    if (size == 0 || bits >= size * 8)
+      return true; // the output is all zeros, which is what ftruncate left
+
+    int64_t s;
+    unsigned r;
+    shiftOffsets(bits, left, s, r);
+
+    const std::size_t page = pageSize();
+    const std::size_t window = windowBytes(chunkBytes, page);
+    const int64_t fileSize = static_cast<int64_t>(size);
+    for (uint64_t first = 0; first < size; first += window)
+    {
+      uint64_t last = std::min<uint64_t>(size, first + window);
+      // Input bytes this window reads, clipped to the file
+      int64_t inFirst = std::max<int64_t>(0, static_cast<int64_t>(first) + s);
+      int64_t inLast = std::min<int64_t>(fileSize, static_cast<int64_t>(last) + s + 1);
+      if (inFirst >= inLast)
+        continue; // every bit of this window was shifted in from outside the file
+      MappedWindow in, out;
+      if (!mapWindow(in, fdIn, input, static_cast<uint64_t>(inFirst), static_cast<uint64_t>(inLast), false, page, error) ||
+          !mapWindow(out, fdOut, output, first, last, true, page, error))
+        return false;
+      shiftWindow(out.at(first), static_cast<int64_t>(first), static_cast<int64_t>(last), in.at(static_cast<uint64_t>(inFirst)),
+                  inFirst, inFirst, inLast, s, r);
+    }
+    return true;
+  }
+
+  bool streamCombineFiles(FileOp op, const char *inputA, const char *inputB, const char *output, std::string &error,
+                          const StreamOptions &options)
+  {
+    BITWISE_STATS_SCOPE(FileCombine, 0);
+    FileDescriptor fdA, fdB, fdOut, directA, directB, directOut;
+    struct stat infoA, infoB;
+    if (!openInput(inputA, fdA, infoA, error) || !openInput(inputB, fdB, infoB, error))
+      return false;
+    if (infoA.st_size != infoB.st_size)
+    {
+      error = std::string(inputA) + " and " + inputB + " differ in size";
+      return false;
+    }
+    const struct stat *inputs[] = {&infoA, &infoB};
+    StreamJob job;
+    job.kind = StreamKind::Combine;
+    job.op = op;
+    job.size = static_cast<uint64_t>(infoA.st_size);
+    BITWISE_STATS_SET_BYTES(3 * job.size);
+    if (!createOutput(output, job.size, inputs, 2, fdOut, error))
+      return false;
+    job.inputCount = 2;
+    job.inputs[0] = directDescriptor(inputA, O_RDONLY, fdA, directA, options.direct);
+    job.inputs[1] = directDescriptor(inputB, O_RDONLY, fdB, directB, options.direct);
+    job.output = directDescriptor(output, O_WRONLY, fdOut, directOut, options.direct);
+    job.inputPaths[0] = inputA;
+    job.inputPaths[1] = inputB;
+    job.outputPath = output;
+    return runStream(job, options, error);
+  }
+
+  bool streamInvertFile(const char *input, const char *output, std::string &error, const StreamOptions &options)
+  {
+    BITWISE_STATS_SCOPE(FileInvert, 0);
+    FileDescriptor fdIn, fdOut, directIn, directOut;
+    struct stat info;
+    if (!openInput(input, fdIn, info, error))
+      return false;
+    const struct stat *inputs[] = {&info};
+    StreamJob job;
+    job.kind = StreamKind::Invert;
+    job.size = static_cast<uint64_t>(info.st_size);
+    BITWISE_STATS_SET_BYTES(2 * job.size);
+    if (!createOutput(output, job.size, inputs, 1, fdOut, error))
+      return false;
+    job.inputs[0] = directDescriptor(input, O_RDONLY, fdIn, directIn, options.direct);
+    job.output = directDescriptor(output, O_WRONLY, fdOut, directOut, options.direct);
+    job.inputPaths[0] = input;
+    job.outputPath = output;
+    return runStream(job, options, error);
+  }
+
+  bool streamShiftFile(const char *input, const char *output, uint64_t bits, bool left, std::string &error,
+                       const StreamOptions &options)
+  {
+    BITWISE_STATS_SCOPE(FileShift, 0);
+    FileDescriptor fdIn, fdOut, directIn, directOut;
+    struct stat info;
+    if (!openInput(input, fdIn, info, error))
+      return false;
+    const struct stat *inputs[] = {&info};
+    StreamJob job;
+    job.kind = StreamKind::Shift;
+    job.size = static_cast<uint64_t>(info.st_size);
+    BITWISE_STATS_SET_BYTES(2 * job.size);
+    if (!createOutput(output, job.size, inputs, 1, fdOut, error))
+      return false;
+    if (job.size == 0 || bits >= job.size * 8)
+      return true; // the output is all zeros, which is what ftruncate left
+    shiftOffsets(bits, left, job.s, job.r);
+    job.inputs[0] = directDescriptor(input, O_RDONLY, fdIn, directIn, options.direct);
+    job.output = directDescriptor(output, O_WRONLY, fdOut, directOut, options.direct);
+    job.inputPaths[0] = input;
+    job.outputPath = output;
+    return runStream(job, options, error);
+  }
+
+  bool streamCountSetBits(const char *input, uint64_t &count, std::string &error, const StreamOptions &options)
+  {
+    BITWISE_STATS_SCOPE(FileCountSetBits, 0);
+    FileDescriptor fdIn, directIn;
+    struct stat info;
+    if (!openInput(input, fdIn, info, error))
+      return false;
+    StreamJob job;
+    job.kind = StreamKind::Count;
+    job.size = static_cast<uint64_t>(info.st_size);
+    BITWISE_STATS_SET_BYTES(job.size);
+    job.inputs[0] = directDescriptor(input, O_RDONLY, fdIn, directIn, options.direct);
+    job.inputPaths[0] = input;
+    if (!runStream(job, options, error))
+      return false;
+    count = job.setBits;
+    return true;
+  }
+
+} // namespace bitwise
@@ -0,0 +1,409 @@
+#include "io_queue.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace bitwise
+{
+  namespace
+  {
+    int ioUringSetup(unsigned entries, io_uring_params *params)
+    {
+      return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int ioUringEnter(int fd, unsigned submit, unsigned minComplete, unsigned flags)
+    {
+      return static_cast<int>(::syscall(__NR_io_uring_enter, fd, submit, minComplete, flags, nullptr, 0));
+    }
+
+    int ioUringRegister(int fd, unsigned opcode, const void *arg, unsigned count)
+    {
+      return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+    }
+
+    std::string describeError(const char *action, int err)
+    {
+      return std::string(action) + ": " + std::strerror(err);
+    }
+
+    // The rings are shared with the kernel: our side publishes the SQ tail and CQ head with
+    // release stores and reads the kernel's CQ tail with an acquire load. Each SQE's user_data
+    // indexes requests_, so a short transfer can be resubmitted for the remainder and the caller
+    // sees one completion for the whole request, as with the thread backend's pread/pwrite loop
+    class IoUringQueue : public IoQueue
+    {
+    public:
+      ~IoUringQueue() override
+      {
+        if (sqRing_ != MAP_FAILED)
+          ::munmap(sqRing_, sqRingBytes_);
+        if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_)
+          ::munmap(cqRing_, cqRingBytes_);
+        if (sqes_ != MAP_FAILED)
+          ::munmap(sqes_, sqesBytes_);
+        if (fd_ >= 0)
+          ::close(fd_);
+      }
+
+      bool init(unsigned depth, std::string &error)
+      {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd_ = ioUringSetup(depth, &params);
+        if (fd_ < 0)
+        {
+          error = describeError("io_uring_setup failed", errno);
+          return false;
+        }
+
+        sqRingBytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap)
+          sqRingBytes_ = cqRingBytes_ = std::max(sqRingBytes_, cqRingBytes_);
+        sqRing_ = ::mmap(nullptr, sqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                         IORING_OFF_SQ_RING);
+        cqRing_ = singleMap ? sqRing_
+                            : ::mmap(nullptr, cqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                                     IORING_OFF_CQ_RING);
+        sqesBytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = ::mmap(nullptr, sqesBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sqRing_ == MAP_FAILED || cqRing_ == MAP_FAILED || sqes_ == MAP_FAILED)
+        {
+          error = describeError("cannot map the io_uring rings", errno);
+          return false;
+        }
+
+        uint8_t *sq = static_cast<uint8_t *>(sqRing_);
+        uint8_t *cq = static_cast<uint8_t *>(cqRing_);
+        sqTail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        cqHead_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        return true;
+      }
+
+      IoBackend backend() const override { return IoBackend::IoUring; }
+
+      bool registerBuffers(uint8_t *const *buffers, std::size_t count, std::size_t bytesEach) override
+      {
+        std::vector<iovec> vectors(count);
+        for (std::size_t i = 0; i < count; ++i)
+          vectors[i] = {buffers[i], bytesEach};
+        if (ioUringRegister(fd_, IORING_REGISTER_BUFFERS, vectors.data(), static_cast<unsigned>(count)) != 0)
+          return false; // usually RLIMIT_MEMLOCK; plain READ/WRITE still work
+        registered_.assign(buffers, buffers + count);
+        registeredBytes_ = bytesEach;
+        return true;
+      }
+
+      void read(int fd, uint8_t *buffer, std::size_t length, uint64_t offset, uint64_t tag) override
+      {
+        queue(false, fd, buffer, length, offset, tag);
+      }
+
+      void write(int fd, const uint8_t *buffer, std::size_t length, uint64_t offset, uint64_t tag) override
+      {
+        queue(true, fd, const_cast<uint8_t *>(buffer), length, offset, tag);
+      }
+
+      bool wait(IoCompletion &completion, std::string &error) override
+      {
+        while (true)
+        {
+          const unsigned head = *cqHead_;
+          if (head != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE))
+          {
+            const io_uring_cqe &cqe = cqes_[head & cqMask_];
+            const std::size_t index = static_cast<std::size_t>(cqe.user_data);
+            const int res = cqe.res;
+            __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+            --inFlight_;
+
+            Request &request = requests_[index];
+            if (res == -EINTR || (res > 0 && request.done + static_cast<std::size_t>(res) < request.length))
+            {
+              // Interrupted or short: continue from where the transfer stopped (0 bytes means end of file)
+              request.done += res > 0 ? static_cast<std::size_t>(res) : 0;
+              submit(index);
+              continue;
+            }
+            completion.tag = request.tag;
+            completion.result = res < 0 ? res : static_cast<int64_t>(request.done + static_cast<std::size_t>(res));
+            freeRequests_.push_back(index);
+            return true;
+          }
+          if (inFlight_ == 0)
+          {
+            error = "no I/O requests in flight";
+            return false;
+          }
+          // Submits everything queued and sleeps until at least one request completes
+          int submitted = ioUringEnter(fd_, unsubmitted_, 1, IORING_ENTER_GETEVENTS);
+          if (submitted < 0)
+          {
+            if (errno == EINTR)
+              continue;
+            error = describeError("io_uring_enter failed", errno);
+            return false;
+          }
+          unsubmitted_ -= static_cast<unsigned>(submitted);
+        }
+      }
+
+    private:
+      struct Request
+      {
+        bool write;
+        int fd;
+        uint8_t *buffer;
+        std::size_t length;
+        uint64_t offset;
+        uint64_t tag;
+        std::size_t done; // bytes transferred by earlier, short completions
+      };
+
+      void queue(bool write, int fd, uint8_t *buffer, std::size_t length, uint64_t offset, uint64_t tag)
+      {
+        std::size_t index = requests_.size();
+        if (freeRequests_.empty())
+        {
+          requests_.emplace_back();
+        }
+        else
+        {
+          index = freeRequests_.back();
+          freeRequests_.pop_back();
+        }
+        requests_[index] = {write, fd, buffer, length, offset, tag, 0};
+        submit(index);
+      }
+
+      // Places the untransferred part of request index in the SQ ring
+      void submit(std::size_t index)
+      {
+        const Request &request = requests_[index];
+        uint8_t *buffer = request.buffer + request.done;
+        const std::size_t length = request.length - request.done;
+        const unsigned tail = *sqTail_;
+        const unsigned slot = tail & sqMask_;
+        io_uring_sqe &sqe = static_cast<io_uring_sqe *>(sqes_)[slot];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = request.write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe.fd = request.fd;
+        sqe.addr = reinterpret_cast<uint64_t>(buffer);
+        sqe.len = static_cast<uint32_t>(length);
+        sqe.off = request.offset + request.done;
+        sqe.user_data = index;
+        for (std::size_t i = 0; i < registered_.size(); ++i)
+        {
+          if (buffer >= registered_[i] && buffer + length <= registered_[i] + registeredBytes_)
+          {
+            sqe.opcode = request.write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            sqe.buf_index = static_cast<uint16_t>(i);
+            break;
+          }
+        }
+        sqArray_[slot] = slot;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        ++unsubmitted_;
+        ++inFlight_;
+      }
+
+      int fd_ = -1;
+      void *sqRing_ = MAP_FAILED;
+      void *cqRing_ = MAP_FAILED;
+      void *sqes_ = MAP_FAILED;
+      std::size_t sqRingBytes_ = 0, cqRingBytes_ = 0, sqesBytes_ = 0;
+      unsigned *sqTail_ = nullptr;
+      unsigned *sqArray_ = nullptr;
+      unsigned sqMask_ = 0;
+      unsigned *cqHead_ = nullptr;
+      unsigned *cqTail_ = nullptr;
+      unsigned cqMask_ = 0;
+      io_uring_cqe *cqes_ = nullptr;
+      unsigned unsubmitted_ = 0; // queued in the SQ ring but not yet passed to io_uring_enter
+      unsigned inFlight_ = 0;    // queued or running, completion not yet reaped
+      std::vector<uint8_t *> registered_;
+      std::size_t registeredBytes_ = 0;
+      std::vector<Request> requests_;        // indexed by user_data
+      std::vector<std::size_t> freeRequests_; // entries of requests_ not in flight
+    };
+
+    class ThreadIoQueue : public IoQueue
+    {
+    public:
+      explicit ThreadIoQueue(unsigned depth)
+      {
+        unsigned threads = std::max(1U, std::min(depth, 4U));
+        for (unsigned t = 0; t < threads; ++t)
+          threads_.emplace_back(&ThreadIoQueue::workerLoop, this);
+      }
+
+      ~ThreadIoQueue() override
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          stopping_ = true;
+        }
+        work_.notify_all();
+        for (std::thread &thread : threads_)
+          thread.join();
+      }
+
+      IoBackend backend() const override { return IoBackend::Threads; }
+
+      bool registerBuffers(uint8_t *const *, std::size_t, std::size_t) override { return false; }
+
+      void read(int fd, uint8_t *buffer, std::size_t length, uint64_t offset, uint64_t tag) override
+      {
+        staged_.push_back({false, fd, buffer, length, offset, tag});
+      }
+
+      void write(int fd, const uint8_t *buffer, std::size_t length, uint64_t offset, uint64_t tag) override
+      {
+        staged_.push_back({true, fd, const_cast<uint8_t *>(buffer), length, offset, tag});
+      }
+
+      bool wait(IoCompletion &completion, std::string &error) override
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!staged_.empty())
+        {
+          inFlight_ += staged_.size();
+          requests_.insert(requests_.end(), staged_.begin(), staged_.end());
+          staged_.clear();
+          work_.notify_all();
+        }
+        if (completions_.empty() && inFlight_ == 0)
+        {
+          error = "no I/O requests in flight";
+          return false;
+        }
+        done_.wait(lock, [this]
+                   { return !completions_.empty(); });
+        completion = completions_.front();
+        completions_.pop_front();
+        --inFlight_;
+        return true;
+      }
+
+    private:
+      struct Request
+      {
+        bool write;
+        int fd;
+        uint8_t *buffer;
+        std::size_t length;
+        uint64_t offset;
+        uint64_t tag;
+      };
+
+      static int64_t transfer(const Request &request)
+      {
+        std::size_t done = 0;
+        while (done < request.length)
+        {
+          off_t at = static_cast<off_t>(request.offset + done);
+          ssize_t n = request.write ? ::pwrite(request.fd, request.buffer + done, request.length - done, at)
+                                    : ::pread(request.fd, request.buffer + done, request.length - done, at);
+          if (n < 0)
+          {
+            if (errno == EINTR)
+              continue;
+            return -errno;
+          }
+          if (n == 0)
+            break; // end of file
+          done += static_cast<std::size_t>(n);
+        }
+        return static_cast<int64_t>(done);
+      }
+
+      void workerLoop()
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+          work_.wait(lock, [this]
+                     { return stopping_ || !requests_.empty(); });
+          if (stopping_)
+            return;
+          Request request = requests_.front();
+          requests_.pop_front();
+          lock.unlock();
+          IoCompletion completion{request.tag, transfer(request)};
+          lock.lock();
+          completions_.push_back(completion);
+          done_.notify_one();
+        }
+      }
+
+      std::vector<Request> staged_; // touched only by the owning thread
+      std::mutex mutex_;
+      std::condition_variable work_; // workers: requests were queued or the queue is stopping
+      std::condition_variable done_; // owner: a completion is available
+      std::deque<Request> requests_;
+      std::deque<IoCompletion> completions_;
+      std::size_t inFlight_ = 0;
+      bool stopping_ = false;
+      std::vector<std::thread> threads_;
+    };
+  } // namespace
+
+  const char *ioBackendName(IoBackend backend)
+  {
+    switch (backend)
+    {
+    case IoBackend::Auto:
+      return "auto";
+    case IoBackend::IoUring:
+      return "io_uring";
+    case IoBackend::Threads:
+      return "threads";
+    }
+    return "unknown";
+  }
+
+  bool ioUringAvailable()
+  {
+    static const bool available = []
+    {
+      io_uring_params params;
+      std::memset(&params, 0, sizeof(params));
+      int fd = ioUringSetup(1, &params);
+      if (fd < 0)
+        return false;
+      ::close(fd);
+      return true;
+    }();
+    return available;
+  }
+
+  std::unique_ptr<IoQueue> IoQueue::create(IoBackend backend, unsigned depth, std::string &error)
+  {
+    depth = std::max(1U, depth);
+    if (backend == IoBackend::Threads || (backend == IoBackend::Auto && !ioUringAvailable()))
+      return std::unique_ptr<IoQueue>(new ThreadIoQueue(depth));
+
+    std::unique_ptr<IoUringQueue> queue(new IoUringQueue());
+    if (!queue->init(depth, error))
+      return nullptr;
+    return queue;
+  }
+
+} // namespace bitwise
@@ -1,7 +1,20 @@
 #include "bitwise_utils.h"
+#include "big_unsigned.h"
+#include "batch_mode.h"
+#include "bitwise_service.h"
+#include "bitwise_stats.h"
+#include "file_ops.h"
+#include "render_sink.h"
 #include <iostream>
 #include <string>
+#include <vector>
 #include <limits>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
 
 void printMenu()
 {
@@ -101,28 +114,272 @@ uint32_t getInput(const std::string &prompt)
   return value;
 }
 
-int getBitPosition()
+int getIntInRange(const std::string &prompt, int low, int high)
 {
-  int position;
+  int value;
   while (true)
   {
-    std::cout << "Enter bit position (0-31): ";
-    if (std::cin >> position && position >= 0 && position <= 31)
+    std::cout << prompt << "(" << low << "-" << high << "): ";
+    if (std::cin >> value && value >= low && value <= high)
     {
       break;
     }
     else
     {
-      std::cout << "Invalid input. Please enter a number between 0 and 31." << std::endl;
+      std::cout << "Invalid input. Please enter a number between " << low << " and " << high << "." << std::endl;
       std::cin.clear();
       std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
     }
   }
-  return position;
+  return value;
 }
 
-int main()
+int getBitPosition()
 {
+  return getIntInRange("Enter bit position ", 0, 31);
+}
+
+void printUsage(const char *program)
+{
+  std::cout << "Usage:\n"
+            << "  " << program << "                 Interactive menu\n"
+            << "  " << program << " --batch [FILE]  Evaluate one operation per line from FILE (or stdin)\n"
+            << "  " << program << " --and|--or|--xor A B -o OUT  Combine two equally sized files bit by bit\n"
+            << "  " << program << " --not A -o OUT               Invert every bit of a file\n"
+            << "  " << program << " --shl|--shr A BITS -o OUT    Shift a whole file (bit i = byte i/8, bit i%8)\n"
+            << "  " << program << " --popcount A                 Count the set bits of a file\n"
+            << "                                      File modes accept --stream to pipeline the I/O through\n"
+            << "                                      io_uring (or threads) with O_DIRECT instead of mmap\n"
+            << "  " << program << " --radix FROM TO NUMBER       Convert a number of any length between bases 2-36\n"
+            << "  " << program << " --serve ADDRESS              Serve the binary request protocol on unix:PATH,\n"
+            << "                                      HOST:PORT or PORT (loopback) until SIGINT/SIGTERM\n"
+            << "  " << program << " --stats [MODE ...]           Run a mode, then print per-operation counts and\n"
+            << "                                      latencies as JSON on stderr\n"
+            << "\nBatch operations (operands in decimal, 0x hex or 0b binary):\n"
+            << "  AND a b | OR a b | XOR a b | NOT a | SHL a n | SHR a n | POPCNT a\n"
+            << "  ISSET a pos | SET a pos | CLEAR a pos | TOGGLE a pos | BIN a | HEX a\n";
+}
+
+int runBatchMode(const char *path)
+{
+  int fd = STDIN_FILENO;
+  if (path != nullptr && std::strcmp(path, "-") != 0)
+  {
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+      std::cerr << "Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+      return 2;
+    }
+  }
+
+  bitwise::FdSink output(STDOUT_FILENO);
+  bitwise::BatchResult result = bitwise::runBatch(fd, output);
+  if (fd != STDIN_FILENO)
+  {
+    close(fd);
+  }
+  if (result.readError != 0)
+  {
+    std::cerr << "Cannot read " << (fd != STDIN_FILENO ? path : "standard input") << ": "
+              << std::strerror(result.readError) << std::endl;
+    return 1;
+  }
+  return result.errors == 0 ? 0 : 1;
+}
+
+bool isFileMode(const std::string &mode)
+{
+  return mode == "--and" || mode == "--or" || mode == "--xor" || mode == "--not" || mode == "--shl" || mode == "--shr" ||
+         mode == "--popcount";
+}
+
+int runFileMode(int argc, char **argv)
+{
+  std::string mode = argv[1];
+  std::vector<const char *> operands;
+  const char *output = nullptr;
+  bool stream = false;
+  for (int i = 2; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+    {
+      output = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--stream") == 0)
+    {
+      stream = true;
+    }
+    else
+    {
+      operands.push_back(argv[i]);
+    }
+  }
+
+  const bool popcount = mode == "--popcount";
+  std::size_t expected = (mode == "--not" || popcount) ? 1 : 2;
+  if ((output == nullptr) != popcount || operands.size() != expected)
+  {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  std::string error;
+  bool ok;
+  if (popcount)
+  {
+    uint64_t count = 0;
+    ok = bitwise::streamCountSetBits(operands[0], count, error);
+    if (ok)
+    {
+      std::cout << count << std::endl;
+    }
+  }
+  else if (mode == "--not")
+  {
+    ok = stream ? bitwise::streamInvertFile(operands[0], output, error) : bitwise::invertFile(operands[0], output, error);
+  }
+  else if (mode == "--shl" || mode == "--shr")
+  {
+    uint64_t bits = 0;
+    const char *last = operands[1] + std::strlen(operands[1]);
+    std::from_chars_result parsed = std::from_chars(operands[1], last, bits);
+    if (parsed.ec != std::errc() || parsed.ptr != last)
+    {
+      std::cerr << "Invalid shift distance: " << operands[1] << std::endl;
+      return 2;
+    }
+    ok = stream ? bitwise::streamShiftFile(operands[0], output, bits, mode == "--shl", error)
+                : bitwise::shiftFile(operands[0], output, bits, mode == "--shl", error);
+  }
+  else
+  {
+    bitwise::FileOp op = mode == "--and" ? bitwise::FileOp::And : mode == "--or" ? bitwise::FileOp::Or : bitwise::FileOp::Xor;
+    ok = stream ? bitwise::streamCombineFiles(op, operands[0], operands[1], output, error)
+                : bitwise::combineFiles(op, operands[0], operands[1], output, error);
+  }
+
+  if (!ok)
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int runRadixMode(const char *from, const char *to, const char *number)
+{
+  unsigned bases[2] = {0, 0};
+  const char *texts[2] = {from, to};
+  for (int i = 0; i < 2; ++i)
+  {
+    const char *last = texts[i] + std::strlen(texts[i]);
+    std::from_chars_result parsed = std::from_chars(texts[i], last, bases[i]);
+    if (parsed.ec != std::errc() || parsed.ptr != last || bases[i] < 2 || bases[i] > 36)
+    {
+      std::cerr << "Invalid base: " << texts[i] << " (expected 2-36)" << std::endl;
+      return 2;
+    }
+  }
+
+  std::string output, error;
+  if (!bitwise::convertRadix(number, bases[0], bases[1], output, error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  std::cout << output << std::endl;
+  return 0;
+}
+
+bitwise::service::Server *activeServer = nullptr;
+
+void stopServer(int)
+{
+  // stop() writes to an eventfd, which may set errno under the interrupted code
+  const int savedErrno = errno;
+  if (activeServer != nullptr)
+    activeServer->stop();
+  errno = savedErrno;
+}
+
+int runServeMode(const char *address)
+{
+  bitwise::service::Address parsed;
+  std::string error;
+  if (!bitwise::service::parseAddress(address, parsed, error))
+  {
+    std::cerr << error << std::endl;
+    return 2;
+  }
+
+  bitwise::service::Server server;
+  if (!server.listen(parsed, error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  if (parsed.unixPath.empty())
+    std::cerr << "Serving on " << parsed.host << ":" << server.port() << std::endl;
+  else
+    std::cerr << "Serving on unix:" << parsed.unixPath << std::endl;
+
+  activeServer = &server;
+  std::signal(SIGINT, stopServer);
+  std::signal(SIGTERM, stopServer);
+  server.run();
+  activeServer = nullptr;
+  return 0;
+}
+
+// Prints the collected operation statistics as JSON on stderr when main returns
+struct StatsReport
+{
+  bool active = false;
+
+  ~StatsReport()
+  {
+    if (active)
+      std::cerr << bitwise::stats::toJson(bitwise::stats::snapshot()) << std::endl;
+  }
+};
+
+int main(int argc, char **argv)
+{
+  // --stats may precede any mode; drop it so the modes see their usual arguments
+  StatsReport report;
+  if (argc > 1 && std::strcmp(argv[1], "--stats") == 0)
+  {
+    report.active = true;
+    bitwise::stats::setEnabled(true);
+    argv[1] = argv[0];
+    ++argv;
+    --argc;
+  }
+
+  if (argc > 1)
+  {
+    std::string mode = argv[1];
+    if (mode == "--batch")
+    {
+      return runBatchMode(argc > 2 ? argv[2] : nullptr);
+    }
+    if (isFileMode(mode))
+    {
+      return runFileMode(argc, argv);
+    }
+    if (mode == "--radix" && argc == 5)
+    {
+      return runRadixMode(argv[2], argv[3], argv[4]);
+    }
+    if (mode == "--serve" && argc == 3)
+    {
+      return runServeMode(argv[2]);
+    }
+    printUsage(argv[0]);
+    return (mode == "--help" || mode == "-h") ? 0 : 2;
+  }
+
   std::cout << "\n"
             << " <== Welcome to the Bitwise Operators Learning Tool ==>" << std::endl;
   std::cout << "This tool helps understand and visualize bitwise operations in C++." << std::endl;
@@ -183,7 +440,7 @@ int main()
     case 5:
     { // Left Shift
       uint32_t a = getInput("Enter number: ");
-      int shift = getInput("Enter shift amount: ");
+      int shift = getIntInRange("Enter shift amount ", 0, 31);
       uint32_t result = bitwise::leftShift(a, shift);
       bitwise::displayShiftOperation(a, shift, result, "LEFT");
       break;
@@ -192,7 +449,7 @@ int main()
     case 6:
     { // Right Shift
       uint32_t a = getInput("Enter number: ");
-      int shift = getInput("Enter shift amount: ");
+      int shift = getIntInRange("Enter shift amount ", 0, 31);
       uint32_t result = bitwise::rightShift(a, shift);
       bitwise::displayShiftOperation(a, shift, result, "RIGHT");
       break;
@@ -253,8 +510,9 @@ int main()
 
     case 13:
     { // Print out a binary table
-      int table_length = getInput("Enter desired table length: ");
-      int basis = getInput("Enter the basis for the table (number of valid selections per bit): ");
+      // Same bounds as the --serve base table request
+      int table_length = getIntInRange("Enter desired table length ", 0, 64);
+      int basis = getIntInRange("Enter the basis for the table (number of valid selections per bit) ", 2, 36);
       bitwise::displayBaseTable(table_length, basis);
       break;
     }
@@ -0,0 +1,774 @@
+#include "morton.h"
+#include "bitwise_generic.h"
+#include "bitwise_stats.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITWISE_X86 1
+#endif
+
+namespace bitwise
+{
+  namespace
+  {
+    // Code bits that hold x; y and z sit one and two places higher
+    constexpr uint32_t kEvenBits32 = 0x55555555U;
+    constexpr uint64_t kEvenBits64 = 0x5555555555555555ULL;
+    constexpr uint32_t kThirdBits32 = 0x09249249U;
+    constexpr uint64_t kThirdBits64 = 0x1249249249249249ULL;
+
+    const bool kHasBmi2 = cpuFeatures().bmi2;
+
+    // Magic-number spreading: every step moves the upper half of each group of bits up by the
+    // group size (2-D) or twice the group size (3-D), then masks off the copies left behind
+    inline uint32_t spread2(uint32_t v)
+    {
+      v &= 0x0000FFFFU;
+      v = (v | (v << 8)) & 0x00FF00FFU;
+      v = (v | (v << 4)) & 0x0F0F0F0FU;
+      v = (v | (v << 2)) & 0x33333333U;
+      return (v | (v << 1)) & 0x55555555U;
+    }
+
+    inline uint64_t spread2(uint64_t v)
+    {
+      v &= 0x00000000FFFFFFFFULL;
+      v = (v | (v << 16)) & 0x0000FFFF0000FFFFULL;
+      v = (v | (v << 8)) & 0x00FF00FF00FF00FFULL;
+      v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+      v = (v | (v << 2)) & 0x3333333333333333ULL;
+      return (v | (v << 1)) & 0x5555555555555555ULL;
+    }
+
+    inline uint32_t spread3(uint32_t v)
+    {
+      v &= 0x000003FFU;
+      v = (v | (v << 16)) & 0x030000FFU;
+      v = (v | (v << 8)) & 0x0300F00FU;
+      v = (v | (v << 4)) & 0x030C30C3U;
+      return (v | (v << 2)) & 0x09249249U;
+    }
+
+    inline uint64_t spread3(uint64_t v)
+    {
+      v &= 0x00000000001FFFFFULL;
+      v = (v | (v << 32)) & 0x001F00000000FFFFULL;
+      v = (v | (v << 16)) & 0x001F0000FF0000FFULL;
+      v = (v | (v << 8)) & 0x100F00F00F00F00FULL;
+      v = (v | (v << 4)) & 0x10C30C30C30C30C3ULL;
+      return (v | (v << 2)) & 0x1249249249249249ULL;
+    }
+
+    // The same steps in reverse gather every second or third bit back into the low bits
+    inline uint32_t compact2(uint32_t v)
+    {
+      v &= 0x55555555U;
+      v = (v | (v >> 1)) & 0x33333333U;
+      v = (v | (v >> 2)) & 0x0F0F0F0FU;
+      v = (v | (v >> 4)) & 0x00FF00FFU;
+      return (v | (v >> 8)) & 0x0000FFFFU;
+    }
+
+    inline uint32_t compact2(uint64_t v)
+    {
+      v &= 0x5555555555555555ULL;
+      v = (v | (v >> 1)) & 0x3333333333333333ULL;
+      v = (v | (v >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+      v = (v | (v >> 4)) & 0x00FF00FF00FF00FFULL;
+      v = (v | (v >> 8)) & 0x0000FFFF0000FFFFULL;
+      return static_cast<uint32_t>(v | (v >> 16));
+    }
+
+    inline uint32_t compact3(uint32_t v)
+    {
+      v &= 0x09249249U;
+      v = (v | (v >> 2)) & 0x030C30C3U;
+      v = (v | (v >> 4)) & 0x0300F00FU;
+      v = (v | (v >> 8)) & 0x030000FFU;
+      return (v | (v >> 16)) & 0x000003FFU;
+    }
+
+    inline uint32_t compact3(uint64_t v)
+    {
+      v &= 0x1249249249249249ULL;
+      v = (v | (v >> 2)) & 0x10C30C30C30C30C3ULL;
+      v = (v | (v >> 4)) & 0x100F00F00F00F00FULL;
+      v = (v | (v >> 8)) & 0x001F0000FF0000FFULL;
+      v = (v | (v >> 16)) & 0x001F00000000FFFFULL;
+      return static_cast<uint32_t>((v | (v >> 32)) & 0x001FFFFFULL);
+    }
+
+    // Code is uint32_t or uint64_t; the code width picks the overload and so the layout
+    template <typename Code>
+    struct MagicCodec
+    {
+      static Code encode(uint32_t x, uint32_t y) { return spread2(Code(x)) | Code(spread2(Code(y)) << 1); }
+      static Code encode(uint32_t x, uint32_t y, uint32_t z)
+      {
+        return spread3(Code(x)) | Code(spread3(Code(y)) << 1) | Code(spread3(Code(z)) << 2);
+      }
+      static void decode(Code code, uint32_t &x, uint32_t &y)
+      {
+        x = compact2(code);
+        y = compact2(Code(code >> 1));
+      }
+      static void decode(Code code, uint32_t &x, uint32_t &y, uint32_t &z)
+      {
+        x = compact3(code);
+        y = compact3(Code(code >> 1));
+        z = compact3(Code(code >> 2));
+      }
+    };
+
+    // One element at a time through a codec; the separate 2-D and 3-D loops keep the inner
+    // loops free of null checks for z
+    template <typename Codec, typename Code>
+    inline void encodeEach(Code *codes, const uint32_t *x, const uint32_t *y, const uint32_t *z, std::size_t count)
+    {
+      if (z == nullptr)
+      {
+        for (std::size_t i = 0; i < count; ++i)
+          codes[i] = Codec::encode(x[i], y[i]);
+      }
+      else
+      {
+        for (std::size_t i = 0; i < count; ++i)
+          codes[i] = Codec::encode(x[i], y[i], z[i]);
+      }
+    }
+
+    template <typename Codec, typename Code>
+    inline void decodeEach(uint32_t *x, uint32_t *y, uint32_t *z, const Code *codes, std::size_t count)
+    {
+      if (z == nullptr)
+      {
+        for (std::size_t i = 0; i < count; ++i)
+          Codec::decode(codes[i], x[i], y[i]);
+      }
+      else
+      {
+        for (std::size_t i = 0; i < count; ++i)
+          Codec::decode(codes[i], x[i], y[i], z[i]);
+      }
+    }
+
+#ifdef BITWISE_X86
+    // PDEP scatters a coordinate straight onto its code bits and PEXT gathers it back
+    template <typename Code>
+    struct Bmi2Codec;
+
+    template <>
+    struct Bmi2Codec<uint32_t>
+    {
+      __attribute__((target("bmi2"))) static uint32_t encode(uint32_t x, uint32_t y)
+      {
+        return _pdep_u32(x, kEvenBits32) | _pdep_u32(y, kEvenBits32 << 1);
+      }
+      __attribute__((target("bmi2"))) static uint32_t encode(uint32_t x, uint32_t y, uint32_t z)
+      {
+        return _pdep_u32(x, kThirdBits32) | _pdep_u32(y, kThirdBits32 << 1) | _pdep_u32(z, kThirdBits32 << 2);
+      }
+      __attribute__((target("bmi2"))) static void decode(uint32_t code, uint32_t &x, uint32_t &y)
+      {
+        x = _pext_u32(code, kEvenBits32);
+        y = _pext_u32(code, kEvenBits32 << 1);
+      }
+      __attribute__((target("bmi2"))) static void decode(uint32_t code, uint32_t &x, uint32_t &y, uint32_t &z)
+      {
+        x = _pext_u32(code, kThirdBits32);
+        y = _pext_u32(code, kThirdBits32 << 1);
+        z = _pext_u32(code, kThirdBits32 << 2);
+      }
+    };
+
+#ifdef __x86_64__
+    template <>
+    struct Bmi2Codec<uint64_t>
+    {
+      __attribute__((target("bmi2"))) static uint64_t encode(uint32_t x, uint32_t y)
+      {
+        return _pdep_u64(x, kEvenBits64) | _pdep_u64(y, kEvenBits64 << 1);
+      }
+      __attribute__((target("bmi2"))) static uint64_t encode(uint32_t x, uint32_t y, uint32_t z)
+      {
+        return _pdep_u64(x, kThirdBits64) | _pdep_u64(y, kThirdBits64 << 1) | _pdep_u64(z, kThirdBits64 << 2);
+      }
+      __attribute__((target("bmi2"))) static void decode(uint64_t code, uint32_t &x, uint32_t &y)
+      {
+        x = static_cast<uint32_t>(_pext_u64(code, kEvenBits64));
+        y = static_cast<uint32_t>(_pext_u64(code, kEvenBits64 << 1));
+      }
+      __attribute__((target("bmi2"))) static void decode(uint64_t code, uint32_t &x, uint32_t &y, uint32_t &z)
+      {
+        x = static_cast<uint32_t>(_pext_u64(code, kThirdBits64));
+        y = static_cast<uint32_t>(_pext_u64(code, kThirdBits64 << 1));
+        z = static_cast<uint32_t>(_pext_u64(code, kThirdBits64 << 2));
+      }
+    };
+#else
+    // 32-bit x86 has no 64-bit PDEP/PEXT
+    template <>
+    struct Bmi2Codec<uint64_t> : MagicCodec<uint64_t>
+    {
+    };
+#endif
+
+    // The BMI2 loops carry the target attribute and spell the loops out, so every PDEP/PEXT is
+    // inlined instead of staying behind a call from a default-target caller
+    template <typename Code>
+    __attribute__((target("bmi2"))) void encodeEachBmi2(Code *codes, const uint32_t *x, const uint32_t *y,
+                                                        const uint32_t *z, std::size_t count)
+    {
+      if (z == nullptr)
+      {
+        for (std::size_t i = 0; i < count; ++i)
+          codes[i] = Bmi2Codec<Code>::encode(x[i], y[i]);
+      }
+      else
+      {
+        for (std::size_t i = 0; i < count; ++i)
+          codes[i] = Bmi2Codec<Code>::encode(x[i], y[i], z[i]);
+      }
+    }
+
+    template <typename Code>
+    __attribute__((target("bmi2"))) void decodeEachBmi2(uint32_t *x, uint32_t *y, uint32_t *z, const Code *codes,
+                                                        std::size_t count)
+    {
+      if (z == nullptr)
+      {
+        for (std::size_t i = 0; i < count; ++i)
+          Bmi2Codec<Code>::decode(codes[i], x[i], y[i]);
+      }
+      else
+      {
+        for (std::size_t i = 0; i < count; ++i)
+          Bmi2Codec<Code>::decode(codes[i], x[i], y[i], z[i]);
+      }
+    }
+
+    // AVX2 spreading: the scalar steps on eight 32-bit lanes, or on four 64-bit lanes for the wide
+    // codes (coordinates zero-extended with VPMOVZXDQ, decoded lanes packed back with VPERMD)
+    __attribute__((target("avx2"))) inline __m256i spread2x8(__m256i v)
+    {
+      v = _mm256_and_si256(v, _mm256_set1_epi32(0x0000FFFF));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 8)), _mm256_set1_epi32(0x00FF00FF));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 4)), _mm256_set1_epi32(0x0F0F0F0F));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 2)), _mm256_set1_epi32(0x33333333));
+      return _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 1)), _mm256_set1_epi32(0x55555555));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i spread3x8(__m256i v)
+    {
+      v = _mm256_and_si256(v, _mm256_set1_epi32(0x000003FF));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 16)), _mm256_set1_epi32(0x030000FF));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 8)), _mm256_set1_epi32(0x0300F00F));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 4)), _mm256_set1_epi32(0x030C30C3));
+      return _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 2)), _mm256_set1_epi32(0x09249249));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i spread2x4(__m256i v)
+    {
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 16)), _mm256_set1_epi64x(0x0000FFFF0000FFFFLL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 8)), _mm256_set1_epi64x(0x00FF00FF00FF00FFLL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 4)), _mm256_set1_epi64x(0x0F0F0F0F0F0F0F0FLL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 2)), _mm256_set1_epi64x(0x3333333333333333LL));
+      return _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 1)), _mm256_set1_epi64x(0x5555555555555555LL));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i spread3x4(__m256i v)
+    {
+      v = _mm256_and_si256(v, _mm256_set1_epi64x(0x00000000001FFFFFLL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 32)), _mm256_set1_epi64x(0x001F00000000FFFFLL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 16)), _mm256_set1_epi64x(0x001F0000FF0000FFLL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 8)), _mm256_set1_epi64x(0x100F00F00F00F00FLL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 4)), _mm256_set1_epi64x(0x10C30C30C30C30C3LL));
+      return _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 2)), _mm256_set1_epi64x(0x1249249249249249LL));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i compact2x8(__m256i v)
+    {
+      v = _mm256_and_si256(v, _mm256_set1_epi32(0x55555555));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi32(v, 1)), _mm256_set1_epi32(0x33333333));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi32(v, 2)), _mm256_set1_epi32(0x0F0F0F0F));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi32(v, 4)), _mm256_set1_epi32(0x00FF00FF));
+      return _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi32(v, 8)), _mm256_set1_epi32(0x0000FFFF));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i compact3x8(__m256i v)
+    {
+      v = _mm256_and_si256(v, _mm256_set1_epi32(0x09249249));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi32(v, 2)), _mm256_set1_epi32(0x030C30C3));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi32(v, 4)), _mm256_set1_epi32(0x0300F00F));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi32(v, 8)), _mm256_set1_epi32(0x030000FF));
+      return _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi32(v, 16)), _mm256_set1_epi32(0x000003FF));
+    }
+
+    // Results stay in the low 32 bits of each 64-bit lane; packLow gathers them into four words
+    __attribute__((target("avx2"))) inline __m256i compact2x4(__m256i v)
+    {
+      v = _mm256_and_si256(v, _mm256_set1_epi64x(0x5555555555555555LL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v, 1)), _mm256_set1_epi64x(0x3333333333333333LL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v, 2)), _mm256_set1_epi64x(0x0F0F0F0F0F0F0F0FLL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v, 4)), _mm256_set1_epi64x(0x00FF00FF00FF00FFLL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v, 8)), _mm256_set1_epi64x(0x0000FFFF0000FFFFLL));
+      return _mm256_or_si256(v, _mm256_srli_epi64(v, 16));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i compact3x4(__m256i v)
+    {
+      v = _mm256_and_si256(v, _mm256_set1_epi64x(0x1249249249249249LL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v, 2)), _mm256_set1_epi64x(0x10C30C30C30C30C3LL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v, 4)), _mm256_set1_epi64x(0x100F00F00F00F00FLL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v, 8)), _mm256_set1_epi64x(0x001F0000FF0000FFLL));
+      v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v, 16)), _mm256_set1_epi64x(0x001F00000000FFFFLL));
+      return _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v, 32)), _mm256_set1_epi64x(0x00000000001FFFFFLL));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i load8(const uint32_t *p)
+    {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i load4Wide(const uint32_t *p)
+    {
+      return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+    }
+
+    __attribute__((target("avx2"))) inline void store8(uint32_t *p, __m256i v)
+    {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+    }
+
+    __attribute__((target("avx2"))) inline void storeLow4(uint32_t *p, __m256i v)
+    {
+      const __m256i evens = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(v, evens)));
+    }
+
+    __attribute__((target("avx2"))) void encode2D32Avx2(uint32_t *codes, const uint32_t *x, const uint32_t *y,
+                                                        std::size_t count)
+    {
+      const std::size_t body = count / 8 * 8;
+      for (std::size_t i = 0; i < body; i += 8)
+        store8(codes + i, _mm256_or_si256(spread2x8(load8(x + i)), _mm256_slli_epi32(spread2x8(load8(y + i)), 1)));
+      encodeEach<MagicCodec<uint32_t>>(codes + body, x + body, y + body, nullptr, count - body);
+    }
+
+    __attribute__((target("avx2"))) void encode3D32Avx2(uint32_t *codes, const uint32_t *x, const uint32_t *y,
+                                                        const uint32_t *z, std::size_t count)
+    {
+      const std::size_t body = count / 8 * 8;
+      for (std::size_t i = 0; i < body; i += 8)
+      {
+        __m256i code = _mm256_or_si256(spread3x8(load8(x + i)), _mm256_slli_epi32(spread3x8(load8(y + i)), 1));
+        store8(codes + i, _mm256_or_si256(code, _mm256_slli_epi32(spread3x8(load8(z + i)), 2)));
+      }
+      encodeEach<MagicCodec<uint32_t>>(codes + body, x + body, y + body, z + body, count - body);
+    }
+
+    __attribute__((target("avx2"))) void encode2D64Avx2(uint64_t *codes, const uint32_t *x, const uint32_t *y,
+                                                        std::size_t count)
+    {
+      const std::size_t body = count / 4 * 4;
+      for (std::size_t i = 0; i < body; i += 4)
+      {
+        __m256i code = _mm256_or_si256(spread2x4(load4Wide(x + i)), _mm256_slli_epi64(spread2x4(load4Wide(y + i)), 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(codes + i), code);
+      }
+      encodeEach<MagicCodec<uint64_t>>(codes + body, x + body, y + body, nullptr, count - body);
+    }
+
+    __attribute__((target("avx2"))) void encode3D64Avx2(uint64_t *codes, const uint32_t *x, const uint32_t *y,
+                                                        const uint32_t *z, std::size_t count)
+    {
+      const std::size_t body = count / 4 * 4;
+      for (std::size_t i = 0; i < body; i += 4)
+      {
+        __m256i code = _mm256_or_si256(spread3x4(load4Wide(x + i)), _mm256_slli_epi64(spread3x4(load4Wide(y + i)), 1));
+        code = _mm256_or_si256(code, _mm256_slli_epi64(spread3x4(load4Wide(z + i)), 2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(codes + i), code);
+      }
+      encodeEach<MagicCodec<uint64_t>>(codes + body, x + body, y + body, z + body, count - body);
+    }
+
+    __attribute__((target("avx2"))) void decode2D32Avx2(uint32_t *x, uint32_t *y, const uint32_t *codes,
+                                                        std::size_t count)
+    {
+      const std::size_t body = count / 8 * 8;
+      for (std::size_t i = 0; i < body; i += 8)
+      {
+        __m256i code = load8(codes + i);
+        store8(x + i, compact2x8(code));
+        store8(y + i, compact2x8(_mm256_srli_epi32(code, 1)));
+      }
+      decodeEach<MagicCodec<uint32_t>>(x + body, y + body, nullptr, codes + body, count - body);
+    }
+
+    __attribute__((target("avx2"))) void decode3D32Avx2(uint32_t *x, uint32_t *y, uint32_t *z, const uint32_t *codes,
+                                                        std::size_t count)
+    {
+      const std::size_t body = count / 8 * 8;
+      for (std::size_t i = 0; i < body; i += 8)
+      {
+        __m256i code = load8(codes + i);
+        store8(x + i, compact3x8(code));
+        store8(y + i, compact3x8(_mm256_srli_epi32(code, 1)));
+        store8(z + i, compact3x8(_mm256_srli_epi32(code, 2)));
+      }
+      decodeEach<MagicCodec<uint32_t>>(x + body, y + body, z + body, codes + body, count - body);
+    }
+
+    __attribute__((target("avx2"))) void decode2D64Avx2(uint32_t *x, uint32_t *y, const uint64_t *codes,
+                                                        std::size_t count)
+    {
+      const std::size_t body = count / 4 * 4;
+      for (std::size_t i = 0; i < body; i += 4)
+      {
+        __m256i code = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(codes + i));
+        storeLow4(x + i, compact2x4(code));
+        storeLow4(y + i, compact2x4(_mm256_srli_epi64(code, 1)));
+      }
+      decodeEach<MagicCodec<uint64_t>>(x + body, y + body, nullptr, codes + body, count - body);
+    }
+
+    __attribute__((target("avx2"))) void decode3D64Avx2(uint32_t *x, uint32_t *y, uint32_t *z, const uint64_t *codes,
+                                                        std::size_t count)
+    {
+      const std::size_t body = count / 4 * 4;
+      for (std::size_t i = 0; i < body; i += 4)
+      {
+        __m256i code = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(codes + i));
+        storeLow4(x + i, compact3x4(code));
+        storeLow4(y + i, compact3x4(_mm256_srli_epi64(code, 1)));
+        storeLow4(z + i, compact3x4(_mm256_srli_epi64(code, 2)));
+      }
+      decodeEach<MagicCodec<uint64_t>>(x + body, y + body, z + body, codes + body, count - body);
+    }
+
+    // Gray decoding is a prefix XOR, so the vector version is log2(width) shift-and-XOR steps per lane
+    __attribute__((target("avx2"))) void grayEncode32Avx2(uint32_t *dst, const uint32_t *src, std::size_t count)
+    {
+      const std::size_t body = count / 8 * 8;
+      for (std::size_t i = 0; i < body; i += 8)
+      {
+        __m256i v = load8(src + i);
+        store8(dst + i, _mm256_xor_si256(v, _mm256_srli_epi32(v, 1)));
+      }
+      for (std::size_t i = body; i < count; ++i)
+        dst[i] = generic::grayEncode(src[i]);
+    }
+
+    __attribute__((target("avx2"))) void grayDecode32Avx2(uint32_t *dst, const uint32_t *src, std::size_t count)
+    {
+      const std::size_t body = count / 8 * 8;
+      for (std::size_t i = 0; i < body; i += 8)
+      {
+        __m256i v = load8(src + i);
+        v = _mm256_xor_si256(v, _mm256_srli_epi32(v, 1));
+        v = _mm256_xor_si256(v, _mm256_srli_epi32(v, 2));
+        v = _mm256_xor_si256(v, _mm256_srli_epi32(v, 4));
+        v = _mm256_xor_si256(v, _mm256_srli_epi32(v, 8));
+        store8(dst + i, _mm256_xor_si256(v, _mm256_srli_epi32(v, 16)));
+      }
+      for (std::size_t i = body; i < count; ++i)
+        dst[i] = generic::grayDecode(src[i]);
+    }
+
+    __attribute__((target("avx2"))) void grayEncode64Avx2(uint64_t *dst, const uint64_t *src, std::size_t count)
+    {
+      const std::size_t body = count / 4 * 4;
+      for (std::size_t i = 0; i < body; i += 4)
+      {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(v, _mm256_srli_epi64(v, 1)));
+      }
+      for (std::size_t i = body; i < count; ++i)
+        dst[i] = generic::grayEncode(src[i]);
+    }
+
+    __attribute__((target("avx2"))) void grayDecode64Avx2(uint64_t *dst, const uint64_t *src, std::size_t count)
+    {
+      const std::size_t body = count / 4 * 4;
+      for (std::size_t i = 0; i < body; i += 4)
+      {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 1));
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 2));
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 4));
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 8));
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 16));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(v, _mm256_srli_epi64(v, 32)));
+      }
+      for (std::size_t i = body; i < count; ++i)
+        dst[i] = generic::grayDecode(src[i]);
+    }
+
+    bool avx2Active()
+    {
+      SimdLevel level = activeSimdLevel();
+      return level == SimdLevel::AVX2 || level == SimdLevel::AVX512;
+    }
+
+    // PDEP/PEXT beat four-lane AVX2 spreading for the 64-bit codes, but AVX2-only parts include
+    // Zen 1/2, where they are microcoded. Every AVX-512 part has fast PDEP, so only that level
+    // sends the wide codes through the BMI2 fallback.
+    bool avx2ForWideCodes()
+    {
+      return activeSimdLevel() == SimdLevel::AVX2 || (activeSimdLevel() == SimdLevel::AVX512 && !kHasBmi2);
+    }
+#endif
+
+    // Shared fallback for the bulk functions below AVX2: per element, through PDEP/PEXT when available
+    template <typename Code>
+    void encodeFallback(Code *codes, const uint32_t *x, const uint32_t *y, const uint32_t *z, std::size_t count)
+    {
+#ifdef BITWISE_X86
+      if (kHasBmi2)
+      {
+        encodeEachBmi2(codes, x, y, z, count);
+        return;
+      }
+#endif
+      encodeEach<MagicCodec<Code>>(codes, x, y, z, count);
+    }
+
+    template <typename Code>
+    void decodeFallback(uint32_t *x, uint32_t *y, uint32_t *z, const Code *codes, std::size_t count)
+    {
+#ifdef BITWISE_X86
+      if (kHasBmi2)
+      {
+        decodeEachBmi2(x, y, z, codes, count);
+        return;
+      }
+#endif
+      decodeEach<MagicCodec<Code>>(x, y, z, codes, count);
+    }
+
+    // Single values pick their codec once per call
+    template <typename Code, typename... Coordinates>
+    Code encodeOne(Coordinates... coordinates)
+    {
+#ifdef BITWISE_X86
+      if (kHasBmi2)
+        return Bmi2Codec<Code>::encode(coordinates...);
+#endif
+      return MagicCodec<Code>::encode(coordinates...);
+    }
+
+    template <typename Code, typename... Coordinates>
+    void decodeOne(Code code, Coordinates &...coordinates)
+    {
+#ifdef BITWISE_X86
+      if (kHasBmi2)
+      {
+        Bmi2Codec<Code>::decode(code, coordinates...);
+        return;
+      }
+#endif
+      MagicCodec<Code>::decode(code, coordinates...);
+    }
+  } // namespace
+
+  uint32_t mortonEncode2D32(uint32_t x, uint32_t y)
+  {
+    return encodeOne<uint32_t>(x, y);
+  }
+
+  uint64_t mortonEncode2D64(uint32_t x, uint32_t y)
+  {
+    return encodeOne<uint64_t>(x, y);
+  }
+
+  uint32_t mortonEncode3D32(uint32_t x, uint32_t y, uint32_t z)
+  {
+    return encodeOne<uint32_t>(x, y, z);
+  }
+
+  uint64_t mortonEncode3D64(uint32_t x, uint32_t y, uint32_t z)
+  {
+    return encodeOne<uint64_t>(x, y, z);
+  }
+
+  void mortonDecode2D32(uint32_t code, uint32_t &x, uint32_t &y)
+  {
+    decodeOne(code, x, y);
+  }
+
+  void mortonDecode2D64(uint64_t code, uint32_t &x, uint32_t &y)
+  {
+    decodeOne(code, x, y);
+  }
+
+  void mortonDecode3D32(uint32_t code, uint32_t &x, uint32_t &y, uint32_t &z)
+  {
+    decodeOne(code, x, y, z);
+  }
+
+  void mortonDecode3D64(uint64_t code, uint32_t &x, uint32_t &y, uint32_t &z)
+  {
+    decodeOne(code, x, y, z);
+  }
+
+  void mortonEncode2D32(uint32_t *codes, const uint32_t *x, const uint32_t *y, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkMortonEncode, 3 * count * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    if (avx2Active())
+    {
+      encode2D32Avx2(codes, x, y, count);
+      return;
+    }
+#endif
+    encodeFallback(codes, x, y, nullptr, count);
+  }
+
+  void mortonEncode2D64(uint64_t *codes, const uint32_t *x, const uint32_t *y, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkMortonEncode, 4 * count * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    if (avx2ForWideCodes())
+    {
+      encode2D64Avx2(codes, x, y, count);
+      return;
+    }
+#endif
+    encodeFallback(codes, x, y, nullptr, count);
+  }
+
+  void mortonEncode3D32(uint32_t *codes, const uint32_t *x, const uint32_t *y, const uint32_t *z, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkMortonEncode, 4 * count * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    if (avx2Active())
+    {
+      encode3D32Avx2(codes, x, y, z, count);
+      return;
+    }
+#endif
+    encodeFallback(codes, x, y, z, count);
+  }
+
+  void mortonEncode3D64(uint64_t *codes, const uint32_t *x, const uint32_t *y, const uint32_t *z, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkMortonEncode, 5 * count * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    if (avx2ForWideCodes())
+    {
+      encode3D64Avx2(codes, x, y, z, count);
+      return;
+    }
+#endif
+    encodeFallback(codes, x, y, z, count);
+  }
+
+  void mortonDecode2D32(uint32_t *x, uint32_t *y, const uint32_t *codes, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkMortonDecode, 3 * count * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    if (avx2Active())
+    {
+      decode2D32Avx2(x, y, codes, count);
+      return;
+    }
+#endif
+    decodeFallback(x, y, nullptr, codes, count);
+  }
+
+  void mortonDecode2D64(uint32_t *x, uint32_t *y, const uint64_t *codes, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkMortonDecode, 4 * count * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    if (avx2ForWideCodes())
+    {
+      decode2D64Avx2(x, y, codes, count);
+      return;
+    }
+#endif
+    decodeFallback(x, y, nullptr, codes, count);
+  }
+
+  void mortonDecode3D32(uint32_t *x, uint32_t *y, uint32_t *z, const uint32_t *codes, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkMortonDecode, 4 * count * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    if (avx2Active())
+    {
+      decode3D32Avx2(x, y, z, codes, count);
+      return;
+    }
+#endif
+    decodeFallback(x, y, z, codes, count);
+  }
+
+  void mortonDecode3D64(uint32_t *x, uint32_t *y, uint32_t *z, const uint64_t *codes, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkMortonDecode, 5 * count * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    if (avx2ForWideCodes())
+    {
+      decode3D64Avx2(x, y, z, codes, count);
+      return;
+    }
+#endif
+    decodeFallback(x, y, z, codes, count);
+  }
+
+  void grayEncode(uint32_t *dst, const uint32_t *src, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkGrayEncode, 2 * count * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    if (avx2Active())
+    {
+      grayEncode32Avx2(dst, src, count);
+      return;
+    }
+#endif
+    for (std::size_t i = 0; i < count; ++i)
+      dst[i] = generic::grayEncode(src[i]);
+  }
+
+  void grayEncode(uint64_t *dst, const uint64_t *src, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkGrayEncode, 2 * count * sizeof(uint64_t));
+#ifdef BITWISE_X86
+    if (avx2Active())
+    {
+      grayEncode64Avx2(dst, src, count);
+      return;
+    }
+#endif
+    for (std::size_t i = 0; i < count; ++i)
+      dst[i] = generic::grayEncode(src[i]);
+  }
+
+  void grayDecode(uint32_t *dst, const uint32_t *src, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkGrayDecode, 2 * count * sizeof(uint32_t));
+#ifdef BITWISE_X86
+    if (avx2Active())
+    {
+      grayDecode32Avx2(dst, src, count);
+      return;
+    }
+#endif
+    for (std::size_t i = 0; i < count; ++i)
+      dst[i] = generic::grayDecode(src[i]);
+  }
+
+  void grayDecode(uint64_t *dst, const uint64_t *src, std::size_t count)
+  {
+    BITWISE_STATS_SCOPE(BulkGrayDecode, 2 * count * sizeof(uint64_t));
+#ifdef BITWISE_X86
+    if (avx2Active())
+    {
+      grayDecode64Avx2(dst, src, count);
+      return;
+    }
+#endif
+    for (std::size_t i = 0; i < count; ++i)
+      dst[i] = generic::grayDecode(src[i]);
+  }
+
+} // namespace bitwise
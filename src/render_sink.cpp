@@ -0,0 +1,24 @@
+#include "render_sink.h"
+#include <cerrno>
+#include <unistd.h>
+
+namespace bitwise
+{
+
+  void FdSink::write(const char *data, std::size_t length)
+  {
+    while (length > 0)
+    {
+      ssize_t written = ::write(fd_, data, length);
+      if (written < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        return; // Nothing useful to do for a broken descriptor; drop the rest like std::cout would
+      }
+      data += written;
+      length -= static_cast<std::size_t>(written);
+    }
+  }
+
+} // namespace bitwise
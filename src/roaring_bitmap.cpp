@@ -0,0 +1,841 @@
+#include "roaring_bitmap.h"
+#include "bitwise_bulk.h"
+#include "bitwise_generic.h"
+#include "bitwise_stats.h"
+#include <algorithm>
+#include <iterator>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITWISE_X86 1
+#endif
+
+namespace bitwise
+{
+  namespace
+  {
+    using Container = RoaringBitmap::Container;
+    using Kind = RoaringBitmap::ContainerKind;
+    using Words = std::vector<uint32_t, AlignedAllocator<uint32_t>>;
+
+    constexpr uint32_t kArrayMaxSize = RoaringBitmap::kArrayMaxSize;
+    constexpr std::size_t kBitmapWords = RoaringBitmap::kBitmapWords;
+    constexpr std::size_t kBitmapBytes = kBitmapWords * sizeof(uint32_t);
+
+    inline uint16_t highBits(uint32_t value) { return static_cast<uint16_t>(value >> 16); }
+    inline uint16_t lowBits(uint32_t value) { return static_cast<uint16_t>(value & 0xFFFF); }
+
+    // Runs are stored flat: values[2k] is the start of run k and values[2k + 1] its length minus one
+    inline std::size_t runCount(const Container &c) { return c.values.size() / 2; }
+    inline uint32_t runStart(const Container &c, std::size_t k) { return c.values[2 * k]; }
+    inline uint32_t runEnd(const Container &c, std::size_t k) { return uint32_t(c.values[2 * k]) + c.values[2 * k + 1]; }
+
+    // Index of the last run starting at or before value, or runCount() if there is none
+    std::size_t findRun(const Container &c, uint16_t value)
+    {
+      std::size_t lo = 0, hi = runCount(c);
+      while (lo < hi)
+      {
+        std::size_t mid = (lo + hi) / 2;
+        if (runStart(c, mid) <= value)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      return lo == 0 ? runCount(c) : lo - 1;
+    }
+
+    inline bool bitmapTest(const Words &words, uint32_t value)
+    {
+      return generic::isBitSet(words[value >> 5], static_cast<int>(value & 31));
+    }
+
+    // Calls fn(low) for every value of the container in increasing order
+    template <typename Fn>
+    void forEachValue(const Container &c, Fn fn)
+    {
+      switch (c.kind)
+      {
+      case Kind::Array:
+        for (uint16_t value : c.values)
+          fn(value);
+        break;
+      case Kind::Bitmap:
+        for (std::size_t w = 0; w < kBitmapWords; ++w)
+        {
+          for (uint32_t word = c.words[w]; word != 0; word &= word - 1)
+            fn(static_cast<uint16_t>(w * 32 + __builtin_ctz(word)));
+        }
+        break;
+      case Kind::Run:
+        for (std::size_t k = 0; k < runCount(c); ++k)
+        {
+          for (uint32_t value = runStart(c, k); value <= runEnd(c, k); ++value)
+            fn(static_cast<uint16_t>(value));
+        }
+        break;
+      }
+    }
+
+    // Sets bits [first, last] of a bitmap a word at a time
+    void fillRange(Words &words, uint32_t first, uint32_t last)
+    {
+      uint32_t firstWord = first >> 5, lastWord = last >> 5;
+      uint32_t firstMask = ~0U << (first & 31);
+      uint32_t lastMask = ~0U >> (31 - (last & 31));
+      if (firstWord == lastWord)
+      {
+        words[firstWord] |= firstMask & lastMask;
+        return;
+      }
+      words[firstWord] |= firstMask;
+      std::fill(words.begin() + firstWord + 1, words.begin() + lastWord, ~0U);
+      words[lastWord] |= lastMask;
+    }
+
+    Words bitmapOf(const Container &c)
+    {
+      if (c.kind == Kind::Bitmap)
+        return c.words;
+      Words words(kBitmapWords, 0);
+      if (c.kind == Kind::Run)
+      {
+        for (std::size_t k = 0; k < runCount(c); ++k)
+          fillRange(words, runStart(c, k), runEnd(c, k));
+      }
+      else
+      {
+        for (uint16_t value : c.values)
+          words[value >> 5] = generic::setBit(words[value >> 5], value & 31);
+      }
+      return words;
+    }
+
+    void toBitmap(Container &c)
+    {
+      c.words = bitmapOf(c);
+      c.values.clear();
+      c.values.shrink_to_fit();
+      c.kind = Kind::Bitmap;
+    }
+
+    // Values decodeBitmap may write past the last set bit
+    constexpr std::size_t kDecodeSlack = 32;
+
+#ifdef BITWISE_X86
+    // Compresses each word's positions out of a vector of its 32 candidates, so no branch depends
+    // on the bits and every word costs the same few instructions however many bits it has
+    __attribute__((target("avx512f,avx512bw,avx512vbmi2,popcnt"))) void decodeAvx512Vbmi2(const uint32_t *words,
+                                                                                         uint16_t *out)
+    {
+      static const uint16_t kLanes[32] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                          16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31};
+      __m512i positions = _mm512_loadu_si512(kLanes);
+      const __m512i step = _mm512_set1_epi16(32);
+      for (std::size_t w = 0; w < kBitmapWords; ++w)
+      {
+        _mm512_storeu_si512(out, _mm512_maskz_compress_epi16(words[w], positions));
+        out += _mm_popcnt_u32(words[w]);
+        positions = _mm512_add_epi16(positions, step);
+      }
+    }
+#endif
+
+    // Writes the set bits of a full bitmap as sorted values; out needs room for kDecodeSlack values
+    // past the last one
+    void decodeBitmap(const uint32_t *words, uint16_t *out)
+    {
+#ifdef BITWISE_X86
+      if (activeSimdLevel() == SimdLevel::AVX512 && cpuFeatures().avx512vbmi2)
+      {
+        decodeAvx512Vbmi2(words, out);
+        return;
+      }
+#endif
+      for (std::size_t w = 0; w < kBitmapWords; ++w)
+      {
+        for (uint32_t word = words[w]; word != 0; word &= word - 1)
+          *out++ = static_cast<uint16_t>(w * 32 + __builtin_ctz(word));
+      }
+    }
+
+    // Array container of the cardinality (at most kArrayMaxSize) set bits of a full bitmap
+    Container arrayOfBitmap(const uint32_t *words, uint32_t cardinality)
+    {
+      uint16_t values[kArrayMaxSize + kDecodeSlack];
+      decodeBitmap(words, values);
+      Container c;
+      c.kind = Kind::Array;
+      c.cardinality = cardinality;
+      c.values.assign(values, values + cardinality);
+      return c;
+    }
+
+    void toArray(Container &c)
+    {
+      if (c.kind == Kind::Bitmap)
+      {
+        c = arrayOfBitmap(c.words.data(), c.cardinality);
+        return;
+      }
+      std::vector<uint16_t> values(c.cardinality);
+      uint16_t *out = values.data();
+      forEachValue(c, [&](uint16_t value)
+                   { *out++ = value; });
+      c.values.swap(values);
+      c.words = Words();
+      c.kind = Kind::Array;
+    }
+
+    std::size_t countRuns(const Container &c)
+    {
+      switch (c.kind)
+      {
+      case Kind::Run:
+        return runCount(c);
+      case Kind::Array:
+      {
+        std::size_t runs = 0;
+        for (std::size_t i = 0; i < c.values.size(); ++i)
+        {
+          if (i == 0 || c.values[i] != c.values[i - 1] + 1)
+            ++runs;
+        }
+        return runs;
+      }
+      case Kind::Bitmap:
+      {
+        // A run starts at every set bit whose lower neighbour is clear
+        std::size_t runs = 0;
+        uint32_t carry = 0;
+        for (uint32_t word : c.words)
+        {
+          runs += generic::countSetBits(word & ~((word << 1) | carry));
+          carry = word >> 31;
+        }
+        return runs;
+      }
+      }
+      return 0;
+    }
+
+    void toRuns(Container &c)
+    {
+      std::vector<uint16_t> runs;
+      runs.reserve(2 * countRuns(c));
+      bool open = false;
+      uint32_t start = 0, previous = 0;
+      forEachValue(c, [&](uint16_t value)
+                   {
+        if (open && value == previous + 1)
+        {
+          previous = value;
+          return;
+        }
+        if (open)
+        {
+          runs.push_back(static_cast<uint16_t>(start));
+          runs.push_back(static_cast<uint16_t>(previous - start));
+        }
+        open = true;
+        start = previous = value; });
+      if (open)
+      {
+        runs.push_back(static_cast<uint16_t>(start));
+        runs.push_back(static_cast<uint16_t>(previous - start));
+      }
+      c.values.swap(runs);
+      c.words = Words();
+      c.kind = Kind::Run;
+    }
+
+    // Array below the threshold, bitmap above it; run containers are left to optimize()
+    void normalize(Container &c)
+    {
+      if (c.kind == Kind::Array && c.cardinality > kArrayMaxSize)
+        toBitmap(c);
+      else if (c.kind == Kind::Bitmap && c.cardinality <= kArrayMaxSize)
+        toArray(c);
+    }
+
+    std::size_t plainBytes(uint32_t cardinality)
+    {
+      return cardinality <= kArrayMaxSize ? cardinality * sizeof(uint16_t) : kBitmapBytes;
+    }
+
+    // Picks whichever of the three forms is smallest; returns true if the kind changed
+    bool optimize(Container &c)
+    {
+      Kind before = c.kind;
+      std::size_t runBytes = countRuns(c) * 2 * sizeof(uint16_t);
+      if (runBytes < plainBytes(c.cardinality))
+      {
+        if (c.kind != Kind::Run)
+          toRuns(c);
+      }
+      else
+      {
+        if (c.kind == Kind::Run)
+        {
+          if (c.cardinality <= kArrayMaxSize)
+            toArray(c);
+          else
+            toBitmap(c);
+        }
+        normalize(c);
+      }
+      return c.kind != before;
+    }
+
+    bool containerContains(const Container &c, uint16_t value)
+    {
+      switch (c.kind)
+      {
+      case Kind::Array:
+        return std::binary_search(c.values.begin(), c.values.end(), value);
+      case Kind::Bitmap:
+        return bitmapTest(c.words, value);
+      case Kind::Run:
+      {
+        std::size_t k = findRun(c, value);
+        return k < runCount(c) && value <= runEnd(c, k);
+      }
+      }
+      return false;
+    }
+
+    bool containerAdd(Container &c, uint16_t value)
+    {
+      switch (c.kind)
+      {
+      case Kind::Array:
+      {
+        auto it = std::lower_bound(c.values.begin(), c.values.end(), value);
+        if (it != c.values.end() && *it == value)
+          return false;
+        c.values.insert(it, value);
+        break;
+      }
+      case Kind::Bitmap:
+      {
+        uint32_t &word = c.words[value >> 5];
+        if (generic::isBitSet(word, value & 31))
+          return false;
+        word = generic::setBit(word, value & 31);
+        break;
+      }
+      case Kind::Run:
+      {
+        std::size_t k = findRun(c, value);
+        std::size_t runs = runCount(c);
+        if (k < runs && value <= runEnd(c, k))
+          return false;
+        bool extendsLeft = k < runs && runEnd(c, k) + 1 == value;
+        std::size_t next = k < runs ? k + 1 : 0;
+        bool extendsRight = next < runs && runStart(c, next) == uint32_t(value) + 1;
+        if (extendsLeft && extendsRight)
+        {
+          // value bridges two runs: fold the next run into this one
+          c.values[2 * k + 1] = static_cast<uint16_t>(runEnd(c, next) - runStart(c, k));
+          c.values.erase(c.values.begin() + 2 * next, c.values.begin() + 2 * next + 2);
+        }
+        else if (extendsLeft)
+        {
+          ++c.values[2 * k + 1];
+        }
+        else if (extendsRight)
+        {
+          --c.values[2 * next];
+          ++c.values[2 * next + 1];
+        }
+        else
+        {
+          uint16_t run[2] = {value, 0};
+          c.values.insert(c.values.begin() + 2 * next, run, run + 2);
+        }
+        break;
+      }
+      }
+      ++c.cardinality;
+      if (c.kind == Kind::Run)
+        optimize(c);
+      else
+        normalize(c);
+      return true;
+    }
+
+    bool containerRemove(Container &c, uint16_t value)
+    {
+      switch (c.kind)
+      {
+      case Kind::Array:
+      {
+        auto it = std::lower_bound(c.values.begin(), c.values.end(), value);
+        if (it == c.values.end() || *it != value)
+          return false;
+        c.values.erase(it);
+        break;
+      }
+      case Kind::Bitmap:
+      {
+        uint32_t &word = c.words[value >> 5];
+        if (!generic::isBitSet(word, value & 31))
+          return false;
+        word = generic::clearBit(word, value & 31);
+        break;
+      }
+      case Kind::Run:
+      {
+        std::size_t k = findRun(c, value);
+        if (k >= runCount(c) || value > runEnd(c, k))
+          return false;
+        uint32_t start = runStart(c, k), end = runEnd(c, k);
+        if (start == end)
+        {
+          c.values.erase(c.values.begin() + 2 * k, c.values.begin() + 2 * k + 2);
+        }
+        else if (value == start)
+        {
+          ++c.values[2 * k];
+          --c.values[2 * k + 1];
+        }
+        else if (value == end)
+        {
+          --c.values[2 * k + 1];
+        }
+        else
+        {
+          // Split [start, end] into [start, value - 1] and [value + 1, end]
+          c.values[2 * k + 1] = static_cast<uint16_t>(value - 1 - start);
+          uint16_t run[2] = {static_cast<uint16_t>(value + 1), static_cast<uint16_t>(end - value - 1)};
+          c.values.insert(c.values.begin() + 2 * k + 2, run, run + 2);
+        }
+        break;
+      }
+      }
+      --c.cardinality;
+      if (c.kind == Kind::Run)
+        optimize(c);
+      else
+        normalize(c);
+      return true;
+    }
+
+    // Run containers take part in set operations in their array or bitmap form
+    const Container &plainForm(const Container &c, Container &scratch)
+    {
+      if (c.kind != Kind::Run)
+        return c;
+      scratch = c;
+      if (scratch.cardinality <= kArrayMaxSize)
+        toArray(scratch);
+      else
+        toBitmap(scratch);
+      return scratch;
+    }
+
+    Container arrayContainer(std::vector<uint16_t> &&values)
+    {
+      Container c;
+      c.kind = Kind::Array;
+      c.cardinality = static_cast<uint32_t>(values.size());
+      c.values = std::move(values);
+      normalize(c);
+      return c;
+    }
+
+    Container bitmapContainer(Words &&words)
+    {
+      Container c;
+      c.kind = Kind::Bitmap;
+      c.words = std::move(words);
+      c.cardinality = static_cast<uint32_t>(countSetBits(c.words.data(), kBitmapWords));
+      normalize(c);
+      return c;
+    }
+
+    enum class SetOp
+    {
+      And,
+      Or,
+      Xor,
+      AndNot
+    };
+
+    template <typename Merge>
+    std::vector<uint16_t> mergeArrays(const Container &a, const Container &b, Merge merge)
+    {
+      std::vector<uint16_t> out;
+      out.reserve(a.values.size() + b.values.size());
+      merge(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter(out));
+      return out;
+    }
+
+    Container combine(SetOp op, const Container &left, const Container &right)
+    {
+      Container leftScratch, rightScratch;
+      const Container &a = plainForm(left, leftScratch);
+      const Container &b = plainForm(right, rightScratch);
+      const bool aBitmap = a.kind == Kind::Bitmap, bBitmap = b.kind == Kind::Bitmap;
+
+      if (aBitmap && bBitmap)
+      {
+        // Combine on the stack and count first: a result small enough for an array is decoded
+        // straight from these words, without allocating a bitmap only to convert it
+        alignas(64) uint32_t out[kBitmapWords];
+        switch (op)
+        {
+        case SetOp::And:
+          bitwiseAnd(out, a.words.data(), b.words.data(), kBitmapWords);
+          break;
+        case SetOp::Or:
+          bitwiseOr(out, a.words.data(), b.words.data(), kBitmapWords);
+          break;
+        case SetOp::Xor:
+          bitwiseXor(out, a.words.data(), b.words.data(), kBitmapWords);
+          break;
+        case SetOp::AndNot:
+          bitwiseNot(out, b.words.data(), kBitmapWords);
+          bitwiseAnd(out, a.words.data(), out, kBitmapWords);
+          break;
+        }
+        const uint32_t cardinality = static_cast<uint32_t>(countSetBits(out, kBitmapWords));
+        if (cardinality <= kArrayMaxSize)
+          return arrayOfBitmap(out, cardinality);
+        Container c;
+        c.kind = Kind::Bitmap;
+        c.cardinality = cardinality;
+        c.words.assign(out, out + kBitmapWords);
+        return c;
+      }
+
+      if (!aBitmap && !bBitmap)
+      {
+        switch (op)
+        {
+        case SetOp::And:
+          return arrayContainer(mergeArrays(a, b, [](auto... args)
+                                            { return std::set_intersection(args...); }));
+        case SetOp::Or:
+          return arrayContainer(mergeArrays(a, b, [](auto... args)
+                                            { return std::set_union(args...); }));
+        case SetOp::Xor:
+          return arrayContainer(mergeArrays(a, b, [](auto... args)
+                                            { return std::set_symmetric_difference(args...); }));
+        case SetOp::AndNot:
+          return arrayContainer(mergeArrays(a, b, [](auto... args)
+                                            { return std::set_difference(args...); }));
+        }
+      }
+
+      // One array, one bitmap
+      const Container &array = aBitmap ? b : a;
+      const Container &bitmap = aBitmap ? a : b;
+      if (op == SetOp::And || (op == SetOp::AndNot && !aBitmap))
+      {
+        // Keep the array values the bitmap has (AND) or lacks (array minus bitmap)
+        const bool keepIfSet = op == SetOp::And;
+        std::vector<uint16_t> out;
+        out.reserve(array.values.size());
+        for (uint16_t value : array.values)
+        {
+          if (bitmapTest(bitmap.words, value) == keepIfSet)
+            out.push_back(value);
+        }
+        return arrayContainer(std::move(out));
+      }
+
+      Words out = bitmap.words;
+      for (uint16_t value : array.values)
+      {
+        uint32_t &word = out[value >> 5];
+        if (op == SetOp::Or)
+          word = generic::setBit(word, value & 31);
+        else if (op == SetOp::Xor)
+          word = generic::toggleBit(word, value & 31);
+        else
+          word = generic::clearBit(word, value & 31); // bitmap minus array
+      }
+      return bitmapContainer(std::move(out));
+    }
+  } // namespace
+
+  RoaringBitmap::RoaringBitmap(std::initializer_list<uint32_t> values)
+  {
+    addMany(values.begin(), values.size());
+  }
+
+  RoaringBitmap::Container *RoaringBitmap::find(uint16_t key)
+  {
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+    if (it == keys_.end() || *it != key)
+      return nullptr;
+    return &containers_[it - keys_.begin()];
+  }
+
+  const RoaringBitmap::Container *RoaringBitmap::find(uint16_t key) const
+  {
+    return const_cast<RoaringBitmap *>(this)->find(key);
+  }
+
+  RoaringBitmap::Container &RoaringBitmap::findOrCreate(uint16_t key)
+  {
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+    std::size_t index = static_cast<std::size_t>(it - keys_.begin());
+    if (it == keys_.end() || *it != key)
+    {
+      keys_.insert(it, key);
+      containers_.insert(containers_.begin() + index, Container());
+    }
+    return containers_[index];
+  }
+
+  void RoaringBitmap::erase(uint16_t key)
+  {
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+    if (it != keys_.end() && *it == key)
+    {
+      containers_.erase(containers_.begin() + (it - keys_.begin()));
+      keys_.erase(it);
+    }
+  }
+
+  bool RoaringBitmap::contains(uint32_t value) const
+  {
+    const Container *c = find(highBits(value));
+    return c != nullptr && containerContains(*c, lowBits(value));
+  }
+
+  void RoaringBitmap::setBit(uint32_t value)
+  {
+    containerAdd(findOrCreate(highBits(value)), lowBits(value));
+  }
+
+  void RoaringBitmap::clearBit(uint32_t value)
+  {
+    Container *c = find(highBits(value));
+    if (c != nullptr && containerRemove(*c, lowBits(value)) && c->cardinality == 0)
+      erase(highBits(value));
+  }
+
+  void RoaringBitmap::toggleBit(uint32_t value)
+  {
+    if (contains(value))
+      clearBit(value);
+    else
+      setBit(value);
+  }
+
+  void RoaringBitmap::addMany(const uint32_t *values, std::size_t count)
+  {
+    Container *current = nullptr;
+    uint32_t currentKey = 0x10000; // no key yet
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      uint16_t key = highBits(values[i]);
+      uint16_t low = lowBits(values[i]);
+      if (key != currentKey)
+      {
+        current = &findOrCreate(key);
+        currentKey = key;
+      }
+      // Sorted input lands at the end of an array container: append without a search
+      if (current->kind == Kind::Array && current->cardinality < kArrayMaxSize &&
+          (current->values.empty() || current->values.back() < low))
+      {
+        current->values.push_back(low);
+        ++current->cardinality;
+      }
+      else
+      {
+        containerAdd(*current, low);
+      }
+    }
+  }
+
+  void RoaringBitmap::addRange(uint32_t first, uint64_t last)
+  {
+    last = std::min<uint64_t>(last, uint64_t(1) << 32);
+    uint64_t value = first;
+    while (value < last)
+    {
+      uint16_t key = static_cast<uint16_t>(value >> 16);
+      uint64_t chunkEnd = std::min<uint64_t>(last, (uint64_t(key) + 1) << 16);
+      uint32_t lo = static_cast<uint32_t>(value & 0xFFFF);
+      uint32_t hi = static_cast<uint32_t>((chunkEnd - 1) & 0xFFFF);
+
+      Container *existing = find(key);
+      if (existing == nullptr || (lo == 0 && hi == 0xFFFF))
+      {
+        Container &c = findOrCreate(key);
+        c.kind = Kind::Run;
+        c.words = Words();
+        c.values = {static_cast<uint16_t>(lo), static_cast<uint16_t>(hi - lo)};
+        c.cardinality = hi - lo + 1;
+      }
+      else
+      {
+        Words words = bitmapOf(*existing);
+        fillRange(words, lo, hi);
+        *existing = bitmapContainer(std::move(words));
+        optimize(*existing);
+      }
+      value = chunkEnd;
+    }
+  }
+
+  uint64_t RoaringBitmap::countSetBits() const
+  {
+    uint64_t total = 0;
+    for (const Container &c : containers_)
+      total += c.cardinality;
+    return total;
+  }
+
+  bool RoaringBitmap::runOptimize()
+  {
+    bool changed = false;
+    for (Container &c : containers_)
+      changed |= optimize(c);
+    return changed;
+  }
+
+  std::vector<uint32_t> RoaringBitmap::toVector() const
+  {
+    std::vector<uint32_t> values;
+    values.reserve(static_cast<std::size_t>(countSetBits()));
+    for (std::size_t i = 0; i < keys_.size(); ++i)
+    {
+      uint32_t high = uint32_t(keys_[i]) << 16;
+      forEachValue(containers_[i], [&](uint16_t low)
+                   { values.push_back(high | low); });
+    }
+    return values;
+  }
+
+  RoaringBitmap::Statistics RoaringBitmap::statistics() const
+  {
+    Statistics stats;
+    stats.bytes = keys_.size() * sizeof(uint16_t);
+    for (const Container &c : containers_)
+    {
+      switch (c.kind)
+      {
+      case Kind::Array:
+        ++stats.arrayContainers;
+        stats.bytes += c.values.size() * sizeof(uint16_t);
+        break;
+      case Kind::Bitmap:
+        ++stats.bitmapContainers;
+        stats.bytes += kBitmapBytes;
+        break;
+      case Kind::Run:
+        ++stats.runContainers;
+        stats.bytes += c.values.size() * sizeof(uint16_t);
+        break;
+      }
+    }
+    return stats;
+  }
+
+  bool RoaringBitmap::operator==(const RoaringBitmap &other) const
+  {
+    if (keys_ != other.keys_)
+      return false;
+    for (std::size_t i = 0; i < containers_.size(); ++i)
+    {
+      const Container &a = containers_[i], &b = other.containers_[i];
+      if (a.cardinality != b.cardinality)
+        return false;
+      // The same set can sit in different kinds of container; compare those as bitmaps
+      bool same = a.kind == b.kind && a.kind != Kind::Bitmap ? a.values == b.values : bitmapOf(a) == bitmapOf(b);
+      if (!same)
+        return false;
+    }
+    return true;
+  }
+
+  namespace
+  {
+    /**
+     * Pairs up containers by key. Keys only the left set has are copied when keepLeft is set, keys
+     * only the right set has when keepRight is set; shared keys go through combine().
+     */
+    void combineKeys(SetOp op, bool keepLeft, bool keepRight,
+                     const std::vector<uint16_t> &leftKeys, const std::vector<Container> &left,
+                     const std::vector<uint16_t> &rightKeys, const std::vector<Container> &right,
+                     std::vector<uint16_t> &outKeys, std::vector<Container> &out)
+    {
+      std::size_t i = 0, j = 0;
+      while (i < leftKeys.size() || j < rightKeys.size())
+      {
+        if (j == rightKeys.size() || (i < leftKeys.size() && leftKeys[i] < rightKeys[j]))
+        {
+          if (keepLeft)
+          {
+            outKeys.push_back(leftKeys[i]);
+            out.push_back(left[i]);
+          }
+          ++i;
+        }
+        else if (i == leftKeys.size() || rightKeys[j] < leftKeys[i])
+        {
+          if (keepRight)
+          {
+            outKeys.push_back(rightKeys[j]);
+            out.push_back(right[j]);
+          }
+          ++j;
+        }
+        else
+        {
+          Container c = combine(op, left[i], right[j]);
+          if (c.cardinality != 0)
+          {
+            outKeys.push_back(leftKeys[i]);
+            out.push_back(std::move(c));
+          }
+          ++i;
+          ++j;
+        }
+      }
+    }
+  } // namespace
+
+  RoaringBitmap bitwiseAnd(const RoaringBitmap &a, const RoaringBitmap &b)
+  {
+    BITWISE_STATS_SCOPE(RoaringAnd, 0);
+    RoaringBitmap result;
+    combineKeys(SetOp::And, false, false, a.keys_, a.containers_, b.keys_, b.containers_, result.keys_,
+                result.containers_);
+    return result;
+  }
+
+  RoaringBitmap bitwiseOr(const RoaringBitmap &a, const RoaringBitmap &b)
+  {
+    BITWISE_STATS_SCOPE(RoaringOr, 0);
+    RoaringBitmap result;
+    combineKeys(SetOp::Or, true, true, a.keys_, a.containers_, b.keys_, b.containers_, result.keys_,
+                result.containers_);
+    return result;
+  }
+
+  RoaringBitmap bitwiseXor(const RoaringBitmap &a, const RoaringBitmap &b)
+  {
+    BITWISE_STATS_SCOPE(RoaringXor, 0);
+    RoaringBitmap result;
+    combineKeys(SetOp::Xor, true, true, a.keys_, a.containers_, b.keys_, b.containers_, result.keys_,
+                result.containers_);
+    return result;
+  }
+
+  RoaringBitmap bitwiseAndNot(const RoaringBitmap &a, const RoaringBitmap &b)
+  {
+    BITWISE_STATS_SCOPE(RoaringAndNot, 0);
+    RoaringBitmap result;
+    combineKeys(SetOp::AndNot, true, false, a.keys_, a.containers_, b.keys_, b.containers_, result.keys_,
+                result.containers_);
+    return result;
+  }
+
+} // namespace bitwise
@@ -0,0 +1,138 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace bitwise
+{
+
+  ThreadPool::ThreadPool(unsigned threads)
+  {
+    if (threads == 0)
+    {
+      threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; ++i)
+    {
+      queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned worker = 1; worker < threads; ++worker)
+    {
+      threads_.emplace_back([this, worker]
+                            { workerLoop(worker); });
+    }
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &thread : threads_)
+    {
+      thread.join();
+    }
+  }
+
+  void ThreadPool::parallelFor(std::size_t taskCount, const std::function<void(std::size_t)> &body)
+  {
+    const unsigned workers = threadCount();
+    if (workers == 1 || taskCount <= 1)
+    {
+      for (std::size_t task = 0; task < taskCount; ++task)
+        body(task);
+      return;
+    }
+
+    Job job{&body, {taskCount}};
+    // Counted before they are visible so a fast thief can never take queued_ below zero
+    queued_.fetch_add(taskCount, std::memory_order_relaxed);
+    for (unsigned worker = 0; worker < workers; ++worker)
+    {
+      std::size_t first = taskCount * worker / workers;
+      std::size_t last = taskCount * (worker + 1) / workers;
+      std::lock_guard<std::mutex> lock(queues_[worker]->mutex);
+      for (std::size_t task = first; task < last; ++task)
+        queues_[worker]->tasks.push_back(Task{&job, task});
+    }
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wake_.notify_all();
+
+    // The caller is worker 0: run its own block, help with others, then wait for stragglers
+    while (job.remaining.load(std::memory_order_acquire) != 0)
+    {
+      if (runOne(0))
+        continue;
+      std::unique_lock<std::mutex> lock(sleepMutex_);
+      finished_.wait(lock, [&]
+                     { return job.remaining.load(std::memory_order_acquire) == 0 ||
+                              queued_.load(std::memory_order_relaxed) > 0; });
+    }
+  }
+
+  bool ThreadPool::popLocal(unsigned worker, Task &task)
+  {
+    WorkQueue &queue = *queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+      return false;
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+  }
+
+  bool ThreadPool::steal(unsigned worker, Task &task)
+  {
+    const unsigned workers = threadCount();
+    for (unsigned offset = 1; offset < workers; ++offset)
+    {
+      WorkQueue &victim = *queues_[(worker + offset) % workers];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty())
+      {
+        task = victim.tasks.back();
+        victim.tasks.pop_back();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ThreadPool::runOne(unsigned worker)
+  {
+    Task task;
+    if (!popLocal(worker, task) && !steal(worker, task))
+      return false;
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    (*task.job->body)(task.index);
+    finish(*task.job);
+    return true;
+  }
+
+  void ThreadPool::finish(Job &job)
+  {
+    // The job lives on its caller's stack and may be gone as soon as remaining reaches 0
+    if (job.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+      finished_.notify_all();
+    }
+  }
+
+  void ThreadPool::workerLoop(unsigned worker)
+  {
+    while (true)
+    {
+      if (runOne(worker))
+        continue;
+      std::unique_lock<std::mutex> lock(sleepMutex_);
+      wake_.wait(lock, [&]
+                 { return stopping_ || queued_.load(std::memory_order_relaxed) > 0; });
+      if (stopping_ && queued_.load(std::memory_order_relaxed) == 0)
+        return;
+    }
+  }
+
+} // namespace bitwise
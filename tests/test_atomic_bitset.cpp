@@ -0,0 +1,177 @@
+#include "../include/atomic_bitset.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+const unsigned kThreads = 8;
+
+template <typename Fn>
+void runThreads(unsigned count, Fn fn)
+{
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < count; ++t)
+    threads.emplace_back(fn, t);
+  for (std::thread &thread : threads)
+    thread.join();
+}
+
+void testBitsetOperations()
+{
+  std::cout << "Testing atomic bitset operations..." << std::endl;
+
+  bitwise::AtomicBitset bits(130);
+  assert(bits.size() == 130);
+  assert(bits.countSetBits() == 0);
+
+  // Every update returns the bit's previous value
+  assert(!bits.setBit(0));
+  assert(bits.setBit(0));
+  assert(!bits.setBit(129));
+  assert(bits.isBitSet(129) && !bits.isBitSet(128));
+  assert(bits.clearBit(0));
+  assert(!bits.clearBit(0));
+  assert(!bits.toggleBit(64));
+  assert(bits.toggleBit(64));
+  assert(!bits.isBitSet(64));
+  assert(!bits.toggleBit(63));
+  assert(bits.countSetBits() == 2);
+
+  bits.clear();
+  assert(bits.countSetBits() == 0);
+
+  std::cout << "✓ Bitset operation tests passed" << std::endl;
+}
+
+void testConcurrentUpdates()
+{
+  std::cout << "Testing concurrent bitset updates..." << std::endl;
+
+  const std::size_t size = 4096;
+  bitwise::AtomicBitset bits(size);
+
+  // All threads race to set every bit: each bit has exactly one winner
+  std::atomic<std::size_t> winners{0};
+  runThreads(kThreads, [&](unsigned)
+             {
+               std::size_t won = 0;
+               for (std::size_t i = 0; i < size; ++i)
+                 won += !bits.setBit(i);
+               winners += won; });
+  assert(winners == size);
+  assert(bits.countSetBits() == size);
+
+  // Threads own interleaved bits that share words; toggling each bit an odd number of times
+  // clears it, so no update may be lost
+  runThreads(kThreads, [&](unsigned t)
+             {
+               for (int round = 0; round < 3; ++round)
+               {
+                 for (std::size_t i = t; i < size; i += kThreads)
+                   bits.toggleBit(i);
+               } });
+  assert(bits.countSetBits() == 0);
+
+  // Same for interleaved set/clear pairs finishing with a set on the even bits
+  runThreads(kThreads, [&](unsigned t)
+             {
+               for (std::size_t i = t; i < size; i += kThreads)
+               {
+                 bits.setBit(i);
+                 bits.clearBit(i);
+                 if (i % 2 == 0)
+                   bits.setBit(i);
+               } });
+  for (std::size_t i = 0; i < size; ++i)
+    assert(bits.isBitSet(i) == (i % 2 == 0));
+
+  std::cout << "✓ Concurrent update tests passed" << std::endl;
+}
+
+void testSlotAllocator()
+{
+  std::cout << "Testing slot allocator..." << std::endl;
+
+  assert(bitwise::SlotAllocator(0).acquire() == bitwise::SlotAllocator::kNoSlot);
+
+  // A capacity that is not a multiple of 64 never hands out slots past the end
+  bitwise::SlotAllocator slots(100);
+  std::vector<std::size_t> taken;
+  for (std::size_t i = 0; i < 100; ++i)
+  {
+    std::size_t slot = slots.acquire();
+    assert(slot < 100);
+    taken.push_back(slot);
+  }
+  assert(slots.acquire() == bitwise::SlotAllocator::kNoSlot);
+  assert(slots.inUse() == 100);
+  std::sort(taken.begin(), taken.end());
+  assert(std::adjacent_find(taken.begin(), taken.end()) == taken.end());
+
+  // A released slot is the only one left to claim
+  slots.release(42);
+  assert(slots.inUse() == 99);
+  assert(slots.acquire() == 42);
+  assert(slots.acquire() == bitwise::SlotAllocator::kNoSlot);
+
+  std::cout << "✓ Slot allocator tests passed" << std::endl;
+}
+
+void testConcurrentSlotAllocator()
+{
+  std::cout << "Testing slot allocator under contention..." << std::endl;
+
+  // Threads drain the allocator together: every slot is handed out exactly once
+  const std::size_t capacity = 1000;
+  bitwise::SlotAllocator slots(capacity);
+  std::vector<std::atomic<int>> owners(capacity);
+  runThreads(kThreads, [&](unsigned)
+             {
+               for (std::size_t slot; (slot = slots.acquire()) != bitwise::SlotAllocator::kNoSlot;)
+               {
+                 assert(slot < capacity);
+                 assert(owners[slot].fetch_add(1) == 0);
+               } });
+  for (std::atomic<int> &owner : owners)
+    assert(owner == 1);
+  assert(slots.inUse() == capacity);
+
+  // Acquire/release churn on a small pool: a slot never has two holders at once
+  bitwise::SlotAllocator pool(kThreads * 2);
+  std::vector<std::atomic<int>> holders(kThreads * 2);
+  runThreads(kThreads, [&](unsigned)
+             {
+               for (int i = 0; i < 20000; ++i)
+               {
+                 std::size_t slot = pool.acquire();
+                 assert(slot != bitwise::SlotAllocator::kNoSlot); // at most kThreads are held
+                 assert(holders[slot].fetch_add(1) == 0);
+                 holders[slot].fetch_sub(1);
+                 pool.release(slot);
+               } });
+  assert(pool.inUse() == 0);
+
+  std::cout << "✓ Contended allocator tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running atomic bitset tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testBitsetOperations();
+  testConcurrentUpdates();
+  testSlotAllocator();
+  testConcurrentSlotAllocator();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
@@ -0,0 +1,139 @@
+#include "../include/batch_mode.h"
+#include "../include/render_sink.h"
+#include <iostream>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+std::string runText(const std::string &input, bitwise::BatchResult *result = nullptr)
+{
+  bitwise::BufferSink sink;
+  bitwise::BatchResult r = bitwise::runBatch(input.data(), input.size(), sink);
+  if (result)
+    *result = r;
+  return sink.str();
+}
+
+void testOperations()
+{
+  std::cout << "Testing batch operations..." << std::endl;
+
+  bitwise::BatchResult result;
+  std::string output = runText(
+      "AND 170 204\n"
+      "OR 0b1010 0b0101\n"
+      "xor 0xFF 0x0F\n"
+      "NOT 0\n"
+      "SHL 1 3\n"
+      "SHR 128 2\n"
+      "POPCNT 42\n"
+      "ISSET 4 2\n"
+      "SET 0 31\n"
+      "CLEAR 15 0\n"
+      "TOGGLE 4 2\n"
+      "BIN 170\n"
+      "HEX 48879\n",
+      &result);
+  assert(output ==
+         "136\n"
+         "15\n"
+         "240\n"
+         "4294967295\n"
+         "8\n"
+         "32\n"
+         "3\n"
+         "1\n"
+         "2147483648\n"
+         "14\n"
+         "0\n"
+         "0000 0000 0000 0000 0000 0000 1010 1010\n"
+         "0xBEEF\n");
+  assert(result.operations == 13 && result.errors == 0);
+
+  std::cout << "✓ Batch operation tests passed" << std::endl;
+}
+
+void testErrorsAndFormatting()
+{
+  std::cout << "Testing batch errors..." << std::endl;
+
+  bitwise::BatchResult result;
+  std::string output = runText(
+      "# comment\n"
+      "\n"
+      "  AND   1\t3  \r\n"
+      "FROB 1 2\n"
+      "AND 1\n"
+      "AND 1 2 3\n"
+      "NOT 4294967296\n"
+      "SHL 1 32\n"
+      "NOT 12abc\n"
+      "OR 1 2", // no trailing newline
+      &result);
+  assert(output ==
+         "1\n"
+         "ERR unknown operation\n"
+         "ERR missing operand\n"
+         "ERR too many operands\n"
+         "ERR invalid operand\n"
+         "ERR bit index out of range (0-31)\n"
+         "ERR invalid operand\n"
+         "3\n");
+  assert(result.operations == 2 && result.errors == 6);
+
+  std::cout << "✓ Batch error tests passed" << std::endl;
+}
+
+void testStreamingFromFd()
+{
+  std::cout << "Testing batch streaming..." << std::endl;
+
+  // Enough lines to span several 1 MiB reads, so lines get split across chunk boundaries
+  std::string input;
+  std::string expected;
+  for (uint32_t i = 0; i < 200000; ++i)
+  {
+    input += "XOR " + std::to_string(i) + " 0xFFFF\n";
+    expected += std::to_string(i ^ 0xFFFF) + "\n";
+  }
+
+  FILE *file = std::tmpfile();
+  assert(file != nullptr);
+  assert(std::fwrite(input.data(), 1, input.size(), file) == input.size());
+  std::fflush(file);
+  std::rewind(file);
+
+  bitwise::BufferSink sink;
+  bitwise::BatchResult result = bitwise::runBatch(fileno(file), sink);
+  std::fclose(file);
+  assert(result.operations == 200000 && result.errors == 0);
+  assert(sink.str() == expected && result.readError == 0);
+
+  // A failed read is reported instead of looking like end of input
+  bitwise::BufferSink failed;
+  result = bitwise::runBatch(-1, failed);
+  assert(result.readError == EBADF && result.operations == 0 && failed.str().empty());
+
+  std::cout << "✓ Batch streaming tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running batch mode tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testOperations();
+  testErrorsAndFormatting();
+  testStreamingFromFd();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
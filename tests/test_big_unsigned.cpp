@@ -0,0 +1,239 @@
+#include "../include/big_unsigned.h"
+#include "../include/bitwise_generic.h"
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // Digit-at-a-time references: Horner's rule to parse and repeated division to print
+  bitwise::BigUnsigned naiveParse(const std::string &digits, unsigned base)
+  {
+    bitwise::BigUnsigned value;
+    for (char c : digits)
+    {
+      value *= base;
+      value += bitwise::BigUnsigned(static_cast<uint64_t>(c <= '9' ? c - '0' : c - 'a' + 10));
+    }
+    return value;
+  }
+
+  std::string naiveToString(const bitwise::BigUnsigned &value, unsigned base)
+  {
+    std::vector<uint64_t> limbs = value.limbs();
+    std::string reversed;
+    while (!limbs.empty())
+    {
+      bitwise::uint128_t remainder = 0;
+      for (std::size_t i = limbs.size(); i-- > 0;)
+      {
+        bitwise::uint128_t current = (remainder << 64) | limbs[i];
+        limbs[i] = static_cast<uint64_t>(current / base);
+        remainder = current % base;
+      }
+      while (!limbs.empty() && limbs.back() == 0)
+        limbs.pop_back();
+      reversed.push_back("0123456789abcdefghijklmnopqrstuvwxyz"[static_cast<unsigned>(remainder)]);
+    }
+    return reversed.empty() ? "0" : std::string(reversed.rbegin(), reversed.rend());
+  }
+
+  bitwise::BigUnsigned randomNumber(std::size_t limbs, std::mt19937_64 &rng)
+  {
+    bitwise::BigUnsigned value;
+    for (std::size_t i = 0; i < limbs; ++i)
+    {
+      value = value * bitwise::BigUnsigned::power(2, 64);
+      value += bitwise::BigUnsigned(rng() | (i == 0 ? 1 : 0));
+    }
+    return value;
+  }
+
+  std::string randomDigits(std::size_t count, unsigned base, std::mt19937_64 &rng)
+  {
+    std::string digits;
+    for (std::size_t i = 0; i < count; ++i)
+      digits.push_back("0123456789abcdefghijklmnopqrstuvwxyz"[rng() % base]);
+    digits[0] = '1';
+    return digits;
+  }
+} // namespace
+
+void testSmallValues()
+{
+  std::cout << "Testing 64-bit values in every base..." << std::endl;
+
+  std::mt19937_64 rng(1);
+  std::vector<uint64_t> values = {0, 1, 9, 10, 35, 36, 0xFFFFFFFFFFFFFFFFULL, 10000000000000000000ULL};
+  for (int i = 0; i < 200; ++i)
+    values.push_back(rng() >> (rng() % 64));
+  for (unsigned base = 2; base <= 36; ++base)
+  {
+    for (uint64_t v : values)
+    {
+      bitwise::BigUnsigned value(v);
+      std::string text = value.toString(base);
+      assert(text == naiveToString(value, base));
+      bitwise::BigUnsigned parsed;
+      std::string error;
+      assert(bitwise::BigUnsigned::parse(text, base, parsed, error));
+      assert(parsed == value);
+    }
+  }
+
+  assert(bitwise::BigUnsigned(0).toString() == "0");
+  assert(bitwise::BigUnsigned(0).isZero());
+  assert(bitwise::BigUnsigned(255).toString(16, true) == "FF");
+  assert(bitwise::BigUnsigned(255).toString(16) == "ff");
+  assert(bitwise::BigUnsigned(35).toString(36) == "z");
+  assert(bitwise::BigUnsigned(5).bitLength() == 3);
+  assert(bitwise::BigUnsigned(0).bitLength() == 0);
+  std::cout << "✓ 64-bit value tests passed" << std::endl;
+}
+
+void testPowers()
+{
+  std::cout << "Testing exact powers..." << std::endl;
+
+  assert(bitwise::BigUnsigned::power(2, 400).toString(16) == "1" + std::string(100, '0'));
+  assert(bitwise::BigUnsigned::power(10, 300).toString() == "1" + std::string(300, '0'));
+  assert(bitwise::BigUnsigned::power(2, 64).toString() == "18446744073709551616");
+  assert(bitwise::BigUnsigned::power(0, 0) == bitwise::BigUnsigned(1));
+  assert(bitwise::BigUnsigned::power(0, 5).isZero());
+  assert(bitwise::BigUnsigned::power(1, 1000) == bitwise::BigUnsigned(1));
+  assert(bitwise::BigUnsigned::power(3, 40) == bitwise::BigUnsigned(12157665459056928801ULL));
+
+  // Square-and-multiply against repeated multiplication
+  bitwise::BigUnsigned repeated(1);
+  for (int i = 0; i < 1500; ++i)
+    repeated *= 7;
+  assert(bitwise::BigUnsigned::power(7, 1500) == repeated);
+  std::cout << "✓ power tests passed" << std::endl;
+}
+
+void testLargeConversions()
+{
+  std::cout << "Testing large conversions against digit-at-a-time references..." << std::endl;
+
+  // Sizes around the recursion thresholds, and one deep enough for several levels of splitting
+  std::mt19937_64 rng(2);
+  const std::size_t limbCounts[] = {2, 15, 16, 17, 31, 32, 33, 64, 65, 100, 257, 1000};
+  const unsigned bases[] = {2, 3, 7, 8, 10, 16, 36};
+  for (std::size_t limbs : limbCounts)
+  {
+    bitwise::BigUnsigned value = randomNumber(limbs, rng);
+    for (unsigned base : bases)
+    {
+      std::string text = value.toString(base);
+      assert(text == naiveToString(value, base));
+      bitwise::BigUnsigned parsed;
+      std::string error;
+      assert(bitwise::BigUnsigned::parse(text, base, parsed, error));
+      assert(parsed == value);
+    }
+  }
+
+  // Parsing random digit strings, including long runs of zeros across split points
+  for (std::size_t count : {19u, 20u, 305u, 306u, 700u, 5000u})
+  {
+    for (unsigned base : {10u, 36u})
+    {
+      std::string digits = randomDigits(count, base, rng);
+      std::fill(digits.begin() + count / 3, digits.begin() + count / 2, '0');
+      bitwise::BigUnsigned parsed;
+      std::string error;
+      assert(bitwise::BigUnsigned::parse(digits, base, parsed, error));
+      assert(parsed == naiveParse(digits, base));
+      assert(parsed.toString(base) == digits);
+    }
+  }
+
+  // Values just below and at a power of the base keep their zero-padded low halves
+  bitwise::BigUnsigned big = bitwise::BigUnsigned::power(10, 4000);
+  assert(big.toString() == "1" + std::string(4000, '0'));
+  std::string nines(4000, '9');
+  bitwise::BigUnsigned below;
+  std::string error;
+  assert(bitwise::BigUnsigned::parse(nines, 10, below, error));
+  assert(below + bitwise::BigUnsigned(1) == big);
+  assert(below.toString() == nines);
+  assert(below < big && !(big < below));
+  std::cout << "✓ large conversion tests passed" << std::endl;
+}
+
+void testMultiply()
+{
+  std::cout << "Testing multiplication..." << std::endl;
+
+  // Karatsuba (balanced and unbalanced) against schoolbook built from small multiplications
+  std::mt19937_64 rng(3);
+  for (std::size_t limbs : {1u, 31u, 40u, 150u})
+  {
+    bitwise::BigUnsigned a = randomNumber(limbs, rng);
+    bitwise::BigUnsigned b = randomNumber(limbs / 3 + 35, rng);
+    bitwise::BigUnsigned expected;
+    const std::vector<uint64_t> &bLimbs = b.limbs();
+    for (std::size_t i = bLimbs.size(); i-- > 0;)
+    {
+      expected = expected * bitwise::BigUnsigned::power(2, 64);
+      bitwise::BigUnsigned partial = a;
+      partial *= bLimbs[i];
+      expected += partial;
+    }
+    assert(a * b == expected);
+    assert(b * a == expected);
+  }
+  assert((bitwise::BigUnsigned(5) * bitwise::BigUnsigned()).isZero());
+  std::cout << "✓ multiplication tests passed" << std::endl;
+}
+
+void testConvertRadix()
+{
+  std::cout << "Testing convertRadix..." << std::endl;
+
+  std::string out, error;
+  assert(bitwise::convertRadix("ff", 16, 2, out, error) && out == "11111111");
+  assert(bitwise::convertRadix("FF", 16, 10, out, error) && out == "255");
+  assert(bitwise::convertRadix("777", 8, 16, out, error) && out == "1ff");
+  assert(bitwise::convertRadix("-255", 10, 16, out, error) && out == "-ff");
+  assert(bitwise::convertRadix("-0", 10, 2, out, error) && out == "0");
+  assert(bitwise::convertRadix("000123", 10, 10, out, error) && out == "123");
+  assert(bitwise::convertRadix("zz", 36, 10, out, error) && out == "1295");
+  assert(bitwise::convertRadix("18446744073709551616", 10, 16, out, error) && out == "10000000000000000");
+
+  assert(!bitwise::convertRadix("12", 2, 10, out, error));
+  assert(error == "invalid digit '2' for base 2");
+  assert(!bitwise::convertRadix("", 10, 2, out, error));
+  assert(error == "empty number");
+  assert(!bitwise::convertRadix("-", 10, 2, out, error));
+  assert(!bitwise::convertRadix("1 2", 10, 2, out, error));
+  assert(!bitwise::convertRadix("12", 10, 37, out, error));
+  assert(error == "base must be 2-36");
+  assert(!bitwise::convertRadix("12", 1, 10, out, error));
+  std::cout << "✓ convertRadix tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running big integer radix conversion tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testSmallValues();
+  testPowers();
+  testLargeConversions();
+  testMultiply();
+  testConvertRadix();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
@@ -0,0 +1,165 @@
+#include "../include/bit_transpose.h"
+#include "../include/bitwise_utils.h"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <vector>
+
+// Reference transpose, one bit at a time
+template <typename Word>
+std::vector<Word> naiveTranspose(const std::vector<Word> &rows)
+{
+  const std::size_t n = sizeof(Word) * 8;
+  std::vector<Word> out(n, 0);
+  for (std::size_t r = 0; r < n; ++r)
+  {
+    for (std::size_t c = 0; c < n; ++c)
+    {
+      if ((rows[r] >> c) & 1)
+        out[c] |= Word(1) << r;
+    }
+  }
+  return out;
+}
+
+void testTranspose8x8()
+{
+  std::cout << "Testing 8x8 transpose..." << std::endl;
+
+  // Row 0 = 0b00000011 -> columns 0 and 1 get bit 0
+  assert(bitwise::transpose8x8(0x03) == 0x0101);
+  assert(bitwise::transpose8x8(0xFF) == 0x0101010101010101ULL); // full row 0 -> full column 0
+  assert(bitwise::transpose8x8(0x8040201008040201ULL) == 0x8040201008040201ULL); // diagonals are fixed points
+  assert(bitwise::transpose8x8(0x0102040810204080ULL) == 0x0102040810204080ULL);
+  std::mt19937_64 rng(8);
+  for (int trial = 0; trial < 1000; ++trial)
+  {
+    uint64_t m = rng();
+    uint64_t t = bitwise::transpose8x8(m);
+    for (unsigned r = 0; r < 8; ++r)
+    {
+      for (unsigned c = 0; c < 8; ++c)
+        assert(((m >> (8 * r + c)) & 1) == ((t >> (8 * c + r)) & 1));
+    }
+    assert(bitwise::transpose8x8(t) == m);
+  }
+
+  std::cout << "✓ 8x8 transpose tests passed" << std::endl;
+}
+
+void testTransposeBlocks(bitwise::SimdLevel level)
+{
+  std::cout << "Testing 32x32 and 64x64 transposes (" << bitwise::simdLevelName(level) << ")..." << std::endl;
+
+  std::mt19937_64 rng(32);
+  for (int trial = 0; trial < 200; ++trial)
+  {
+    std::vector<uint32_t> rows32(32);
+    std::vector<uint64_t> rows64(64);
+    for (uint32_t &row : rows32)
+      row = static_cast<uint32_t>(rng());
+    for (uint64_t &row : rows64)
+      row = rng();
+    if (trial == 0)
+    {
+      // Identity, all ones and a single bit in the far corner
+      for (std::size_t i = 0; i < 32; ++i)
+        rows32[i] = 1U << i;
+      std::fill(rows64.begin(), rows64.end(), ~0ULL);
+    }
+    else if (trial == 1)
+    {
+      std::fill(rows32.begin(), rows32.end(), 0U);
+      rows32[31] = 1;
+      std::fill(rows64.begin(), rows64.end(), 0ULL);
+      rows64[0] = 1ULL << 63;
+    }
+
+    std::vector<uint32_t> out32(32);
+    bitwise::transpose32x32(out32.data(), rows32.data());
+    assert(out32 == naiveTranspose(rows32));
+    std::vector<uint64_t> out64(64);
+    bitwise::transpose64x64(out64.data(), rows64.data());
+    assert(out64 == naiveTranspose(rows64));
+
+    // In place gives the same result, and transposing twice restores the input
+    std::vector<uint32_t> inPlace32 = rows32;
+    bitwise::transpose32x32(inPlace32.data(), inPlace32.data());
+    assert(inPlace32 == out32);
+    bitwise::transpose32x32(inPlace32.data(), inPlace32.data());
+    assert(inPlace32 == rows32);
+    std::vector<uint64_t> inPlace64 = rows64;
+    bitwise::transpose64x64(inPlace64.data(), inPlace64.data());
+    assert(inPlace64 == out64);
+    bitwise::transpose64x64(inPlace64.data(), inPlace64.data());
+    assert(inPlace64 == rows64);
+  }
+
+  std::cout << "✓ Block transpose tests passed" << std::endl;
+}
+
+void testTransposeBitMatrix(bitwise::SimdLevel level)
+{
+  std::cout << "Testing bulk transposeBitMatrix (" << bitwise::simdLevelName(level) << ")..." << std::endl;
+
+  std::mt19937 rng(77);
+  const std::size_t shapes[][2] = {{0, 1}, {1, 1}, {31, 1}, {32, 1}, {33, 1}, {1000, 1}, {64, 2}, {100, 3}, {7, 5}};
+  for (const auto &shape : shapes)
+  {
+    const std::size_t rows = shape[0], rowWords = shape[1];
+    const std::size_t outWords = (rows + 31) / 32;
+    std::vector<uint32_t> src(rows * rowWords);
+    for (uint32_t &word : src)
+      word = rng();
+    // Sentinel word past the end must survive
+    std::vector<uint32_t> dst(32 * rowWords * outWords + 1, 0xDEADBEEF);
+    bitwise::transposeBitMatrix(dst.data(), src.data(), rows, rowWords);
+    assert(dst.back() == 0xDEADBEEF);
+
+    for (std::size_t c = 0; c < 32 * rowWords; ++c)
+    {
+      for (std::size_t r = 0; r < 32 * outWords; ++r)
+      {
+        bool expected = r < rows && bitwise::isBitSet(src[r * rowWords + c / 32], static_cast<int>(c % 32));
+        assert(bitwise::isBitSet(dst[c * outWords + r / 32], static_cast<int>(r % 32)) == expected);
+      }
+    }
+
+    // Transposing the 32 x rows result back recovers the records
+    if (rowWords == 1 && rows > 0)
+    {
+      std::vector<uint32_t> back(32 * outWords);
+      bitwise::transposeBitMatrix(back.data(), dst.data(), 32, outWords);
+      for (std::size_t r = 0; r < rows; ++r)
+        assert(back[r] == src[r]);
+    }
+  }
+
+  std::cout << "✓ Bulk transpose tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running bit-matrix transpose tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testTranspose8x8();
+  bitwise::SimdLevel best = bitwise::detectSimdLevel();
+  for (int level = 0; level <= static_cast<int>(best); ++level)
+  {
+    bitwise::SimdLevel selected = bitwise::setSimdLevel(static_cast<bitwise::SimdLevel>(level));
+    testTransposeBlocks(selected);
+    testTransposeBitMatrix(selected);
+  }
+  bitwise::setSimdLevel(best);
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
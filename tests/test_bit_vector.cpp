@@ -0,0 +1,169 @@
+#include "../include/bit_vector.h"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+void testBitOperations()
+{
+  std::cout << "Testing BitVector bit operations..." << std::endl;
+
+  bitwise::BitVector bits(100);
+  assert(bits.size() == 100);
+  assert(bits.countSetBits() == 0);
+  assert(reinterpret_cast<std::uintptr_t>(bits.data()) % bitwise::kCacheLineSize == 0);
+
+  bits.setBit(0);
+  bits.setBit(31);
+  bits.setBit(32);
+  bits.setBit(99);
+  assert(bits.isBitSet(0) && bits.isBitSet(31) && bits.isBitSet(32) && bits.isBitSet(99));
+  assert(!bits.isBitSet(1) && !bits.isBitSet(98));
+  assert(bits.countSetBits() == 4);
+
+  bits.clearBit(31);
+  assert(!bits.isBitSet(31));
+  bits.toggleBit(50);
+  assert(bits.isBitSet(50));
+  bits.toggleBit(50);
+  assert(!bits.isBitSet(50));
+  assert(bits.countSetBits() == 3);
+
+  std::cout << "✓ BitVector bit operation tests passed" << std::endl;
+}
+
+void testResize()
+{
+  std::cout << "Testing BitVector resize/pushBack..." << std::endl;
+
+  bitwise::BitVector bits(5, true);
+  assert(bits.countSetBits() == 5);
+  bits.resize(70, true);
+  assert(bits.countSetBits() == 70);
+  bits.resize(40);
+  assert(bits.countSetBits() == 40);
+  bits.resize(64);
+  assert(bits.countSetBits() == 40 && !bits.isBitSet(63));
+
+  bitwise::BitVector pushed;
+  for (int i = 0; i < 1000; ++i)
+    pushed.pushBack(i % 3 == 0);
+  assert(pushed.size() == 1000);
+  assert(pushed.countSetBits() == 334);
+  assert(pushed.isBitSet(999) && !pushed.isBitSet(998));
+
+  std::cout << "✓ BitVector resize tests passed" << std::endl;
+}
+
+void checkRankSelect(const bitwise::BitVector &bits, const std::vector<std::size_t> &ones)
+{
+  // Compare against a position list computed independently
+  std::size_t k = 0;
+  for (std::size_t i = 0; i <= bits.size(); i += 7)
+  {
+    while (k < ones.size() && ones[k] < i)
+      ++k;
+    assert(bits.rank(i) == k);
+  }
+  assert(bits.rank(bits.size()) == ones.size());
+  // Positions past the end clamp to size(), including ones still inside the last word or block
+  for (std::size_t past : {std::size_t(1), std::size_t(31), std::size_t(100), std::size_t(2000), std::size_t(1) << 20})
+    assert(bits.rank(bits.size() + past) == ones.size());
+  for (std::size_t j = 0; j < ones.size(); ++j)
+    assert(bits.select(j) == ones[j]);
+  assert(bits.select(ones.size()) == bits.size());
+}
+
+void testRankSelect()
+{
+  std::cout << "Testing BitVector rank/select..." << std::endl;
+
+  std::mt19937 rng(7);
+  const double densities[] = {0.001, 0.05, 0.5, 0.97};
+  for (double density : densities)
+  {
+    std::bernoulli_distribution coin(density);
+    bitwise::BitVector bits;
+    std::vector<std::size_t> ones;
+    for (std::size_t i = 0; i < 120000; ++i)
+    {
+      bool bit = coin(rng);
+      bits.pushBack(bit);
+      if (bit)
+        ones.push_back(i);
+    }
+
+    checkRankSelect(bits, ones); // linear fallback
+    bits.buildRankSelectIndex();
+    assert(bits.hasRankSelectIndex());
+    checkRankSelect(bits, ones); // indexed
+
+    bits.toggleBit(1);
+    assert(!bits.hasRankSelectIndex());
+  }
+
+  // Sparse stretches long enough to store explicit positions, between dense stretches that are
+  // binary searched, and a sparse tail span with fewer than 8192 ones
+  {
+    bitwise::BitVector mixed;
+    std::vector<std::size_t> ones;
+    auto append = [&](std::size_t length, std::size_t stride)
+    {
+      for (std::size_t i = 0; i < length; ++i)
+      {
+        bool bit = i % stride == 0;
+        if (bit)
+          ones.push_back(mixed.size());
+        mixed.pushBack(bit);
+      }
+    };
+    append(std::size_t(1) << 20, 2);
+    append(std::size_t(10) << 20, 1000);
+    append(std::size_t(1) << 16, 3);
+    append(std::size_t(6) << 20, 4099);
+    mixed.buildRankSelectIndex();
+    for (std::size_t j = 0; j < ones.size(); ++j)
+      assert(mixed.select(j) == ones[j] && mixed.rank(ones[j]) == j);
+    assert(mixed.select(ones.size()) == mixed.size());
+  }
+
+  // Small vectors whose last block runs far past the words: rank(n) agrees with and without the index
+  for (std::size_t size : {1, 31, 32, 100, 2047, 2048, 2049})
+  {
+    bitwise::BitVector full(size, true);
+    std::vector<std::size_t> expected;
+    for (std::size_t n = 0; n < 3 * 2048 + 5; ++n)
+      expected.push_back(full.rank(n));
+    full.buildRankSelectIndex();
+    for (std::size_t n = 0; n < expected.size(); ++n)
+      assert(full.rank(n) == expected[n] && expected[n] == std::min(n, size));
+  }
+
+  bitwise::BitVector empty;
+  empty.buildRankSelectIndex();
+  assert(empty.rank(0) == 0);
+  assert(empty.select(0) == 0);
+
+  std::cout << "✓ BitVector rank/select tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running BitVector tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testBitOperations();
+  testResize();
+  testRankSelect();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
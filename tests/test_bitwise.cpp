@@ -1,6 +1,7 @@
 #include "../include/bitwise_utils.h"
 #include <iostream>
 #include <cassert>
+#include <climits>
 #include <string>
 
 void testBinaryString()
@@ -27,6 +28,40 @@ void testHexString()
   std::cout << "✓ toHexString tests passed" << std::endl;
 }
 
+void testToChars()
+{
+  std::cout << "Testing toBinaryChars/toHexChars..." << std::endl;
+
+  char buffer[bitwise::kMaxBinaryChars];
+  std::to_chars_result r = bitwise::toBinaryChars(buffer, buffer + sizeof(buffer), 0xA5, 8);
+  assert(r.ec == std::errc() && std::string(buffer, r.ptr) == "1010 0101");
+  r = bitwise::toBinaryChars(buffer, buffer + sizeof(buffer), 0x5, 6);
+  assert(std::string(buffer, r.ptr) == "00 0101");
+  r = bitwise::toBinaryChars(buffer, buffer + sizeof(buffer), 0x1A5, 10, false);
+  assert(std::string(buffer, r.ptr) == "0110100101");
+  r = bitwise::toBinaryChars(buffer, buffer + sizeof(buffer), 0xFFFFFFFF);
+  assert(r.ptr == buffer + bitwise::kMaxBinaryChars);
+  r = bitwise::toBinaryChars(buffer, buffer + 8, 0xA5, 8);
+  assert(r.ec == std::errc::value_too_large);
+
+  r = bitwise::toHexChars(buffer, buffer + sizeof(buffer), 0xBEEF);
+  assert(std::string(buffer, r.ptr) == "0xBEEF");
+  r = bitwise::toHexChars(buffer, buffer + sizeof(buffer), 0xABC, false, false);
+  assert(std::string(buffer, r.ptr) == "abc");
+  r = bitwise::toHexChars(buffer, buffer + bitwise::kMaxHexChars, 0xFFFFFFFF);
+  assert(std::string(buffer, r.ptr) == "0xFFFFFFFF");
+  r = bitwise::toHexChars(buffer, buffer + 3, 0x100);
+  assert(r.ec == std::errc::value_too_large);
+
+  // The string versions are built on the same code and must keep their format
+  assert(bitwise::toBinaryString(0x80000001) == "1000 0000 0000 0000 0000 0000 0000 0001");
+  assert(bitwise::toBinaryString(3, 0) == "");
+  assert(bitwise::toHexString(0x12345678) == "0x12345678");
+  assert(bitwise::toHexString(0x100) == "0x100");
+
+  std::cout << "✓ toBinaryChars/toHexChars tests passed" << std::endl;
+}
+
 void testBitwiseOperations()
 {
   std::cout << "Testing bitwise operations..." << std::endl;
@@ -108,10 +143,38 @@ void testCountSetBits()
   assert(bitwise::countSetBits(0b1010) == 2);
   assert(bitwise::countSetBits(0b0101) == 2);
   assert(bitwise::countSetBits(0xFFFFFFFF) == 32);
+  assert(bitwise::countSetBits(0x80000001) == 2);
+  assert(bitwise::countSetBits(0xDEADBEEF) == 24);
 
   std::cout << "✓ countSetBits tests passed" << std::endl;
 }
 
+void testPower()
+{
+  std::cout << "Testing power/checkedPower..." << std::endl;
+
+  assert(bitwise::power(2, 10) == 1024);
+  assert(bitwise::power(16, 15) == 0x1000000000000000LL);
+  assert(bitwise::power(-3, 3) == -27);
+  assert(bitwise::power(7, 0) == 1);
+  assert(bitwise::power(5, -2) == 1);
+  assert(bitwise::power(0, 0) == 1);
+  assert(bitwise::power(2, 62) == 1LL << 62);
+
+  long long result = 0;
+  assert(bitwise::checkedPower(3, 39, result) && result == 4052555153018976267LL);
+  assert(!bitwise::checkedPower(2, 63, result));
+  assert(bitwise::checkedPower(-2, 63, result) && result == LLONG_MIN);
+  assert(!bitwise::checkedPower(10, 19, result));
+  assert(bitwise::checkedPower(1, INT_MAX, result) && result == 1);
+
+  // Overflow saturates instead of wrapping
+  assert(bitwise::power(2, 64) == LLONG_MAX);
+  assert(bitwise::power(-10, 19) == LLONG_MIN);
+  assert(bitwise::power(-10, 20) == LLONG_MAX);
+  std::cout << "✓ power tests passed" << std::endl;
+}
+
 void runAllTests()
 {
   std::cout << "Running all tests..." << std::endl;
@@ -119,10 +182,12 @@ void runAllTests()
 
   testBinaryString();
   testHexString();
+  testToChars();
   testBitwiseOperations();
   testShiftOperations();
   testBitManipulation();
   testCountSetBits();
+  testPower();
 
   std::cout << "====================" << std::endl;
   std::cout << "All tests passed! ✓" << std::endl;
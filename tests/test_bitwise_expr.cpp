@@ -0,0 +1,159 @@
+#include "../include/bitwise_expr.h"
+#include "../include/bitwise_utils.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <string>
+#include <vector>
+
+bitwise::ExpressionPlan compileOrDie(const std::string &source)
+{
+  bitwise::ExpressionPlan plan;
+  std::string error;
+  bool ok = bitwise::ExpressionPlan::compile(source, plan, error);
+  if (!ok)
+    std::cout << "compile failed: " << error << std::endl;
+  assert(ok);
+  return plan;
+}
+
+void testPrecedenceAndSemantics()
+{
+  std::cout << "Testing expression semantics..." << std::endl;
+
+  bitwise::ExpressionPlan plan = compileOrDie("(a & b) ^ ~c << 3");
+  assert((plan.variables() == std::vector<std::string>{"a", "b", "c"}));
+
+  std::mt19937 rng(5);
+  for (int i = 0; i < 1000; ++i)
+  {
+    uint32_t values[3] = {static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng())};
+    // Same expression through the library's scalar operators, C precedence: ~ binds tighter than <<
+    uint32_t expected = bitwise::bitwiseXor(bitwise::bitwiseAnd(values[0], values[1]),
+                                            bitwise::leftShift(bitwise::bitwiseNot(values[2]), 3));
+    assert(plan.evaluate(values) == expected);
+  }
+
+  uint32_t row[2] = {0xF0, 0x0F};
+  assert(compileOrDie("x | y & 0x3").evaluate(row) == (0xF0 | (0x0F & 0x3)));
+  assert(compileOrDie("x ^ y | 1").evaluate(row) == ((0xF0 ^ 0x0F) | 1));
+  assert(compileOrDie("x >> 4 << 1").evaluate(row) == ((0xF0 >> 4) << 1));
+  uint32_t shifts[2] = {1, 40};
+  assert(compileOrDie("a << b").evaluate(shifts) == 0); // shifts of 32+ are defined as 0
+  assert(compileOrDie("0b1010 & 0xFF ^ 3").evaluate(shifts) == ((0b1010 & 0xFF) ^ 3));
+
+  std::cout << "✓ Expression semantics tests passed" << std::endl;
+}
+
+void testOptimizations()
+{
+  std::cout << "Testing expression optimizations..." << std::endl;
+
+  // Constant folding
+  bitwise::ExpressionPlan folded = compileOrDie("(0xF0 | 0x0F) & ~0 << 4");
+  assert(folded.instructionCount() == 0);
+  assert(folded.evaluate(nullptr) == ((0xF0 | 0x0F) & (~0U << 4)));
+
+  // Identities
+  assert(compileOrDie("a & 0").instructionCount() == 0);
+  assert(compileOrDie("a | 0 ^ 0").instructionCount() == 0);
+  assert(compileOrDie("~~a").instructionCount() == 0);
+  assert(compileOrDie("a ^ a").instructionCount() == 0);
+  assert(compileOrDie("a << 32").instructionCount() == 0);
+  assert(compileOrDie("a << 3 << 4").instructionCount() == 1);
+
+  // Shared subexpressions are computed once
+  bitwise::ExpressionPlan shared = compileOrDie("(a & b) | ~(b & a) ^ (a & b)");
+  assert(shared.instructionCount() == 4);
+
+  // Registers are recycled, so a long chain needs only a couple of block buffers
+  bitwise::ExpressionPlan chain = compileOrDie("((((a & b) | c) ^ d) & ~e) >> 1 | (a << 2)");
+  assert(chain.registerCount() <= 2);
+
+  std::cout << "✓ Expression optimization tests passed" << std::endl;
+}
+
+void testColumnExecution()
+{
+  std::cout << "Testing fused column execution..." << std::endl;
+
+  bitwise::ExpressionPlan plan = compileOrDie("((a & b) ^ ~c << 3) | (1 << d) & 0xFFFF");
+  const std::size_t rows = bitwise::ExpressionPlan::kBlockSize * 3 + 77;
+  std::mt19937 rng(11);
+  std::vector<std::vector<uint32_t>> columns(4, std::vector<uint32_t>(rows));
+  for (auto &column : columns)
+    for (uint32_t &value : column)
+      value = rng();
+  for (uint32_t &value : columns[3])
+    value %= 40; // shift counts, some of them out of range
+
+  const uint32_t *pointers[4] = {columns[0].data(), columns[1].data(), columns[2].data(), columns[3].data()};
+  std::vector<uint32_t> out(rows);
+  plan.execute(pointers, out.data(), rows);
+  for (std::size_t i = 0; i < rows; ++i)
+  {
+    uint32_t row[4] = {columns[0][i], columns[1][i], columns[2][i], columns[3][i]};
+    assert(out[i] == plan.evaluate(row));
+  }
+
+  // Output may alias an input column
+  std::vector<uint32_t> a = columns[0];
+  const uint32_t *aliased[4] = {a.data(), columns[1].data(), columns[2].data(), columns[3].data()};
+  plan.execute(aliased, a.data(), rows);
+  assert(a == out);
+
+  // Bare variables and constants
+  std::vector<uint32_t> copy(rows);
+  bitwise::ExpressionPlan identity = compileOrDie("a & a");
+  identity.execute(pointers, copy.data(), rows);
+  assert(copy == columns[0]);
+
+  std::cout << "✓ Fused column execution tests passed" << std::endl;
+}
+
+void testErrors()
+{
+  std::cout << "Testing expression errors..." << std::endl;
+
+  // Includes operands that fail before any node exists ("~", "~(") and failures on the right of
+  // every binary operator, none of which may reach the graph builder
+  const char *bad[] = {"", "a &", "(a | b", "a + b", "0x1FFFFFFFF", "12ab", "a b", ")",
+                       "~", "~~", "~(", "(~", "~)", "~a &", "a | ~", "a ^ (", "a & ~~", "a << ~",
+                       "a >> (", "~(a |", "1 | ~+", "((((~"};
+  for (const char *source : bad)
+  {
+    bitwise::ExpressionPlan plan;
+    std::string error;
+    assert(!bitwise::ExpressionPlan::compile(source, plan, error));
+    assert(!error.empty());
+  }
+
+  bitwise::ExpressionPlan plan;
+  std::string error;
+  bitwise::ExpressionPlan::compile("a + b", plan, error);
+  assert(error == "unexpected '+' at column 3");
+  bitwise::ExpressionPlan::compile("~", plan, error);
+  assert(error == "unexpected end of expression at column 2");
+
+  std::cout << "✓ Expression error tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running expression compiler tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testPrecedenceAndSemantics();
+  testOptimizations();
+  testColumnExecution();
+  testErrors();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
@@ -0,0 +1,259 @@
+#include "../include/bitwise_generic.h"
+#include "../include/bitwise_utils.h"
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace g = bitwise::generic;
+
+// Everything below is evaluated by the compiler; a failure stops the build
+static_assert(g::bitwiseAnd<uint8_t>(0b1010, 0b1100) == 0b1000, "uint8 AND");
+static_assert(g::bitwiseOr<uint16_t>(0xF000, 0x000F) == 0xF00F, "uint16 OR");
+static_assert(g::bitwiseXor<uint32_t>(0xFFFF0000U, 0xFFFFFFFFU) == 0x0000FFFFU, "uint32 XOR");
+static_assert(g::bitwiseNot<uint8_t>(0x0F) == 0xF0, "NOT truncates to the operand width");
+static_assert(g::bitwiseNot<uint64_t>(0) == ~0ULL, "uint64 NOT");
+static_assert(g::leftShift<uint8_t>(0x81, 1) == 0x02, "uint8 shift drops the high bit");
+static_assert(g::leftShift<uint64_t>(1, 63) == (1ULL << 63), "uint64 shift");
+static_assert(g::leftShift<uint32_t>(1, 32) == 0 && g::rightShift<uint32_t>(1, -1) == 0, "out-of-range shifts are 0");
+static_assert(g::setBit<uint64_t>(0, 40) == (1ULL << 40), "uint64 setBit");
+static_assert(g::clearBit<uint16_t>(0xFFFF, 15) == 0x7FFF, "uint16 clearBit");
+static_assert(g::toggleBit<uint8_t>(0, 7) == 0x80, "uint8 toggleBit");
+static_assert(g::isBitSet<uint64_t>(1ULL << 50, 50) && !g::isBitSet<uint64_t>(1ULL << 50, 64), "uint64 isBitSet");
+static_assert(g::countSetBits<uint8_t>(0xFF) == 8, "uint8 popcount");
+static_assert(g::countSetBits<uint64_t>(0xF0F0F0F0F0F0F0F0ULL) == 32, "uint64 popcount");
+static_assert(g::power<uint32_t>(3, 5) == 243, "power");
+static_assert(g::power<uint8_t>(2, 8) == 0, "power wraps modulo 2^width");
+static_assert(g::power<uint64_t>(10, 19) == 10000000000000000000ULL, "uint64 power");
+
+constexpr long long checkedPowerOr(long long base, unsigned exponent, long long fallback)
+{
+  long long result = 0;
+  return g::checkedPower(base, exponent, result) ? result : fallback;
+}
+static_assert(checkedPowerOr(10, 18, -1) == 1000000000000000000LL, "checkedPower");
+static_assert(checkedPowerOr(10, 19, -1) == -1, "checkedPower detects overflow");
+static_assert(checkedPowerOr(-2, 63, 0) < 0, "checkedPower reaches LLONG_MIN");
+static_assert(g::countLeadingZeros<uint8_t>(0x10) == 3 && g::countLeadingZeros<uint64_t>(0) == 64, "clz");
+static_assert(g::countTrailingZeros<uint16_t>(0x8000) == 15 && g::countTrailingZeros<uint32_t>(0) == 32, "ctz");
+static_assert(g::rotateLeft<uint8_t>(0x81, 1) == 0x03 && g::rotateRight<uint32_t>(1, 1) == 0x80000000U, "rotate");
+static_assert(g::rotateLeft<uint16_t>(0x1234, 16) == 0x1234 && g::rotateLeft<uint16_t>(0x1234, -4) == 0x4123, "rotate modulo width");
+static_assert(g::funnelShiftLeft<uint8_t>(0x12, 0x80, 1) == 0x25 && g::funnelShiftRight<uint8_t>(0x01, 0x10, 4) == 0x11, "funnel shift");
+static_assert(g::funnelShiftLeft<uint32_t>(5, 7, 32) == 5 && g::funnelShiftRight<uint32_t>(5, 7, 0) == 7, "funnel shift modulo width");
+static_assert(g::reverseBits<uint8_t>(0x01) == 0x80 && g::reverseBits<uint64_t>(0x0F) == 0xF000000000000000ULL, "reverse");
+static_assert(g::extractBits<uint32_t>(0xABCD1234U, 0x0000FF00U) == 0x12, "pext");
+static_assert(g::extractBits<uint8_t>(0b10110110, 0b01010101) == 0b0110, "pext uint8");
+static_assert(g::depositBits<uint32_t>(0x12, 0x0000FF00U) == 0x1200, "pdep");
+static_assert(g::depositBits<uint16_t>(0b1011, 0b1000100010001000) == 0b1000000010001000, "pdep uint16");
+
+constexpr int sumOfSetBitPositions(uint32_t value)
+{
+  int sum = 0;
+  for (int position : g::setBitPositions(value))
+    sum += position;
+  return sum;
+}
+static_assert(sumOfSetBitPositions(0x80000005U) == 33, "set-bit iteration");
+static_assert(g::toBinaryArray<uint8_t>(0xA5)[0] == '1' && g::toBinaryArray<uint8_t>(0xA5)[4] == ' ', "binary array");
+static_assert(g::binary_chars_v<uint32_t> == bitwise::kMaxBinaryChars, "binary width matches the 32-bit formatter");
+
+#ifdef BITWISE_HAS_INT128
+constexpr bitwise::uint128_t kHigh = static_cast<bitwise::uint128_t>(1) << 100;
+static_assert(g::setBit<bitwise::uint128_t>(0, 100) == kHigh, "uint128 setBit");
+static_assert(g::countSetBits(g::bitwiseNot<bitwise::uint128_t>(0)) == 128, "uint128 popcount");
+static_assert(g::rightShift(kHigh, 100) == 1, "uint128 shift");
+static_assert(g::countLeadingZeros(kHigh) == 27 && g::countTrailingZeros(kHigh) == 100, "uint128 clz/ctz");
+static_assert(g::reverseBits(kHigh) == static_cast<bitwise::uint128_t>(1) << 27, "uint128 reverse");
+static_assert(g::extractBits(kHigh | 1, kHigh) == 1 && g::depositBits<bitwise::uint128_t>(1, kHigh) == kHigh, "uint128 pext/pdep");
+#endif
+
+// Bit-at-a-time definitions the branch-free and hardware versions must agree with
+template <typename T>
+T referenceExtract(T value, T mask)
+{
+  T out = 0;
+  int next = 0;
+  for (int i = 0; i < g::bit_width_v<T>; ++i)
+  {
+    if (g::isBitSet(mask, i))
+    {
+      if (g::isBitSet(value, i))
+        out = g::setBit(out, next);
+      ++next;
+    }
+  }
+  return out;
+}
+
+template <typename T>
+T referenceDeposit(T value, T mask)
+{
+  T out = 0;
+  int next = 0;
+  for (int i = 0; i < g::bit_width_v<T>; ++i)
+  {
+    if (g::isBitSet(mask, i))
+    {
+      if (g::isBitSet(value, next))
+        out = g::setBit(out, i);
+      ++next;
+    }
+  }
+  return out;
+}
+
+template <typename T>
+void checkBitPrimitives(std::mt19937_64 &rng)
+{
+  for (int round = 0; round < 2000; ++round)
+  {
+    T value = static_cast<T>(rng()), mask = static_cast<T>(rng());
+    if (round % 4 == 1)
+      mask = static_cast<T>(mask & rng()); // sparser masks
+    if (round % 4 == 2)
+      value = static_cast<T>(value >> (rng() % g::bit_width_v<T>));
+    assert(g::extractBits(value, mask) == referenceExtract(value, mask));
+    assert(g::depositBits(value, mask) == referenceDeposit(value, mask));
+    assert(g::extractBits(g::depositBits(value, mask), mask) == referenceExtract(referenceDeposit(value, mask), mask));
+
+    int clz = g::countLeadingZeros(value), ctz = g::countTrailingZeros(value);
+    assert(value == 0 ? clz == g::bit_width_v<T> : g::isBitSet(value, g::bit_width_v<T> - 1 - clz));
+    assert(value == 0 ? ctz == g::bit_width_v<T> : g::isBitSet(value, ctz) && (value & static_cast<T>(g::leftShift(T(1), ctz) - 1)) == 0);
+    assert(g::reverseBits(g::reverseBits(value)) == value);
+    assert(g::countLeadingZeros(g::reverseBits(value)) == ctz);
+    int shift = static_cast<int>(rng() % 200) - 100;
+    assert(g::rotateRight(g::rotateLeft(value, shift), shift) == value);
+    assert(g::countSetBits(g::rotateLeft(value, shift)) == g::countSetBits(value));
+    // Funnelling a word with itself is a rotation
+    assert(g::funnelShiftLeft(value, value, shift) == g::rotateLeft(value, shift));
+    assert(g::funnelShiftRight(value, value, shift) == g::rotateRight(value, shift));
+
+    int visited = 0, previous = -1;
+    for (int position : g::setBitPositions(value))
+    {
+      assert(position > previous && g::isBitSet(value, position));
+      previous = position;
+      ++visited;
+    }
+    assert(visited == g::countSetBits(value));
+  }
+}
+
+void testBitPrimitives()
+{
+  std::cout << "Testing clz/ctz/rotate/reverse/pext/pdep..." << std::endl;
+
+  std::mt19937_64 rng(15);
+  checkBitPrimitives<uint8_t>(rng);
+  checkBitPrimitives<uint16_t>(rng);
+  checkBitPrimitives<uint32_t>(rng);
+  checkBitPrimitives<uint64_t>(rng);
+
+  // The runtime-dispatched uint32_t versions agree with the portable ones
+  for (int round = 0; round < 10000; ++round)
+  {
+    uint32_t value = static_cast<uint32_t>(rng()), mask = static_cast<uint32_t>(rng() & rng());
+    assert(bitwise::extractBits(value, mask) == g::extractBits(value, mask));
+    assert(bitwise::depositBits(value, mask) == g::depositBits(value, mask));
+    int shift = static_cast<int>(rng() % 100) - 50;
+    assert(bitwise::rotateLeft(value, shift) == g::rotateLeft(value, shift));
+    assert(bitwise::rotateRight(value, shift) == g::rotateRight(value, shift));
+    uint32_t low = static_cast<uint32_t>(rng());
+    uint64_t joined = (static_cast<uint64_t>(value) << 32) | low;
+    int amount = static_cast<int>(rng() % 32);
+    assert(bitwise::funnelShiftLeft(value, low, amount) == static_cast<uint32_t>((joined << amount) >> 32));
+    assert(bitwise::funnelShiftRight(value, low, amount) == static_cast<uint32_t>(joined >> amount));
+    assert(bitwise::funnelShiftLeft(value, low, amount + 32) == bitwise::funnelShiftLeft(value, low, amount));
+  }
+
+  const uint32_t words[] = {0x80000001U, 0, 0x6U};
+  std::vector<std::size_t> positions;
+  g::forEachSetBit(words, 3, [&](std::size_t position)
+                   { positions.push_back(position); });
+  assert((positions == std::vector<std::size_t>{0, 31, 65, 66}));
+
+  std::cout << "✓ Bit primitive tests passed" << std::endl;
+}
+
+void testBinaryStrings()
+{
+  std::cout << "Testing generic toBinaryString..." << std::endl;
+
+  assert(g::toBinaryString<uint8_t>(0xA5) == "1010 0101");
+  assert(g::toBinaryString<uint16_t>(0x8001) == "1000 0000 0000 0001");
+  assert(g::toBinaryString<uint64_t>(1ULL << 63, 64).substr(0, 4) == "1000");
+  assert(g::toBinaryString<uint32_t>(170, 8) == bitwise::toBinaryString(170, 8));
+  constexpr auto array = g::toBinaryArray<uint32_t>(0xDEADBEEF);
+  assert(std::strcmp(array.data(), bitwise::toBinaryString(0xDEADBEEF).c_str()) == 0);
+
+  std::cout << "✓ Generic toBinaryString tests passed" << std::endl;
+}
+
+void testWrappersMatch()
+{
+  std::cout << "Testing uint32_t wrappers against generic versions..." << std::endl;
+
+  const uint32_t samples[] = {0, 1, 0x80000000U, 0xDEADBEEFU, 0xFFFFFFFFU, 12345};
+  for (uint32_t a : samples)
+  {
+    for (uint32_t b : samples)
+    {
+      assert(bitwise::bitwiseAnd(a, b) == g::bitwiseAnd(a, b));
+      assert(bitwise::bitwiseOr(a, b) == g::bitwiseOr(a, b));
+      assert(bitwise::bitwiseXor(a, b) == g::bitwiseXor(a, b));
+    }
+    assert(bitwise::bitwiseNot(a) == g::bitwiseNot(a));
+    assert(bitwise::countSetBits(a) == g::countSetBits(a));
+    assert(bitwise::countLeadingZeros(a) == g::countLeadingZeros(a));
+    assert(bitwise::countTrailingZeros(a) == g::countTrailingZeros(a));
+    assert(bitwise::reverseBits(a) == g::reverseBits(a));
+    for (int shift = -2; shift < 40; ++shift)
+    {
+      assert(bitwise::leftShift(a, shift) == g::leftShift(a, shift));
+      assert(bitwise::rightShift(a, shift) == g::rightShift(a, shift));
+    }
+  }
+  assert(bitwise::leftShift(1, 32) == 0);
+
+  std::cout << "✓ Wrapper tests passed" << std::endl;
+}
+
+#ifdef BITWISE_HAS_INT128
+void testInt128()
+{
+  std::cout << "Testing uint128_t operations..." << std::endl;
+
+  bitwise::uint128_t value = 0;
+  for (int bit = 0; bit < 128; bit += 3)
+    value = g::setBit(value, bit);
+  assert(g::countSetBits(value) == 43);
+  assert(g::isBitSet(value, 126) && !g::isBitSet(value, 127));
+  assert(g::toBinaryString(value).size() == g::binary_chars_v<bitwise::uint128_t>);
+  assert(g::power<bitwise::uint128_t>(2, 127) == static_cast<bitwise::uint128_t>(1) << 127);
+
+  std::cout << "✓ uint128_t tests passed" << std::endl;
+}
+#endif
+
+void runAllTests()
+{
+  std::cout << "Running generic operation tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testBinaryStrings();
+  testWrappersMatch();
+  testBitPrimitives();
+#ifdef BITWISE_HAS_INT128
+  testInt128();
+#endif
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
@@ -0,0 +1,162 @@
+#include "../include/bloom_filter.h"
+#include "../include/bitwise_cpu.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <string>
+#include <vector>
+
+std::vector<uint64_t> randomKeys(std::size_t count, uint64_t seed)
+{
+  std::mt19937_64 rng(seed);
+  std::vector<uint64_t> keys(count);
+  for (uint64_t &key : keys)
+    key = rng();
+  return keys;
+}
+
+void testSizing()
+{
+  std::cout << "Testing filter sizing..." << std::endl;
+
+  assert(bitwise::BloomFilter().blockCount() == 1);
+  assert(bitwise::BloomFilter(std::size_t(0)).blockCount() == 1);
+  assert(bitwise::BloomFilter::blocksFor(0, 0.01) == 1);
+  assert(bitwise::BloomFilter::falsePositiveRate(10, 0) == 0);
+
+  std::size_t loose = bitwise::BloomFilter::blocksFor(100000, 0.05);
+  std::size_t medium = bitwise::BloomFilter::blocksFor(100000, 0.01);
+  std::size_t tight = bitwise::BloomFilter::blocksFor(100000, 0.001);
+  assert(loose < medium && medium < tight);
+  // The smallest block count meeting the target: one block fewer misses it
+  assert(bitwise::BloomFilter::falsePositiveRate(medium, 100000) <= 0.01);
+  assert(bitwise::BloomFilter::falsePositiveRate(medium - 1, 100000) > 0.01);
+  assert(bitwise::BloomFilter(100000, 0.01).blockCount() == medium);
+
+  std::cout << "✓ Sizing tests passed" << std::endl;
+}
+
+void testMembership(bitwise::SimdLevel level)
+{
+  std::cout << "Testing membership and false positive rate (" << bitwise::simdLevelName(level) << ")..." << std::endl;
+
+  const std::size_t count = 100000;
+  std::vector<uint64_t> keys = randomKeys(count, 1);
+  std::vector<uint64_t> absent = randomKeys(count, 2);
+  for (double rate : {0.01, 0.001})
+  {
+    bitwise::BloomFilter filter(count, rate);
+    for (uint64_t key : keys)
+      filter.insert(key);
+    for (uint64_t key : keys)
+      assert(filter.contains(key)); // no false negatives
+
+    std::size_t falsePositives = 0;
+    for (uint64_t key : absent)
+      falsePositives += filter.contains(key);
+    double measured = static_cast<double>(falsePositives) / count;
+    assert(measured < 1.5 * rate);
+
+    // The batch functions build the same bits and give the same answers
+    bitwise::BloomFilter batched(count, rate);
+    batched.insertMany(keys.data(), keys.size());
+    assert(batched == filter);
+    std::vector<uint64_t> mask((count + 63) / 64, ~0ULL);
+    batched.containsMany(mask.data(), absent.data(), absent.size());
+    std::size_t batchPositives = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      bool bit = (mask[i / 64] >> (i % 64)) & 1;
+      assert(bit == filter.contains(absent[i]));
+      batchPositives += bit;
+    }
+    assert(batchPositives == falsePositives);
+    assert((mask.back() >> (count % 64)) == 0); // bits past count are cleared
+  }
+
+  std::cout << "✓ Membership tests passed" << std::endl;
+}
+
+void testLayoutMatchesAcrossLevels()
+{
+  std::cout << "Testing that every SIMD level builds the same bits..." << std::endl;
+
+  std::vector<uint64_t> keys = randomKeys(5000, 3);
+  bitwise::SimdLevel best = bitwise::detectSimdLevel();
+  bitwise::setSimdLevel(bitwise::SimdLevel::Scalar);
+  bitwise::BloomFilter scalar(keys.size(), 0.01);
+  scalar.insertMany(keys.data(), keys.size());
+  bitwise::setSimdLevel(best);
+  bitwise::BloomFilter vector(keys.size(), 0.01);
+  vector.insertMany(keys.data(), keys.size());
+  assert(scalar == vector);
+
+  std::cout << "✓ Layout tests passed" << std::endl;
+}
+
+void testSerialization()
+{
+  std::cout << "Testing serialization..." << std::endl;
+
+  std::vector<uint64_t> keys = randomKeys(2000, 4);
+  bitwise::BloomFilter filter(keys.size(), 0.02);
+  filter.insertMany(keys.data(), keys.size());
+
+  std::vector<uint8_t> buffer(filter.serializedSize());
+  assert(buffer.size() == 16 + filter.blockCount() * 32);
+  filter.serialize(buffer.data());
+  assert(std::string(buffer.begin(), buffer.begin() + 4) == "BWBF");
+
+  bitwise::BloomFilter restored;
+  std::string error;
+  assert(bitwise::BloomFilter::deserialize(buffer.data(), buffer.size(), restored, error));
+  assert(restored == filter);
+  for (uint64_t key : keys)
+    assert(restored.contains(key));
+
+  // Truncated, oversized, mislabelled and future-version buffers are rejected
+  assert(!bitwise::BloomFilter::deserialize(buffer.data(), buffer.size() - 1, restored, error));
+  assert(error.find("does not match") != std::string::npos);
+  std::vector<uint8_t> longer = buffer;
+  longer.resize(buffer.size() + 32);
+  assert(!bitwise::BloomFilter::deserialize(longer.data(), longer.size(), restored, error));
+  assert(!bitwise::BloomFilter::deserialize(buffer.data(), 8, restored, error));
+  std::vector<uint8_t> corrupt = buffer;
+  corrupt[0] = 'X';
+  assert(!bitwise::BloomFilter::deserialize(corrupt.data(), corrupt.size(), restored, error));
+  assert(error == "not a serialized Bloom filter");
+  corrupt = buffer;
+  corrupt[4] = 2;
+  assert(!bitwise::BloomFilter::deserialize(corrupt.data(), corrupt.size(), restored, error));
+  assert(error.find("version 2") != std::string::npos);
+  assert(restored == filter); // failed calls leave the output untouched
+
+  filter.clear();
+  assert(filter != restored);
+  assert(filter == bitwise::BloomFilter(filter.blockCount()));
+
+  std::cout << "✓ Serialization tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running Bloom filter tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testSizing();
+  bitwise::SimdLevel best = bitwise::detectSimdLevel();
+  for (int level = 0; level <= static_cast<int>(best); ++level)
+    testMembership(bitwise::setSimdLevel(static_cast<bitwise::SimdLevel>(level)));
+  bitwise::setSimdLevel(best);
+  testLayoutMatchesAcrossLevels();
+  testSerialization();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
@@ -0,0 +1,279 @@
+#include "../include/bitwise_utils.h"
+#include "../include/bitwise_bulk.h"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <vector>
+
+// Lengths chosen to hit empty input, pure tails, exact vector multiples and vector + tail
+static const std::size_t kLengths[] = {0, 1, 3, 7, 8, 15, 16, 31, 32, 33, 100, 1023, 4099};
+
+std::vector<uint32_t> randomWords(std::size_t length, std::mt19937 &rng)
+{
+  std::vector<uint32_t> words(length);
+  for (uint32_t &word : words)
+  {
+    word = rng();
+  }
+  return words;
+}
+
+void testBinaryKernels(bitwise::SimdLevel level)
+{
+  std::mt19937 rng(1234);
+  for (std::size_t length : kLengths)
+  {
+    // Offset by one word so the SIMD paths also see unaligned pointers
+    std::vector<uint32_t> a = randomWords(length + 1, rng);
+    std::vector<uint32_t> b = randomWords(length + 1, rng);
+    std::vector<uint32_t> dst(length + 1);
+
+    bitwise::bitwiseAnd(dst.data() + 1, a.data() + 1, b.data() + 1, length);
+    for (std::size_t i = 1; i <= length; ++i)
+      assert(dst[i] == bitwise::bitwiseAnd(a[i], b[i]));
+
+    bitwise::bitwiseOr(dst.data() + 1, a.data() + 1, b.data() + 1, length);
+    for (std::size_t i = 1; i <= length; ++i)
+      assert(dst[i] == bitwise::bitwiseOr(a[i], b[i]));
+
+    bitwise::bitwiseXor(dst.data() + 1, a.data() + 1, b.data() + 1, length);
+    for (std::size_t i = 1; i <= length; ++i)
+      assert(dst[i] == bitwise::bitwiseXor(a[i], b[i]));
+
+    bitwise::bitwiseNot(dst.data() + 1, a.data() + 1, length);
+    for (std::size_t i = 1; i <= length; ++i)
+      assert(dst[i] == bitwise::bitwiseNot(a[i]));
+  }
+  std::cout << "✓ " << bitwise::simdLevelName(level) << " binary/NOT kernels match scalar functions" << std::endl;
+}
+
+void testCountSetBits(bitwise::SimdLevel level)
+{
+  std::mt19937 rng(4321);
+  // Include lengths large enough to run the full 16-vector Harley-Seal loop more than once
+  std::vector<std::size_t> lengths(std::begin(kLengths), std::end(kLengths));
+  lengths.push_back(128 * 16 + 5);
+  lengths.push_back(256 * 16 * 3 + 17);
+  for (std::size_t length : lengths)
+  {
+    std::vector<uint32_t> words = randomWords(length + 1, rng);
+    uint64_t expected = 0;
+    for (std::size_t i = 1; i <= length; ++i)
+      expected += bitwise::countSetBits(words[i]);
+    assert(bitwise::countSetBits(words.data() + 1, length) == expected);
+  }
+
+  std::vector<uint32_t> full(5000, 0xFFFFFFFF);
+  assert(bitwise::countSetBits(full.data(), full.size()) == 5000ULL * 32);
+  std::vector<uint32_t> empty(5000, 0);
+  assert(bitwise::countSetBits(empty.data(), empty.size()) == 0);
+
+  std::cout << "✓ " << bitwise::simdLevelName(level) << " buffer countSetBits matches scalar function" << std::endl;
+}
+
+void testInPlace()
+{
+  std::mt19937 rng(99);
+  std::vector<uint32_t> a = randomWords(1000, rng);
+  std::vector<uint32_t> b = randomWords(1000, rng);
+  std::vector<uint32_t> expected(1000);
+  for (std::size_t i = 0; i < a.size(); ++i)
+    expected[i] = bitwise::bitwiseNot(bitwise::bitwiseXor(a[i], b[i]));
+
+  bitwise::bitwiseXor(a.data(), a.data(), b.data(), a.size());
+  bitwise::bitwiseNot(a.data(), a.data(), a.size());
+  assert(a == expected);
+
+  std::cout << "✓ In-place kernels tests passed" << std::endl;
+}
+
+void testNoOverrun()
+{
+  // Words just past the requested length must be left untouched
+  std::vector<uint32_t> a(40, 0xFFFFFFFF);
+  std::vector<uint32_t> dst(40, 0x12345678);
+  bitwise::bitwiseNot(dst.data(), a.data(), 37);
+  for (std::size_t i = 0; i < 37; ++i)
+    assert(dst[i] == 0);
+  for (std::size_t i = 37; i < 40; ++i)
+    assert(dst[i] == 0x12345678);
+
+  std::cout << "✓ Tail handling tests passed" << std::endl;
+}
+
+// Bit-at-a-time reference for the multi-word shifts
+std::vector<uint32_t> referenceShift(const std::vector<uint32_t> &src, std::size_t bits, bool left)
+{
+  std::vector<uint32_t> out(src.size(), 0);
+  std::size_t total = src.size() * 32;
+  for (std::size_t i = 0; i < total; ++i)
+  {
+    std::size_t from = left ? i - bits : i + bits;
+    bool inside = left ? (i >= bits) : (bits < total - i);
+    if (inside && ((src[from / 32] >> (from % 32)) & 1))
+      out[i / 32] |= 1U << (i % 32);
+  }
+  return out;
+}
+
+// Rotation one bit at a time, towards higher indices when left is true
+std::vector<uint32_t> referenceRotate(const std::vector<uint32_t> &src, std::size_t bits, bool left)
+{
+  const std::size_t total = src.size() * 32;
+  std::vector<uint32_t> out(src.size(), 0);
+  for (std::size_t i = 0; i < total; ++i)
+  {
+    if (!((src[i / 32] >> (i % 32)) & 1))
+      continue;
+    std::size_t to = left ? (i + bits) % total : (i + total - bits % total) % total;
+    out[to / 32] |= 1U << (to % 32);
+  }
+  return out;
+}
+
+void testMultiWordShifts(bitwise::SimdLevel level)
+{
+  std::mt19937 rng(7);
+  const std::size_t distances[] = {0, 1, 5, 31, 32, 33, 64, 95, 200, 32 * 33 - 1, 32 * 33, 32 * 33 + 9, 32 * 100 + 17};
+  // 100 words cover several vector blocks plus a tail at every level
+  for (std::size_t length : {0, 1, 2, 33, 100})
+  {
+    std::vector<uint32_t> src = randomWords(length, rng);
+    for (std::size_t bits : distances)
+    {
+      std::vector<uint32_t> dst(length, 0xDEADBEEF);
+      bitwise::leftShift(dst.data(), src.data(), length, bits);
+      assert(dst == referenceShift(src, bits, true));
+      std::fill(dst.begin(), dst.end(), 0xDEADBEEF);
+      bitwise::rightShift(dst.data(), src.data(), length, bits);
+      assert(dst == referenceShift(src, bits, false));
+
+      // In place, every source word must be read before it is overwritten
+      std::vector<uint32_t> inPlace = src;
+      bitwise::leftShift(inPlace.data(), inPlace.data(), length, bits);
+      assert(inPlace == referenceShift(src, bits, true));
+      inPlace = src;
+      bitwise::rightShift(inPlace.data(), inPlace.data(), length, bits);
+      assert(inPlace == referenceShift(src, bits, false));
+
+      // Rotations keep every bit, in both directions and in place
+      std::fill(dst.begin(), dst.end(), 0xDEADBEEF);
+      bitwise::rotateLeft(dst.data(), src.data(), length, bits);
+      assert(dst == referenceRotate(src, bits, true));
+      std::fill(dst.begin(), dst.end(), 0xDEADBEEF);
+      bitwise::rotateRight(dst.data(), src.data(), length, bits);
+      assert(dst == referenceRotate(src, bits, false));
+      inPlace = src;
+      bitwise::rotateLeft(inPlace.data(), inPlace.data(), length, bits);
+      assert(inPlace == referenceRotate(src, bits, true));
+      bitwise::rotateRight(inPlace.data(), inPlace.data(), length, bits);
+      assert(inPlace == src);
+
+      // Ranges computed piecewise give the same words as the whole shift
+      if (length > 2)
+      {
+        std::vector<uint32_t> pieces(length, 0xDEADBEEF);
+        bitwise::leftShiftRange(pieces.data(), src.data(), length, bits, 0, 5);
+        bitwise::leftShiftRange(pieces.data(), src.data(), length, bits, 5, length);
+        assert(pieces == referenceShift(src, bits, true));
+        bitwise::rightShiftRange(pieces.data(), src.data(), length, bits, 7, length);
+        bitwise::rightShiftRange(pieces.data(), src.data(), length, bits, 0, 7);
+        assert(pieces == referenceShift(src, bits, false));
+      }
+    }
+  }
+  // A one-word buffer behaves like the scalar shifts and rotates
+  uint32_t word = 0x80000001, out = 0;
+  bitwise::leftShift(&out, &word, 1, 4);
+  assert(out == bitwise::leftShift(word, 4));
+  bitwise::rightShift(&out, &word, 1, 4);
+  assert(out == bitwise::rightShift(word, 4));
+  bitwise::rotateLeft(&out, &word, 1, 36);
+  assert(out == bitwise::rotateLeft(word, 4));
+  bitwise::rotateRight(&out, &word, 1, 4);
+  assert(out == bitwise::rotateRight(word, 4));
+
+  std::cout << "✓ Multi-word shifts and rotates match bit-by-bit references at " << bitwise::simdLevelName(level)
+            << std::endl;
+}
+
+void testBitBatches(bitwise::SimdLevel level)
+{
+  std::mt19937 rng(99);
+  // Small buffers take the prefetch-only path; the 4 MiB one with 100000 positions is bucketed
+  for (std::size_t length : {std::size_t(1), std::size_t(37), std::size_t(1) << 20})
+  {
+    for (std::size_t count : {0, 1, 7, 8, 17, 64, 100, 1000, 100000})
+    {
+      std::vector<uint32_t> positions(count);
+      for (uint32_t &position : positions)
+        position = static_cast<uint32_t>(rng() % (length * 32));
+      if (count > 2)
+        positions[1] = positions[0]; // duplicates must toggle twice
+
+      std::vector<uint32_t> start = randomWords(length, rng);
+      std::vector<uint32_t> batch = start, expected = start;
+
+      bitwise::setBits(batch.data(), positions.data(), count);
+      for (uint32_t p : positions)
+        expected[p / 32] = bitwise::setBit(expected[p / 32], p % 32);
+      assert(batch == expected);
+
+      bitwise::toggleBits(batch.data(), positions.data(), count);
+      for (uint32_t p : positions)
+        expected[p / 32] = bitwise::toggleBit(expected[p / 32], p % 32);
+      assert(batch == expected);
+
+      batch = expected = start;
+      bitwise::clearBits(batch.data(), positions.data(), count);
+      for (uint32_t p : positions)
+        expected[p / 32] = bitwise::clearBit(expected[p / 32], p % 32);
+      assert(batch == expected);
+
+      // The mask word past the end is a canary for stray writes
+      std::vector<uint64_t> mask((count + 63) / 64 + 1, ~0ULL);
+      bitwise::testBits(mask.data(), start.data(), positions.data(), count);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        bool bit = (mask[i / 64] >> (i % 64)) & 1;
+        assert(bit == bitwise::isBitSet(start[positions[i] / 32], positions[i] % 32));
+      }
+      if (count % 64 != 0)
+        assert((mask[count / 64] >> (count % 64)) == 0);
+      assert(mask.back() == ~0ULL);
+    }
+  }
+  std::cout << "✓ Batched bit operations match the single-bit functions at " << bitwise::simdLevelName(level)
+            << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running bulk kernel tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  bitwise::SimdLevel best = bitwise::detectSimdLevel();
+  std::cout << "Detected SIMD level: " << bitwise::simdLevelName(best) << std::endl;
+  for (int level = 0; level <= static_cast<int>(best); ++level)
+  {
+    bitwise::SimdLevel selected = bitwise::setSimdLevel(static_cast<bitwise::SimdLevel>(level));
+    assert(selected == static_cast<bitwise::SimdLevel>(level));
+    testBinaryKernels(selected);
+    testCountSetBits(selected);
+    testInPlace();
+    testNoOverrun();
+    testBitBatches(selected);
+    testMultiWordShifts(selected);
+  }
+  bitwise::setSimdLevel(best);
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
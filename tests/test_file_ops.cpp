@@ -0,0 +1,185 @@
+#include "../include/file_ops.h"
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+  // A page-sized window and a size that spans several windows plus a ragged tail
+  const std::size_t kChunk = 4096;
+  const std::size_t kSize = 3 * 4096 + 123;
+
+  std::string tempPath(const char *name)
+  {
+    const char *dir = std::getenv("TMPDIR");
+    return std::string(dir ? dir : "/tmp") + "/bitwise_file_ops_" + std::to_string(getpid()) + "_" + name;
+  }
+
+  void writeFile(const std::string &path, const std::vector<uint8_t> &bytes)
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  }
+
+  std::vector<uint8_t> readFile(const std::string &path)
+  {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  std::vector<uint8_t> randomBytes(std::size_t size, uint32_t seed)
+  {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> bytes(size);
+    for (uint8_t &b : bytes)
+      b = static_cast<uint8_t>(rng());
+    return bytes;
+  }
+
+  // Bit-at-a-time reference: bit i of the output is bit i - bits (left) or i + bits (right) of the input
+  std::vector<uint8_t> referenceShift(const std::vector<uint8_t> &in, uint64_t bits, bool left)
+  {
+    std::vector<uint8_t> out(in.size(), 0);
+    uint64_t total = in.size() * 8;
+    for (uint64_t i = 0; i < total; ++i)
+    {
+      uint64_t source;
+      if (left)
+      {
+        if (i < bits)
+          continue;
+        source = i - bits;
+      }
+      else
+      {
+        if (bits >= total - i)
+          continue;
+        source = i + bits;
+      }
+      if ((in[source / 8] >> (source % 8)) & 1)
+        out[i / 8] |= static_cast<uint8_t>(1U << (i % 8));
+    }
+    return out;
+  }
+} // namespace
+
+void testCombineAndInvert()
+{
+  std::cout << "Testing file AND/OR/XOR/NOT..." << std::endl;
+
+  std::vector<uint8_t> a = randomBytes(kSize, 1);
+  std::vector<uint8_t> b = randomBytes(kSize, 2);
+  std::string pathA = tempPath("a"), pathB = tempPath("b"), pathOut = tempPath("out");
+  writeFile(pathA, a);
+  writeFile(pathB, b);
+
+  std::string error;
+  const bitwise::FileOp ops[] = {bitwise::FileOp::And, bitwise::FileOp::Or, bitwise::FileOp::Xor};
+  for (bitwise::FileOp op : ops)
+  {
+    assert(bitwise::combineFiles(op, pathA.c_str(), pathB.c_str(), pathOut.c_str(), error, kChunk));
+    std::vector<uint8_t> out = readFile(pathOut);
+    assert(out.size() == kSize);
+    for (std::size_t i = 0; i < kSize; ++i)
+    {
+      uint8_t expected = op == bitwise::FileOp::And ? (a[i] & b[i]) : op == bitwise::FileOp::Or ? (a[i] | b[i]) : (a[i] ^ b[i]);
+      assert(out[i] == expected);
+    }
+  }
+
+  // The default (large) window gives the same result as small ones
+  assert(bitwise::invertFile(pathA.c_str(), pathOut.c_str(), error));
+  std::vector<uint8_t> inverted = readFile(pathOut);
+  assert(inverted.size() == kSize);
+  for (std::size_t i = 0; i < kSize; ++i)
+    assert(inverted[i] == static_cast<uint8_t>(~a[i]));
+
+  unlink(pathA.c_str());
+  unlink(pathB.c_str());
+  unlink(pathOut.c_str());
+  std::cout << "✓ File AND/OR/XOR/NOT tests passed" << std::endl;
+}
+
+void testShift()
+{
+  std::cout << "Testing file shifts..." << std::endl;
+
+  std::vector<uint8_t> in = randomBytes(kSize, 3);
+  std::string pathIn = tempPath("shift_in"), pathOut = tempPath("shift_out");
+  writeFile(pathIn, in);
+
+  const uint64_t distances[] = {0, 1, 3, 7, 8, 9, 63, 64, 65, 4096 * 8 - 5, 4096 * 8 + 3, 2 * 4096 * 8 + 17,
+                                kSize * 8 - 1, kSize * 8, kSize * 8 + 100};
+  std::string error;
+  for (uint64_t bits : distances)
+  {
+    for (bool left : {true, false})
+    {
+      assert(bitwise::shiftFile(pathIn.c_str(), pathOut.c_str(), bits, left, error, kChunk));
+      assert(readFile(pathOut) == referenceShift(in, bits, left));
+    }
+  }
+
+  unlink(pathIn.c_str());
+  unlink(pathOut.c_str());
+  std::cout << "✓ File shift tests passed" << std::endl;
+}
+
+void testErrors()
+{
+  std::cout << "Testing file operation errors..." << std::endl;
+
+  std::string pathA = tempPath("err_a"), pathB = tempPath("err_b"), pathOut = tempPath("err_out");
+  writeFile(pathA, randomBytes(100, 4));
+  writeFile(pathB, randomBytes(101, 5));
+
+  std::string error;
+  assert(!bitwise::combineFiles(bitwise::FileOp::Xor, pathA.c_str(), pathB.c_str(), pathOut.c_str(), error));
+  assert(error.find("differ in size") != std::string::npos);
+
+  error.clear();
+  assert(!bitwise::invertFile(tempPath("missing").c_str(), pathOut.c_str(), error));
+  assert(error.find("cannot open") != std::string::npos);
+
+  // Writing over an input would truncate it before it is read
+  error.clear();
+  assert(!bitwise::invertFile(pathA.c_str(), pathA.c_str(), error));
+  assert(error.find("must not be one of the inputs") != std::string::npos);
+  assert(readFile(pathA).size() == 100);
+
+  // Empty inputs give an empty output
+  writeFile(pathB, {});
+  assert(bitwise::shiftFile(pathB.c_str(), pathOut.c_str(), 5, true, error));
+  assert(readFile(pathOut).empty());
+
+  unlink(pathA.c_str());
+  unlink(pathB.c_str());
+  unlink(pathOut.c_str());
+  std::cout << "✓ File operation error tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running file operation tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testCombineAndInvert();
+  testShift();
+  testErrors();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
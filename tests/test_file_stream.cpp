@@ -0,0 +1,290 @@
+#include "../include/file_ops.h"
+#include "../include/io_queue.h"
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+  // Several 4 KiB chunks plus a ragged tail, so reads and writes hit the aligned tail and truncation
+  const std::size_t kSize = 5 * 4096 + 123;
+
+  std::string tempPath(const char *name)
+  {
+    const char *dir = std::getenv("TMPDIR");
+    return std::string(dir ? dir : "/tmp") + "/bitwise_file_stream_" + std::to_string(getpid()) + "_" + name;
+  }
+
+  void writeFile(const std::string &path, const std::vector<uint8_t> &bytes)
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  }
+
+  std::vector<uint8_t> readFile(const std::string &path)
+  {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  std::vector<uint8_t> randomBytes(std::size_t size, uint32_t seed)
+  {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> bytes(size);
+    for (uint8_t &b : bytes)
+      b = static_cast<uint8_t>(rng());
+    return bytes;
+  }
+
+  // Every backend this kernel supports, each with and without O_DIRECT, using small chunks and a
+  // shallow queue so slots are reused many times
+  std::vector<bitwise::StreamOptions> allOptions()
+  {
+    std::vector<bitwise::StreamOptions> result;
+    std::vector<bitwise::IoBackend> backends = {bitwise::IoBackend::Threads};
+    if (bitwise::ioUringAvailable())
+      backends.push_back(bitwise::IoBackend::IoUring);
+    for (bitwise::IoBackend backend : backends)
+    {
+      for (bool direct : {false, true})
+      {
+        bitwise::StreamOptions options;
+        options.chunkBytes = 4096;
+        options.depth = 3;
+        options.direct = direct;
+        options.backend = backend;
+        result.push_back(options);
+      }
+    }
+    return result;
+  }
+} // namespace
+
+void testIoQueue()
+{
+  std::cout << "Testing IoQueue..." << std::endl;
+
+  std::string path = tempPath("queue");
+  std::vector<uint8_t> data = randomBytes(3 * 4096, 1);
+  writeFile(path, data);
+  int fd = open(path.c_str(), O_RDWR);
+  assert(fd >= 0);
+
+  for (const bitwise::StreamOptions &options : allOptions())
+  {
+    if (options.direct)
+      continue;
+    std::string error;
+    std::unique_ptr<bitwise::IoQueue> queue = bitwise::IoQueue::create(options.backend, 4, error);
+    assert(queue);
+    assert(queue->backend() == options.backend);
+
+    // Three reads in flight at once, completing in any order
+    std::vector<uint8_t> buffers(3 * 4096);
+    for (uint64_t i = 0; i < 3; ++i)
+      queue->read(fd, buffers.data() + i * 4096, 4096, i * 4096, 10 + i);
+    unsigned seen = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+      bitwise::IoCompletion completion;
+      assert(queue->wait(completion, error));
+      assert(completion.tag >= 10 && completion.tag < 13);
+      assert(completion.result == 4096);
+      seen |= 1U << (completion.tag - 10);
+    }
+    assert(seen == 7);
+    assert(buffers == data);
+
+    // Writes, short reads at the end of the file and errors come back through the completion
+    const uint8_t patch[4] = {1, 2, 3, 4};
+    queue->write(fd, patch, sizeof(patch), 100, 1);
+    bitwise::IoCompletion completion;
+    assert(queue->wait(completion, error));
+    assert(completion.tag == 1 && completion.result == 4);
+    std::copy(patch, patch + sizeof(patch), data.begin() + 100);
+    queue->read(fd, buffers.data(), 4096, 2 * 4096 + 100, 2);
+    assert(queue->wait(completion, error));
+    assert(completion.tag == 2 && completion.result == 4096 - 100);
+    queue->read(-1, buffers.data(), 16, 0, 3);
+    assert(queue->wait(completion, error));
+    assert(completion.tag == 3 && completion.result < 0);
+
+    // Nothing left to wait for
+    assert(!queue->wait(completion, error));
+    assert(!error.empty());
+
+    // A read that returns part of the request is continued until the rest arrives (pipes need io_uring,
+    // since pread does not work on them)
+    if (options.backend == bitwise::IoBackend::IoUring)
+    {
+      int fds[2];
+      assert(pipe(fds) == 0);
+      assert(::write(fds[1], data.data(), 100) == 100);
+      queue->read(fds[0], buffers.data(), 300, 0, 4);
+      std::thread writer([&]
+                         {
+                           usleep(20000);
+                           assert(::write(fds[1], data.data() + 100, 200) == 200); });
+      assert(queue->wait(completion, error));
+      writer.join();
+      assert(completion.tag == 4 && completion.result == 300);
+      assert(std::equal(data.begin(), data.begin() + 300, buffers.begin()));
+
+      // End of input before the full length comes back short
+      queue->read(fds[0], buffers.data(), 300, 0, 5);
+      assert(::write(fds[1], data.data(), 50) == 50);
+      close(fds[1]);
+      assert(queue->wait(completion, error));
+      assert(completion.tag == 5 && completion.result == 50);
+      close(fds[0]);
+    }
+  }
+
+  close(fd);
+  unlink(path.c_str());
+  std::cout << "✓ IoQueue tests passed" << std::endl;
+}
+
+void testStreamMatchesMapped()
+{
+  std::cout << "Testing streamed AND/OR/XOR/NOT/popcount against mmap..." << std::endl;
+
+  std::vector<uint8_t> a = randomBytes(kSize, 2);
+  std::vector<uint8_t> b = randomBytes(kSize, 3);
+  std::string pathA = tempPath("a"), pathB = tempPath("b"), pathOut = tempPath("out"), pathRef = tempPath("ref");
+  writeFile(pathA, a);
+  writeFile(pathB, b);
+
+  uint64_t expectedCount = 0;
+  for (uint8_t byte : a)
+    expectedCount += static_cast<uint64_t>(__builtin_popcount(byte));
+
+  std::string error;
+  const bitwise::FileOp ops[] = {bitwise::FileOp::And, bitwise::FileOp::Or, bitwise::FileOp::Xor};
+  for (const bitwise::StreamOptions &options : allOptions())
+  {
+    for (bitwise::FileOp op : ops)
+    {
+      assert(bitwise::combineFiles(op, pathA.c_str(), pathB.c_str(), pathRef.c_str(), error));
+      assert(bitwise::streamCombineFiles(op, pathA.c_str(), pathB.c_str(), pathOut.c_str(), error, options));
+      assert(readFile(pathOut).size() == kSize);
+      assert(readFile(pathOut) == readFile(pathRef));
+    }
+
+    assert(bitwise::invertFile(pathA.c_str(), pathRef.c_str(), error));
+    assert(bitwise::streamInvertFile(pathA.c_str(), pathOut.c_str(), error, options));
+    assert(readFile(pathOut) == readFile(pathRef));
+
+    uint64_t count = 0;
+    assert(bitwise::streamCountSetBits(pathA.c_str(), count, error, options));
+    assert(count == expectedCount);
+  }
+
+  // The default options (1 MiB chunks, auto backend) on a file smaller than one chunk
+  assert(bitwise::streamInvertFile(pathA.c_str(), pathOut.c_str(), error));
+  assert(readFile(pathOut) == readFile(pathRef));
+
+  unlink(pathA.c_str());
+  unlink(pathB.c_str());
+  unlink(pathOut.c_str());
+  unlink(pathRef.c_str());
+  std::cout << "✓ Streamed AND/OR/XOR/NOT/popcount tests passed" << std::endl;
+}
+
+void testStreamShift()
+{
+  std::cout << "Testing streamed shifts against mmap..." << std::endl;
+
+  std::vector<uint8_t> in = randomBytes(kSize, 4);
+  std::string pathIn = tempPath("shift_in"), pathOut = tempPath("shift_out"), pathRef = tempPath("shift_ref");
+  writeFile(pathIn, in);
+
+  // Distances inside a chunk, across chunk and alignment boundaries, and past the end
+  const uint64_t distances[] = {0, 1, 7, 8, 13, 4096 * 8 - 5, 4096 * 8 + 3, 2 * 4096 * 8 + 17, kSize * 8 - 1,
+                                kSize * 8, kSize * 8 + 100};
+  std::string error;
+  for (const bitwise::StreamOptions &options : allOptions())
+  {
+    for (uint64_t bits : distances)
+    {
+      for (bool left : {true, false})
+      {
+        assert(bitwise::shiftFile(pathIn.c_str(), pathRef.c_str(), bits, left, error));
+        assert(bitwise::streamShiftFile(pathIn.c_str(), pathOut.c_str(), bits, left, error, options));
+        assert(readFile(pathOut) == readFile(pathRef));
+      }
+    }
+  }
+
+  unlink(pathIn.c_str());
+  unlink(pathOut.c_str());
+  unlink(pathRef.c_str());
+  std::cout << "✓ Streamed shift tests passed" << std::endl;
+}
+
+void testStreamErrors()
+{
+  std::cout << "Testing streamed operation errors..." << std::endl;
+
+  std::string pathA = tempPath("err_a"), pathB = tempPath("err_b"), pathOut = tempPath("err_out");
+  writeFile(pathA, randomBytes(100, 5));
+  writeFile(pathB, randomBytes(101, 6));
+
+  std::string error;
+  assert(!bitwise::streamCombineFiles(bitwise::FileOp::Xor, pathA.c_str(), pathB.c_str(), pathOut.c_str(), error));
+  assert(error.find("differ in size") != std::string::npos);
+
+  error.clear();
+  uint64_t count = 0;
+  assert(!bitwise::streamCountSetBits(tempPath("missing").c_str(), count, error));
+  assert(error.find("cannot open") != std::string::npos);
+
+  error.clear();
+  assert(!bitwise::streamInvertFile(pathA.c_str(), pathA.c_str(), error));
+  assert(error.find("must not be one of the inputs") != std::string::npos);
+  assert(readFile(pathA).size() == 100);
+
+  // Empty inputs give an empty output and no set bits
+  writeFile(pathB, {});
+  assert(bitwise::streamShiftFile(pathB.c_str(), pathOut.c_str(), 5, true, error));
+  assert(readFile(pathOut).empty());
+  assert(bitwise::streamInvertFile(pathB.c_str(), pathOut.c_str(), error));
+  assert(readFile(pathOut).empty());
+  assert(bitwise::streamCountSetBits(pathB.c_str(), count, error));
+  assert(count == 0);
+
+  unlink(pathA.c_str());
+  unlink(pathB.c_str());
+  unlink(pathOut.c_str());
+  std::cout << "✓ Streamed operation error tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running streamed file operation tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testIoQueue();
+  testStreamMatchesMapped();
+  testStreamShift();
+  testStreamErrors();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
@@ -0,0 +1,185 @@
+#include "../include/morton.h"
+#include "../include/bitwise_generic.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <vector>
+
+namespace g = bitwise::generic;
+
+static_assert(g::grayEncode<uint8_t>(0) == 0 && g::grayEncode<uint8_t>(1) == 1 && g::grayEncode<uint8_t>(2) == 3, "gray");
+static_assert(g::grayEncode<uint8_t>(3) == 2 && g::grayEncode<uint32_t>(0x80000000U) == 0xC0000000U, "gray");
+static_assert(g::grayDecode<uint16_t>(g::grayEncode<uint16_t>(0xBEEF)) == 0xBEEF, "gray round trip");
+static_assert(g::grayDecode<uint64_t>(~0ULL) == 0xAAAAAAAAAAAAAAAAULL, "gray prefix xor");
+
+// Reference interleave, one bit at a time: coordinate c's bit i lands on code bit dims * i + c
+template <typename Code>
+Code referenceEncode(const uint32_t *coordinates, unsigned dims, unsigned bitsEach)
+{
+  Code code = 0;
+  for (unsigned i = 0; i < bitsEach; ++i)
+  {
+    for (unsigned c = 0; c < dims; ++c)
+    {
+      if ((coordinates[c] >> i) & 1)
+        code |= Code(1) << (dims * i + c);
+    }
+  }
+  return code;
+}
+
+void testSingleValues()
+{
+  std::cout << "Testing single-value Morton codes..." << std::endl;
+
+  assert(bitwise::mortonEncode2D32(0xFFFF, 0) == 0x55555555U);
+  assert(bitwise::mortonEncode2D32(0, 0xFFFF) == 0xAAAAAAAAU);
+  assert(bitwise::mortonEncode2D32(0x10000, 0x10000) == 0); // bits above 16 are ignored
+  assert(bitwise::mortonEncode2D32(3, 5) == 0x27);
+  assert(bitwise::mortonEncode2D64(0xFFFFFFFFU, 0xFFFFFFFFU) == ~0ULL);
+  assert(bitwise::mortonEncode3D32(1, 1, 1) == 7 && bitwise::mortonEncode3D32(0x3FF, 0, 0) == 0x09249249U);
+  assert(bitwise::mortonEncode3D64(0, 0, 0x1FFFFF) == 0x4924924924924924ULL);
+
+  std::mt19937 rng(21);
+  for (int trial = 0; trial < 20000; ++trial)
+  {
+    uint32_t c[3] = {static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng())};
+    uint32_t x, y, z;
+
+    uint32_t code32 = bitwise::mortonEncode2D32(c[0], c[1]);
+    assert(code32 == referenceEncode<uint32_t>(c, 2, 16));
+    bitwise::mortonDecode2D32(code32, x, y);
+    assert(x == (c[0] & 0xFFFF) && y == (c[1] & 0xFFFF));
+
+    uint64_t code64 = bitwise::mortonEncode2D64(c[0], c[1]);
+    assert(code64 == referenceEncode<uint64_t>(c, 2, 32));
+    bitwise::mortonDecode2D64(code64, x, y);
+    assert(x == c[0] && y == c[1]);
+
+    code32 = bitwise::mortonEncode3D32(c[0], c[1], c[2]);
+    assert(code32 == referenceEncode<uint32_t>(c, 3, 10));
+    bitwise::mortonDecode3D32(code32 | 0xC0000000U, x, y, z); // bits past the layout are ignored
+    assert(x == (c[0] & 0x3FF) && y == (c[1] & 0x3FF) && z == (c[2] & 0x3FF));
+
+    code64 = bitwise::mortonEncode3D64(c[0], c[1], c[2]);
+    assert(code64 == referenceEncode<uint64_t>(c, 3, 21));
+    bitwise::mortonDecode3D64(code64 | (1ULL << 63), x, y, z);
+    assert(x == (c[0] & 0x1FFFFF) && y == (c[1] & 0x1FFFFF) && z == (c[2] & 0x1FFFFF));
+  }
+  std::cout << "✓ Single-value Morton codes match the bit-by-bit reference" << std::endl;
+}
+
+void testBulkMorton(bitwise::SimdLevel level)
+{
+  std::mt19937 rng(22);
+  // Counts around the 4- and 8-lane batches, so every kernel also runs its scalar tail
+  for (std::size_t count : {0, 1, 3, 4, 7, 8, 9, 31, 1000})
+  {
+    std::vector<uint32_t> x(count), y(count), z(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      x[i] = static_cast<uint32_t>(rng());
+      y[i] = static_cast<uint32_t>(rng());
+      z[i] = static_cast<uint32_t>(rng());
+    }
+    std::vector<uint32_t> codes32(count), dx(count), dy(count), dz(count);
+    std::vector<uint64_t> codes64(count);
+
+    bitwise::mortonEncode2D32(codes32.data(), x.data(), y.data(), count);
+    bitwise::mortonDecode2D32(dx.data(), dy.data(), codes32.data(), count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      assert(codes32[i] == bitwise::mortonEncode2D32(x[i], y[i]));
+      assert(dx[i] == (x[i] & 0xFFFF) && dy[i] == (y[i] & 0xFFFF));
+    }
+
+    bitwise::mortonEncode2D64(codes64.data(), x.data(), y.data(), count);
+    bitwise::mortonDecode2D64(dx.data(), dy.data(), codes64.data(), count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      assert(codes64[i] == bitwise::mortonEncode2D64(x[i], y[i]));
+      assert(dx[i] == x[i] && dy[i] == y[i]);
+    }
+
+    bitwise::mortonEncode3D32(codes32.data(), x.data(), y.data(), z.data(), count);
+    bitwise::mortonDecode3D32(dx.data(), dy.data(), dz.data(), codes32.data(), count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      assert(codes32[i] == bitwise::mortonEncode3D32(x[i], y[i], z[i]));
+      assert(dx[i] == (x[i] & 0x3FF) && dy[i] == (y[i] & 0x3FF) && dz[i] == (z[i] & 0x3FF));
+    }
+
+    bitwise::mortonEncode3D64(codes64.data(), x.data(), y.data(), z.data(), count);
+    bitwise::mortonDecode3D64(dx.data(), dy.data(), dz.data(), codes64.data(), count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      assert(codes64[i] == bitwise::mortonEncode3D64(x[i], y[i], z[i]));
+      assert(dx[i] == (x[i] & 0x1FFFFF) && dy[i] == (y[i] & 0x1FFFFF) && dz[i] == (z[i] & 0x1FFFFF));
+    }
+  }
+  std::cout << "✓ Bulk Morton codes match the single-value functions at " << bitwise::simdLevelName(level)
+            << std::endl;
+}
+
+void testBulkGray(bitwise::SimdLevel level)
+{
+  std::mt19937_64 rng(23);
+  for (std::size_t count : {0, 1, 3, 4, 7, 8, 9, 1000})
+  {
+    std::vector<uint32_t> words(count), gray32(count);
+    std::vector<uint64_t> wide(count), gray64(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      wide[i] = rng();
+      words[i] = static_cast<uint32_t>(wide[i] >> 7);
+    }
+
+    bitwise::grayEncode(gray32.data(), words.data(), count);
+    bitwise::grayEncode(gray64.data(), wide.data(), count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      assert(gray32[i] == g::grayEncode(words[i]));
+      assert(gray64[i] == g::grayEncode(wide[i]));
+    }
+
+    // Decoding in place restores the input
+    bitwise::grayDecode(gray32.data(), gray32.data(), count);
+    bitwise::grayDecode(gray64.data(), gray64.data(), count);
+    assert(gray32 == words);
+    assert(gray64 == wide);
+  }
+
+  // Consecutive values differ in exactly one bit of their codes
+  std::vector<uint32_t> counting(4096), codes(4096);
+  for (uint32_t i = 0; i < counting.size(); ++i)
+    counting[i] = i;
+  bitwise::grayEncode(codes.data(), counting.data(), counting.size());
+  for (std::size_t i = 1; i < codes.size(); ++i)
+    assert(g::countSetBits(codes[i] ^ codes[i - 1]) == 1);
+  std::cout << "✓ Bulk Gray codes match the generic functions at " << bitwise::simdLevelName(level) << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running Morton and Gray code tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testSingleValues();
+  bitwise::SimdLevel best = bitwise::detectSimdLevel();
+  for (int level = 0; level <= static_cast<int>(best); ++level)
+  {
+    bitwise::SimdLevel selected = bitwise::setSimdLevel(static_cast<bitwise::SimdLevel>(level));
+    testBulkMorton(selected);
+    testBulkGray(selected);
+  }
+  bitwise::setSimdLevel(best);
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
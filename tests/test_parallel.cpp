@@ -0,0 +1,158 @@
+#include "../include/bitwise_bulk.h"
+#include "../include/bitwise_parallel.h"
+#include "../include/thread_pool.h"
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Lengths below the parallel threshold, exact multiples of the grain and ragged ones
+static const std::size_t kLengths[] = {0, 1, 1000, 4 * bitwise::kParallelGrainWords,
+                                       7 * bitwise::kParallelGrainWords + 123};
+
+std::vector<uint32_t> randomWords(std::size_t length, std::mt19937 &rng)
+{
+  std::vector<uint32_t> words(length);
+  for (uint32_t &word : words)
+  {
+    word = rng();
+  }
+  return words;
+}
+
+void testThreadPool()
+{
+  std::cout << "Testing work-stealing thread pool..." << std::endl;
+
+  for (unsigned threads : {1U, 2U, 4U, 7U})
+  {
+    bitwise::ThreadPool pool(threads);
+    assert(pool.threadCount() == threads);
+
+    // Every task runs exactly once, including with uneven task costs that force stealing
+    for (std::size_t tasks : {0, 1, 3, 100, 1000})
+    {
+      std::vector<std::atomic<int>> runs(tasks);
+      pool.parallelFor(tasks, [&](std::size_t task)
+                       {
+        if (task % 17 == 0)
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+        runs[task].fetch_add(1); });
+      for (std::atomic<int> &count : runs)
+        assert(count.load() == 1);
+    }
+  }
+
+  // Several callers can share one pool
+  bitwise::ThreadPool shared(3);
+  std::atomic<std::size_t> total{0};
+  std::vector<std::thread> callers;
+  for (int c = 0; c < 3; ++c)
+  {
+    callers.emplace_back([&]
+                         { shared.parallelFor(500, [&](std::size_t)
+                                              { total.fetch_add(1); }); });
+  }
+  for (std::thread &caller : callers)
+    caller.join();
+  assert(total.load() == 1500);
+
+  std::cout << "✓ Thread pool tests passed" << std::endl;
+}
+
+void testParallelKernels()
+{
+  std::cout << "Testing parallel kernels..." << std::endl;
+
+  std::mt19937 rng(2024);
+  for (unsigned threads : {1U, 3U, 4U})
+  {
+    bitwise::ThreadPool pool(threads);
+    for (std::size_t length : kLengths)
+    {
+      std::vector<uint32_t> a = randomWords(length, rng);
+      std::vector<uint32_t> b = randomWords(length, rng);
+      std::vector<uint32_t> expected(length), actual(length);
+
+      bitwise::bitwiseAnd(expected.data(), a.data(), b.data(), length);
+      bitwise::parallelAnd(actual.data(), a.data(), b.data(), length, pool);
+      assert(actual == expected);
+
+      bitwise::bitwiseOr(expected.data(), a.data(), b.data(), length);
+      bitwise::parallelOr(actual.data(), a.data(), b.data(), length, pool);
+      assert(actual == expected);
+
+      bitwise::bitwiseXor(expected.data(), a.data(), b.data(), length);
+      bitwise::parallelXor(actual.data(), a.data(), b.data(), length, pool);
+      assert(actual == expected);
+
+      bitwise::bitwiseNot(expected.data(), a.data(), length);
+      bitwise::parallelNot(actual.data(), a.data(), length, pool);
+      assert(actual == expected);
+
+      assert(bitwise::parallelCountSetBits(a.data(), length, pool) == bitwise::countSetBits(a.data(), length));
+
+      // Shifts that cross task boundaries, by less than a word, whole words and more than a task
+      for (std::size_t bits : {std::size_t(0), std::size_t(13), std::size_t(64),
+                               bitwise::kParallelGrainWords * 32 + 5, length * 32})
+      {
+        bitwise::leftShift(expected.data(), a.data(), length, bits);
+        bitwise::parallelLeftShift(actual.data(), a.data(), length, bits, pool);
+        assert(actual == expected);
+        bitwise::rightShift(expected.data(), a.data(), length, bits);
+        bitwise::parallelRightShift(actual.data(), a.data(), length, bits, pool);
+        assert(actual == expected);
+      }
+    }
+  }
+  std::cout << "✓ Parallel kernels match the single-threaded ones" << std::endl;
+}
+
+void testParallelBuffer()
+{
+  std::cout << "Testing ParallelBuffer..." << std::endl;
+
+  bitwise::setParallelThreads(3);
+  assert(bitwise::defaultThreadPool().threadCount() == 3);
+
+  bitwise::ParallelBuffer buffer(5 * bitwise::kParallelGrainWords + 7);
+  assert(buffer.size() == 5 * bitwise::kParallelGrainWords + 7);
+  for (std::size_t i = 0; i < buffer.size(); ++i)
+    assert(buffer[i] == 0);
+
+  // Default-pool overloads work on first-touched buffers
+  bitwise::ParallelBuffer other(buffer.size());
+  bitwise::parallelNot(other.data(), buffer.data(), buffer.size());
+  assert(bitwise::parallelCountSetBits(other.data(), other.size()) == other.size() * 32);
+
+  bitwise::ParallelBuffer moved(std::move(other));
+  assert(other.data() == nullptr && other.size() == 0);
+  assert(moved[moved.size() - 1] == 0xFFFFFFFF);
+
+  bitwise::ParallelBuffer empty(0);
+  assert(empty.size() == 0);
+
+  bitwise::setParallelThreads(0);
+  std::cout << "✓ ParallelBuffer tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running parallel engine tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testThreadPool();
+  testParallelKernels();
+  testParallelBuffer();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
@@ -0,0 +1,180 @@
+#include "../include/bitwise_utils.h"
+#include "../include/render_sink.h"
+#include <iostream>
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+// Counts writes so the tests can check each visualization is a single write
+class CountingSink : public bitwise::RenderSink
+{
+public:
+  void write(const char *data, std::size_t length) override
+  {
+    ++writes;
+    text.append(data, length);
+  }
+
+  int writes = 0;
+  std::string text;
+};
+
+void testBitwiseOperationRender()
+{
+  std::cout << "Testing displayBitwiseOperation rendering..." << std::endl;
+
+  CountingSink sink;
+  bitwise::displayBitwiseOperation(sink, 170, 204, "AND", 136);
+  assert(sink.writes == 1);
+  assert(sink.text ==
+         "\n<== Bitwise AND Operation ==>\n"
+         "Decimal: 170 AND 204 = 136\n"
+         "Hex:     0xAA AND 0xCC = 0x88\n"
+         "\n"
+         "Bit-by-bit comparison:\n"
+         " 0000 0000 0000 0000 0000 0000 1010 1010 (A)\n"
+         " 0000 0000 0000 0000 0000 0000 1100 1100 (B)\n"
+         "--------------------------------------------\n"
+         " 0000 0000 0000 0000 0000 0000 1000 1000 (Result)\n");
+
+  std::cout << "✓ displayBitwiseOperation rendering tests passed" << std::endl;
+}
+
+void testNotAndShiftRender()
+{
+  std::cout << "Testing NOT/shift rendering..." << std::endl;
+
+  CountingSink sink;
+  bitwise::displayBitwiseNotOperation(sink, 0, 0xFFFFFFFF);
+  assert(sink.writes == 1);
+  assert(sink.text ==
+         "\n<== Bitwise NOT Operation ==>\n"
+         "Decimal: ~0 = 4294967295\n"
+         "Hex:     ~0x0 = 0xFFFFFFFF\n"
+         "\n"
+         "Bit-by-bit comparison:\n"
+         " 0000 0000 0000 0000 0000 0000 0000 0000 (A)\n"
+         "--------------------------------------------\n"
+         " 1111 1111 1111 1111 1111 1111 1111 1111 (~A)\n");
+
+  sink.text.clear();
+  bitwise::displayShiftOperation(sink, 1, 2, 4, "LEFT");
+  assert(sink.writes == 2);
+  assert(sink.text ==
+         "\n<== LEFT Shift Operation ==>\n"
+         "Decimal: 1 << 2 = 4\n"
+         "Hex:     0x1 << 2 = 0x4\n"
+         "\n"
+         "Shift visualization:\n"
+         " 0000 0000 0000 0000 0000 0000 0000 0001 (Original)\n"
+         "    ←- shifted left by 2 positions\n"
+         " 0000 0000 0000 0000 0000 0000 0000 0100 (Result)\n");
+
+  sink.text.clear();
+  bitwise::displayShiftOperation(sink, 8, 3, 1, "RIGHT");
+  assert(sink.text.find("Decimal: 8 >> 3 = 1\n") != std::string::npos);
+  assert(sink.text.find("      -→ shifted right by 3 positions\n") != std::string::npos);
+
+  std::cout << "✓ NOT/shift rendering tests passed" << std::endl;
+}
+
+void testBaseTableRender()
+{
+  std::cout << "Testing base table rendering..." << std::endl;
+
+  CountingSink sink;
+  bitwise::displayBaseTable(sink, 8, 2);
+  assert(sink.writes == 1);
+  assert(sink.text ==
+         "\n<== Base2 Table ==> \n"
+         "256|128| 64| 32| 16|  8|  4|  2|  1|\n"
+         "2^8|2^7|2^6|2^5|2^4|2^3|2^2|2^1|2^0|\n");
+
+  // Columns are as wide as the widest value or label, even when a label is the widest
+  CountingSink small;
+  bitwise::displayBaseTable(small, 2, -3);
+  assert(small.text ==
+         "\n<== Base-3 Table ==> \n"
+         "   9|  -3|   1|\n"
+         "-3^2|-3^1|-3^0|\n");
+
+  // A shorter table reuses the cached columns; a longer one keeps going past 64 bits
+  CountingSink shorter;
+  bitwise::displayBaseTable(shorter, 1, 2);
+  assert(shorter.text == "\n<== Base2 Table ==> \n  2|  1|\n2^1|2^0|\n");
+  CountingSink wide;
+  bitwise::displayBaseTable(wide, 100, 16);
+  assert(wide.text.find(" 1152921504606846976|") != std::string::npos);
+  assert(wide.text.find(" 18446744073709551616|") != std::string::npos);
+  assert(wide.text.find("16^100|") != std::string::npos);
+  CountingSink decimal;
+  bitwise::displayBaseTable(decimal, 40, -10);
+  assert(decimal.text.find("|-1000000000000000000000000000000000000000|") != std::string::npos);
+  assert(decimal.text.find("10000000000000000000000000000000000000000|") == 24);
+
+  // Tables past the cached length are computed per call, and a full cache of bases is dropped
+  CountingSink longTable;
+  bitwise::displayBaseTable(longTable, 300, 2);
+  assert(longTable.text.find("2^299|") != std::string::npos);
+  for (int basis = 3; basis < 80; ++basis)
+  {
+    CountingSink scan;
+    bitwise::displayBaseTable(scan, 2, basis);
+  }
+  CountingSink again;
+  bitwise::displayBaseTable(again, 8, 2);
+  assert(again.text == sink.text);
+  std::cout << "✓ base table rendering tests passed" << std::endl;
+}
+
+void testSinks()
+{
+  std::cout << "Testing sinks..." << std::endl;
+
+  bitwise::BufferSink buffer;
+  bitwise::displayBitwiseOperation(buffer, 1, 3, "OR", 3);
+  bitwise::displayBitwiseOperation(buffer, 1, 3, "OR", 3);
+  std::string single = buffer.str().substr(0, buffer.str().size() / 2);
+  assert(buffer.str() == single + single);
+
+  std::ostringstream stream;
+  bitwise::OstreamSink ostreamSink(stream);
+  bitwise::displayBitwiseOperation(ostreamSink, 1, 3, "OR", 3);
+  assert(stream.str() == single);
+
+  int fds[2];
+  assert(pipe(fds) == 0);
+  bitwise::FdSink fdSink(fds[1]);
+  bitwise::displayBitwiseOperation(fdSink, 1, 3, "OR", 3);
+  close(fds[1]);
+  std::string piped;
+  char chunk[256];
+  ssize_t n;
+  while ((n = read(fds[0], chunk, sizeof(chunk))) > 0)
+    piped.append(chunk, static_cast<std::size_t>(n));
+  close(fds[0]);
+  assert(piped == single);
+
+  std::cout << "✓ Sink tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running render sink tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testBitwiseOperationRender();
+  testNotAndShiftRender();
+  testBaseTableRender();
+  testSinks();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
@@ -0,0 +1,314 @@
+#include "../include/roaring_bitmap.h"
+#include "../include/bitwise_cpu.h"
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+using Reference = std::set<uint32_t>;
+
+std::vector<uint32_t> toVector(const Reference &reference)
+{
+  return std::vector<uint32_t>(reference.begin(), reference.end());
+}
+
+void checkMatches(const bitwise::RoaringBitmap &bitmap, const Reference &reference)
+{
+  assert(bitmap.countSetBits() == reference.size());
+  assert(bitmap.empty() == reference.empty());
+  assert(bitmap.toVector() == toVector(reference));
+}
+
+// A set mixing all three container kinds: a sparse chunk, a dense chunk and a chunk of long runs
+void buildMixed(std::mt19937 &rng, uint32_t seedKey, bitwise::RoaringBitmap &bitmap, Reference &reference)
+{
+  uint32_t sparseBase = seedKey << 16, denseBase = (seedKey + 1) << 16, runBase = (seedKey + 3) << 16;
+  for (int i = 0; i < 300; ++i)
+  {
+    uint32_t value = sparseBase + rng() % 65536;
+    bitmap.setBit(value);
+    reference.insert(value);
+  }
+  for (int i = 0; i < 20000; ++i)
+  {
+    uint32_t value = denseBase + rng() % 65536;
+    bitmap.setBit(value);
+    reference.insert(value);
+  }
+  for (uint32_t start = runBase + rng() % 100; start < runBase + 60000; start += 1000 + rng() % 500)
+  {
+    uint32_t length = 200 + rng() % 300;
+    bitmap.addRange(start, uint64_t(start) + length);
+    for (uint32_t v = start; v < start + length; ++v)
+      reference.insert(v);
+  }
+}
+
+void testBitOperations()
+{
+  std::cout << "Testing RoaringBitmap bit operations..." << std::endl;
+
+  bitwise::RoaringBitmap bitmap;
+  assert(bitmap.empty() && bitmap.countSetBits() == 0);
+
+  bitmap.setBit(0);
+  bitmap.setBit(65535);
+  bitmap.setBit(65536);
+  bitmap.setBit(0xFFFFFFFF);
+  assert(bitmap.contains(0) && bitmap.contains(65535) && bitmap.contains(65536) && bitmap.contains(0xFFFFFFFF));
+  assert(!bitmap.contains(1) && !bitmap.contains(0xFFFFFFFE));
+  assert(bitmap.countSetBits() == 4);
+  assert(bitmap.statistics().arrayContainers == 3);
+
+  bitmap.setBit(0); // already present
+  assert(bitmap.countSetBits() == 4);
+
+  bitmap.clearBit(65536);
+  assert(!bitmap.contains(65536));
+  assert(bitmap.statistics().arrayContainers == 2); // empty containers are dropped
+
+  bitmap.toggleBit(7);
+  assert(bitmap.contains(7));
+  bitmap.toggleBit(7);
+  assert(!bitmap.contains(7));
+
+  bitwise::RoaringBitmap listed{5, 3, 1 << 20, 3};
+  assert((listed.toVector() == std::vector<uint32_t>{3, 5, 1 << 20}));
+
+  std::cout << "✓ Bit operation tests passed" << std::endl;
+}
+
+void testContainerConversions()
+{
+  std::cout << "Testing container conversions..." << std::endl;
+
+  // Crossing 4096 values turns an array into a bitmap, and dropping back turns it into an array
+  bitwise::RoaringBitmap bitmap;
+  for (uint32_t v = 0; v < 2 * bitwise::RoaringBitmap::kArrayMaxSize; v += 2)
+    bitmap.setBit(v);
+  assert(bitmap.statistics().arrayContainers == 1);
+  bitmap.setBit(1);
+  assert(bitmap.statistics().bitmapContainers == 1);
+  assert(bitmap.statistics().bytes == 2 + bitwise::RoaringBitmap::kBitmapWords * 4);
+  bitmap.clearBit(1);
+  assert(bitmap.statistics().arrayContainers == 1);
+  assert(bitmap.countSetBits() == bitwise::RoaringBitmap::kArrayMaxSize);
+
+  // Ranges are stored as runs, and stay correct as values are added and removed inside them
+  bitwise::RoaringBitmap runs;
+  Reference reference;
+  runs.addRange(100, 50000);
+  for (uint32_t v = 100; v < 50000; ++v)
+    reference.insert(v);
+  assert(runs.statistics().runContainers == 1);
+  assert(runs.statistics().bytes == 2 + 4);
+  checkMatches(runs, reference);
+
+  for (uint32_t v : {500U, 501U, 100U, 49999U, 700U})
+  {
+    runs.clearBit(v);
+    reference.erase(v);
+  }
+  for (uint32_t v : {500U, 99U, 50000U, 60000U})
+  {
+    runs.setBit(v);
+    reference.insert(v);
+  }
+  assert(runs.statistics().runContainers == 1);
+  checkMatches(runs, reference);
+
+  // A range spanning several chunks, including the very top of the 32-bit space
+  bitwise::RoaringBitmap wide;
+  wide.addRange(0xFFFD0000, uint64_t(1) << 32);
+  assert(wide.countSetBits() == 3 * 65536);
+  assert(wide.contains(0xFFFFFFFF) && !wide.contains(0xFFFCFFFF));
+  wide.addRange(10, 10); // empty
+  assert(wide.countSetBits() == 3 * 65536);
+
+  // runOptimize compresses interval-heavy containers and leaves scattered ones alone
+  bitwise::RoaringBitmap scattered;
+  for (uint32_t v = 0; v < 60000; ++v)
+  {
+    if (v % 3 != 0)
+      scattered.setBit(v);
+  }
+  assert(scattered.statistics().bitmapContainers == 1);
+  assert(!scattered.runOptimize());
+
+  bitwise::RoaringBitmap intervals;
+  for (uint32_t v = 0; v < 60000; ++v)
+  {
+    if (v % 1000 < 900)
+      intervals.setBit(v);
+  }
+  bitwise::RoaringBitmap before = intervals;
+  assert(intervals.statistics().bitmapContainers == 1);
+  assert(intervals.runOptimize());
+  assert(intervals.statistics().runContainers == 1);
+  assert(intervals.statistics().bytes < before.statistics().bytes);
+  assert(intervals == before);
+
+  std::cout << "✓ Container conversion tests passed" << std::endl;
+}
+
+void testSetOperations()
+{
+  std::cout << "Testing set operations across container kinds..." << std::endl;
+
+  std::mt19937 rng(13);
+  for (int round = 0; round < 6; ++round)
+  {
+    bitwise::RoaringBitmap a, b;
+    Reference refA, refB;
+    // Overlapping key ranges so every pairing of array, bitmap and run containers occurs
+    buildMixed(rng, 0, a, refA);
+    buildMixed(rng, static_cast<uint32_t>(round % 4), b, refB);
+    if (round % 2 == 1)
+    {
+      a.runOptimize();
+      b.runOptimize();
+    }
+    checkMatches(a, refA);
+    checkMatches(b, refB);
+
+    Reference expected;
+    std::set_intersection(refA.begin(), refA.end(), refB.begin(), refB.end(), std::inserter(expected, expected.end()));
+    checkMatches(bitwise::bitwiseAnd(a, b), expected);
+
+    expected.clear();
+    std::set_union(refA.begin(), refA.end(), refB.begin(), refB.end(), std::inserter(expected, expected.end()));
+    checkMatches(bitwise::bitwiseOr(a, b), expected);
+
+    expected.clear();
+    std::set_symmetric_difference(refA.begin(), refA.end(), refB.begin(), refB.end(),
+                                  std::inserter(expected, expected.end()));
+    checkMatches(bitwise::bitwiseXor(a, b), expected);
+
+    expected.clear();
+    std::set_difference(refA.begin(), refA.end(), refB.begin(), refB.end(), std::inserter(expected, expected.end()));
+    checkMatches(bitwise::bitwiseAndNot(a, b), expected);
+    expected.clear();
+    std::set_difference(refB.begin(), refB.end(), refA.begin(), refA.end(), std::inserter(expected, expected.end()));
+    checkMatches(bitwise::bitwiseAndNot(b, a), expected);
+  }
+
+  // Identities
+  bitwise::RoaringBitmap a, empty;
+  Reference refA;
+  buildMixed(rng, 7, a, refA);
+  assert(bitwise::bitwiseXor(a, a).empty());
+  assert(bitwise::bitwiseAndNot(a, a).empty());
+  assert(bitwise::bitwiseAnd(a, a) == a);
+  assert(bitwise::bitwiseOr(a, empty) == a);
+  assert(bitwise::bitwiseAnd(a, empty).empty());
+
+  std::cout << "✓ Set operations match std::set" << std::endl;
+}
+
+void testDenseIntersections()
+{
+  std::cout << "Testing bitmap intersections that shrink to arrays..." << std::endl;
+
+  bitwise::SimdLevel best = bitwise::detectSimdLevel();
+  for (int level = 0; level <= static_cast<int>(best); ++level)
+  {
+    bitwise::setSimdLevel(static_cast<bitwise::SimdLevel>(level));
+    std::mt19937 rng(17);
+    for (int round = 0; round < 4; ++round)
+    {
+      // Two bitmap containers whose intersection is small, including the first and last values of the chunk
+      bitwise::RoaringBitmap a, b;
+      Reference refA, refB;
+      for (uint32_t value : {0U, 1U, 65504U, 65535U})
+      {
+        a.setBit((5 << 16) + value);
+        b.setBit((5 << 16) + value);
+        refA.insert((5 << 16) + value);
+        refB.insert((5 << 16) + value);
+      }
+      for (int i = 0; i < 9000 + 2000 * round; ++i)
+      {
+        uint32_t value = (5 << 16) + rng() % 65536;
+        a.setBit(value);
+        refA.insert(value);
+        value = (5 << 16) + rng() % 65536;
+        b.setBit(value);
+        refB.insert(value);
+      }
+      Reference expected;
+      std::set_intersection(refA.begin(), refA.end(), refB.begin(), refB.end(), std::inserter(expected, expected.end()));
+      bitwise::RoaringBitmap both = bitwise::bitwiseAnd(a, b);
+      checkMatches(both, expected);
+      assert(both.statistics().arrayContainers == 1);
+      expected.clear();
+      std::set_difference(refA.begin(), refA.end(), refB.begin(), refB.end(), std::inserter(expected, expected.end()));
+      checkMatches(bitwise::bitwiseAndNot(a, b), expected);
+    }
+
+    // Even values against multiples of 16 plus some odd values: exactly kArrayMaxSize in common
+    bitwise::RoaringBitmap evens, sixteenths;
+    for (uint32_t value = 0; value < 65536; value += 2)
+      evens.setBit(value);
+    for (uint32_t value = 0; value < 65536; value += 16)
+      sixteenths.setBit(value);
+    for (uint32_t value = 1; value < 4000; value += 2)
+      sixteenths.setBit(value);
+    bitwise::RoaringBitmap common = bitwise::bitwiseAnd(evens, sixteenths);
+    assert(common.countSetBits() == bitwise::RoaringBitmap::kArrayMaxSize);
+    assert(common.statistics().arrayContainers == 1);
+    std::vector<uint32_t> values = common.toVector();
+    for (std::size_t i = 0; i < values.size(); ++i)
+      assert(values[i] == 16 * i);
+  }
+  bitwise::setSimdLevel(best);
+
+  std::cout << "✓ Bitmap intersections match std::set at every SIMD level" << std::endl;
+}
+
+void testAddMany()
+{
+  std::cout << "Testing addMany..." << std::endl;
+
+  std::mt19937 rng(99);
+  std::vector<uint32_t> values(50000);
+  for (uint32_t &value : values)
+    value = rng() % (1U << 20);
+
+  bitwise::RoaringBitmap unsorted;
+  unsorted.addMany(values.data(), values.size());
+
+  std::sort(values.begin(), values.end());
+  bitwise::RoaringBitmap sorted;
+  sorted.addMany(values.data(), values.size());
+
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+  assert(sorted.toVector() == values);
+  assert(unsorted == sorted);
+  assert(sorted.countSetBits() == values.size());
+
+  std::cout << "✓ addMany tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running RoaringBitmap tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testBitOperations();
+  testContainerConversions();
+  testSetOperations();
+  testDenseIntersections();
+  testAddMany();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
@@ -0,0 +1,422 @@
+#include "../include/bitwise_service.h"
+#include "../include/bitwise_utils.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using bitwise::service::Op;
+
+// Runs one Session over a whole buffer and decodes every response
+std::vector<bitwise::service::Response> answer(bitwise::service::Session &session, const std::vector<uint8_t> &requests,
+                                               std::vector<uint8_t> &out)
+{
+  out.clear();
+  std::size_t consumed = session.process(requests.data(), requests.size(), out);
+  assert(consumed == requests.size());
+  std::vector<bitwise::service::Response> responses;
+  std::size_t offset = 0;
+  while (offset < out.size())
+  {
+    bitwise::service::Response response;
+    std::size_t length = bitwise::service::parseResponse(out.data() + offset, out.size() - offset, response);
+    assert(length > 0);
+    responses.push_back(response);
+    offset += length;
+  }
+  return responses;
+}
+
+void testNumericRequests()
+{
+  std::cout << "Testing numeric requests..." << std::endl;
+
+  bitwise::service::Session session;
+  std::vector<uint8_t> requests, out;
+  const uint32_t pairs[] = {0xF0F0, 0xFF00, 12, 10, 0xFFFFFFFF, 0};
+  bitwise::service::appendRequest(requests, 1, Op::And, 0, pairs, 3);
+  bitwise::service::appendRequest(requests, 2, Op::Xor, 0, pairs, 3);
+  const uint32_t shifts[] = {1, 31, 0x80000000, 31, 0xFF, 0};
+  bitwise::service::appendRequest(requests, 3, Op::Shl, 0, shifts, 3);
+  bitwise::service::appendRequest(requests, 4, Op::Shr, 0, shifts, 3);
+  const uint32_t popcount[] = {0xFF, 0, 0, 0};
+  bitwise::service::appendRequest(requests, 5, Op::Popcnt, 0, popcount, 2);
+  const uint32_t bits[] = {0b1010, 1, 0b1010, 2};
+  bitwise::service::appendRequest(requests, 6, Op::IsSet, 0, bits, 2);
+  bitwise::service::appendRequest(requests, 7, Op::Toggle, 0, bits, 2);
+  bitwise::service::appendRequest(requests, 8, Op::Not, 0, nullptr, 0); // empty batch
+
+  // Eight pipelined frames come back in order, one response each
+  std::vector<bitwise::service::Response> responses = answer(session, requests, out);
+  assert(responses.size() == 8);
+  for (std::size_t i = 0; i < responses.size(); ++i)
+  {
+    assert(responses[i].id == i + 1);
+    assert(responses[i].status == bitwise::service::Status::Ok);
+  }
+  assert(responses[0].op == Op::And && responses[0].count == 3);
+  assert(responses[0].number(0) == 0xF000 && responses[0].number(1) == 8 && responses[0].number(2) == 0);
+  assert(responses[1].number(0) == 0x0FF0 && responses[1].number(1) == 6 && responses[1].number(2) == 0xFFFFFFFF);
+  assert(responses[2].number(0) == 0x80000000 && responses[2].number(1) == 0 && responses[2].number(2) == 0xFF);
+  assert(responses[3].number(0) == 0 && responses[3].number(1) == 1 && responses[3].number(2) == 0xFF);
+  assert(responses[4].number(0) == 8 && responses[4].number(1) == 0);
+  assert(responses[5].number(0) == 1 && responses[5].number(1) == 0);
+  assert(responses[6].number(0) == 0b1000 && responses[6].number(1) == 0b1110);
+  assert(responses[7].count == 0 && responses[7].payloadSize == 0);
+
+  std::cout << "✓ Numeric request tests passed" << std::endl;
+}
+
+void testTextRequests()
+{
+  std::cout << "Testing text and rendered requests..." << std::endl;
+
+  bitwise::service::Session session;
+  std::vector<uint8_t> requests, out;
+  const uint32_t values[] = {5, 0, 0xDEADBEEF, 0};
+  bitwise::service::appendRequest(requests, 1, Op::Bin, 0, values, 2);
+  bitwise::service::appendRequest(requests, 2, Op::Hex, 0, values, 2);
+  const uint32_t pair[] = {0b1100, 0b1010};
+  bitwise::service::appendRequest(requests, 3, Op::And, bitwise::service::kFlagRender, pair, 1);
+  const uint32_t shift[] = {3, 4};
+  bitwise::service::appendRequest(requests, 4, Op::Shl, bitwise::service::kFlagRender, shift, 1);
+  const uint32_t table[] = {4, 2};
+  bitwise::service::appendRequest(requests, 5, Op::BaseTable, 0, table, 1);
+
+  std::vector<bitwise::service::Response> responses = answer(session, requests, out);
+  assert(responses.size() == 5);
+  assert(responses[0].texts() == (std::vector<std::string>{bitwise::toBinaryString(5), bitwise::toBinaryString(0xDEADBEEF)}));
+  assert(responses[1].texts() == (std::vector<std::string>{bitwise::toHexString(5), bitwise::toHexString(0xDEADBEEF)}));
+
+  // Rendered text is exactly what the visualizers write to a sink
+  bitwise::BufferSink expected;
+  bitwise::displayBitwiseOperation(expected, 0b1100, 0b1010, "AND", 0b1000);
+  assert(responses[2].texts() == std::vector<std::string>{expected.str()});
+  expected.clear();
+  bitwise::displayShiftOperation(expected, 3, 4, 48, "LEFT");
+  assert(responses[3].texts() == std::vector<std::string>{expected.str()});
+  expected.clear();
+  bitwise::displayBaseTable(expected, 4, 2);
+  assert(responses[4].texts() == std::vector<std::string>{expected.str()});
+
+  std::cout << "✓ Text request tests passed" << std::endl;
+}
+
+void testBadRequests()
+{
+  std::cout << "Testing malformed requests..." << std::endl;
+
+  bitwise::service::Session session;
+  std::vector<uint8_t> requests, out;
+  const uint32_t badShift[] = {1, 3, 1, 32};
+  bitwise::service::appendRequest(requests, 1, Op::Shl, 0, badShift, 2);
+  const uint32_t pair[] = {1, 2};
+  bitwise::service::appendRequest(requests, 2, static_cast<Op>(99), 0, pair, 1);
+  bitwise::service::appendRequest(requests, 3, Op::Popcnt, bitwise::service::kFlagRender, pair, 1);
+  bitwise::service::appendRequest(requests, 4, Op::And, 0x80, pair, 1);
+  const uint32_t table[] = {4, 1};
+  bitwise::service::appendRequest(requests, 5, Op::BaseTable, 0, table, 1);
+  bitwise::service::appendRequest(requests, 6, Op::And, 0, pair, 1);
+  requests[requests.size() - 10] = 2; // item count 2 with one item of payload
+
+  std::vector<bitwise::service::Response> responses = answer(session, requests, out);
+  assert(responses.size() == 6);
+  const char *messages[] = {"bit index out of range (0-31)", "unknown operation", "operation has no visualizer",
+                            "unknown flags", "base table needs length 0-64 and basis 2-36",
+                            "payload size does not match item count"};
+  for (std::size_t i = 0; i < 6; ++i)
+  {
+    assert(responses[i].id == i + 1);
+    assert(responses[i].status == bitwise::service::Status::BadRequest);
+    assert(responses[i].texts() == std::vector<std::string>{messages[i]});
+  }
+  assert(!session.failed()); // framing was intact, so the session carries on
+
+  // Rendered and base table frames are capped, since each item expands to kilobytes of text
+  std::vector<uint32_t> tables(2 * 65535);
+  for (std::size_t i = 0; i < tables.size(); i += 2)
+  {
+    tables[i] = 64;
+    tables[i + 1] = 36;
+  }
+  requests.clear();
+  bitwise::service::appendRequest(requests, 1, Op::BaseTable, 0, tables.data(), 65535);
+  bitwise::service::appendRequest(requests, 2, Op::Xor, bitwise::service::kFlagRender, tables.data(), 65);
+  bitwise::service::appendRequest(requests, 3, Op::BaseTable, 0, tables.data(), 64);
+  responses = answer(session, requests, out);
+  assert(responses.size() == 3);
+  for (std::size_t i = 0; i < 2; ++i)
+  {
+    assert(responses[i].status == bitwise::service::Status::BadRequest);
+    assert(responses[i].texts() == std::vector<std::string>{"too many rendered items (at most 64)"});
+  }
+  assert(responses[2].status == bitwise::service::Status::Ok && responses[2].count == 64);
+
+  // Frames past the output limit are left for a later call
+  out.clear();
+  std::size_t first = session.process(requests.data(), requests.size(), out, 1);
+  assert(first == requests.size() - bitwise::service::kHeaderSize - 8 * 65 - bitwise::service::kHeaderSize - 8 * 64);
+  assert(session.process(requests.data() + first, requests.size() - first, out, 1) == 0);
+  out.clear();
+  std::size_t rest = session.process(requests.data() + first, requests.size() - first, out, 1);
+  assert(rest == bitwise::service::kHeaderSize + 8 * 65);
+
+  // A partial frame is left for the next call
+  requests.clear();
+  bitwise::service::appendRequest(requests, 7, Op::Or, 0, pair, 1);
+  out.clear();
+  assert(session.process(requests.data(), requests.size() - 1, out) == 0 && out.empty());
+  assert(session.process(requests.data(), 5, out) == 0);
+
+  // An impossible payload length ends the session
+  std::vector<uint8_t> garbage(bitwise::service::kHeaderSize, 0xFF);
+  out.clear();
+  assert(session.process(garbage.data(), garbage.size(), out) == garbage.size());
+  assert(session.failed());
+  bitwise::service::Response response;
+  assert(bitwise::service::parseResponse(out.data(), out.size(), response) == out.size());
+  assert(response.status == bitwise::service::Status::BadRequest);
+
+  std::cout << "✓ Malformed request tests passed" << std::endl;
+}
+
+void testAddresses()
+{
+  std::cout << "Testing address parsing..." << std::endl;
+
+  bitwise::service::Address address;
+  std::string error;
+  assert(bitwise::service::parseAddress("unix:/tmp/bitwise.sock", address, error));
+  assert(address.unixPath == "/tmp/bitwise.sock");
+  assert(bitwise::service::parseAddress("localhost:7000", address, error));
+  assert(address.unixPath.empty() && address.host == "localhost" && address.port == 7000);
+  assert(bitwise::service::parseAddress("7001", address, error));
+  assert(address.host == "127.0.0.1" && address.port == 7001);
+  assert(!bitwise::service::parseAddress("unix:", address, error));
+  assert(!bitwise::service::parseAddress("host:99999", address, error));
+  assert(!bitwise::service::parseAddress(":80", address, error));
+  assert(!bitwise::service::parseAddress("port", address, error));
+  assert(error.find("invalid address") != std::string::npos);
+
+  std::cout << "✓ Address tests passed" << std::endl;
+}
+
+// Sends requests in small pieces and reads until expected responses have arrived
+std::vector<uint8_t> exchange(int fd, const std::vector<uint8_t> &requests, std::size_t expected,
+                              std::size_t pieceSize = 7)
+{
+  for (std::size_t sent = 0; sent < requests.size();)
+  {
+    std::size_t piece = std::min<std::size_t>(pieceSize, requests.size() - sent);
+    ssize_t written = send(fd, requests.data() + sent, piece, MSG_NOSIGNAL);
+    assert(written > 0);
+    sent += static_cast<std::size_t>(written);
+  }
+  std::vector<uint8_t> received;
+  std::size_t parsed = 0, offset = 0;
+  while (parsed < expected)
+  {
+    uint8_t buffer[4096];
+    ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+    assert(got > 0);
+    received.insert(received.end(), buffer, buffer + got);
+    bitwise::service::Response response;
+    while (std::size_t length = bitwise::service::parseResponse(received.data() + offset, received.size() - offset, response))
+    {
+      offset += length;
+      ++parsed;
+    }
+  }
+  return received;
+}
+
+void testServer(const bitwise::service::Address &listenAddress, const char *label)
+{
+  std::cout << "Testing the epoll server over " << label << "..." << std::endl;
+
+  bitwise::service::Server server;
+  std::string error;
+  assert(server.listen(listenAddress, error));
+  bitwise::service::Address clientAddress = listenAddress;
+  if (clientAddress.unixPath.empty())
+    clientAddress.port = server.port();
+  std::thread loop([&]
+                   { server.run(); });
+
+  // Several clients at once, each pipelining frames split across many small writes
+  std::vector<std::thread> clients;
+  for (uint32_t c = 0; c < 4; ++c)
+  {
+    clients.emplace_back([&, c]
+                         {
+                           std::string connectError;
+                           int fd = bitwise::service::connectTo(clientAddress, connectError);
+                           assert(fd >= 0);
+                           for (int round = 0; round < 20; ++round)
+                           {
+                             std::vector<uint8_t> requests;
+                             std::vector<uint32_t> operands;
+                             for (uint32_t i = 0; i < 100; ++i)
+                             {
+                               operands.push_back(c * 1000 + i);
+                               operands.push_back(0xFF);
+                             }
+                             for (uint32_t f = 0; f < 10; ++f)
+                               bitwise::service::appendRequest(requests, f, Op::And, 0, operands.data(), 100);
+                             std::vector<uint8_t> replies = exchange(fd, requests, 10);
+                             std::size_t offset = 0;
+                             for (uint32_t f = 0; f < 10; ++f)
+                             {
+                               bitwise::service::Response response;
+                               offset += bitwise::service::parseResponse(replies.data() + offset, replies.size() - offset, response);
+                               assert(response.id == f && response.count == 100);
+                               for (uint32_t i = 0; i < 100; ++i)
+                                 assert(response.number(i) == ((c * 1000 + i) & 0xFF));
+                             }
+                             assert(offset == replies.size());
+                           }
+                           close(fd); });
+  }
+  for (std::thread &client : clients)
+    client.join();
+
+  // An oversized base table frame is refused; pipelined frames whose output exceeds the
+  // server's backlog are answered in turn as the client drains it
+  int fd = bitwise::service::connectTo(clientAddress, error);
+  assert(fd >= 0);
+  std::vector<uint32_t> tables(2 * 65535);
+  for (std::size_t i = 0; i < tables.size(); i += 2)
+  {
+    tables[i] = 64;
+    tables[i + 1] = 36;
+  }
+  std::vector<uint8_t> requests;
+  bitwise::service::appendRequest(requests, 1, Op::BaseTable, 0, tables.data(), 65535);
+  std::vector<uint8_t> refused = exchange(fd, requests, 1);
+  bitwise::service::Response response;
+  assert(bitwise::service::parseResponse(refused.data(), refused.size(), response) == refused.size());
+  assert(response.id == 1 && response.status == bitwise::service::Status::BadRequest);
+  requests.clear();
+  for (uint32_t f = 0; f < 20; ++f)
+    bitwise::service::appendRequest(requests, f, Op::BaseTable, 0, tables.data(), 64);
+  // One write: the server stops reading while its backlog is full, so tiny pieces could fill the socket
+  std::vector<uint8_t> tableReplies = exchange(fd, requests, 20, requests.size());
+  bitwise::BufferSink table;
+  bitwise::displayBaseTable(table, 64, 36);
+  std::size_t offset = 0;
+  for (uint32_t f = 0; f < 20; ++f)
+  {
+    offset += bitwise::service::parseResponse(tableReplies.data() + offset, tableReplies.size() - offset, response);
+    assert(response.id == f && response.status == bitwise::service::Status::Ok && response.count == 64);
+    assert(response.texts().back() == table.str());
+  }
+  assert(offset == tableReplies.size());
+  close(fd);
+
+  // A broken frame gets its error response and then the connection is closed
+  fd = bitwise::service::connectTo(clientAddress, error);
+  assert(fd >= 0);
+  std::vector<uint8_t> garbage(bitwise::service::kHeaderSize, 0xFF);
+  std::vector<uint8_t> reply = exchange(fd, garbage, 1);
+  bitwise::service::parseResponse(reply.data(), reply.size(), response);
+  assert(response.status == bitwise::service::Status::BadRequest);
+  uint8_t byte;
+  assert(recv(fd, &byte, 1, 0) == 0);
+  close(fd);
+
+  server.stop();
+  loop.join();
+
+  std::cout << "✓ Server tests passed" << std::endl;
+}
+
+void testDescriptorExhaustion()
+{
+  std::cout << "Testing accept with no descriptors left..." << std::endl;
+
+  bitwise::service::Server server;
+  std::string error;
+  assert(server.listen(bitwise::service::Address(), error));
+  bitwise::service::Address address;
+  address.port = server.port();
+  std::thread loop([&]
+                   { server.run(); });
+
+  const uint32_t pair[] = {6, 3};
+  std::vector<uint8_t> request;
+  bitwise::service::appendRequest(request, 1, Op::And, 0, pair, 1);
+  int first = bitwise::service::connectTo(address, error);
+  assert(first >= 0 && !exchange(first, request, 1).empty());
+
+  // The socket is made before the limit drops to the lowest free descriptor, so only the server's accept fails
+  int waiting = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  int lowest = dup(waiting);
+  assert(waiting >= 0 && lowest >= 0);
+  close(lowest);
+  rlimit saved;
+  assert(getrlimit(RLIMIT_NOFILE, &saved) == 0);
+  rlimit lowered = saved;
+  lowered.rlim_cur = static_cast<rlim_t>(lowest);
+  assert(setrlimit(RLIMIT_NOFILE, &lowered) == 0);
+  sockaddr_in local{};
+  local.sin_family = AF_INET;
+  local.sin_port = htons(server.port());
+  local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  assert(connect(waiting, reinterpret_cast<sockaddr *>(&local), sizeof(local)) == 0);
+
+  // The loop must sleep rather than retry accept on the still-readable listener
+  timespec before, after;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &before);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &after);
+  double busy = double(after.tv_sec - before.tv_sec) + double(after.tv_nsec - before.tv_nsec) / 1e9;
+  assert(busy < 0.1);
+
+  // Closing a session frees a descriptor and the waiting client is served
+  close(first);
+  std::vector<uint8_t> reply = exchange(waiting, request, 1);
+  bitwise::service::Response response;
+  assert(bitwise::service::parseResponse(reply.data(), reply.size(), response) == reply.size());
+  assert(response.status == bitwise::service::Status::Ok && response.number(0) == 2);
+  assert(setrlimit(RLIMIT_NOFILE, &saved) == 0);
+  close(waiting);
+
+  server.stop();
+  loop.join();
+
+  std::cout << "✓ Descriptor exhaustion tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running service tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testNumericRequests();
+  testTextRequests();
+  testBadRequests();
+  testAddresses();
+
+  bitwise::service::Address local;
+  local.unixPath = "test_service_" + std::to_string(getpid()) + ".sock";
+  testServer(local, "a Unix socket");
+  assert(access(local.unixPath.c_str(), F_OK) != 0); // the server removes its socket file
+  testServer(bitwise::service::Address(), "loopback TCP");
+  testDescriptorExhaustion();
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}
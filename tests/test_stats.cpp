@@ -0,0 +1,132 @@
+#include "../include/bitwise_stats.h"
+#include "../include/bitwise_bulk.h"
+#include "../include/bitwise_utils.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stats = bitwise::stats;
+
+void testDisabledByDefault()
+{
+  std::cout << "Testing that recording starts disabled..." << std::endl;
+
+  assert(!stats::enabled());
+  bitwise::bitwiseAnd(1U, 3U);
+  std::vector<uint32_t> words(64, 1);
+  bitwise::countSetBits(words.data(), words.size());
+  stats::Snapshot snapshot = stats::snapshot();
+  for (const stats::OperationStats &op : snapshot.operations)
+    assert(op.calls == 0);
+  assert(stats::toJson(snapshot).find("\"operations\":[]") != std::string::npos);
+
+  std::cout << "✓ Nothing is recorded while disabled" << std::endl;
+}
+
+void testCounting()
+{
+  std::cout << "Testing call, byte and latency counters..." << std::endl;
+
+  stats::setEnabled(true);
+  stats::reset();
+  for (int i = 0; i < 10; ++i)
+    bitwise::bitwiseXor(static_cast<uint32_t>(i), 5U);
+  bitwise::rotateLeft(1U, 3);
+  bitwise::rotateRight(1U, 3);
+
+  std::vector<uint32_t> a(1000, 0xF0F0F0F0), b(1000, 0xFF00FF00), out(1000);
+  bitwise::bitwiseAnd(out.data(), a.data(), b.data(), a.size());
+  bitwise::bitwiseAnd(out.data(), a.data(), b.data(), a.size());
+  stats::setEnabled(false);
+  bitwise::bitwiseXor(1U, 2U); // after disabling: not counted
+
+  stats::Snapshot snapshot = stats::snapshot();
+  assert(snapshot[stats::Operation::Xor].calls == 10);
+  assert(snapshot[stats::Operation::Xor].timedCalls == 0);
+  assert(snapshot[stats::Operation::Rotate].calls == 2);
+
+  const stats::OperationStats &bulk = snapshot[stats::Operation::BulkAnd];
+  assert(bulk.calls == 2 && bulk.timedCalls == 2);
+  assert(bulk.bytes == 2 * 3 * 1000 * sizeof(uint32_t));
+  uint64_t histogramTotal = 0;
+  for (uint64_t count : bulk.latency)
+    histogramTotal += count;
+  assert(histogramTotal == 2);
+
+  std::string json = stats::toJson(snapshot);
+  assert(json.find("\"name\":\"xor\",\"calls\":10") != std::string::npos);
+  assert(json.find("\"name\":\"bulk.and\",\"calls\":2,\"bytes\":24000,\"total_ns\":") != std::string::npos);
+  assert(json.find("\"lt_ns\":") != std::string::npos);
+  assert(json.find("\"name\":\"and\"") == std::string::npos); // operations without calls are left out
+
+  // reset() starts a new period without losing later calls
+  stats::reset();
+  assert(stats::snapshot()[stats::Operation::Xor].calls == 0);
+  stats::setEnabled(true);
+  bitwise::bitwiseXor(1U, 2U);
+  stats::setEnabled(false);
+  assert(stats::snapshot()[stats::Operation::Xor].calls == 1);
+
+  std::cout << "✓ Counter tests passed" << std::endl;
+}
+
+void testThreadsMerge()
+{
+  std::cout << "Testing per-thread counters merge..." << std::endl;
+
+  stats::setEnabled(true);
+  stats::reset();
+  const int threads = 4, calls = 50000;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t)
+  {
+    workers.emplace_back([]
+                         {
+      for (int i = 0; i < calls; ++i)
+        bitwise::setBit(0U, i & 31); });
+  }
+  // Snapshots while the workers run see a consistent, non-decreasing count
+  uint64_t previous = 0;
+  for (int i = 0; i < 20; ++i)
+  {
+    uint64_t now = stats::snapshot()[stats::Operation::SetBit].calls;
+    assert(now >= previous && now <= uint64_t(threads) * calls);
+    previous = now;
+  }
+  for (std::thread &worker : workers)
+    worker.join();
+  stats::setEnabled(false);
+
+  // Exited threads have folded their counters into the totals
+  assert(stats::snapshot()[stats::Operation::SetBit].calls == uint64_t(threads) * calls);
+
+  std::cout << "✓ Thread merge tests passed" << std::endl;
+}
+
+void runAllTests()
+{
+  std::cout << "Running operation statistics tests..." << std::endl;
+  std::cout << "====================" << std::endl;
+
+  testDisabledByDefault();
+  if (stats::kCompiledIn)
+  {
+    testCounting();
+    testThreadsMerge();
+  }
+  else
+  {
+    std::cout << "(instrumentation compiled out; counter tests skipped)" << std::endl;
+  }
+
+  std::cout << "====================" << std::endl;
+  std::cout << "All tests passed! ✓" << std::endl;
+}
+
+int main()
+{
+  runAllTests();
+  return 0;
+}